@@ -0,0 +1,83 @@
+// CPU feature detection for the tools running without an AviSynth host
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#include "CpuFlags.h"
+#include "avs/cpuid.h"
+
+#if defined (__GNUC__) && ! defined (__INTEL_COMPILER)
+#include <x86intrin.h>
+#else
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+
+
+int detect_cpu_flags()
+{
+  int flags = 0;
+#if defined (__GNUC__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    flags |= CPUF_MMX | CPUF_SSE | CPUF_INTEGER_SSE | CPUF_SSE2;
+  if (__builtin_cpu_supports("sse3"))
+    flags |= CPUF_SSE3;
+  if (__builtin_cpu_supports("ssse3"))
+    flags |= CPUF_SSSE3;
+  if (__builtin_cpu_supports("sse4.1"))
+    flags |= CPUF_SSE4_1;
+  if (__builtin_cpu_supports("sse4.2"))
+    flags |= CPUF_SSE4_2;
+  if (__builtin_cpu_supports("avx"))
+    flags |= CPUF_AVX;
+  if (__builtin_cpu_supports("avx2"))
+    flags |= CPUF_AVX2;
+  if (__builtin_cpu_supports("fma"))
+    flags |= CPUF_FMA3;
+#elif defined (_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  if (info[3] & (1 << 26))
+    flags |= CPUF_MMX | CPUF_SSE | CPUF_INTEGER_SSE | CPUF_SSE2;
+  if (info[2] & (1 << 0))
+    flags |= CPUF_SSE3;
+  if (info[2] & (1 << 9))
+    flags |= CPUF_SSSE3;
+  if (info[2] & (1 << 19))
+    flags |= CPUF_SSE4_1;
+  if (info[2] & (1 << 20))
+    flags |= CPUF_SSE4_2;
+  // AVX needs the OS support for the ymm registers
+  const bool os_avx = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+  if (os_avx && (info[2] & (1 << 28)))
+    flags |= CPUF_AVX;
+  if (os_avx && (info[2] & (1 << 12)))
+    flags |= CPUF_FMA3;
+  __cpuidex(info, 7, 0);
+  if (os_avx && (info[1] & (1 << 5)))
+    flags |= CPUF_AVX2;
+#endif
+  return flags;
+}
+
+
+
+uint64_t read_tsc()
+{
+  return __rdtsc();
+}
@@ -0,0 +1,30 @@
+// CPU feature detection for the tools running without an AviSynth host
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#ifndef __MV_CpuFlags__
+#define __MV_CpuFlags__
+
+#include <cstdint>
+
+// AviSynth CPUF_ flags of the running CPU, as env->GetCPUFlags()
+int detect_cpu_flags();
+
+// Time stamp counter
+uint64_t read_tsc();
+
+#endif // __MV_CpuFlags__
@@ -0,0 +1,962 @@
+// Minimal AviSynth host: the classes whose code is baked into the plugins
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+// Same semantics as the AviSynth+ core for everything the plugins can
+// reach through AVS_Linkage.
+
+#include "ScriptEnvironment.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined (_MSC_VER)
+#include <malloc.h>
+#endif
+
+
+
+static void *aligned_malloc(size_t size, size_t align)
+{
+#if defined (_MSC_VER) || defined (__MINGW32__)
+  return _aligned_malloc(size, align);
+#else
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, align, size) != 0)
+    return nullptr;
+  return ptr;
+#endif
+}
+
+static void aligned_free(void *ptr)
+{
+#if defined (_MSC_VER) || defined (__MINGW32__)
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+static inline int sample_bits_code(int pixel_type)
+{
+  return (pixel_type >> VideoInfo::CS_Shift_Sample_Bits) & 7;
+}
+
+// Planar type without the sample size
+static inline int planar_layout(int pixel_type)
+{
+  return pixel_type & VideoInfo::CS_PLANAR_MASK & ~VideoInfo::CS_Sample_Bits_Mask;
+}
+
+
+
+/**********************************************************************/
+// VideoInfo
+
+bool VideoInfo::HasVideo() const { return width != 0; }
+bool VideoInfo::HasAudio() const { return audio_samples_per_second != 0; }
+bool VideoInfo::IsRGB() const { return (pixel_type & CS_BGR) != 0; }
+bool VideoInfo::IsRGB24() const { return (pixel_type & CS_BGR24) == CS_BGR24 && sample_bits_code(pixel_type) == 0 && !IsPlanar(); }
+bool VideoInfo::IsRGB32() const { return (pixel_type & CS_BGR32) == CS_BGR32 && sample_bits_code(pixel_type) == 0 && !IsPlanar(); }
+bool VideoInfo::IsYUV() const { return (pixel_type & CS_YUV) != 0; }
+bool VideoInfo::IsYUY2() const { return (pixel_type & CS_YUY2) == CS_YUY2; }
+bool VideoInfo::IsYV24() const { return (pixel_type & CS_PLANAR_MASK) == (CS_YV24 & CS_PLANAR_FILTER); }
+bool VideoInfo::IsYV16() const { return (pixel_type & CS_PLANAR_MASK) == (CS_YV16 & CS_PLANAR_FILTER); }
+bool VideoInfo::IsYV12() const { return (pixel_type & CS_PLANAR_MASK) == (CS_YV12 & CS_PLANAR_FILTER); }
+bool VideoInfo::IsYV411() const { return (pixel_type & CS_PLANAR_MASK) == (CS_YV411 & CS_PLANAR_FILTER); }
+bool VideoInfo::IsY8() const { return (pixel_type & CS_PLANAR_MASK) == (CS_Y8 & CS_PLANAR_FILTER); }
+
+bool VideoInfo::IsColorSpace(int c_space) const
+{
+  return IsPlanar()
+    ? (pixel_type & CS_PLANAR_MASK) == (c_space & CS_PLANAR_FILTER)
+    : (pixel_type & c_space) == c_space;
+}
+
+bool VideoInfo::Is(int property) const { return (pixel_type & property) == property; }
+bool VideoInfo::IsPlanar() const { return (pixel_type & CS_PLANAR) != 0; }
+bool VideoInfo::IsFieldBased() const { return (image_type & IT_FIELDBASED) != 0; }
+bool VideoInfo::IsParityKnown() const { return (image_type & IT_FIELDBASED) != 0 && (image_type & (IT_BFF | IT_TFF)) != 0; }
+bool VideoInfo::IsBFF() const { return (image_type & IT_BFF) != 0; }
+bool VideoInfo::IsTFF() const { return (image_type & IT_TFF) != 0; }
+
+bool VideoInfo::IsVPlaneFirst() const
+{
+  return !IsY() && IsPlanar() && (pixel_type & (CS_VPlaneFirst | CS_UPlaneFirst)) == CS_VPlaneFirst;
+}
+
+int VideoInfo::BytesFromPixels(int pixels) const
+{
+  if (IsPlanar())
+    return pixels * ComponentSize(); // first plane only
+  return pixels * (BitsPerPixel() >> 3);
+}
+
+int VideoInfo::RowSize(int plane) const
+{
+  const int rowsize = BytesFromPixels(width);
+  const bool yuv_planar = IsPlanar() && !IsY() && !IsRGB();
+  switch (plane)
+  {
+  case PLANAR_U: case PLANAR_V:
+    return yuv_planar ? rowsize >> GetPlaneWidthSubsampling(plane) : 0;
+  case PLANAR_U_ALIGNED: case PLANAR_V_ALIGNED:
+    return yuv_planar
+      ? ((rowsize >> GetPlaneWidthSubsampling(plane & ~PLANAR_ALIGNED)) + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1)
+      : 0;
+  case PLANAR_ALIGNED: case PLANAR_Y_ALIGNED:
+    return (rowsize + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1);
+  case PLANAR_R_ALIGNED: case PLANAR_G_ALIGNED: case PLANAR_B_ALIGNED:
+    return (IsPlanarRGB() || IsPlanarRGBA()) ? (rowsize + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1) : 0;
+  case PLANAR_R: case PLANAR_G: case PLANAR_B:
+    return (IsPlanarRGB() || IsPlanarRGBA()) ? rowsize : 0;
+  case PLANAR_A:
+    return (IsPlanarRGBA() || IsYUVA()) ? rowsize : 0;
+  case PLANAR_A_ALIGNED:
+    return (IsPlanarRGBA() || IsYUVA()) ? (rowsize + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1) : 0;
+  }
+  return rowsize;
+}
+
+int VideoInfo::BMPSize() const
+{
+  const int main_size = height * ((RowSize() + 3) & ~3);
+  if (IsPlanar() && !IsY() && !IsRGB())
+  {
+    const int uv_size = (height >> GetPlaneHeightSubsampling(PLANAR_U)) * ((RowSize(PLANAR_U) + 3) & ~3);
+    return main_size + 2 * uv_size + (IsYUVA() ? main_size : 0);
+  }
+  if (IsPlanar())
+    return main_size * NumComponents();
+  return main_size;
+}
+
+int64_t VideoInfo::AudioSamplesFromFrames(int frames) const
+{
+  return (fps_numerator != 0 && HasVideo())
+    ? int64_t(frames) * audio_samples_per_second * fps_denominator / fps_numerator
+    : 0;
+}
+
+int VideoInfo::FramesFromAudioSamples(int64_t samples) const
+{
+  return (fps_denominator != 0 && HasAudio())
+    ? int((samples * fps_numerator) / (int64_t(fps_denominator) * audio_samples_per_second))
+    : 0;
+}
+
+int64_t VideoInfo::AudioSamplesFromBytes(int64_t bytes) const
+{
+  return HasAudio() ? bytes / BytesPerAudioSample() : 0;
+}
+
+int64_t VideoInfo::BytesFromAudioSamples(int64_t samples) const { return samples * BytesPerAudioSample(); }
+int VideoInfo::AudioChannels() const { return HasAudio() ? nchannels : 0; }
+int VideoInfo::SampleType() const { return sample_type; }
+bool VideoInfo::IsSampleType(int testtype) const { return (sample_type & testtype) != 0; }
+int VideoInfo::SamplesPerSecond() const { return audio_samples_per_second; }
+int VideoInfo::BytesPerAudioSample() const { return nchannels * BytesPerChannelSample(); }
+
+void VideoInfo::SetFieldBased(bool isfieldbased)
+{
+  if (isfieldbased)
+    image_type |= IT_FIELDBASED;
+  else
+    image_type &= ~IT_FIELDBASED;
+}
+
+void VideoInfo::Set(int property) { image_type |= property; }
+void VideoInfo::Clear(int property) { image_type &= ~property; }
+
+int VideoInfo::GetPlaneWidthSubsampling(int plane) const
+{
+  plane &= ~PLANAR_ALIGNED;
+  if (plane == PLANAR_Y || plane == PLANAR_A || plane == PLANAR_R || plane == PLANAR_G || plane == PLANAR_B || plane == 0)
+    return 0;
+  if (NumComponents() == 1)
+    throw AvisynthError("Filter error: GetPlaneWidthSubsampling not available on greyscale pixel type.");
+  if (IsYUY2())
+    return 1;
+  if (IsPlanar() && !IsRGB())
+    return ((pixel_type >> CS_Shift_Sub_Width) + 1) & 3;
+  throw AvisynthError("Filter error: GetPlaneWidthSubsampling called with unsupported pixel type.");
+}
+
+int VideoInfo::GetPlaneHeightSubsampling(int plane) const
+{
+  plane &= ~PLANAR_ALIGNED;
+  if (plane == PLANAR_Y || plane == PLANAR_A || plane == PLANAR_R || plane == PLANAR_G || plane == PLANAR_B || plane == 0)
+    return 0;
+  if (NumComponents() == 1)
+    throw AvisynthError("Filter error: GetPlaneHeightSubsampling not available on greyscale pixel type.");
+  if (IsYUY2())
+    return 0;
+  if (IsPlanar() && !IsRGB())
+    return ((pixel_type >> CS_Shift_Sub_Height) + 1) & 3;
+  throw AvisynthError("Filter error: GetPlaneHeightSubsampling called with unsupported pixel type.");
+}
+
+int VideoInfo::BitsPerPixel() const
+{
+  switch (pixel_type)
+  {
+  case CS_BGR24: return 24;
+  case CS_BGR32: return 32;
+  case CS_YUY2:  return 16;
+  case CS_Y8:    return 8;
+  case CS_BGR48: return 48;
+  case CS_BGR64: return 64;
+  }
+  if (IsPlanar())
+  {
+    const int s = ComponentSize() * 8;
+    if (IsY())
+      return s;
+    if (IsPlanarRGB())
+      return 3 * s;
+    if (IsPlanarRGBA())
+      return 4 * s;
+    const int sub = GetPlaneWidthSubsampling(PLANAR_U) + GetPlaneHeightSubsampling(PLANAR_U);
+    return s + ((2 * s) >> sub) + (IsYUVA() ? s : 0);
+  }
+  return 0;
+}
+
+int VideoInfo::BytesPerChannelSample() const
+{
+  switch (sample_type)
+  {
+  case SAMPLE_INT8:  return 1;
+  case SAMPLE_INT16: return 2;
+  case SAMPLE_INT24: return 3;
+  case SAMPLE_INT32: return 4;
+  case SAMPLE_FLOAT: return 4;
+  }
+  return 0;
+}
+
+void VideoInfo::SetFPS(unsigned numerator, unsigned denominator)
+{
+  if (numerator == 0 || denominator == 0)
+  {
+    fps_numerator = 0;
+    fps_denominator = 1;
+    return;
+  }
+  unsigned x = numerator;
+  unsigned y = denominator;
+  while (y != 0)
+  {
+    const unsigned t = x % y;
+    x = y;
+    y = t;
+  }
+  fps_numerator = numerator / x;
+  fps_denominator = denominator / x;
+}
+
+void VideoInfo::MulDivFPS(unsigned multiplier, unsigned divisor)
+{
+  uint64_t num = uint64_t(fps_numerator) * multiplier;
+  uint64_t den = uint64_t(fps_denominator) * divisor;
+  uint64_t x = num;
+  uint64_t y = den;
+  while (y != 0)
+  {
+    const uint64_t t = x % y;
+    x = y;
+    y = t;
+  }
+  if (x != 0)
+  {
+    num /= x;
+    den /= x;
+  }
+  while (num > 0xFFFFFFFFu || den > 0xFFFFFFFFu)
+  {
+    num >>= 1;
+    den >>= 1;
+  }
+  SetFPS(unsigned(num), unsigned(den));
+}
+
+bool VideoInfo::IsSameColorspace(const VideoInfo& vi) const
+{
+  return vi.pixel_type == pixel_type || (IsYV12() && vi.IsYV12());
+}
+
+int VideoInfo::NumComponents() const
+{
+  switch (pixel_type)
+  {
+  case CS_UNKNOWN: return 0;
+  case CS_RAW32:   return 1;
+  case CS_YUY2:    return 3;
+  case CS_BGR24:   return 3;
+  case CS_BGR48:   return 3;
+  case CS_BGR32:   return 4;
+  case CS_BGR64:   return 4;
+  }
+  if (IsY())
+    return 1;
+  if (IsYUVA() || IsPlanarRGBA())
+    return 4;
+  return 3;
+}
+
+int VideoInfo::ComponentSize() const
+{
+  switch (sample_bits_code(pixel_type))
+  {
+  case 0: return 1;
+  case 2: return 4;
+  }
+  return 2;
+}
+
+int VideoInfo::BitsPerComponent() const
+{
+  static const int bits [8] = { 8, 16, 32, 0, 0, 10, 12, 14 };
+  return bits [sample_bits_code(pixel_type)];
+}
+
+bool VideoInfo::Is444() const
+{
+  const int l = planar_layout(pixel_type);
+  return l == (CS_GENERIC_YUV444 & CS_PLANAR_FILTER) || l == (CS_GENERIC_YUVA444 & CS_PLANAR_FILTER);
+}
+
+bool VideoInfo::Is422() const
+{
+  const int l = planar_layout(pixel_type);
+  return l == (CS_GENERIC_YUV422 & CS_PLANAR_FILTER) || l == (CS_GENERIC_YUVA422 & CS_PLANAR_FILTER);
+}
+
+bool VideoInfo::Is420() const
+{
+  const int l = planar_layout(pixel_type);
+  return l == (CS_GENERIC_YUV420 & CS_PLANAR_FILTER) || l == (CS_GENERIC_YUVA420 & CS_PLANAR_FILTER);
+}
+
+bool VideoInfo::IsY() const { return planar_layout(pixel_type) == (CS_GENERIC_Y & CS_PLANAR_FILTER); }
+bool VideoInfo::IsRGB48() const { return (pixel_type & CS_BGR24) == CS_BGR24 && !IsPlanar() && sample_bits_code(pixel_type) == 1; }
+bool VideoInfo::IsRGB64() const { return (pixel_type & CS_BGR32) == CS_BGR32 && !IsPlanar() && sample_bits_code(pixel_type) == 1; }
+bool VideoInfo::IsYUVA() const { return (pixel_type & CS_YUVA) != 0; }
+bool VideoInfo::IsPlanarRGB() const { return planar_layout(pixel_type) == (CS_GENERIC_RGBP & CS_PLANAR_FILTER); }
+bool VideoInfo::IsPlanarRGBA() const { return planar_layout(pixel_type) == (CS_GENERIC_RGBAP & CS_PLANAR_FILTER); }
+
+
+
+/**********************************************************************/
+// VideoFrameBuffer
+
+VideoFrameBuffer::VideoFrameBuffer(int size, int margin, Device* device_)
+  : data(static_cast<BYTE *>(aligned_malloc(size_t(size) + margin, FRAME_ALIGN)))
+  , data_size(size)
+  , sequence_number(0)
+  , refcount(0)
+  , device(device_)
+{
+  if (data == nullptr)
+    throw std::bad_alloc();
+  ScriptEnvironment::NotifyAlloc(size_t(size));
+}
+
+VideoFrameBuffer::VideoFrameBuffer()
+  : data(nullptr)
+  , data_size(0)
+  , sequence_number(0)
+  , refcount(0)
+  , device(nullptr)
+{
+}
+
+VideoFrameBuffer::~VideoFrameBuffer()
+{
+  if (data != nullptr)
+  {
+    aligned_free(data);
+    ScriptEnvironment::NotifyFree(data_size);
+  }
+}
+
+const BYTE* VideoFrameBuffer::GetReadPtr() const { return data; }
+BYTE* VideoFrameBuffer::GetWritePtr() { ++sequence_number; return data; }
+int VideoFrameBuffer::GetDataSize() const { return data_size; }
+int VideoFrameBuffer::GetSequenceNumber() const { return int(sequence_number); }
+int VideoFrameBuffer::GetRefcount() const { return int(refcount); }
+
+
+
+/**********************************************************************/
+// VideoFrame
+
+void* VideoFrame::operator new(size_t size)
+{
+  return ::operator new(size);
+}
+
+VideoFrame::VideoFrame(VideoFrameBuffer* _vfb, AVSMap* avsmap, int _offset, int _pitch, int _row_size, int _height)
+  : refcount(0), vfb(_vfb), offset(_offset), pitch(_pitch), row_size(_row_size), height(_height)
+  , offsetU(_offset), offsetV(_offset), pitchUV(0), row_sizeUV(0), heightUV(0)
+  , offsetA(0), pitchA(0), row_sizeA(0)
+  , properties(avsmap)
+{
+  InterlockedIncrement(&vfb->refcount);
+}
+
+VideoFrame::VideoFrame(VideoFrameBuffer* _vfb, AVSMap* avsmap, int _offset, int _pitch, int _row_size, int _height, int _offsetU, int _offsetV, int _pitchUV, int _row_sizeUV, int _heightUV)
+  : refcount(0), vfb(_vfb), offset(_offset), pitch(_pitch), row_size(_row_size), height(_height)
+  , offsetU(_offsetU), offsetV(_offsetV), pitchUV(_pitchUV), row_sizeUV(_row_sizeUV), heightUV(_heightUV)
+  , offsetA(0), pitchA(0), row_sizeA(0)
+  , properties(avsmap)
+{
+  InterlockedIncrement(&vfb->refcount);
+}
+
+VideoFrame::VideoFrame(VideoFrameBuffer* _vfb, AVSMap* avsmap, int _offset, int _pitch, int _row_size, int _height, int _offsetU, int _offsetV, int _pitchUV, int _row_sizeUV, int _heightUV, int _offsetA)
+  : refcount(0), vfb(_vfb), offset(_offset), pitch(_pitch), row_size(_row_size), height(_height)
+  , offsetU(_offsetU), offsetV(_offsetV), pitchUV(_pitchUV), row_sizeUV(_row_sizeUV), heightUV(_heightUV)
+  , offsetA(_offsetA), pitchA(_pitch), row_sizeA(_row_size)
+  , properties(avsmap)
+{
+  InterlockedIncrement(&vfb->refcount);
+}
+
+// Frames are only destroyed by Release()
+VideoFrame::~VideoFrame()
+{
+  delete properties;
+  if (InterlockedDecrement(&vfb->refcount) == 0)
+    ScriptEnvironment::RecycleBuffer(vfb);
+}
+
+void VideoFrame::DESTRUCTOR()
+{
+}
+
+void VideoFrame::AddRef()
+{
+  InterlockedIncrement(&refcount);
+}
+
+void VideoFrame::Release()
+{
+  if (InterlockedDecrement(&refcount) == 0)
+    delete this;
+}
+
+int VideoFrame::GetPitch(int plane) const
+{
+  switch (plane)
+  {
+  case PLANAR_U: case PLANAR_V: case PLANAR_U_ALIGNED: case PLANAR_V_ALIGNED:
+  case PLANAR_B: case PLANAR_R: case PLANAR_B_ALIGNED: case PLANAR_R_ALIGNED:
+    return pitchUV;
+  case PLANAR_A: case PLANAR_A_ALIGNED:
+    return pitchA;
+  }
+  return pitch;
+}
+
+int VideoFrame::GetRowSize(int plane) const
+{
+  switch (plane)
+  {
+  case PLANAR_U: case PLANAR_V: case PLANAR_B: case PLANAR_R:
+    return (pitchUV != 0) ? row_sizeUV : 0;
+  case PLANAR_U_ALIGNED: case PLANAR_V_ALIGNED: case PLANAR_B_ALIGNED: case PLANAR_R_ALIGNED:
+    if (pitchUV != 0)
+    {
+      const int r = (row_sizeUV + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1);
+      return (r <= pitchUV) ? r : row_sizeUV;
+    }
+    return 0;
+  case PLANAR_A:
+    return (pitchA != 0) ? row_sizeA : 0;
+  case PLANAR_A_ALIGNED:
+    if (pitchA != 0)
+    {
+      const int r = (row_sizeA + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1);
+      return (r <= pitchA) ? r : row_sizeA;
+    }
+    return 0;
+  case PLANAR_ALIGNED: case PLANAR_Y_ALIGNED: case PLANAR_G_ALIGNED:
+    {
+      const int r = (row_size + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1);
+      return (r <= pitch) ? r : row_size;
+    }
+  }
+  return row_size;
+}
+
+int VideoFrame::GetHeight(int plane) const
+{
+  switch (plane & ~PLANAR_ALIGNED)
+  {
+  case PLANAR_U: case PLANAR_V: case PLANAR_B: case PLANAR_R:
+    return (pitchUV != 0) ? heightUV : 0;
+  case PLANAR_A:
+    return (pitchA != 0) ? height : 0;
+  }
+  return height;
+}
+
+VideoFrameBuffer* VideoFrame::GetFrameBuffer() const { return vfb; }
+
+int VideoFrame::GetOffset(int plane) const
+{
+  switch (plane & ~PLANAR_ALIGNED)
+  {
+  case PLANAR_U: case PLANAR_B: return offsetU;
+  case PLANAR_V: case PLANAR_R: return offsetV;
+  case PLANAR_A: return offsetA;
+  }
+  return offset;
+}
+
+const BYTE* VideoFrame::GetReadPtr(int plane) const
+{
+  return vfb->GetReadPtr() + GetOffset(plane);
+}
+
+bool VideoFrame::IsWritable() const
+{
+  return refcount == 1 && vfb->refcount == 1;
+}
+
+// As AviSynth: no pointer on shared frames
+BYTE* VideoFrame::GetWritePtr(int plane) const
+{
+  if (plane == 0 || plane == PLANAR_Y || plane == PLANAR_G)
+    ++vfb->sequence_number;
+  return IsWritable() ? vfb->data + GetOffset(plane) : nullptr;
+}
+
+AVSMap& VideoFrame::getProperties() { return *properties; }
+const AVSMap& VideoFrame::getConstProperties() { return *properties; }
+void VideoFrame::setProperties(const AVSMap& _properties) { *properties = _properties; }
+PDevice VideoFrame::GetDevice() const { return PDevice(); }
+int VideoFrame::CheckMemory() const { return -1; }
+
+VideoFrame* VideoFrame::Subframe(int rel_offset, int new_pitch, int new_row_size, int new_height) const
+{
+  return new VideoFrame(vfb, new AVSMap(*properties), offset + rel_offset, new_pitch, new_row_size, new_height);
+}
+
+VideoFrame* VideoFrame::Subframe(int rel_offset, int new_pitch, int new_row_size, int new_height, int rel_offsetU, int rel_offsetV, int _pitchUV) const
+{
+  const int xsub = (row_size != 0 && row_sizeUV != 0) ? row_size / row_sizeUV : 1;
+  const int ysub = (height != 0 && heightUV != 0) ? height / heightUV : 1;
+  return new VideoFrame(vfb, new AVSMap(*properties), offset + rel_offset, new_pitch, new_row_size, new_height,
+    rel_offsetU + offsetU, rel_offsetV + offsetV, _pitchUV, new_row_size / xsub, new_height / ysub);
+}
+
+VideoFrame* VideoFrame::Subframe(int rel_offset, int new_pitch, int new_row_size, int new_height, int rel_offsetU, int rel_offsetV, int _pitchUV, int rel_offsetA) const
+{
+  const int xsub = (row_size != 0 && row_sizeUV != 0) ? row_size / row_sizeUV : 1;
+  const int ysub = (height != 0 && heightUV != 0) ? height / heightUV : 1;
+  return new VideoFrame(vfb, new AVSMap(*properties), offset + rel_offset, new_pitch, new_row_size, new_height,
+    rel_offsetU + offsetU, rel_offsetV + offsetV, _pitchUV, new_row_size / xsub, new_height / ysub, rel_offsetA + offsetA);
+}
+
+
+
+/**********************************************************************/
+// IClip
+
+void IClip::AddRef()
+{
+  InterlockedIncrement(&refcnt);
+}
+
+void IClip::Release()
+{
+  if (InterlockedDecrement(&refcnt) == 0)
+    delete this;
+}
+
+
+
+/**********************************************************************/
+// PClip
+
+void PClip::Init(IClip* x) { if (x) x->AddRef(); p = x; }
+void PClip::Set(IClip* x) { if (x) x->AddRef(); if (p) p->Release(); p = x; }
+IClip* PClip::GetPointerWithAddRef() const { if (p) p->AddRef(); return p; }
+
+PClip::PClip() { CONSTRUCTOR0(); }
+PClip::PClip(const PClip& x) { CONSTRUCTOR1(x); }
+PClip::PClip(IClip* x) { CONSTRUCTOR2(x); }
+void PClip::operator=(IClip* x) { OPERATOR_ASSIGN0(x); }
+void PClip::operator=(const PClip& x) { OPERATOR_ASSIGN1(x); }
+PClip::~PClip() { DESTRUCTOR(); }
+
+void PClip::CONSTRUCTOR0() { p = nullptr; }
+void PClip::CONSTRUCTOR1(const PClip& x) { Init(x.p); }
+void PClip::CONSTRUCTOR2(IClip* x) { Init(x); }
+void PClip::OPERATOR_ASSIGN0(IClip* x) { Set(x); }
+void PClip::OPERATOR_ASSIGN1(const PClip& x) { Set(x.p); }
+void PClip::DESTRUCTOR() { if (p) p->Release(); }
+
+
+
+/**********************************************************************/
+// PVideoFrame
+
+void PVideoFrame::Init(VideoFrame* x) { if (x) x->AddRef(); p = x; }
+void PVideoFrame::Set(VideoFrame* x) { if (x) x->AddRef(); if (p) p->Release(); p = x; }
+
+PVideoFrame::PVideoFrame() { CONSTRUCTOR0(); }
+PVideoFrame::PVideoFrame(const PVideoFrame& x) { CONSTRUCTOR1(x); }
+PVideoFrame::PVideoFrame(VideoFrame* x) { CONSTRUCTOR2(x); }
+void PVideoFrame::operator=(VideoFrame* x) { OPERATOR_ASSIGN0(x); }
+void PVideoFrame::operator=(const PVideoFrame& x) { OPERATOR_ASSIGN1(x); }
+PVideoFrame::~PVideoFrame() { DESTRUCTOR(); }
+
+void PVideoFrame::CONSTRUCTOR0() { p = nullptr; }
+void PVideoFrame::CONSTRUCTOR1(const PVideoFrame& x) { Init(x.p); }
+void PVideoFrame::CONSTRUCTOR2(VideoFrame* x) { Init(x); }
+void PVideoFrame::OPERATOR_ASSIGN0(VideoFrame* x) { Set(x); }
+void PVideoFrame::OPERATOR_ASSIGN1(const PVideoFrame& x) { Set(x.p); }
+void PVideoFrame::DESTRUCTOR() { if (p) p->Release(); }
+
+
+
+/**********************************************************************/
+// AVSValue
+// Arrays are deep copies, strings are not copied (SaveString storage).
+
+AVSValue::AVSValue() { CONSTRUCTOR0(); }
+AVSValue::AVSValue(IClip* c) { CONSTRUCTOR1(c); }
+AVSValue::AVSValue(const PClip& c) { CONSTRUCTOR2(c); }
+AVSValue::AVSValue(bool b) { CONSTRUCTOR3(b); }
+AVSValue::AVSValue(int i) { CONSTRUCTOR4(i); }
+AVSValue::AVSValue(float f) { CONSTRUCTOR5(f); }
+AVSValue::AVSValue(double f) { CONSTRUCTOR6(f); }
+AVSValue::AVSValue(const char* s) { CONSTRUCTOR7(s); }
+AVSValue::AVSValue(const AVSValue* a, int size) { CONSTRUCTOR8(a, size); }
+AVSValue::AVSValue(const AVSValue& a, int size) { CONSTRUCTOR8(&a, size); }
+AVSValue::AVSValue(const AVSValue& v) { CONSTRUCTOR9(v); }
+AVSValue::AVSValue(const PFunction& n) { CONSTRUCTOR11(n); }
+AVSValue::~AVSValue() { DESTRUCTOR(); }
+AVSValue& AVSValue::operator=(const AVSValue& v) { return OPERATOR_ASSIGN(v); }
+
+bool AVSValue::Defined() const { return type != 'v'; }
+bool AVSValue::IsClip() const { return type == 'c'; }
+bool AVSValue::IsBool() const { return type == 'b'; }
+bool AVSValue::IsInt() const { return type == 'i'; }
+bool AVSValue::IsFloat() const { return type == 'f' || type == 'i'; }
+bool AVSValue::IsString() const { return type == 's'; }
+bool AVSValue::IsArray() const { return type == 'a'; }
+bool AVSValue::IsFunction() const { return type == 'n'; }
+
+PClip AVSValue::AsClip() const { return IsClip() ? PClip(clip) : PClip(); }
+bool AVSValue::AsBool() const { return AsBool1(); }
+int AVSValue::AsInt() const { return AsInt1(); }
+const char* AVSValue::AsString() const { return AsString1(); }
+double AVSValue::AsFloat() const { return AsFloat1(); }
+float AVSValue::AsFloatf() const { return float(AsFloat1()); }
+bool AVSValue::AsBool(bool def) const { return AsBool2(def); }
+int AVSValue::AsInt(int def) const { return AsInt2(def); }
+double AVSValue::AsFloat(float def) const { return AsFloat2(def); }
+float AVSValue::AsFloatf(float def) const { return float(AsFloat2(def)); }
+const char* AVSValue::AsString(const char* def) const { return AsString2(def); }
+int AVSValue::ArraySize() const { return IsArray() ? array_size : 1; }
+const AVSValue& AVSValue::operator[](int index) const { return OPERATOR_INDEX(index); }
+
+bool AVSValue::AsBool1() const { return IsBool() ? boolean : false; }
+int AVSValue::AsInt1() const { return IsInt() ? integer : 0; }
+const char* AVSValue::AsString1() const { return IsString() ? string : nullptr; }
+double AVSValue::AsFloat1() const { return IsInt() ? integer : (type == 'f' ? floating_pt : 0.0); }
+bool AVSValue::AsBool2(bool def) const { return IsBool() ? boolean : def; }
+int AVSValue::AsInt2(int def) const { return IsInt() ? integer : def; }
+double AVSValue::AsDblDef(double def) const { return IsInt() ? integer : (type == 'f' ? floating_pt : def); }
+double AVSValue::AsFloat2(float def) const { return IsInt() ? integer : (type == 'f' ? floating_pt : def); }
+const char* AVSValue::AsString2(const char* def) const { return IsString() ? string : def; }
+
+void AVSValue::CONSTRUCTOR0() { type = 'v'; array_size = 0; clip = nullptr; }
+void AVSValue::CONSTRUCTOR1(IClip* c) { type = 'c'; array_size = 0; clip = c; if (c) c->AddRef(); }
+void AVSValue::CONSTRUCTOR2(const PClip& c) { type = 'c'; array_size = 0; clip = c.GetPointerWithAddRef(); }
+void AVSValue::CONSTRUCTOR3(bool b) { type = 'b'; array_size = 0; clip = nullptr; boolean = b; }
+void AVSValue::CONSTRUCTOR4(int i) { type = 'i'; array_size = 0; clip = nullptr; integer = i; }
+void AVSValue::CONSTRUCTOR5(float f) { type = 'f'; array_size = 0; clip = nullptr; floating_pt = f; }
+void AVSValue::CONSTRUCTOR6(double f) { type = 'f'; array_size = 0; clip = nullptr; floating_pt = float(f); }
+void AVSValue::CONSTRUCTOR7(const char* s) { type = 's'; array_size = 0; string = s; }
+void AVSValue::CONSTRUCTOR9(const AVSValue& v) { Assign(&v, true); }
+void AVSValue::CONSTRUCTOR11(const PFunction&) { CONSTRUCTOR0(); } // no script functions
+
+void AVSValue::CONSTRUCTOR8(const AVSValue* a, int size)
+{
+  type = 'a';
+  array_size = short(size);
+  AVSValue *copy = (size > 0) ? new AVSValue [size] : nullptr;
+  for (int i = 0; i < size; ++i)
+    copy [i] = a [i];
+  array = copy;
+}
+
+void AVSValue::DESTRUCTOR()
+{
+  if (type == 'c' && clip != nullptr)
+    clip->Release();
+  else if (type == 'a')
+    delete [] array;
+  type = 'v';
+}
+
+AVSValue& AVSValue::OPERATOR_ASSIGN(const AVSValue& v)
+{
+  if (this != &v)
+  {
+    // v may be owned by this
+    AVSValue tmp(v);
+    DESTRUCTOR();
+    Assign(&tmp, true);
+  }
+  return *this;
+}
+
+const AVSValue& AVSValue::OPERATOR_INDEX(int index) const
+{
+  return (IsArray() && index >= 0 && index < array_size) ? array [index] : *this;
+}
+
+void AVSValue::Assign(const AVSValue* src, bool init)
+{
+  if (!init)
+    DESTRUCTOR();
+  if (src->type == 'a')
+    CONSTRUCTOR8(src->array, src->array_size);
+  else
+  {
+    type = src->type;
+    array_size = src->array_size;
+    // whole union
+    memcpy(&clip, &src->clip, sizeof(*this) - (reinterpret_cast<const char *>(&clip) - reinterpret_cast<const char *>(this)));
+    if (type == 'c' && clip != nullptr)
+      clip->AddRef();
+    else if (type == 'n')
+      CONSTRUCTOR0();
+  }
+}
+
+
+
+/**********************************************************************/
+// PFunction, PDevice: no script functions, CPU frames only
+
+PFunction::PFunction() { CONSTRUCTOR0(); }
+PFunction::PFunction(IFunction* p) { CONSTRUCTOR1(p); }
+PFunction::PFunction(const PFunction& p) { CONSTRUCTOR2(p); }
+PFunction& PFunction::operator=(IFunction* p) { return OPERATOR_ASSIGN0(p); }
+PFunction& PFunction::operator=(const PFunction& p) { return OPERATOR_ASSIGN1(p); }
+PFunction::~PFunction() { DESTRUCTOR(); }
+
+void PFunction::CONSTRUCTOR0() { e = nullptr; }
+void PFunction::CONSTRUCTOR1(IFunction* p) { e = p; }
+void PFunction::CONSTRUCTOR2(const PFunction& p) { e = p.e; }
+PFunction& PFunction::OPERATOR_ASSIGN0(IFunction* p) { e = p; return *this; }
+PFunction& PFunction::OPERATOR_ASSIGN1(const PFunction& p) { e = p.e; return *this; }
+void PFunction::DESTRUCTOR() { e = nullptr; }
+
+PDevice::PDevice() { CONSTRUCTOR0(); }
+PDevice::PDevice(Device* p) { CONSTRUCTOR1(p); }
+PDevice::PDevice(const PDevice& p) { CONSTRUCTOR2(p); }
+PDevice& PDevice::operator=(Device* p) { return OPERATOR_ASSIGN0(p); }
+PDevice& PDevice::operator=(const PDevice& p) { return OPERATOR_ASSIGN1(p); }
+PDevice::~PDevice() { DESTRUCTOR(); }
+
+void PDevice::CONSTRUCTOR0() { e = nullptr; }
+void PDevice::CONSTRUCTOR1(Device* p) { e = p; }
+void PDevice::CONSTRUCTOR2(const PDevice& p) { e = p.e; }
+PDevice& PDevice::OPERATOR_ASSIGN0(Device* p) { e = p; return *this; }
+PDevice& PDevice::OPERATOR_ASSIGN1(const PDevice& p) { e = p.e; return *this; }
+void PDevice::DESTRUCTOR() { e = nullptr; }
+AvsDeviceType PDevice::GetType() const { return DEV_TYPE_CPU; }
+int PDevice::GetId() const { return 0; }
+int PDevice::GetIndex() const { return 0; }
+const char* PDevice::GetName() const { return "CPU"; }
+
+
+
+/**********************************************************************/
+// Linkage table given to the plugins
+
+static AVS_Linkage build_linkage()
+{
+  AVS_Linkage l;
+  memset(&l, 0, sizeof(l));
+  l.Size = int(sizeof(l));
+
+  l.HasVideo = &VideoInfo::HasVideo;
+  l.HasAudio = &VideoInfo::HasAudio;
+  l.IsRGB = &VideoInfo::IsRGB;
+  l.IsRGB24 = &VideoInfo::IsRGB24;
+  l.IsRGB32 = &VideoInfo::IsRGB32;
+  l.IsYUV = &VideoInfo::IsYUV;
+  l.IsYUY2 = &VideoInfo::IsYUY2;
+  l.IsYV24 = &VideoInfo::IsYV24;
+  l.IsYV16 = &VideoInfo::IsYV16;
+  l.IsYV12 = &VideoInfo::IsYV12;
+  l.IsYV411 = &VideoInfo::IsYV411;
+  l.IsY8 = &VideoInfo::IsY8;
+  l.IsColorSpace = &VideoInfo::IsColorSpace;
+  l.Is = &VideoInfo::Is;
+  l.IsPlanar = &VideoInfo::IsPlanar;
+  l.IsFieldBased = &VideoInfo::IsFieldBased;
+  l.IsParityKnown = &VideoInfo::IsParityKnown;
+  l.IsBFF = &VideoInfo::IsBFF;
+  l.IsTFF = &VideoInfo::IsTFF;
+  l.IsVPlaneFirst = &VideoInfo::IsVPlaneFirst;
+  l.BytesFromPixels = &VideoInfo::BytesFromPixels;
+  l.RowSize = &VideoInfo::RowSize;
+  l.BMPSize = &VideoInfo::BMPSize;
+  l.AudioSamplesFromFrames = &VideoInfo::AudioSamplesFromFrames;
+  l.FramesFromAudioSamples = &VideoInfo::FramesFromAudioSamples;
+  l.AudioSamplesFromBytes = &VideoInfo::AudioSamplesFromBytes;
+  l.BytesFromAudioSamples = &VideoInfo::BytesFromAudioSamples;
+  l.AudioChannels = &VideoInfo::AudioChannels;
+  l.SampleType = &VideoInfo::SampleType;
+  l.IsSampleType = &VideoInfo::IsSampleType;
+  l.SamplesPerSecond = &VideoInfo::SamplesPerSecond;
+  l.BytesPerAudioSample = &VideoInfo::BytesPerAudioSample;
+  l.SetFieldBased = &VideoInfo::SetFieldBased;
+  l.Set = &VideoInfo::Set;
+  l.Clear = &VideoInfo::Clear;
+  l.GetPlaneWidthSubsampling = &VideoInfo::GetPlaneWidthSubsampling;
+  l.GetPlaneHeightSubsampling = &VideoInfo::GetPlaneHeightSubsampling;
+  l.BitsPerPixel = &VideoInfo::BitsPerPixel;
+  l.BytesPerChannelSample = &VideoInfo::BytesPerChannelSample;
+  l.SetFPS = &VideoInfo::SetFPS;
+  l.MulDivFPS = &VideoInfo::MulDivFPS;
+  l.IsSameColorspace = &VideoInfo::IsSameColorspace;
+
+  l.VFBGetReadPtr = &VideoFrameBuffer::GetReadPtr;
+  l.VFBGetWritePtr = &VideoFrameBuffer::GetWritePtr;
+  l.GetDataSize = &VideoFrameBuffer::GetDataSize;
+  l.GetSequenceNumber = &VideoFrameBuffer::GetSequenceNumber;
+  l.GetRefcount = &VideoFrameBuffer::GetRefcount;
+
+  l.GetPitch = &VideoFrame::GetPitch;
+  l.GetRowSize = &VideoFrame::GetRowSize;
+  l.GetHeight = &VideoFrame::GetHeight;
+  l.GetFrameBuffer = &VideoFrame::GetFrameBuffer;
+  l.GetOffset = &VideoFrame::GetOffset;
+  l.VFGetReadPtr = &VideoFrame::GetReadPtr;
+  l.IsWritable = &VideoFrame::IsWritable;
+  l.VFGetWritePtr = &VideoFrame::GetWritePtr;
+  l.VideoFrame_DESTRUCTOR = &VideoFrame::DESTRUCTOR;
+
+  l.PClip_CONSTRUCTOR0 = &PClip::CONSTRUCTOR0;
+  l.PClip_CONSTRUCTOR1 = &PClip::CONSTRUCTOR1;
+  l.PClip_CONSTRUCTOR2 = &PClip::CONSTRUCTOR2;
+  l.PClip_OPERATOR_ASSIGN0 = &PClip::OPERATOR_ASSIGN0;
+  l.PClip_OPERATOR_ASSIGN1 = &PClip::OPERATOR_ASSIGN1;
+  l.PClip_DESTRUCTOR = &PClip::DESTRUCTOR;
+
+  l.PVideoFrame_CONSTRUCTOR0 = &PVideoFrame::CONSTRUCTOR0;
+  l.PVideoFrame_CONSTRUCTOR1 = &PVideoFrame::CONSTRUCTOR1;
+  l.PVideoFrame_CONSTRUCTOR2 = &PVideoFrame::CONSTRUCTOR2;
+  l.PVideoFrame_OPERATOR_ASSIGN0 = &PVideoFrame::OPERATOR_ASSIGN0;
+  l.PVideoFrame_OPERATOR_ASSIGN1 = &PVideoFrame::OPERATOR_ASSIGN1;
+  l.PVideoFrame_DESTRUCTOR = &PVideoFrame::DESTRUCTOR;
+
+  l.AVSValue_CONSTRUCTOR0 = &AVSValue::CONSTRUCTOR0;
+  l.AVSValue_CONSTRUCTOR1 = &AVSValue::CONSTRUCTOR1;
+  l.AVSValue_CONSTRUCTOR2 = &AVSValue::CONSTRUCTOR2;
+  l.AVSValue_CONSTRUCTOR3 = &AVSValue::CONSTRUCTOR3;
+  l.AVSValue_CONSTRUCTOR4 = &AVSValue::CONSTRUCTOR4;
+  l.AVSValue_CONSTRUCTOR5 = &AVSValue::CONSTRUCTOR5;
+  l.AVSValue_CONSTRUCTOR6 = &AVSValue::CONSTRUCTOR6;
+  l.AVSValue_CONSTRUCTOR7 = &AVSValue::CONSTRUCTOR7;
+  l.AVSValue_CONSTRUCTOR8 = &AVSValue::CONSTRUCTOR8;
+  l.AVSValue_CONSTRUCTOR9 = &AVSValue::CONSTRUCTOR9;
+  l.AVSValue_DESTRUCTOR = &AVSValue::DESTRUCTOR;
+  l.AVSValue_OPERATOR_ASSIGN = &AVSValue::OPERATOR_ASSIGN;
+  l.AVSValue_OPERATOR_INDEX = &AVSValue::OPERATOR_INDEX;
+  l.Defined = &AVSValue::Defined;
+  l.IsClip = &AVSValue::IsClip;
+  l.IsBool = &AVSValue::IsBool;
+  l.IsInt = &AVSValue::IsInt;
+  l.IsFloat = &AVSValue::IsFloat;
+  l.IsString = &AVSValue::IsString;
+  l.IsArray = &AVSValue::IsArray;
+  l.AsClip = &AVSValue::AsClip;
+  l.AsBool1 = &AVSValue::AsBool1;
+  l.AsInt1 = &AVSValue::AsInt1;
+  l.AsString1 = &AVSValue::AsString1;
+  l.AsFloat1 = &AVSValue::AsFloat1;
+  l.AsBool2 = &AVSValue::AsBool2;
+  l.AsInt2 = &AVSValue::AsInt2;
+  l.AsDblDef = &AVSValue::AsDblDef;
+  l.AsFloat2 = &AVSValue::AsFloat2;
+  l.AsString2 = &AVSValue::AsString2;
+  l.ArraySize = &AVSValue::ArraySize;
+
+  l.NumComponents = &VideoInfo::NumComponents;
+  l.ComponentSize = &VideoInfo::ComponentSize;
+  l.BitsPerComponent = &VideoInfo::BitsPerComponent;
+  l.Is444 = &VideoInfo::Is444;
+  l.Is422 = &VideoInfo::Is422;
+  l.Is420 = &VideoInfo::Is420;
+  l.IsY = &VideoInfo::IsY;
+  l.IsRGB48 = &VideoInfo::IsRGB48;
+  l.IsRGB64 = &VideoInfo::IsRGB64;
+  l.IsYUVA = &VideoInfo::IsYUVA;
+  l.IsPlanarRGB = &VideoInfo::IsPlanarRGB;
+  l.IsPlanarRGBA = &VideoInfo::IsPlanarRGBA;
+
+  l.getProperties = &VideoFrame::getProperties;
+  l.getConstProperties = &VideoFrame::getConstProperties;
+  l.setProperties = &VideoFrame::setProperties;
+
+  l.AVSValue_CONSTRUCTOR11 = &AVSValue::CONSTRUCTOR11;
+  l.IsFunction = &AVSValue::IsFunction;
+  l.PFunction_CONSTRUCTOR0 = &PFunction::CONSTRUCTOR0;
+  l.PFunction_CONSTRUCTOR1 = &PFunction::CONSTRUCTOR1;
+  l.PFunction_CONSTRUCTOR2 = &PFunction::CONSTRUCTOR2;
+  l.PFunction_OPERATOR_ASSIGN0 = &PFunction::OPERATOR_ASSIGN0;
+  l.PFunction_OPERATOR_ASSIGN1 = &PFunction::OPERATOR_ASSIGN1;
+  l.PFunction_DESTRUCTOR = &PFunction::DESTRUCTOR;
+
+  l.VideoFrame_CheckMemory = &VideoFrame::CheckMemory;
+  l.VideoFrame_GetDevice = &VideoFrame::GetDevice;
+
+  l.PDevice_CONSTRUCTOR0 = &PDevice::CONSTRUCTOR0;
+  l.PDevice_CONSTRUCTOR1 = &PDevice::CONSTRUCTOR1;
+  l.PDevice_CONSTRUCTOR2 = &PDevice::CONSTRUCTOR2;
+  l.PDevice_OPERATOR_ASSIGN0 = &PDevice::OPERATOR_ASSIGN0;
+  l.PDevice_OPERATOR_ASSIGN1 = &PDevice::OPERATOR_ASSIGN1;
+  l.PDevice_DESTRUCTOR = &PDevice::DESTRUCTOR;
+  l.PDevice_GetType = &PDevice::GetType;
+  l.PDevice_GetId = &PDevice::GetId;
+  l.PDevice_GetIndex = &PDevice::GetIndex;
+  l.PDevice_GetName = &PDevice::GetName;
+
+  // Everything up to the Neo part
+  l.Size = int(offsetof(AVS_Linkage, GetNeoEnv));
+
+  return l;
+}
+
+const AVS_Linkage *ScriptEnvironment::GetLinkage()
+{
+  static const AVS_Linkage linkage = build_linkage();
+  return &linkage;
+}
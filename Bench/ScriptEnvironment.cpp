@@ -0,0 +1,971 @@
+// Minimal AviSynth host for the tools running the filters without AviSynth
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#include "ScriptEnvironment.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#if defined (_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+
+
+static std::atomic<size_t> host_cur_bytes(0);
+static std::atomic<size_t> host_peak_bytes(0);
+
+// Released frame buffers, reused by the next frames of the same size
+static std::mutex pool_mtx;
+static std::vector<VideoFrameBuffer *> pool;
+enum { POOL_CAPACITY = 64 };
+
+static bool same_name(const char *a, const char *b)
+{
+  for (; *a != '\0' && *b != '\0'; ++a, ++b)
+  {
+    if (tolower((unsigned char)*a) != tolower((unsigned char)*b))
+      return false;
+  }
+  return *a == *b;
+}
+
+static int round_up(int x, int align)
+{
+  return (x + align - 1) & ~(align - 1);
+}
+
+
+
+int AVSMap::Value::size() const
+{
+  switch (type)
+  {
+  case PROPTYPE_INT:   return int(i.size());
+  case PROPTYPE_FLOAT: return int(f.size());
+  case PROPTYPE_DATA:  return int(d.size());
+  }
+  return 0;
+}
+
+
+
+ScriptEnvironment::ScriptEnvironment(int cpu_flags)
+  : _cpu_flags(cpu_flags)
+{
+  AddFunction("InternalCache", "c", &create_internal_cache, this);
+}
+
+
+
+ScriptEnvironment::~ScriptEnvironment()
+{
+  for (auto it = _at_exit.rbegin(); it != _at_exit.rend(); ++it)
+    it->first(it->second, this);
+  _at_exit.clear();
+
+  {
+    std::lock_guard<std::mutex> lock(pool_mtx);
+    for (VideoFrameBuffer *vfb : pool)
+      delete vfb;
+    pool.clear();
+  }
+
+  for (auto &a : _allocations)
+  {
+#if defined (_MSC_VER) || defined (__MINGW32__)
+    _aligned_free(a.first);
+#else
+    free(a.first);
+#endif
+  }
+
+  // The plugins stay loaded: the clips of the caller may outlive us.
+}
+
+
+
+void ScriptEnvironment::LoadPlugin(const char *path)
+{
+  typedef const char* (__stdcall *InitFunc)(IScriptEnvironment* env, const AVS_Linkage* const vectors);
+
+#if defined (_WIN32)
+  HMODULE handle = LoadLibraryA(path);
+  if (handle == nullptr)
+    ThrowError("LoadPlugin: cannot load %s", path);
+  InitFunc init = (InitFunc)GetProcAddress(handle, "AvisynthPluginInit3");
+  if (init == nullptr)
+    init = (InitFunc)GetProcAddress(handle, "_AvisynthPluginInit3@8");
+#else
+  void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr)
+    ThrowError("LoadPlugin: %s", dlerror());
+  InitFunc init = (InitFunc)dlsym(handle, "AvisynthPluginInit3");
+#endif
+  if (init == nullptr)
+    ThrowError("LoadPlugin: %s is not an AviSynth 2.6+ plugin", path);
+
+  _plugin_handles.push_back((void *)handle);
+  init(this, GetLinkage());
+}
+
+
+
+const ScriptEnvironment::Function *ScriptEnvironment::FindFunction(const char *name) const
+{
+  // Last registration wins, as with AviSynth
+  for (auto it = _functions.rbegin(); it != _functions.rend(); ++it)
+  {
+    if (same_name(it->name.c_str(), name))
+      return &*it;
+  }
+  return nullptr;
+}
+
+
+
+char ScriptEnvironment::GetParamType(const char *function, const char *param) const
+{
+  const Function *fnc = FindFunction(function);
+  if (fnc != nullptr)
+  {
+    for (const Param &par : parse_params(fnc->params.c_str()))
+    {
+      if (!par.name.empty() && same_name(par.name.c_str(), param))
+        return par.type;
+    }
+  }
+  return 0;
+}
+
+
+
+AVSValue ScriptEnvironment::Call(const char *name, const std::vector<AVSValue> &args, const std::vector<NamedArg> &named)
+{
+  const Function *fnc = FindFunction(name);
+  if (fnc == nullptr)
+    ThrowError("Script error: there is no function named \"%s\"", name);
+
+  AVSValue res = apply(*fnc, args, named);
+  if (res.IsClip() && _clip_wrapper && fnc->apply != &create_internal_cache)
+    res = _clip_wrapper(fnc->name.c_str(), res.AsClip());
+
+  return res;
+}
+
+
+
+size_t ScriptEnvironment::GetCurrentBytes()
+{
+  return host_cur_bytes.load();
+}
+
+size_t ScriptEnvironment::GetPeakBytes()
+{
+  return host_peak_bytes.load();
+}
+
+void ScriptEnvironment::NotifyAlloc(size_t size)
+{
+  const size_t cur = (host_cur_bytes += size);
+  size_t peak = host_peak_bytes.load();
+  while (cur > peak && !host_peak_bytes.compare_exchange_weak(peak, cur))
+    continue;
+}
+
+void ScriptEnvironment::NotifyFree(size_t size)
+{
+  host_cur_bytes -= size;
+}
+
+
+
+void ScriptEnvironment::RecycleBuffer(VideoFrameBuffer *vfb)
+{
+  std::lock_guard<std::mutex> lock(pool_mtx);
+  if (pool.size() >= POOL_CAPACITY)
+  {
+    delete pool.front();
+    pool.erase(pool.begin());
+  }
+  pool.push_back(vfb);
+}
+
+
+
+VideoFrameBuffer *ScriptEnvironment::get_buffer(int size)
+{
+  {
+    std::lock_guard<std::mutex> lock(pool_mtx);
+    for (auto it = pool.rbegin(); it != pool.rend(); ++it)
+    {
+      if ((*it)->data_size == size)
+      {
+        VideoFrameBuffer *vfb = *it;
+        pool.erase(std::next(it).base());
+        ++vfb->sequence_number;
+        return vfb;
+      }
+    }
+  }
+
+  return new VideoFrameBuffer(size, 0, nullptr);
+}
+
+
+
+// Plane order in the buffer: Y, U, V, A (G, B, R, A for planar RGB)
+PVideoFrame ScriptEnvironment::new_frame(const VideoInfo &vi, int align)
+{
+  align = std::max(align, int(FRAME_ALIGN));
+
+  const int row_size = vi.RowSize(vi.IsPlanar() ? PLANAR_Y : 0);
+  const int pitch = round_up(row_size, align);
+  const int size_y = pitch * vi.height;
+
+  if (!vi.IsPlanar() || vi.IsY())
+  {
+    VideoFrameBuffer *vfb = get_buffer(size_y);
+    return new VideoFrame(vfb, new AVSMap, 0, pitch, row_size, vi.height);
+  }
+
+  int row_size_uv = row_size;
+  int height_uv = vi.height;
+  if (!vi.IsRGB())
+  {
+    row_size_uv = vi.RowSize(PLANAR_U);
+    height_uv = vi.height >> vi.GetPlaneHeightSubsampling(PLANAR_U);
+  }
+  const int pitch_uv = round_up(row_size_uv, align);
+  const int size_uv = pitch_uv * height_uv;
+  const bool alpha = vi.IsYUVA() || vi.IsPlanarRGBA();
+
+  VideoFrameBuffer *vfb = get_buffer(size_y + 2 * size_uv + (alpha ? size_y : 0));
+  const int offset_u = size_y;
+  const int offset_v = size_y + size_uv;
+  if (alpha)
+  {
+    return new VideoFrame(vfb, new AVSMap, 0, pitch, row_size, vi.height,
+      offset_u, offset_v, pitch_uv, row_size_uv, height_uv, offset_v + size_uv);
+  }
+  return new VideoFrame(vfb, new AVSMap, 0, pitch, row_size, vi.height,
+    offset_u, offset_v, pitch_uv, row_size_uv, height_uv);
+}
+
+
+
+std::vector<ScriptEnvironment::Param> ScriptEnvironment::parse_params(const char *params)
+{
+  std::vector<Param> list;
+  const char *p = params;
+  while (*p != '\0')
+  {
+    Param par;
+    par.array = false;
+    if (*p == '[')
+    {
+      const char *end = strchr(p, ']');
+      if (end == nullptr)
+        break;
+      par.name.assign(p + 1, end);
+      p = end + 1;
+    }
+    par.type = *p;
+    if (par.type == '\0')
+      break;
+    ++p;
+    if (*p == '*' || *p == '+')
+    {
+      par.array = true;
+      ++p;
+    }
+    list.push_back(par);
+  }
+  return list;
+}
+
+
+
+bool ScriptEnvironment::check_type(const AVSValue &val, char type) const
+{
+  switch (type)
+  {
+  case 'c': return val.IsClip();
+  case 'i': return val.IsInt();
+  case 'f': return val.IsFloat();
+  case 'b': return val.IsBool();
+  case 's': return val.IsString();
+  }
+  return true;
+}
+
+
+
+// Positional arguments first, in order (including the named parameters),
+// then the named ones. An array parameter takes all the following
+// positional arguments of its type.
+AVSValue ScriptEnvironment::apply(const Function &fnc, const std::vector<AVSValue> &args, const std::vector<NamedArg> &named)
+{
+  const std::vector<Param> params = parse_params(fnc.params.c_str());
+  std::vector<AVSValue> vals(params.size());
+
+  size_t a = 0;
+  for (size_t p = 0; p < params.size() && a < args.size(); ++p)
+  {
+    if (params [p].array)
+    {
+      std::vector<AVSValue> elts;
+      while (a < args.size() && check_type(args [a], params [p].type))
+        elts.push_back(args [a++]);
+      vals [p] = AVSValue(elts.empty() ? nullptr : &elts [0], int(elts.size()));
+    }
+    else
+    {
+      if (!check_type(args [a], params [p].type))
+        ThrowError("Script error: invalid argument %d to %s", int(a + 1), fnc.name.c_str());
+      vals [p] = args [a++];
+    }
+  }
+  if (a < args.size())
+    ThrowError("Script error: too many arguments to %s", fnc.name.c_str());
+
+  for (const NamedArg &arg : named)
+  {
+    size_t p = 0;
+    while (p < params.size() && !same_name(params [p].name.c_str(), arg.first.c_str()))
+      ++p;
+    if (p == params.size() || params [p].name.empty())
+      ThrowError("Script error: %s does not have a named argument \"%s\"", fnc.name.c_str(), arg.first.c_str());
+    if (!check_type(arg.second, params [p].type))
+      ThrowError("Script error: invalid type for %s argument \"%s\"", fnc.name.c_str(), arg.first.c_str());
+    vals [p] = arg.second;
+  }
+
+  for (size_t p = 0; p < params.size(); ++p)
+  {
+    if (params [p].name.empty() && !vals [p].Defined() && !params [p].array)
+      ThrowError("Script error: %s is missing argument %d", fnc.name.c_str(), int(p + 1));
+  }
+
+  const AVSValue args_arr(vals.empty() ? nullptr : &vals [0], int(vals.size()));
+  return fnc.apply(args_arr, fnc.user_data, this);
+}
+
+
+
+AVSValue __cdecl ScriptEnvironment::create_internal_cache(AVSValue args, void *user_data, IScriptEnvironment *env)
+{
+  ScriptEnvironment &self = *static_cast<ScriptEnvironment *>(user_data);
+  const PClip clip = args [0].AsClip();
+  return self._clip_wrapper ? self._clip_wrapper("InternalCache", clip) : clip;
+}
+
+
+
+int __stdcall ScriptEnvironment::GetCPUFlags()
+{
+  return _cpu_flags;
+}
+
+
+
+char* __stdcall ScriptEnvironment::SaveString(const char* s, int length)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+  if (length < 0)
+    length = int(strlen(s));
+  _strings.emplace_back(s, size_t(length));
+  return &_strings.back() [0];
+}
+
+
+
+char* ScriptEnvironment::Sprintf(const char* fmt, ...)
+{
+  va_list val;
+  va_start(val, fmt);
+  char *s = VSprintf(fmt, val);
+  va_end(val);
+  return s;
+}
+
+
+
+char* __stdcall ScriptEnvironment::VSprintf(const char* fmt, va_list val)
+{
+  va_list val2;
+  va_copy(val2, val);
+  const int len = vsnprintf(nullptr, 0, fmt, val2);
+  va_end(val2);
+  if (len < 0)
+    return nullptr;
+  std::vector<char> buf(size_t(len) + 1);
+  vsnprintf(&buf [0], buf.size(), fmt, val);
+  return SaveString(&buf [0], len);
+}
+
+
+
+void ScriptEnvironment::ThrowError(const char* fmt, ...)
+{
+  va_list val;
+  va_start(val, fmt);
+  const char *msg = VSprintf(fmt, val);
+  va_end(val);
+  throw AvisynthError(msg != nullptr ? msg : fmt);
+}
+
+
+
+void __stdcall ScriptEnvironment::AddFunction(const char* name, const char* params, ApplyFunc apply, void* user_data)
+{
+  Function fnc;
+  fnc.name = name;
+  fnc.params = params;
+  fnc.apply = apply;
+  fnc.user_data = user_data;
+  _functions.push_back(fnc);
+}
+
+
+
+bool __stdcall ScriptEnvironment::FunctionExists(const char* name)
+{
+  return FindFunction(name) != nullptr;
+}
+
+
+
+AVSValue __stdcall ScriptEnvironment::Invoke(const char* name, const AVSValue args, const char* const* arg_names)
+{
+  if (FindFunction(name) == nullptr)
+    throw NotFound();
+
+  std::vector<AVSValue> pos;
+  std::vector<NamedArg> named;
+  const int nbr_args = args.IsArray() ? args.ArraySize() : 1;
+  for (int i = 0; i < nbr_args; ++i)
+  {
+    if (arg_names != nullptr && arg_names [i] != nullptr)
+      named.push_back(NamedArg(arg_names [i], args [i]));
+    else
+      pos.push_back(args [i]);
+  }
+
+  return Call(name, pos, named);
+}
+
+
+
+AVSValue __stdcall ScriptEnvironment::GetVar(const char* name)
+{
+  throw NotFound();
+}
+
+bool __stdcall ScriptEnvironment::SetVar(const char* name, const AVSValue& val)
+{
+  return false;
+}
+
+bool __stdcall ScriptEnvironment::SetGlobalVar(const char* name, const AVSValue& val)
+{
+  return false;
+}
+
+void __stdcall ScriptEnvironment::PushContext(int level)
+{
+}
+
+void __stdcall ScriptEnvironment::PopContext()
+{
+}
+
+
+
+PVideoFrame __stdcall ScriptEnvironment::NewVideoFrame(const VideoInfo& vi, int align)
+{
+  return new_frame(vi, align);
+}
+
+
+
+bool __stdcall ScriptEnvironment::MakeWritable(PVideoFrame* pvf)
+{
+  const PVideoFrame &src = *pvf;
+  if (src->IsWritable())
+    return false;
+
+  VideoFrameBuffer *vfb = get_buffer(src->vfb->data_size);
+  memcpy(vfb->data, src->vfb->data, size_t(src->vfb->data_size));
+  VideoFrame *dst = new VideoFrame(vfb, new AVSMap(*src->properties),
+    src->offset, src->pitch, src->row_size, src->height,
+    src->offsetU, src->offsetV, src->pitchUV, src->row_sizeUV, src->heightUV);
+  dst->offsetA = src->offsetA;
+  dst->pitchA = src->pitchA;
+  dst->row_sizeA = src->row_sizeA;
+  *pvf = dst;
+
+  return true;
+}
+
+
+
+void __stdcall ScriptEnvironment::BitBlt(BYTE* dstp, int dst_pitch, const BYTE* srcp, int src_pitch, int row_size, int height)
+{
+  if (height <= 0 || row_size <= 0)
+    return;
+  if (src_pitch == dst_pitch && dst_pitch == row_size)
+  {
+    memcpy(dstp, srcp, size_t(row_size) * height);
+    return;
+  }
+  for (int y = 0; y < height; ++y)
+  {
+    memcpy(dstp, srcp, size_t(row_size));
+    dstp += dst_pitch;
+    srcp += src_pitch;
+  }
+}
+
+
+
+void __stdcall ScriptEnvironment::AtExit(ShutdownFunc function, void* user_data)
+{
+  _at_exit.push_back(std::make_pair(function, user_data));
+}
+
+
+
+void __stdcall ScriptEnvironment::CheckVersion(int version)
+{
+  if (version > AVISYNTH_INTERFACE_VERSION)
+    ThrowError("Plugin was designed for a later version of Avisynth (%d)", version);
+}
+
+
+
+PVideoFrame __stdcall ScriptEnvironment::Subframe(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size, int new_height)
+{
+  return src->Subframe(rel_offset, new_pitch, new_row_size, new_height);
+}
+
+int __stdcall ScriptEnvironment::SetMemoryMax(int mem)
+{
+  return int(host_cur_bytes.load() >> 20);
+}
+
+int __stdcall ScriptEnvironment::SetWorkingDir(const char * newdir)
+{
+  return -1;
+}
+
+void* __stdcall ScriptEnvironment::ManageCache(int key, void* data)
+{
+  return nullptr;
+}
+
+bool __stdcall ScriptEnvironment::PlanarChromaAlignment(PlanarChromaAlignmentMode key)
+{
+  return false;
+}
+
+PVideoFrame __stdcall ScriptEnvironment::SubframePlanar(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size,
+  int new_height, int rel_offsetU, int rel_offsetV, int new_pitchUV)
+{
+  return src->Subframe(rel_offset, new_pitch, new_row_size, new_height, rel_offsetU, rel_offsetV, new_pitchUV);
+}
+
+void __stdcall ScriptEnvironment::DeleteScriptEnvironment()
+{
+  delete this;
+}
+
+void __stdcall ScriptEnvironment::ApplyMessage(PVideoFrame* frame, const VideoInfo& vi, const char* message, int size,
+  int textcolor, int halocolor, int bgcolor)
+{
+  // No text rendering
+}
+
+const AVS_Linkage* __stdcall ScriptEnvironment::GetAVSLinkage()
+{
+  return GetLinkage();
+}
+
+AVSValue __stdcall ScriptEnvironment::GetVarDef(const char* name, const AVSValue& def)
+{
+  return def;
+}
+
+PVideoFrame __stdcall ScriptEnvironment::SubframePlanarA(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size,
+  int new_height, int rel_offsetU, int rel_offsetV, int new_pitchUV, int rel_offsetA)
+{
+  return src->Subframe(rel_offset, new_pitch, new_row_size, new_height, rel_offsetU, rel_offsetV, new_pitchUV, rel_offsetA);
+}
+
+
+
+/**********************************************************************/
+// Frame properties
+
+void __stdcall ScriptEnvironment::copyFrameProps(const PVideoFrame& src, PVideoFrame& dst)
+{
+  *dst->properties = *src->properties;
+}
+
+const AVSMap* __stdcall ScriptEnvironment::getFramePropsRO(const PVideoFrame& frame)
+{
+  return frame->properties;
+}
+
+AVSMap* __stdcall ScriptEnvironment::getFramePropsRW(PVideoFrame& frame)
+{
+  return frame->properties;
+}
+
+int __stdcall ScriptEnvironment::propNumKeys(const AVSMap* map)
+{
+  return int(map->data.size());
+}
+
+const char* __stdcall ScriptEnvironment::propGetKey(const AVSMap* map, int index)
+{
+  if (index < 0 || index >= int(map->data.size()))
+    return nullptr;
+  auto it = map->data.begin();
+  std::advance(it, index);
+  return it->first.c_str();
+}
+
+int __stdcall ScriptEnvironment::propNumElements(const AVSMap* map, const char* key)
+{
+  auto it = map->data.find(key);
+  return (it != map->data.end()) ? it->second.size() : -1;
+}
+
+char __stdcall ScriptEnvironment::propGetType(const AVSMap* map, const char* key)
+{
+  auto it = map->data.find(key);
+  return (it != map->data.end()) ? it->second.type : char(PROPTYPE_UNSET);
+}
+
+// Looks up an element, sets *error (if any) and returns null on failure
+template <typename T>
+static const T *prop_elt(const AVSMap* map, const char* key, int index, char type, const std::vector<T> AVSMap::Value::*member, int* error)
+{
+  int err = 0;
+  const T *ptr = nullptr;
+  auto it = map->data.find(key);
+  if (it == map->data.end())
+    err = GETPROPERROR_UNSET;
+  else if (it->second.type != type)
+    err = GETPROPERROR_TYPE;
+  else if (index < 0 || index >= it->second.size())
+    err = GETPROPERROR_INDEX;
+  else
+    ptr = &(it->second.*member) [index];
+  if (error != nullptr)
+    *error = err;
+  return ptr;
+}
+
+int64_t __stdcall ScriptEnvironment::propGetInt(const AVSMap* map, const char* key, int index, int* error)
+{
+  const int64_t *v = prop_elt(map, key, index, PROPTYPE_INT, &AVSMap::Value::i, error);
+  return (v != nullptr) ? *v : 0;
+}
+
+double __stdcall ScriptEnvironment::propGetFloat(const AVSMap* map, const char* key, int index, int* error)
+{
+  const double *v = prop_elt(map, key, index, PROPTYPE_FLOAT, &AVSMap::Value::f, error);
+  return (v != nullptr) ? *v : 0;
+}
+
+const char* __stdcall ScriptEnvironment::propGetData(const AVSMap* map, const char* key, int index, int* error)
+{
+  const std::string *v = prop_elt(map, key, index, PROPTYPE_DATA, &AVSMap::Value::d, error);
+  return (v != nullptr) ? v->data() : nullptr;
+}
+
+int __stdcall ScriptEnvironment::propGetDataSize(const AVSMap* map, const char* key, int index, int* error)
+{
+  const std::string *v = prop_elt(map, key, index, PROPTYPE_DATA, &AVSMap::Value::d, error);
+  return (v != nullptr) ? int(v->size()) : -1;
+}
+
+PClip __stdcall ScriptEnvironment::propGetClip(const AVSMap* map, const char* key, int index, int* error)
+{
+  if (error != nullptr)
+    *error = (map->data.count(key) != 0) ? int(GETPROPERROR_TYPE) : int(GETPROPERROR_UNSET);
+  return PClip();
+}
+
+const PVideoFrame __stdcall ScriptEnvironment::propGetFrame(const AVSMap* map, const char* key, int index, int* error)
+{
+  if (error != nullptr)
+    *error = (map->data.count(key) != 0) ? int(GETPROPERROR_TYPE) : int(GETPROPERROR_UNSET);
+  return PVideoFrame();
+}
+
+int __stdcall ScriptEnvironment::propDeleteKey(AVSMap* map, const char* key)
+{
+  return int(map->data.erase(key));
+}
+
+// Returns the value to write to, or null if the type does not match
+static AVSMap::Value *prop_set(AVSMap* map, const char* key, char type, int append)
+{
+  AVSMap::Value &v = map->data [key];
+  if (append == PROPAPPENDMODE_REPLACE || v.type == PROPTYPE_UNSET)
+  {
+    v = AVSMap::Value();
+    v.type = type;
+  }
+  else if (v.type != type)
+    return nullptr;
+  return &v;
+}
+
+int __stdcall ScriptEnvironment::propSetInt(AVSMap* map, const char* key, int64_t i, int append)
+{
+  AVSMap::Value *v = prop_set(map, key, PROPTYPE_INT, append);
+  if (v == nullptr)
+    return 1;
+  if (append != PROPAPPENDMODE_TOUCH)
+    v->i.push_back(i);
+  return 0;
+}
+
+int __stdcall ScriptEnvironment::propSetFloat(AVSMap* map, const char* key, double d, int append)
+{
+  AVSMap::Value *v = prop_set(map, key, PROPTYPE_FLOAT, append);
+  if (v == nullptr)
+    return 1;
+  if (append != PROPAPPENDMODE_TOUCH)
+    v->f.push_back(d);
+  return 0;
+}
+
+int __stdcall ScriptEnvironment::propSetData(AVSMap* map, const char* key, const char* d, int length, int append)
+{
+  AVSMap::Value *v = prop_set(map, key, PROPTYPE_DATA, append);
+  if (v == nullptr)
+    return 1;
+  if (append != PROPAPPENDMODE_TOUCH)
+    v->d.emplace_back(d, (length < 0) ? strlen(d) : size_t(length));
+  return 0;
+}
+
+int __stdcall ScriptEnvironment::propSetClip(AVSMap* map, const char* key, PClip& clip, int append)
+{
+  return 1;
+}
+
+int __stdcall ScriptEnvironment::propSetFrame(AVSMap* map, const char* key, const PVideoFrame& frame, int append)
+{
+  return 1;
+}
+
+const int64_t* __stdcall ScriptEnvironment::propGetIntArray(const AVSMap* map, const char* key, int* error)
+{
+  return prop_elt(map, key, 0, PROPTYPE_INT, &AVSMap::Value::i, error);
+}
+
+const double* __stdcall ScriptEnvironment::propGetFloatArray(const AVSMap* map, const char* key, int* error)
+{
+  return prop_elt(map, key, 0, PROPTYPE_FLOAT, &AVSMap::Value::f, error);
+}
+
+int __stdcall ScriptEnvironment::propSetIntArray(AVSMap* map, const char* key, const int64_t* i, int size)
+{
+  AVSMap::Value *v = prop_set(map, key, PROPTYPE_INT, PROPAPPENDMODE_REPLACE);
+  v->i.assign(i, i + size);
+  return 0;
+}
+
+int __stdcall ScriptEnvironment::propSetFloatArray(AVSMap* map, const char* key, const double* d, int size)
+{
+  AVSMap::Value *v = prop_set(map, key, PROPTYPE_FLOAT, PROPAPPENDMODE_REPLACE);
+  v->f.assign(d, d + size);
+  return 0;
+}
+
+AVSMap* __stdcall ScriptEnvironment::createMap()
+{
+  return new AVSMap;
+}
+
+void __stdcall ScriptEnvironment::freeMap(AVSMap* map)
+{
+  delete map;
+}
+
+void __stdcall ScriptEnvironment::clearMap(AVSMap* map)
+{
+  map->data.clear();
+}
+
+
+
+PVideoFrame __stdcall ScriptEnvironment::NewVideoFrameP(const VideoInfo& vi, PVideoFrame* propSrc, int align)
+{
+  PVideoFrame dst = new_frame(vi, align);
+  if (propSrc != nullptr && *propSrc)
+    copyFrameProps(*propSrc, dst);
+  return dst;
+}
+
+
+
+size_t __stdcall ScriptEnvironment::GetEnvProperty(AvsEnvProperty prop)
+{
+  switch (prop)
+  {
+  case AEP_PHYSICAL_CPUS:
+  case AEP_LOGICAL_CPUS:
+    return std::max(1u, std::thread::hardware_concurrency());
+  case AEP_THREADPOOL_THREADS:
+  case AEP_FILTERCHAIN_THREADS:
+    return 1;
+  case AEP_THREAD_ID:
+    return 0;
+  case AEP_VERSION:
+    return AVISYNTH_INTERFACE_VERSION;
+  case AEP_NUM_DEVICES:
+    return 1;
+  case AEP_FRAME_ALIGN:
+  case AEP_PLANE_ALIGN:
+    return FRAME_ALIGN;
+  default:
+    ThrowError("GetEnvProperty: unsupported property %d", int(prop));
+  }
+  return 0;
+}
+
+
+
+void* __stdcall ScriptEnvironment::Allocate(size_t nBytes, size_t alignment, AvsAllocType type)
+{
+  alignment = std::max(alignment, sizeof(void *));
+#if defined (_MSC_VER) || defined (__MINGW32__)
+  void *ptr = _aligned_malloc(nBytes, alignment);
+#else
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, alignment, nBytes) != 0)
+    ptr = nullptr;
+#endif
+  if (ptr != nullptr)
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _allocations [ptr] = nBytes;
+    NotifyAlloc(nBytes);
+  }
+  return ptr;
+}
+
+
+
+void __stdcall ScriptEnvironment::Free(void* ptr)
+{
+  if (ptr == nullptr)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    auto it = _allocations.find(ptr);
+    if (it == _allocations.end())
+      return;
+    NotifyFree(it->second);
+    _allocations.erase(it);
+  }
+#if defined (_MSC_VER) || defined (__MINGW32__)
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+
+
+bool __stdcall ScriptEnvironment::GetVarTry(const char* name, AVSValue* val) const
+{
+  return false;
+}
+
+bool __stdcall ScriptEnvironment::GetVarBool(const char* name, bool def) const
+{
+  return def;
+}
+
+int __stdcall ScriptEnvironment::GetVarInt(const char* name, int def) const
+{
+  return def;
+}
+
+double __stdcall ScriptEnvironment::GetVarDouble(const char* name, double def) const
+{
+  return def;
+}
+
+const char* __stdcall ScriptEnvironment::GetVarString(const char* name, const char* def) const
+{
+  return def;
+}
+
+int64_t __stdcall ScriptEnvironment::GetVarLong(const char* name, int64_t def) const
+{
+  return def;
+}
+
+
+
+bool __stdcall ScriptEnvironment::InvokeTry(AVSValue* result, const char* name, const AVSValue& args, const char* const* arg_names)
+{
+  if (FindFunction(name) == nullptr)
+    return false;
+  *result = Invoke(name, args, arg_names);
+  return true;
+}
+
+// No implicit last
+AVSValue __stdcall ScriptEnvironment::Invoke2(const AVSValue& implicit_last, const char* name, const AVSValue args, const char* const* arg_names)
+{
+  return Invoke(name, args, arg_names);
+}
+
+bool __stdcall ScriptEnvironment::Invoke2Try(AVSValue* result, const AVSValue& implicit_last, const char* name, const AVSValue args, const char* const* arg_names)
+{
+  return InvokeTry(result, name, args, arg_names);
+}
+
+AVSValue __stdcall ScriptEnvironment::Invoke3(const AVSValue& implicit_last, const PFunction& func, const AVSValue args, const char* const* arg_names)
+{
+  throw NotFound();
+}
+
+bool __stdcall ScriptEnvironment::Invoke3Try(AVSValue* result, const AVSValue& implicit_last, const PFunction& func, const AVSValue args, const char* const* arg_names)
+{
+  return false;
+}
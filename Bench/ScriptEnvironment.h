@@ -0,0 +1,218 @@
+// Minimal AviSynth host for the tools running the filters without AviSynth
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#ifndef __MV_ScriptEnvironment__
+#define __MV_ScriptEnvironment__
+
+// This part plays the role of avisynth.dll: it is built with
+// BUILDING_AVSCORE and implements the classes whose code is only baked into
+// the plugins (HostCore.cpp). The plugin is loaded as a shared library and
+// gets the host AVS_Linkage table, as with the real host.
+// Only what MVTools uses is really implemented: no script, no variables,
+// no audio, no MT. The frame requests come from a single thread.
+
+#include "avisynth.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+
+// Frame properties: int, float and data arrays
+class AVSMap
+{
+public:
+  struct Value
+  {
+    char type = PROPTYPE_UNSET;
+    std::vector<int64_t> i;
+    std::vector<double> f;
+    std::vector<std::string> d;
+    int size() const;
+  };
+
+  std::map<std::string, Value> data;
+};
+
+
+
+class ScriptEnvironment
+  : public IScriptEnvironment
+{
+public:
+
+  struct Function
+  {
+    std::string name;
+    std::string params;
+    ApplyFunc apply;
+    void *user_data;
+  };
+
+  // Named argument, for Call()
+  typedef std::pair<std::string, AVSValue> NamedArg;
+
+  // Called for each clip returned by a function, and by InternalCache.
+  // Gives a chance to insert a cache or instrumentation.
+  typedef std::function<PClip (const char *name, const PClip &clip)> ClipWrapper;
+
+  explicit ScriptEnvironment(int cpu_flags);
+  virtual ~ScriptEnvironment();
+
+  // Throws AvisynthError on failure
+  void LoadPlugin(const char *path);
+
+  const Function *FindFunction(const char *name) const;
+
+  // Invokes the function with arguments matched to its parameter list
+  AVSValue Call(const char *name, const std::vector<AVSValue> &args, const std::vector<NamedArg> &named);
+
+  // Type letter of a named parameter, 0 if the function or the parameter
+  // does not exist
+  char GetParamType(const char *function, const char *param) const;
+
+  void SetClipWrapper(const ClipWrapper &wrapper) { _clip_wrapper = wrapper; }
+
+  // Host allocations: frame buffers (including the recycled ones) and
+  // Allocate()
+  static size_t GetCurrentBytes();
+  static size_t GetPeakBytes();
+
+  // Used by the frame buffer and frame code
+  static void NotifyAlloc(size_t size);
+  static void NotifyFree(size_t size);
+  static void RecycleBuffer(VideoFrameBuffer *vfb);
+  static const AVS_Linkage *GetLinkage();
+
+  // IScriptEnvironment
+  int __stdcall GetCPUFlags() override;
+  char* __stdcall SaveString(const char* s, int length = -1) override;
+  char* Sprintf(const char* fmt, ...) override;
+  char* __stdcall VSprintf(const char* fmt, va_list val) override;
+#ifdef AVS_WINDOWS
+  __declspec(noreturn) void ThrowError(const char* fmt, ...) override;
+#else
+  void ThrowError(const char* fmt, ...) override;
+#endif
+  void __stdcall AddFunction(const char* name, const char* params, ApplyFunc apply, void* user_data) override;
+  bool __stdcall FunctionExists(const char* name) override;
+  AVSValue __stdcall Invoke(const char* name, const AVSValue args, const char* const* arg_names = 0) override;
+  AVSValue __stdcall GetVar(const char* name) override;
+  bool __stdcall SetVar(const char* name, const AVSValue& val) override;
+  bool __stdcall SetGlobalVar(const char* name, const AVSValue& val) override;
+  void __stdcall PushContext(int level = 0) override;
+  void __stdcall PopContext() override;
+  PVideoFrame __stdcall NewVideoFrame(const VideoInfo& vi, int align = FRAME_ALIGN) override;
+  bool __stdcall MakeWritable(PVideoFrame* pvf) override;
+  void __stdcall BitBlt(BYTE* dstp, int dst_pitch, const BYTE* srcp, int src_pitch, int row_size, int height) override;
+  void __stdcall AtExit(ShutdownFunc function, void* user_data) override;
+  void __stdcall CheckVersion(int version = AVISYNTH_INTERFACE_VERSION) override;
+  PVideoFrame __stdcall Subframe(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size, int new_height) override;
+  int __stdcall SetMemoryMax(int mem) override;
+  int __stdcall SetWorkingDir(const char * newdir) override;
+  void* __stdcall ManageCache(int key, void* data) override;
+  bool __stdcall PlanarChromaAlignment(PlanarChromaAlignmentMode key) override;
+  PVideoFrame __stdcall SubframePlanar(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size,
+    int new_height, int rel_offsetU, int rel_offsetV, int new_pitchUV) override;
+  void __stdcall DeleteScriptEnvironment() override;
+  void __stdcall ApplyMessage(PVideoFrame* frame, const VideoInfo& vi, const char* message, int size,
+    int textcolor, int halocolor, int bgcolor) override;
+  const AVS_Linkage* __stdcall GetAVSLinkage() override;
+  AVSValue __stdcall GetVarDef(const char* name, const AVSValue& def = AVSValue()) override;
+  PVideoFrame __stdcall SubframePlanarA(PVideoFrame src, int rel_offset, int new_pitch, int new_row_size,
+    int new_height, int rel_offsetU, int rel_offsetV, int new_pitchUV, int rel_offsetA) override;
+  void __stdcall copyFrameProps(const PVideoFrame& src, PVideoFrame& dst) override;
+  const AVSMap* __stdcall getFramePropsRO(const PVideoFrame& frame) override;
+  AVSMap* __stdcall getFramePropsRW(PVideoFrame& frame) override;
+  int __stdcall propNumKeys(const AVSMap* map) override;
+  const char* __stdcall propGetKey(const AVSMap* map, int index) override;
+  int __stdcall propNumElements(const AVSMap* map, const char* key) override;
+  char __stdcall propGetType(const AVSMap* map, const char* key) override;
+  int64_t __stdcall propGetInt(const AVSMap* map, const char* key, int index, int* error) override;
+  double __stdcall propGetFloat(const AVSMap* map, const char* key, int index, int* error) override;
+  const char* __stdcall propGetData(const AVSMap* map, const char* key, int index, int* error) override;
+  int __stdcall propGetDataSize(const AVSMap* map, const char* key, int index, int* error) override;
+  PClip __stdcall propGetClip(const AVSMap* map, const char* key, int index, int* error) override;
+  const PVideoFrame __stdcall propGetFrame(const AVSMap* map, const char* key, int index, int* error) override;
+  int __stdcall propDeleteKey(AVSMap* map, const char* key) override;
+  int __stdcall propSetInt(AVSMap* map, const char* key, int64_t i, int append) override;
+  int __stdcall propSetFloat(AVSMap* map, const char* key, double d, int append) override;
+  int __stdcall propSetData(AVSMap* map, const char* key, const char* d, int length, int append) override;
+  int __stdcall propSetClip(AVSMap* map, const char* key, PClip& clip, int append) override;
+  int __stdcall propSetFrame(AVSMap* map, const char* key, const PVideoFrame& frame, int append) override;
+  const int64_t* __stdcall propGetIntArray(const AVSMap* map, const char* key, int* error) override;
+  const double* __stdcall propGetFloatArray(const AVSMap* map, const char* key, int* error) override;
+  int __stdcall propSetIntArray(AVSMap* map, const char* key, const int64_t* i, int size) override;
+  int __stdcall propSetFloatArray(AVSMap* map, const char* key, const double* d, int size) override;
+  AVSMap* __stdcall createMap() override;
+  void __stdcall freeMap(AVSMap* map) override;
+  void __stdcall clearMap(AVSMap* map) override;
+  PVideoFrame __stdcall NewVideoFrameP(const VideoInfo& vi, PVideoFrame* propSrc, int align = FRAME_ALIGN) override;
+  size_t __stdcall GetEnvProperty(AvsEnvProperty prop) override;
+  void* __stdcall Allocate(size_t nBytes, size_t alignment, AvsAllocType type) override;
+  void __stdcall Free(void* ptr) override;
+  bool __stdcall GetVarTry(const char* name, AVSValue* val) const override;
+  bool __stdcall GetVarBool(const char* name, bool def) const override;
+  int __stdcall GetVarInt(const char* name, int def) const override;
+  double __stdcall GetVarDouble(const char* name, double def) const override;
+  const char* __stdcall GetVarString(const char* name, const char* def) const override;
+  int64_t __stdcall GetVarLong(const char* name, int64_t def) const override;
+  bool __stdcall InvokeTry(AVSValue* result, const char* name, const AVSValue& args, const char* const* arg_names = 0) override;
+  AVSValue __stdcall Invoke2(const AVSValue& implicit_last, const char* name, const AVSValue args, const char* const* arg_names = 0) override;
+  bool __stdcall Invoke2Try(AVSValue* result, const AVSValue& implicit_last, const char* name, const AVSValue args, const char* const* arg_names = 0) override;
+  AVSValue __stdcall Invoke3(const AVSValue& implicit_last, const PFunction& func, const AVSValue args, const char* const* arg_names = 0) override;
+  bool __stdcall Invoke3Try(AVSValue* result, const AVSValue& implicit_last, const PFunction& func, const AVSValue args, const char* const* arg_names = 0) override;
+
+private:
+
+  struct Param
+  {
+    std::string name; // empty for the positional-only parameters
+    char type;        // c, i, f, b, s or . (any)
+    bool array;       // * or +
+  };
+
+  static std::vector<Param> parse_params(const char *params);
+  bool check_type(const AVSValue &val, char type) const;
+  AVSValue apply(const Function &fnc, const std::vector<AVSValue> &args, const std::vector<NamedArg> &named);
+
+  static AVSValue __cdecl create_internal_cache(AVSValue args, void *user_data, IScriptEnvironment *env);
+
+  static VideoFrameBuffer *get_buffer(int size);
+  static PVideoFrame new_frame(const VideoInfo &vi, int align);
+
+  int _cpu_flags;
+  std::vector<Function> _functions;
+  std::deque<std::string> _strings; // SaveString storage, addresses are stable
+  std::vector<std::pair<ShutdownFunc, void *> > _at_exit;
+  std::vector<void *> _plugin_handles;
+  ClipWrapper _clip_wrapper;
+
+  std::mutex _mtx; // strings and allocations
+
+  std::map<void *, size_t> _allocations; // Allocate()
+};
+
+#endif // __MV_ScriptEnvironment__
@@ -0,0 +1,850 @@
+// Kernel micro-benchmark, without an AviSynth host
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+// Times the kernels of the dispatch tables (SAD, SATD, luma, copy, overlaps,
+// DegrainN), the sub-pixel interpolators and the RB2 reducers, for each
+// block size, bit depth and arch_t tier supported by the CPU.
+// A tier is listed only when it selects a different kernel than the tier
+// below it, the speedup is relative to the C kernel.
+//
+// With -verify, nothing is timed: each tier runs on random and edge case
+// blocks and its results (return values and whole output buffers, margins
+// included) are compared with the ones of the C kernel.
+//
+// mvtools-bench [-f family]... [-b bits]... [-s WxH]... [-a arch] [-t ms] [-csv] [-verify]
+
+#include "CpuFlags.h"
+#include "avs/cpuid.h"
+#include "CopyCode.h"
+#include "Interpolation.h"
+#include "MDegrainN.h"
+#include "overlap.h"
+#include "SADFunctions.h"
+#include "types.h"
+#include "Variance.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+
+
+namespace
+{
+
+struct Options
+{
+  std::vector<std::string> families;
+  std::vector<int> bits;
+  std::vector<std::pair<int, int> > sizes;
+  arch_t max_arch = USE_AVX2;
+  double min_ms = 20;
+  bool csv = false;
+  bool verify = false;
+};
+
+struct ArchInfo
+{
+  arch_t arch;
+  const char *name;
+  int cpu_flags; // avisynth CPUF_ flags required by the tier
+};
+
+const ArchInfo arch_list[] =
+{
+  { NO_SIMD,   "c",     0 },
+  { USE_SSE2,  "sse2",  CPUF_SSE2 },
+  { USE_SSE41, "sse41", CPUF_SSE2 | CPUF_SSE4_1 },
+  { USE_AVX,   "avx",   CPUF_SSE2 | CPUF_SSE4_1 | CPUF_AVX },
+  { USE_AVX2,  "avx2",  CPUF_SSE2 | CPUF_SSE4_1 | CPUF_AVX | CPUF_AVX2 }
+};
+
+// block sizes of the function tables
+const int block_sizes[][2] =
+{
+  { 64, 64 }, { 64, 48 }, { 64, 32 }, { 64, 16 },
+  { 48, 64 }, { 48, 48 }, { 48, 24 }, { 48, 12 },
+  { 32, 64 }, { 32, 32 }, { 32, 24 }, { 32, 16 }, { 32, 8 },
+  { 24, 48 }, { 24, 32 }, { 24, 24 }, { 24, 12 }, { 24, 6 },
+  { 16, 64 }, { 16, 32 }, { 16, 16 }, { 16, 12 }, { 16, 8 }, { 16, 4 }, { 16, 2 }, { 16, 1 },
+  { 12, 48 }, { 12, 24 }, { 12, 16 }, { 12, 12 }, { 12, 6 }, { 12, 3 },
+  { 8, 32 }, { 8, 16 }, { 8, 8 }, { 8, 4 }, { 8, 2 }, { 8, 1 },
+  { 6, 24 }, { 6, 12 }, { 6, 6 }, { 6, 3 },
+  { 4, 8 }, { 4, 4 }, { 4, 2 }, { 4, 1 },
+  { 3, 6 }, { 3, 3 },
+  { 2, 4 }, { 2, 2 }, { 2, 1 }
+};
+
+const int bits_list[] = { 8, 10, 16, 32 };
+
+// interpolated and reduced plane size
+const int PLANE_W = 960;
+const int PLANE_H = 540;
+
+// margin around the blocks, for the reference displacements
+const int MARGIN = 16;
+
+// Input patterns of -verify
+enum Pattern
+{
+  PAT_RANDOM = 0,
+  PAT_ZERO,
+  PAT_MAX,
+  PAT_CHECKER, // 0 and max alternating
+  PAT_RAMP,
+
+  PAT_NBR_ELT
+};
+
+const char * const pattern_names[PAT_NBR_ELT] = { "random", "zero", "max", "checker", "ramp" };
+
+// calls per pattern, covering the displacements of the kernel calls
+const int VERIFY_CALLS = 16;
+
+
+
+// Aligned pixel buffer filled with samples of the given depth, random by
+// default
+class Plane
+{
+public:
+  Plane(int width, int height, int bits, uint32_t seed)
+    : _bits(bits)
+    , _pixelsize(bits == 8 ? 1 : (bits == 32 ? 4 : 2))
+    , _pitch(((width * _pixelsize) + 63) & ~63)
+    , _height(height)
+    , _buf(size_t(_pitch) * height + 64)
+  {
+    fill(PAT_RANDOM, seed);
+  }
+
+  // The whole pitch is filled. Float samples are in [0; 1).
+  void fill(Pattern pattern, uint32_t seed)
+  {
+    std::mt19937 gen(seed);
+    const uint32_t mask = (_bits == 32) ? 0xFFFF : (1u << _bits) - 1;
+    for (int y = 0; y < _height; y++)
+    {
+      uint8_t *row_ptr = data() + y * _pitch;
+      for (int x = 0; x < _pitch / _pixelsize; x++)
+      {
+        uint32_t v = 0;
+        switch (pattern)
+        {
+        case PAT_RANDOM:  v = gen() & mask; break;
+        case PAT_MAX:     v = mask; break;
+        case PAT_CHECKER: v = ((x ^ y) & 1) ? mask : 0; break;
+        case PAT_RAMP:    v = uint32_t((x + y) * (mask / 127)) & mask; break;
+        default:          break;
+        }
+        if (_pixelsize == 1)
+          row_ptr[x] = uint8_t(v);
+        else if (_pixelsize == 2)
+          reinterpret_cast<uint16_t *>(row_ptr)[x] = uint16_t(v);
+        else
+          reinterpret_cast<float *>(row_ptr)[x] = float(v) / 65536.0f;
+      }
+    }
+  }
+
+  uint8_t *data()
+  {
+    return reinterpret_cast<uint8_t *>((reinterpret_cast<uintptr_t>(_buf.data()) + 63) & ~uintptr_t(63));
+  }
+  uint8_t *at(int x, int y) { return data() + y * _pitch + x * _pixelsize; }
+  int pitch() const { return _pitch; }
+  size_t size() const { return size_t(_pitch) * _height; }
+
+private:
+  int _bits;
+  int _pixelsize;
+  int _pitch;
+  int _height;
+  std::vector<uint8_t> _buf;
+};
+
+
+
+struct Timing
+{
+  double ns;     // per call
+  double cycles; // TSC cycles per call
+};
+
+// Calls fn in batches of growing size until a batch lasts min_ms
+Timing measure(const std::function<void(int)> &fn, double min_ms)
+{
+  typedef std::chrono::steady_clock Clock;
+  fn(0); // warm-up
+  int64_t count = 16;
+  for (;;)
+  {
+    const Clock::time_point t0 = Clock::now();
+    const uint64_t c0 = read_tsc();
+    for (int64_t i = 0; i < count; i++)
+      fn(int(i));
+    const uint64_t c1 = read_tsc();
+    const double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    if (ms >= min_ms || count >= (int64_t(1) << 40))
+      return { ms * 1e6 / count, double(c1 - c0) / count };
+    count *= (ms < min_ms / 16) ? 16 : 2;
+  }
+}
+
+
+
+class Report
+{
+public:
+  Report(bool csv, bool verify) : _csv(csv)
+  {
+    if (verify)
+    {
+      if (_csv)
+        printf("family,kernel,size,bits,arch,result\n");
+      else
+        printf("%-9s %-18s %-9s %4s %-6s %s\n", "family", "kernel", "size", "bits", "arch", "result");
+    }
+    else if (_csv)
+      printf("family,kernel,size,bits,arch,ns_per_call,mpix_per_s,cycles_per_call,speedup\n");
+    else
+      printf("%-9s %-18s %-9s %4s %-6s %12s %10s %12s %8s\n",
+        "family", "kernel", "size", "bits", "arch", "ns/call", "Mpix/s", "cycles/call", "speedup");
+  }
+
+  // The first entry of a group is the C reference
+  void begin_group() { _ref_ns = 0; }
+
+  void add(const char *family, const char *kernel, int w, int h, int bits, const char *arch, int64_t pixels, const Timing &t)
+  {
+    if (_ref_ns == 0)
+      _ref_ns = t.ns;
+    char size[32];
+    snprintf(size, sizeof(size), "%dx%d", w, h);
+    const double mpix = double(pixels) * 1e3 / t.ns;
+    const double speedup = _ref_ns / t.ns;
+    if (_csv)
+      printf("%s,%s,%s,%d,%s,%.2f,%.1f,%.1f,%.2f\n", family, kernel, size, bits, arch, t.ns, mpix, t.cycles, speedup);
+    else
+      printf("%-9s %-18s %-9s %4d %-6s %12.2f %10.1f %12.1f %7.2fx\n", family, kernel, size, bits, arch, t.ns, mpix, t.cycles, speedup);
+    fflush(stdout);
+  }
+
+  // Comparison of a tier with the C kernel, result is "ok" or the first
+  // difference
+  void add_check(const char *family, const char *kernel, int w, int h, int bits, const char *arch, const std::string &result)
+  {
+    char size[32];
+    snprintf(size, sizeof(size), "%dx%d", w, h);
+    if (_csv)
+      printf("%s,%s,%s,%d,%s,%s\n", family, kernel, size, bits, arch, result.c_str());
+    else
+      printf("%-9s %-18s %-9s %4d %-6s %s\n", family, kernel, size, bits, arch, result.c_str());
+    fflush(stdout);
+    ++_nbr_checks;
+    if (result != "ok")
+      ++_nbr_mismatches;
+  }
+
+  void print_check_summary() const
+  {
+    fprintf(stderr, "%d checks, %d mismatches\n", _nbr_checks, _nbr_mismatches);
+  }
+
+  int nbr_mismatches() const { return _nbr_mismatches; }
+
+private:
+  bool _csv;
+  double _ref_ns = 0;
+  int _nbr_checks = 0;
+  int _nbr_mismatches = 0;
+};
+
+
+
+class Bench
+{
+public:
+  Bench(const Options &opt, int cpu_flags) : _opt(opt), _cpu_flags(cpu_flags), _report(opt.csv, opt.verify) {}
+
+  void run()
+  {
+    if (use_family("sad")) bench_sad();
+    if (use_family("satd")) bench_satd();
+    if (use_family("luma")) bench_luma();
+    if (use_family("copy")) bench_copy();
+    if (use_family("overlaps")) bench_overlaps();
+    if (use_family("degrain")) bench_degrain();
+    if (use_family("interp")) bench_interp();
+    if (use_family("reduce")) bench_reduce();
+    if (_opt.verify)
+      _report.print_check_summary();
+  }
+
+  int nbr_mismatches() const { return _report.nbr_mismatches(); }
+
+private:
+
+  // Buffers of a kernel call, for -verify. The inputs are filled with each
+  // pattern and the outputs are cleared before the calls.
+  struct Io
+  {
+    std::vector<Plane *> in;
+    std::vector<std::pair<uint8_t *, size_t> > out;
+    unsigned int *ret = nullptr; // accumulated return values, if any
+  };
+
+  struct Result
+  {
+    std::vector<unsigned int> ret; // one per call
+    std::vector<uint8_t> out;
+  };
+
+  bool use_family(const char *name) const
+  {
+    return _opt.families.empty()
+      || std::find(_opt.families.begin(), _opt.families.end(), name) != _opt.families.end();
+  }
+  bool use_bits(int bits) const
+  {
+    return _opt.bits.empty() || std::find(_opt.bits.begin(), _opt.bits.end(), bits) != _opt.bits.end();
+  }
+  bool use_size(int w, int h) const
+  {
+    return _opt.sizes.empty()
+      || std::find(_opt.sizes.begin(), _opt.sizes.end(), std::make_pair(w, h)) != _opt.sizes.end();
+  }
+  bool use_arch(const ArchInfo &a) const
+  {
+    return a.arch <= _opt.max_arch && (a.cpu_flags & _cpu_flags) == a.cpu_flags;
+  }
+  static int pixelsize_of(int bits) { return bits == 8 ? 1 : (bits == 32 ? 4 : 2); }
+
+  // Runs the kernel of each tier, skipping the tiers falling back to the
+  // same kernel as the tier below (unless the kernel dispatches by itself
+  // on _tier_cpu_flags). Times it, or with -verify compares its results
+  // with the C tier.
+  template <typename F, typename G>
+  void bench_tiers(const char *family, const char *kernel, int w, int h, int bits, int64_t pixels, const Io &io, G get_fn, F make_call, bool same_fn_skip = true)
+  {
+    _report.begin_group();
+    decltype(get_fn(NO_SIMD)) prev_fn = nullptr;
+    std::vector<Result> ref;
+    for (const ArchInfo &a : arch_list)
+    {
+      if (!use_arch(a))
+        continue;
+      const auto fn = get_fn(a.arch);
+      if (fn == nullptr || (same_fn_skip && fn == prev_fn))
+        continue;
+      prev_fn = fn;
+      _tier_cpu_flags = a.cpu_flags;
+      const std::function<void(int)> call = make_call(fn);
+      if (!_opt.verify)
+      {
+        _report.add(family, kernel, w, h, bits, a.name, pixels, measure(call, _opt.min_ms));
+        continue;
+      }
+
+      std::string result = "ok";
+      for (int p = 0; p < PAT_NBR_ELT; p++)
+      {
+        Result res = run_pattern(io, Pattern(p), call);
+        if (ref.size() <= size_t(p))
+          ref.push_back(std::move(res)); // C tier
+        else if (result == "ok")
+          result = compare(ref[p], res, Pattern(p));
+      }
+      if (a.arch != NO_SIMD)
+        _report.add_check(family, kernel, w, h, bits, a.name, result);
+    }
+  }
+
+  static Result run_pattern(const Io &io, Pattern pattern, const std::function<void(int)> &call)
+  {
+    for (size_t k = 0; k < io.in.size(); k++)
+      io.in[k]->fill(pattern, uint32_t(k + 1));
+    for (const auto &o : io.out)
+      memset(o.first, 0, o.second);
+    Result res;
+    for (int i = 0; i < VERIFY_CALLS; i++)
+    {
+      if (io.ret != nullptr)
+        *io.ret = 0;
+      call(i);
+      if (io.ret != nullptr)
+        res.ret.push_back(*io.ret);
+    }
+    for (const auto &o : io.out)
+      res.out.insert(res.out.end(), o.first, o.first + o.second);
+    return res;
+  }
+
+  // Bit-exact comparison, float results included
+  static std::string compare(const Result &ref, const Result &res, Pattern pattern)
+  {
+    char txt[128];
+    for (size_t i = 0; i < ref.ret.size(); i++)
+    {
+      if (ref.ret[i] != res.ret[i])
+      {
+        snprintf(txt, sizeof(txt), "MISMATCH %s: call %d returns %u instead of %u",
+          pattern_names[pattern], int(i), res.ret[i], ref.ret[i]);
+        return txt;
+      }
+    }
+    const auto diff = std::mismatch(ref.out.begin(), ref.out.end(), res.out.begin());
+    if (diff.first != ref.out.end())
+    {
+      snprintf(txt, sizeof(txt), "MISMATCH %s: output byte %d is %d instead of %d",
+        pattern_names[pattern], int(diff.first - ref.out.begin()), *diff.second, *diff.first);
+      return txt;
+    }
+    return "ok";
+  }
+
+  void bench_sad()
+  {
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits))
+        continue;
+      Plane src(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 1);
+      Plane ref(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 2);
+      for (const auto &bs : block_sizes)
+      {
+        const int w = bs[0];
+        const int h = bs[1];
+        if (!use_size(w, h))
+          continue;
+        unsigned int sink = 0;
+        bench_tiers("sad", "SAD", w, h, bits, w * h, Io { { &src, &ref }, {}, &sink },
+          [&](arch_t arch) { return get_sad_function(w, h, bits, arch); },
+          [&](SADFunction *fn) {
+            return [&, fn](int i) {
+              // a few reference positions, as a small search
+              const uint8_t *ref_ptr = ref.at(MARGIN + (i & 3) - 2, MARGIN + ((i >> 2) & 3) - 2);
+              sink += fn(src.at(MARGIN, MARGIN), src.pitch(), ref_ptr, ref.pitch());
+            };
+          });
+        _sink += sink;
+      }
+    }
+  }
+
+  void bench_satd()
+  {
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits) || bits == 10)
+        continue; // by pixel size
+      const int ps = pixelsize_of(bits);
+      Plane src(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 1);
+      Plane ref(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 2);
+      for (const auto &bs : block_sizes)
+      {
+        const int w = bs[0];
+        const int h = bs[1];
+        if (!use_size(w, h))
+          continue;
+        unsigned int sink = 0;
+        bench_tiers("satd", "SATD", w, h, bits, w * h, Io { { &src, &ref }, {}, &sink },
+          [&](arch_t arch) { return get_satd_function(w, h, ps, arch); },
+          [&](SADFunction *fn) {
+            return [&, fn](int i) {
+              const uint8_t *ref_ptr = ref.at(MARGIN + (i & 3) - 2, MARGIN + ((i >> 2) & 3) - 2);
+              sink += fn(src.at(MARGIN, MARGIN), src.pitch(), ref_ptr, ref.pitch());
+            };
+          });
+        _sink += sink;
+      }
+    }
+  }
+
+  void bench_luma()
+  {
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits) || bits == 10)
+        continue;
+      const int ps = pixelsize_of(bits);
+      Plane src(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 1);
+      for (const auto &bs : block_sizes)
+      {
+        const int w = bs[0];
+        const int h = bs[1];
+        if (!use_size(w, h))
+          continue;
+        unsigned int sink = 0;
+        bench_tiers("luma", "Luma", w, h, bits, w * h, Io { { &src }, {}, &sink },
+          [&](arch_t arch) { return get_luma_function(w, h, ps, arch); },
+          [&](LUMAFunction *fn) {
+            return [&, fn](int i) {
+              sink += fn(src.at(MARGIN + (i & 3), MARGIN), src.pitch());
+            };
+          });
+        _sink += sink;
+      }
+    }
+  }
+
+  void bench_copy()
+  {
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits) || bits == 10)
+        continue;
+      const int ps = pixelsize_of(bits);
+      Plane src(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 1);
+      Plane dst(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 2);
+      for (const auto &bs : block_sizes)
+      {
+        const int w = bs[0];
+        const int h = bs[1];
+        if (!use_size(w, h))
+          continue;
+        bench_tiers("copy", "Copy", w, h, bits, w * h, Io { { &src }, { { dst.data(), dst.size() } } },
+          [&](arch_t arch) { return get_copy_function(w, h, ps, arch); },
+          [&](COPYFunction *fn) {
+            return [&, fn](int i) {
+              fn(dst.at(MARGIN, MARGIN), dst.pitch(), src.at(MARGIN + (i & 3), MARGIN), src.pitch());
+            };
+          });
+      }
+    }
+  }
+
+  void bench_overlaps()
+  {
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits) || bits == 10)
+        continue;
+      const int ps = pixelsize_of(bits);
+      Plane src(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 1);
+      // accumulator: short for 8 bits, int or float otherwise
+      const int dst_pitch = 64 + 2 * MARGIN;
+      std::vector<int32_t> dst(size_t(dst_pitch) * (64 + 2 * MARGIN), 0);
+      // window: 11-bit integer weights, float ones for float clips
+      std::vector<short> win(64 * 64, 1024);
+      std::vector<float> win_f(64 * 64, 0.5f);
+      short *win_ptr = (ps == 4) ? reinterpret_cast<short *>(win_f.data()) : win.data();
+      for (const auto &bs : block_sizes)
+      {
+        const int w = bs[0];
+        const int h = bs[1];
+        if (!use_size(w, h))
+          continue;
+        const Io io { { &src }, { { reinterpret_cast<uint8_t *>(dst.data()), dst.size() * sizeof(dst[0]) } } };
+        bench_tiers("overlaps", "Overlaps", w, h, bits, w * h, io,
+          [&](arch_t arch) { return get_overlaps_function(w, h, ps, false, arch); },
+          [&](OverlapsFunction *fn) {
+            return [&, fn](int i) {
+              // the accumulator is reset from time to time, as for a new frame
+              if ((i & 1023) == 0)
+                std::fill(dst.begin(), dst.end(), 0);
+              fn(reinterpret_cast<uint16_t *>(dst.data()), dst_pitch, src.at(MARGIN + (i & 3), MARGIN), src.pitch(), win_ptr, w);
+            };
+          });
+      }
+    }
+  }
+
+  void bench_degrain()
+  {
+    const int trad = 2;
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits))
+        continue;
+      Plane src(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 1);
+      Plane dst(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 2);
+      std::vector<Plane> refs;
+      for (int k = 0; k < trad * 2; k++)
+        refs.emplace_back(64 + 2 * MARGIN, 64 + 2 * MARGIN, bits, 3 + k);
+      const BYTE *ref_ptr[trad * 2];
+      int ref_pitch[trad * 2];
+      for (int k = 0; k < trad * 2; k++)
+      {
+        ref_ptr[k] = refs[k].at(MARGIN, MARGIN);
+        ref_pitch[k] = refs[k].pitch();
+      }
+      // total weight 256
+      int wall[trad * 2 + 1];
+      wall[0] = 256 - trad * 2 * 48;
+      for (int k = 1; k <= trad * 2; k++)
+        wall[k] = 48;
+
+      Io io { { &src }, { { dst.data(), dst.size() } } };
+      for (Plane &r : refs)
+        io.in.push_back(&r);
+
+      for (const auto &bs : block_sizes)
+      {
+        const int w = bs[0];
+        const int h = bs[1];
+        if (!use_size(w, h))
+          continue;
+        bench_tiers("degrain", "DegrainN trad=2", w, h, bits, w * h, io,
+          [&](arch_t arch) { return MDegrainN::get_denoiseN_function(w, h, bits, false, false, arch); },
+          [&](MDegrainN::DenoiseNFunction *fn) {
+            return [&, fn](int) {
+              // the kernels advance the reference pointers
+              const BYTE *ref_cur[trad * 2];
+              std::copy(ref_ptr, ref_ptr + trad * 2, ref_cur);
+              fn(dst.at(MARGIN, MARGIN), nullptr, dst.pitch(), src.at(MARGIN, MARGIN), src.pitch(), ref_cur, ref_pitch, wall, trad);
+            };
+          });
+      }
+    }
+  }
+
+  typedef void (InterpFunction)(unsigned char *pDst, const unsigned char *pSrc, int nDstPitch, int nSrcPitch, int nWidth, int nHeight, int bits_per_pixel);
+  typedef void (AverageFunction)(unsigned char *pDst, const unsigned char *pSrc1, const unsigned char *pSrc2, int nPitch, int nWidth, int nHeight);
+
+  struct InterpEntry
+  {
+    const char *name;
+    InterpFunction *fn[3][3]; // [pixelsize 1, 2, 4][c, sse2, sse41]
+  };
+
+  void bench_interp()
+  {
+    static const InterpEntry entries[] =
+    {
+      { "Bilin hor", {
+        { HorizontalBilin<uint8_t>, HorizontalBilin_sse2<uint8_t>, nullptr },
+        { HorizontalBilin<uint16_t>, HorizontalBilin_sse2<uint16_t>, nullptr },
+        { HorizontalBilin<float>, nullptr, nullptr } } },
+      { "Bilin ver", {
+        { VerticalBilin<uint8_t>, VerticalBilin_sse2<uint8_t>, nullptr },
+        { VerticalBilin<uint16_t>, VerticalBilin_sse2<uint16_t>, nullptr },
+        { VerticalBilin<float>, nullptr, nullptr } } },
+      { "Bilin dia", {
+        { DiagonalBilin<uint8_t>, DiagonalBilin_sse2<uint8_t, false>, nullptr },
+        { DiagonalBilin<uint16_t>, DiagonalBilin_sse2<uint16_t, false>, DiagonalBilin_sse2<uint16_t, true> },
+        { DiagonalBilin<float>, nullptr, nullptr } } },
+      { "Bicubic hor", {
+        { HorizontalBicubic<uint8_t>, HorizontalBicubic_sse2<uint8_t, false>, nullptr },
+        { HorizontalBicubic<uint16_t>, HorizontalBicubic_sse2<uint16_t, false>, HorizontalBicubic_sse2<uint16_t, true> },
+        { HorizontalBicubic<float>, nullptr, nullptr } } },
+      { "Bicubic ver", {
+        { VerticalBicubic<uint8_t>, VerticalBicubic_sse2<uint8_t, false>, VerticalBicubic_sse2<uint8_t, true> },
+        { VerticalBicubic<uint16_t>, VerticalBicubic_sse2<uint16_t, false>, VerticalBicubic_sse2<uint16_t, true> },
+        { VerticalBicubic<float>, nullptr, nullptr } } },
+      { "Wiener hor", {
+        { HorizontalWiener<uint8_t>, HorizontalWiener_sse2<uint8_t, false>, nullptr },
+        { HorizontalWiener<uint16_t>, HorizontalWiener_sse2<uint16_t, false>, HorizontalWiener_sse2<uint16_t, true> },
+        { HorizontalWiener<float>, nullptr, nullptr } } },
+      { "Wiener ver", {
+        { VerticalWiener<uint8_t>, VerticalWiener_sse2<uint8_t, false>, nullptr },
+        { VerticalWiener<uint16_t>, VerticalWiener_sse2<uint16_t, false>, VerticalWiener_sse2<uint16_t, true> },
+        { VerticalWiener<float>, nullptr, nullptr } } }
+    };
+    static AverageFunction * const average[3][3] =
+    {
+      { Average2<uint8_t>, Average2_sse2<uint8_t>, nullptr },
+      { Average2<uint16_t>, Average2_sse2<uint16_t>, nullptr },
+      { Average2<float>, nullptr, nullptr }
+    };
+
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits))
+        continue;
+      const int ps = pixelsize_of(bits);
+      const int ps_idx = (ps == 1) ? 0 : (ps == 2 ? 1 : 2);
+      Plane src(PLANE_W + 2 * MARGIN, PLANE_H + 2 * MARGIN, bits, 1);
+      Plane src2(PLANE_W + 2 * MARGIN, PLANE_H + 2 * MARGIN, bits, 2);
+      Plane dst(PLANE_W + 2 * MARGIN, PLANE_H + 2 * MARGIN, bits, 3);
+      const int64_t pixels = int64_t(PLANE_W) * PLANE_H;
+      const Io io { { &src, &src2 }, { { dst.data(), dst.size() } } };
+
+      for (const InterpEntry &e : entries)
+      {
+        bench_tiers("interp", e.name, PLANE_W, PLANE_H, bits, pixels, io,
+          [&](arch_t arch) { return interp_tier(e.fn[ps_idx], arch); },
+          [&](InterpFunction *fn) {
+            return [&, fn](int) {
+              fn(dst.at(MARGIN, MARGIN), src.at(MARGIN, MARGIN), dst.pitch(), src.pitch(), PLANE_W, PLANE_H, bits);
+            };
+          });
+      }
+      bench_tiers("interp", "Average2", PLANE_W, PLANE_H, bits, pixels, io,
+        [&](arch_t arch) { return interp_tier(average[ps_idx], arch); },
+        [&](AverageFunction *fn) {
+          return [&, fn](int) {
+            fn(dst.at(MARGIN, MARGIN), src.at(MARGIN, MARGIN), src2.at(MARGIN, MARGIN), src.pitch(), PLANE_W, PLANE_H);
+          };
+        });
+    }
+  }
+
+  // Best variant available at the tier, as MVPlane selects them
+  template <typename T>
+  static T *interp_tier(T * const fn[3], arch_t arch)
+  {
+    if (arch >= USE_SSE41 && fn[2] != nullptr)
+      return fn[2];
+    if (arch >= USE_SSE2 && fn[1] != nullptr)
+      return fn[1];
+    return fn[0];
+  }
+
+  typedef void (ReduceFunction)(unsigned char *pDst, const unsigned char *pSrc, int nDstPitch, int nSrcPitch, int nWidth, int nHeight, int y_beg, int y_end, int cpuFlags);
+
+  // The reducers dispatch internally on cpuFlags, every tier is listed.
+  void bench_reduce()
+  {
+    struct ReduceEntry
+    {
+      const char *name;
+      ReduceFunction *fn[3];
+    };
+    static const ReduceEntry entries[] =
+    {
+      { "RB2F", { RB2F<uint8_t>, RB2F<uint16_t>, RB2F<float> } },
+      { "RB2Filtered", { RB2Filtered<uint8_t>, RB2Filtered<uint16_t>, RB2Filtered<float> } },
+      { "RB2BilinearFilt", { RB2BilinearFiltered<uint8_t>, RB2BilinearFiltered<uint16_t>, RB2BilinearFiltered<float> } },
+      { "RB2Quadratic", { RB2Quadratic<uint8_t>, RB2Quadratic<uint16_t>, RB2Quadratic<float> } },
+      { "RB2Cubic", { RB2Cubic<uint8_t>, RB2Cubic<uint16_t>, RB2Cubic<float> } }
+    };
+
+    for (int bits : bits_list)
+    {
+      if (!use_bits(bits))
+        continue;
+      const int ps = pixelsize_of(bits);
+      const int ps_idx = (ps == 1) ? 0 : (ps == 2 ? 1 : 2);
+      Plane src(PLANE_W + 2 * MARGIN, PLANE_H + 2 * MARGIN, bits, 1);
+      Plane dst(PLANE_W / 2 + 2 * MARGIN, PLANE_H / 2 + 2 * MARGIN, bits, 2);
+      const int w = PLANE_W / 2;
+      const int h = PLANE_H / 2;
+
+      const Io io { { &src }, { { dst.data(), dst.size() } } };
+
+      for (const ReduceEntry &e : entries)
+      {
+        // no AVX variant
+        bench_tiers("reduce", e.name, PLANE_W, PLANE_H, bits, int64_t(PLANE_W) * PLANE_H, io,
+          [&](arch_t arch) { return (arch == USE_AVX) ? nullptr : e.fn[ps_idx]; },
+          [&](ReduceFunction *fn) {
+            const int cpu_flags = _tier_cpu_flags;
+            return [&, fn, cpu_flags](int) {
+              fn(dst.at(MARGIN, MARGIN), src.at(MARGIN, MARGIN), dst.pitch(), src.pitch(), w, h, 0, h, cpu_flags);
+            };
+          }, false);
+      }
+    }
+  }
+
+  const Options &_opt;
+  int _cpu_flags;
+  int _tier_cpu_flags = 0; // CPU flags of the tier being run
+  Report _report;
+  unsigned int _sink = 0;
+
+public:
+  unsigned int sink() const { return _sink; }
+};
+
+
+
+arch_t parse_arch(const char *s)
+{
+  for (const ArchInfo &a : arch_list)
+  {
+    if (strcmp(s, a.name) == 0)
+      return a.arch;
+  }
+  fprintf(stderr, "mvtools-bench: unknown arch \"%s\"\n", s);
+  exit(1);
+}
+
+void usage()
+{
+  printf(
+    "Usage: mvtools-bench [options]\n"
+    "  -f family  sad, satd, luma, copy, overlaps, degrain, interp, reduce (repeatable, default all)\n"
+    "  -b bits    8, 10, 16 or 32 (repeatable, default all)\n"
+    "  -s WxH     block size (repeatable, default all)\n"
+    "  -a arch    highest tier: c, sse2, sse41, avx, avx2 (default: all supported by the CPU)\n"
+    "  -t ms      minimum measuring time per kernel (default 20)\n"
+    "  -csv       CSV output\n"
+    "  -verify    compares the results of each tier with the C kernel instead of timing\n"
+  );
+}
+
+} // namespace
+
+
+
+int main(int argc, char *argv[])
+{
+  Options opt;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool has_val = (i + 1 < argc);
+    if (arg == "-f" && has_val)
+      opt.families.push_back(argv[++i]);
+    else if (arg == "-b" && has_val)
+      opt.bits.push_back(atoi(argv[++i]));
+    else if (arg == "-s" && has_val)
+    {
+      int w = 0;
+      int h = 0;
+      if (sscanf(argv[++i], "%dx%d", &w, &h) != 2)
+      {
+        fprintf(stderr, "mvtools-bench: invalid block size \"%s\"\n", argv[i]);
+        return 1;
+      }
+      opt.sizes.push_back(std::make_pair(w, h));
+    }
+    else if (arg == "-a" && has_val)
+      opt.max_arch = parse_arch(argv[++i]);
+    else if (arg == "-t" && has_val)
+      opt.min_ms = atof(argv[++i]);
+    else if (arg == "-csv")
+      opt.csv = true;
+    else if (arg == "-verify")
+      opt.verify = true;
+    else
+    {
+      usage();
+      return (arg == "-h" || arg == "--help") ? 0 : 1;
+    }
+  }
+
+  const int cpu_flags = detect_cpu_flags();
+  Bench bench(opt, cpu_flags);
+  bench.run();
+
+  if (opt.verify)
+    return (bench.nbr_mismatches() > 0) ? 1 : 0;
+
+  // keeps the SAD results alive
+  return (bench.sink() == 0x12345678) ? 2 : 0;
+}
@@ -0,0 +1,985 @@
+// Headless pipeline runner, without AviSynth
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+// Loads the plugin into the minimal host of ScriptEnvironment.h and runs a
+// fixed filter chain on a Y4M file, a raw YUV file or a synthetic clip:
+//   super:      MSuper
+//   analyse:    MSuper -> MAnalyse
+//   degrain:    MSuper -> MAnalyse(multi) -> MDegrainN
+//   compensate: MSuper -> MAnalyse -> MCompensate
+//   flowfps:    MSuper -> MAnalyse x2 -> MFlowFps (double rate)
+// Every filter output goes through a node with a small frame cache, as with
+// the AviSynth+ caches, which records the time spent in the filter itself.
+// Reports the throughput, the time per filter and the peak memory.
+// With --verify, the chain is built once per CPU tier instead, and the
+// output frames of each tier are compared with the ones of the C tier.
+// With --props, the int and float properties of the output frames are
+// printed, e.g. the MAnalyse search counters (-p MAnalyse.stats=true).
+// With --kernels, the kernel implementations selected by the filters are
+// printed (MToolsInfo). With --memory, the memory allocated by each filter
+// instance is printed after processing (MToolsMemory).
+//
+// mvtools-run [options] input
+
+#include "CpuFlags.h"
+#include "ScriptEnvironment.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined (_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+struct Options
+{
+  std::string input;
+  std::string plugin = MVTOOLS_PLUGIN_PATH;
+  std::string chain = "degrain";
+  std::string output;
+  std::string raw_format = "yuv420p";
+  int raw_w = 0;
+  int raw_h = 0;
+  int fps_num = 25;
+  int fps_den = 1;
+  int start = 0;
+  int frames = -1; // all
+  int tr = 2;
+  int cache = 16;
+  int cpu_mask = -1;
+  bool verify = false;
+  bool props = false;
+  bool kernels = false;
+  bool memory = false;
+  std::vector<std::string> params; // Filter.param=value
+};
+
+struct FormatInfo
+{
+  const char *name;
+  const char *y4m; // C tag, null if none
+  int pixel_type;
+};
+
+const FormatInfo format_list[] =
+{
+  { "yuv420p",   "420jpeg", VideoInfo::CS_YV12 },
+  { "yuv420p10", "420p10",  VideoInfo::CS_YUV420P10 },
+  { "yuv420p12", "420p12",  VideoInfo::CS_YUV420P12 },
+  { "yuv420p14", "420p14",  VideoInfo::CS_YUV420P14 },
+  { "yuv420p16", "420p16",  VideoInfo::CS_YUV420P16 },
+  { "yuv420ps",  nullptr,   VideoInfo::CS_YUV420PS },
+  { "yuv422p",   "422",     VideoInfo::CS_YV16 },
+  { "yuv422p10", "422p10",  VideoInfo::CS_YUV422P10 },
+  { "yuv422p12", "422p12",  VideoInfo::CS_YUV422P12 },
+  { "yuv422p14", "422p14",  VideoInfo::CS_YUV422P14 },
+  { "yuv422p16", "422p16",  VideoInfo::CS_YUV422P16 },
+  { "yuv422ps",  nullptr,   VideoInfo::CS_YUV422PS },
+  { "yuv444p",   "444",     VideoInfo::CS_YV24 },
+  { "yuv444p10", "444p10",  VideoInfo::CS_YUV444P10 },
+  { "yuv444p12", "444p12",  VideoInfo::CS_YUV444P12 },
+  { "yuv444p14", "444p14",  VideoInfo::CS_YUV444P14 },
+  { "yuv444p16", "444p16",  VideoInfo::CS_YUV444P16 },
+  { "yuv444ps",  nullptr,   VideoInfo::CS_YUV444PS },
+  { "gray",      "mono",    VideoInfo::CS_Y8 },
+  { "gray10",    "mono10",  VideoInfo::CS_Y10 },
+  { "gray12",    "mono12",  VideoInfo::CS_Y12 },
+  { "gray14",    "mono14",  VideoInfo::CS_Y14 },
+  { "gray16",    "mono16",  VideoInfo::CS_Y16 },
+  { "grays",     nullptr,   VideoInfo::CS_Y32 }
+};
+
+const FormatInfo *find_format(const std::string &name)
+{
+  for (const FormatInfo &f : format_list)
+  {
+    if (name == f.name)
+      return &f;
+  }
+  return nullptr;
+}
+
+const FormatInfo *find_y4m_format(const std::string &tag)
+{
+  // 4:2:0 chroma siting variants
+  if (tag == "420" || tag == "420mpeg2" || tag == "420paldv")
+    return find_format("yuv420p");
+  for (const FormatInfo &f : format_list)
+  {
+    if (f.y4m != nullptr && tag == f.y4m)
+      return &f;
+  }
+  return nullptr;
+}
+
+const FormatInfo *find_pixel_type(int pixel_type)
+{
+  for (const FormatInfo &f : format_list)
+  {
+    if (f.pixel_type == pixel_type)
+      return &f;
+  }
+  return nullptr;
+}
+
+std::vector<int> plane_list(const VideoInfo &vi)
+{
+  if (vi.IsY())
+    return std::vector<int> { PLANAR_Y };
+  return std::vector<int> { PLANAR_Y, PLANAR_U, PLANAR_V };
+}
+
+int64_t frame_bytes(const VideoInfo &vi)
+{
+  const int64_t size_y = int64_t(vi.width) * vi.ComponentSize() * vi.height;
+  if (vi.IsY())
+    return size_y;
+  const int sx = vi.GetPlaneWidthSubsampling(PLANAR_U);
+  const int sy = vi.GetPlaneHeightSubsampling(PLANAR_U);
+  return size_y + 2 * (int64_t(vi.width >> sx) * vi.ComponentSize() * (vi.height >> sy));
+}
+
+int fseek64(FILE *f, int64_t pos)
+{
+#if defined (_WIN32)
+  return _fseeki64(f, pos, SEEK_SET);
+#else
+  return fseeko(f, off_t(pos), SEEK_SET);
+#endif
+}
+
+
+
+// Y4M, raw or synthetic source
+class SourceClip
+  : public IClip
+{
+public:
+
+  // Throws AvisynthError
+  SourceClip(const Options &opt, IScriptEnvironment *env)
+  {
+    memset(&_vi, 0, sizeof(_vi));
+    _vi.fps_numerator = opt.fps_num;
+    _vi.fps_denominator = opt.fps_den;
+
+    if (opt.input.compare(0, 6, "synth:") == 0)
+      open_synth(opt.input.substr(6), opt.raw_format, env);
+    else
+    {
+      _file = fopen(opt.input.c_str(), "rb");
+      if (_file == nullptr)
+        env->ThrowError("mvtools-run: cannot open %s", opt.input.c_str());
+      if (opt.raw_w > 0)
+        open_raw(opt, env);
+      else
+        open_y4m(env);
+    }
+    if (_vi.num_frames <= 0)
+      env->ThrowError("mvtools-run: empty source");
+  }
+
+  ~SourceClip()
+  {
+    if (_file != nullptr)
+      fclose(_file);
+  }
+
+  PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) override
+  {
+    n = std::max(0, std::min(n, _vi.num_frames - 1));
+    PVideoFrame dst = env->NewVideoFrame(_vi);
+    if (_file == nullptr)
+      fill_synth(dst, n);
+    else
+    {
+      fseek64(_file, _offsets [n]);
+      for (int p : plane_list(_vi))
+      {
+        BYTE *dst_ptr = dst->GetWritePtr(p);
+        const int row_size = dst->GetRowSize(p);
+        for (int y = 0; y < dst->GetHeight(p); ++y)
+        {
+          if (fread(dst_ptr, 1, row_size, _file) != size_t(row_size))
+            env->ThrowError("mvtools-run: truncated frame %d", n);
+          dst_ptr += dst->GetPitch(p);
+        }
+      }
+    }
+    return dst;
+  }
+
+  bool __stdcall GetParity(int n) override { return false; }
+  void __stdcall GetAudio(void* buf, int64_t start, int64_t count, IScriptEnvironment* env) override {}
+  int __stdcall SetCacheHints(int cachehints, int frame_range) override { return 0; }
+  const VideoInfo& __stdcall GetVideoInfo() override { return _vi; }
+
+private:
+
+  void open_synth(const std::string &spec, const std::string &def_format, IScriptEnvironment *env)
+  {
+    // WxH[:frames[:format]]
+    char fmt [32];
+    snprintf(fmt, sizeof(fmt), "%s", def_format.c_str());
+    _vi.num_frames = 100;
+    if (sscanf(spec.c_str(), "%dx%d:%d:%31s", &_vi.width, &_vi.height, &_vi.num_frames, fmt) < 2)
+      env->ThrowError("mvtools-run: invalid synthetic source \"%s\"", spec.c_str());
+    set_format(fmt, env);
+  }
+
+  void open_raw(const Options &opt, IScriptEnvironment *env)
+  {
+    _vi.width = opt.raw_w;
+    _vi.height = opt.raw_h;
+    set_format(opt.raw_format, env);
+    fseek(_file, 0, SEEK_END);
+    const int64_t size = ftell(_file);
+    const int64_t fsize = frame_bytes(_vi);
+    _vi.num_frames = int(size / fsize);
+    for (int n = 0; n < _vi.num_frames; ++n)
+      _offsets.push_back(n * fsize);
+  }
+
+  void open_y4m(IScriptEnvironment *env)
+  {
+    std::string header = read_line();
+    if (header.compare(0, 10, "YUV4MPEG2 ") != 0)
+      env->ThrowError("mvtools-run: not a Y4M file (use --raw WxH for raw YUV)");
+
+    std::string tag = "420jpeg";
+    size_t pos = 9;
+    while (pos < header.size())
+    {
+      const size_t end = std::min(header.find(' ', pos + 1), header.size());
+      const std::string field = header.substr(pos + 1, end - pos - 1);
+      pos = end;
+      if (field.empty())
+        continue;
+      switch (field [0])
+      {
+      case 'W': _vi.width = atoi(field.c_str() + 1); break;
+      case 'H': _vi.height = atoi(field.c_str() + 1); break;
+      case 'C': tag = field.substr(1); break;
+      case 'F':
+        {
+          unsigned num = 0;
+          unsigned den = 0;
+          if (sscanf(field.c_str() + 1, "%u:%u", &num, &den) == 2 && num > 0 && den > 0)
+          {
+            _vi.fps_numerator = num;
+            _vi.fps_denominator = den;
+          }
+        }
+        break;
+      }
+    }
+    const FormatInfo *fmt = find_y4m_format(tag);
+    if (fmt == nullptr)
+      env->ThrowError("mvtools-run: unsupported Y4M colorspace C%s", tag.c_str());
+    _vi.pixel_type = fmt->pixel_type;
+    if (_vi.width <= 0 || _vi.height <= 0)
+      env->ThrowError("mvtools-run: invalid Y4M frame size");
+
+    const int64_t fsize = frame_bytes(_vi);
+    for (;;)
+    {
+      const std::string frame_hdr = read_line();
+      if (frame_hdr.compare(0, 5, "FRAME") != 0)
+        break;
+      const int64_t offset = ftell_64();
+      if (fseek64(_file, offset + fsize) != 0)
+        break;
+      _offsets.push_back(offset);
+    }
+    // last frame possibly truncated, checked when read
+    _vi.num_frames = int(_offsets.size());
+  }
+
+  void set_format(const std::string &name, IScriptEnvironment *env)
+  {
+    const FormatInfo *fmt = find_format(name);
+    if (fmt == nullptr)
+      env->ThrowError("mvtools-run: unknown format \"%s\"", name.c_str());
+    _vi.pixel_type = fmt->pixel_type;
+    if (_vi.width <= 0 || _vi.height <= 0)
+      env->ThrowError("mvtools-run: invalid source size");
+  }
+
+  std::string read_line()
+  {
+    std::string line;
+    int c;
+    while ((c = fgetc(_file)) != EOF && c != '\n')
+      line += char(c);
+    return line;
+  }
+
+  int64_t ftell_64()
+  {
+#if defined (_WIN32)
+    return _ftelli64(_file);
+#else
+    return int64_t(ftello(_file));
+#endif
+  }
+
+  // Textured blocks moving by (2, 1) pixels per frame, with some noise
+  void fill_synth(PVideoFrame &dst, int n)
+  {
+    const int bits = _vi.BitsPerComponent();
+    for (int p : plane_list(_vi))
+    {
+      const int sx = (p == PLANAR_Y) ? 0 : _vi.GetPlaneWidthSubsampling(p);
+      const int sy = (p == PLANAR_Y) ? 0 : _vi.GetPlaneHeightSubsampling(p);
+      const int w = dst->GetRowSize(p) / _vi.ComponentSize();
+      const int h = dst->GetHeight(p);
+      BYTE *dst_ptr = dst->GetWritePtr(p);
+      for (int y = 0; y < h; ++y)
+      {
+        for (int x = 0; x < w; ++x)
+        {
+          const int xs = (x << sx) - 2 * n;
+          const int ys = (y << sy) - n;
+          const uint32_t blk = hash(uint32_t(xs >> 3), uint32_t(ys >> 3), uint32_t(p));
+          const uint32_t noise = hash(uint32_t(x), uint32_t(y), uint32_t(n * 4 + p)) & 7;
+          const int v = int(32 + (blk % 192) + noise);
+          if (bits == 8)
+            dst_ptr [x] = BYTE(v);
+          else if (bits == 32)
+            reinterpret_cast<float *>(dst_ptr) [x] = (p == PLANAR_Y) ? v / 255.0f : (v - 128) / 255.0f;
+          else
+            reinterpret_cast<uint16_t *>(dst_ptr) [x] = uint16_t(v << (bits - 8));
+        }
+        dst_ptr += dst->GetPitch(p);
+      }
+    }
+  }
+
+  static uint32_t hash(uint32_t x, uint32_t y, uint32_t z)
+  {
+    uint32_t h = x * 0x8DA6B343u ^ y * 0xD8163841u ^ z * 0xCB1AB31Fu;
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+  }
+
+  VideoInfo _vi;
+  FILE *_file = nullptr;
+  std::vector<int64_t> _offsets;
+};
+
+
+
+struct NodeStats
+{
+  std::string name;
+  int calls = 0;
+  int hits = 0;
+  double incl_s = 0;
+  double self_s = 0;
+};
+
+// Time of the children of the nodes being called
+thread_local std::vector<double> child_time_stack;
+
+// Cache and instrumentation around a filter
+class Node
+  : public IClip
+{
+public:
+
+  Node(const PClip &child, const std::shared_ptr<NodeStats> &stats, int capacity)
+    : _child(child)
+    , _stats(stats)
+    , _capacity(capacity)
+  {
+  }
+
+  PVideoFrame __stdcall GetFrame(int n, IScriptEnvironment* env) override
+  {
+    ++_stats->calls;
+    for (auto it = _frames.begin(); it != _frames.end(); ++it)
+    {
+      if (it->first == n)
+      {
+        ++_stats->hits;
+        std::pair<int, PVideoFrame> f = *it;
+        _frames.erase(it);
+        _frames.push_back(f);
+        return f.second;
+      }
+    }
+
+    child_time_stack.push_back(0);
+    const Clock::time_point beg = Clock::now();
+    PVideoFrame frame;
+    try
+    {
+      frame = _child->GetFrame(n, env);
+    }
+    catch (...)
+    {
+      child_time_stack.pop_back();
+      throw;
+    }
+    const double dur = std::chrono::duration<double>(Clock::now() - beg).count();
+    _stats->incl_s += dur;
+    _stats->self_s += dur - child_time_stack.back();
+    child_time_stack.pop_back();
+    if (!child_time_stack.empty())
+      child_time_stack.back() += dur;
+
+    if (_capacity > 0)
+    {
+      if (int(_frames.size()) >= _capacity)
+        _frames.pop_front();
+      _frames.push_back(std::make_pair(n, frame));
+    }
+    return frame;
+  }
+
+  bool __stdcall GetParity(int n) override { return _child->GetParity(n); }
+  void __stdcall GetAudio(void* buf, int64_t start, int64_t count, IScriptEnvironment* env) override { _child->GetAudio(buf, start, count, env); }
+  int __stdcall SetCacheHints(int cachehints, int frame_range) override { return _child->SetCacheHints(cachehints, frame_range); }
+  const VideoInfo& __stdcall GetVideoInfo() override { return _child->GetVideoInfo(); }
+
+private:
+
+  PClip _child;
+  std::shared_ptr<NodeStats> _stats;
+  int _capacity;
+  std::deque<std::pair<int, PVideoFrame> > _frames; // most recently used last
+};
+
+
+
+class Runner
+{
+public:
+
+  Runner(const Options &opt, ScriptEnvironment &env)
+    : _opt(opt)
+    , _env(env)
+  {
+    _env.SetClipWrapper([this](const char *name, const PClip &clip) { return wrap(name, clip); });
+  }
+
+  PClip build()
+  {
+    parse_overrides();
+
+    const PClip src = wrap("Source", new SourceClip(_opt, &_env));
+    const VideoInfo &vi = src->GetVideoInfo();
+    const PClip super = call("MSuper", { src }, {});
+
+    const std::string &c = _opt.chain;
+    if (c == "super")
+      return super;
+    if (c == "analyse")
+      return call("MAnalyse", { super }, {});
+    if (c == "degrain")
+    {
+      const PClip mv = call("MAnalyse", { super }, { { "multi", true }, { "delta", _opt.tr } });
+      return call("MDegrainN", { src, super, mv, _opt.tr }, { { "thSAD", 400 } });
+    }
+    if (c == "compensate")
+    {
+      const PClip bv = call("MAnalyse", { super }, { { "isb", true } });
+      return call("MCompensate", { src, super, bv }, {});
+    }
+    if (c == "flowfps")
+    {
+      const PClip bv = call("MAnalyse", { super }, { { "isb", true } });
+      const PClip fv = call("MAnalyse", { super }, { { "isb", false } });
+      return call("MFlowFps", { src, super, bv, fv },
+        { { "num", int(vi.fps_numerator * 2) }, { "den", int(vi.fps_denominator) } });
+    }
+    _env.ThrowError("mvtools-run: unknown chain \"%s\"", c.c_str());
+    return PClip();
+  }
+
+  void report(int nbr_frames, double wall_s) const
+  {
+    printf("%d frames in %.3f s: %.2f fps\n\n", nbr_frames, wall_s, nbr_frames / wall_s);
+    printf("%-16s %8s %8s %10s %10s %7s %9s\n", "node", "calls", "hits", "incl ms", "self ms", "self %", "ms/frame");
+    for (const auto &s : _stats)
+    {
+      printf("%-16s %8d %8d %10.1f %10.1f %6.1f%% %9.3f\n",
+        s->name.c_str(), s->calls, s->hits, s->incl_s * 1e3, s->self_s * 1e3,
+        100 * s->self_s / wall_s, s->self_s * 1e3 / nbr_frames);
+    }
+    printf("\npeak frame memory: %.1f MiB\n", ScriptEnvironment::GetPeakBytes() / 1048576.0);
+    printf("peak RSS:          %.1f MiB\n", peak_rss() / 1048576.0);
+  }
+
+private:
+
+  PClip wrap(const char *name, const PClip &clip)
+  {
+    std::string label = name;
+    int count = 0;
+    for (const auto &s : _stats)
+    {
+      if (s->name.compare(0, label.size(), label) == 0)
+        ++count;
+    }
+    if (count > 0)
+      label += "#" + std::to_string(count + 1);
+
+    auto stats = std::make_shared<NodeStats>();
+    stats->name = label;
+    _stats.push_back(stats);
+    return new Node(clip, stats, _opt.cache);
+  }
+
+  PClip call(const char *name, std::vector<AVSValue> args, std::vector<ScriptEnvironment::NamedArg> named)
+  {
+    // command line values replace the chain ones
+    for (const auto &o : _overrides [name])
+    {
+      named.erase(std::remove_if(named.begin(), named.end(),
+        [&o](const ScriptEnvironment::NamedArg &a) { return a.first == o.first; }), named.end());
+      named.push_back(o);
+    }
+    return _env.Call(name, args, named).AsClip();
+  }
+
+  void parse_overrides()
+  {
+    for (const std::string &p : _opt.params)
+    {
+      const size_t dot = p.find('.');
+      const size_t eq = p.find('=');
+      if (dot == std::string::npos || eq == std::string::npos || eq < dot)
+        _env.ThrowError("mvtools-run: invalid parameter \"%s\", expected Filter.param=value", p.c_str());
+      const std::string fnc = p.substr(0, dot);
+      const std::string par = p.substr(dot + 1, eq - dot - 1);
+      const char *val = _env.SaveString(p.c_str() + eq + 1);
+      AVSValue v;
+      switch (_env.GetParamType(fnc.c_str(), par.c_str()))
+      {
+      case 'i': v = atoi(val); break;
+      case 'f': v = atof(val); break;
+      case 'b': v = (strcmp(val, "true") == 0 || strcmp(val, "1") == 0); break;
+      case 's': v = val; break;
+      default:
+        _env.ThrowError("mvtools-run: %s has no int, float, bool or string parameter \"%s\"", fnc.c_str(), par.c_str());
+      }
+      _overrides [fnc].push_back(ScriptEnvironment::NamedArg(par, v));
+    }
+  }
+
+  static size_t peak_rss()
+  {
+#if defined (_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+      return pmc.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return size_t(usage.ru_maxrss) * 1024;
+#endif
+  }
+
+  const Options &_opt;
+  ScriptEnvironment &_env;
+  std::vector<std::shared_ptr<NodeStats> > _stats; // creation order
+  std::map<std::string, std::vector<ScriptEnvironment::NamedArg> > _overrides;
+};
+
+
+
+// Y4M writer
+class Output
+{
+public:
+
+  Output(const std::string &path, const VideoInfo &vi, IScriptEnvironment *env)
+    : _vi(vi)
+  {
+    const FormatInfo *fmt = find_pixel_type(vi.pixel_type);
+    if (fmt == nullptr || fmt->y4m == nullptr)
+      env->ThrowError("mvtools-run: the output format cannot be written to Y4M");
+    _file = fopen(path.c_str(), "wb");
+    if (_file == nullptr)
+      env->ThrowError("mvtools-run: cannot create %s", path.c_str());
+    fprintf(_file, "YUV4MPEG2 W%d H%d F%u:%u Ip A1:1 C%s\n",
+      vi.width, vi.height, vi.fps_numerator, vi.fps_denominator, fmt->y4m);
+  }
+
+  ~Output()
+  {
+    fclose(_file);
+  }
+
+  void write(const PVideoFrame &frame)
+  {
+    fputs("FRAME\n", _file);
+    for (int p : plane_list(_vi))
+    {
+      const BYTE *src_ptr = frame->GetReadPtr(p);
+      for (int y = 0; y < frame->GetHeight(p); ++y)
+      {
+        fwrite(src_ptr, 1, frame->GetRowSize(p), _file);
+        src_ptr += frame->GetPitch(p);
+      }
+    }
+  }
+
+private:
+
+  VideoInfo _vi;
+  FILE *_file;
+};
+
+
+
+struct ArchInfo
+{
+  const char *name;
+  int cpu_flags;
+};
+
+const ArchInfo arch_list[] =
+{
+  { "c",     0 },
+  { "sse2",  CPUF_MMX | CPUF_INTEGER_SSE | CPUF_SSE | CPUF_SSE2 },
+  { "sse41", CPUF_MMX | CPUF_INTEGER_SSE | CPUF_SSE | CPUF_SSE2 | CPUF_SSE3 | CPUF_SSSE3 | CPUF_SSE4_1 },
+  { "avx",   CPUF_MMX | CPUF_INTEGER_SSE | CPUF_SSE | CPUF_SSE2 | CPUF_SSE3 | CPUF_SSSE3 | CPUF_SSE4_1 | CPUF_SSE4_2 | CPUF_AVX },
+  { "avx2",  -1 }
+};
+
+void usage()
+{
+  printf(
+    "Usage: mvtools-run [options] input\n"
+    "  input             Y4M file, raw YUV file (with --raw) or synth:WxH[:frames[:format]]\n"
+    "  --chain name      super, analyse, degrain, compensate, flowfps (default degrain)\n"
+    "  --tr n            MDegrainN temporal radius (default 2)\n"
+    "  -p F.param=value  filter parameter, e.g. -p MAnalyse.blksize=16 (repeatable)\n"
+    "  --raw WxH         raw input of this size\n"
+    "  --format name     raw and synthetic input format: yuv420p, yuv420p10..16, yuv420ps,\n"
+    "                    yuv422p*, yuv444p*, gray, gray10..16, grays (default yuv420p)\n"
+    "  --fps num:den     raw and synthetic input frame rate (default 25:1)\n"
+    "  --start n         first output frame (default 0)\n"
+    "  --frames n        number of output frames (default all)\n"
+    "  --cache n         frames cached after each filter (default 16)\n"
+    "  -a arch           highest CPU tier: c, sse2, sse41, avx, avx2 (default avx2)\n"
+    "  -o file.y4m       writes the output\n"
+    "  --verify          compares the output of each tier up to -a with the C one\n"
+    "  --props           prints the int and float properties of the output frames\n"
+    "  --kernels         prints the kernel implementations selected by the filters\n"
+    "  --memory          prints the memory allocated by the filters\n"
+    "  --plugin path     plugin to load (default %s)\n",
+    MVTOOLS_PLUGIN_PATH
+  );
+}
+
+// One line per property: frame number, name and values
+void print_props(int n, const PVideoFrame &frame, ScriptEnvironment &env)
+{
+  const AVSMap *map = env.getFramePropsRO(frame);
+  const int nbr_keys = env.propNumKeys(map);
+  for (int k = 0; k < nbr_keys; ++k)
+  {
+    const char *key = env.propGetKey(map, k);
+    const char type = env.propGetType(map, key);
+    if (type != PROPTYPE_INT && type != PROPTYPE_FLOAT)
+      continue;
+    std::string line = std::to_string(n) + " " + key + ":";
+    const int nbr_elt = env.propNumElements(map, key);
+    for (int i = 0; i < nbr_elt; ++i)
+    {
+      int err = 0;
+      char val_0[64];
+      if (type == PROPTYPE_INT)
+        snprintf(val_0, sizeof(val_0), " %lld", (long long)env.propGetInt(map, key, i, &err));
+      else
+        snprintf(val_0, sizeof(val_0), " %g", env.propGetFloat(map, key, i, &err));
+      line += val_0;
+    }
+    printf("%s\n", line.c_str());
+  }
+}
+
+// Builds the chain at each tier and compares the frames with the C ones.
+// Returns the number of tiers giving different frames.
+int verify(const Options &opt)
+{
+  struct Tier
+  {
+    const char *name;
+    std::unique_ptr<ScriptEnvironment> env;
+    std::unique_ptr<Runner> runner;
+    PClip out;
+    int nbr_diff = 0;
+    std::string first_diff;
+  };
+
+  const int cpu_flags = detect_cpu_flags();
+  std::vector<std::unique_ptr<Tier> > tiers;
+  int prev_flags = -1;
+  for (const ArchInfo &a : arch_list)
+  {
+    // skips the tiers the CPU or -a cannot reach
+    const int flags = cpu_flags & a.cpu_flags & opt.cpu_mask;
+    if (flags == prev_flags)
+      continue;
+    prev_flags = flags;
+    std::unique_ptr<Tier> t(new Tier);
+    t->name = a.name;
+    t->env.reset(new ScriptEnvironment(flags));
+    t->env->LoadPlugin(opt.plugin.c_str());
+    t->runner.reset(new Runner(opt, *t->env));
+    t->out = t->runner->build();
+    tiers.push_back(std::move(t));
+  }
+
+  const Tier &ref = *tiers.front();
+  const VideoInfo &vi = ref.out->GetVideoInfo();
+  const std::vector<int> planes = plane_list(vi);
+  const int start = std::max(0, std::min(opt.start, vi.num_frames));
+  const int end = (opt.frames < 0) ? vi.num_frames : std::min(start + opt.frames, vi.num_frames);
+  if (end <= start)
+    ref.env->ThrowError("mvtools-run: no frame to process");
+
+  for (int n = start; n < end; ++n)
+  {
+    const PVideoFrame ref_frame = ref.out->GetFrame(n, ref.env.get());
+    // the header of the vector frames holds the CPU flags of MAnalyse
+    int skip = 0;
+    if (opt.chain == "analyse")
+      memcpy(&skip, ref_frame->GetReadPtr(), sizeof(skip));
+    for (size_t k = 1; k < tiers.size(); ++k)
+    {
+      Tier &t = *tiers[k];
+      const PVideoFrame frame = t.out->GetFrame(n, t.env.get());
+      std::string diff;
+      for (int i = 0; i < int(planes.size()) && diff.empty(); ++i)
+      {
+        const int p = planes [i];
+        const int row_size = ref_frame->GetRowSize(p);
+        for (int y = 0; y < ref_frame->GetHeight(p) && diff.empty(); ++y)
+        {
+          const BYTE *a = ref_frame->GetReadPtr(p) + y * ref_frame->GetPitch(p);
+          const BYTE *b = frame->GetReadPtr(p) + y * frame->GetPitch(p);
+          const int x_beg = (i == 0 && y == 0) ? std::min(skip, row_size) : 0;
+          if (memcmp(a + x_beg, b + x_beg, row_size - x_beg) == 0)
+            continue;
+          int x = x_beg;
+          while (a [x] == b [x])
+            ++x;
+          char txt [128];
+          snprintf(txt, sizeof(txt), "frame %d, plane %d, row %d, byte %d is %d instead of %d",
+            n, i, y, x, b [x], a [x]);
+          diff = txt;
+        }
+      }
+      if (!diff.empty())
+      {
+        if (t.nbr_diff == 0)
+          t.first_diff = diff;
+        ++t.nbr_diff;
+      }
+    }
+  }
+
+  printf("%s: %dx%d, %d-bit, chain %s, frames %d-%d\n",
+    opt.input.c_str(), vi.width, vi.height, vi.BitsPerComponent(), opt.chain.c_str(), start, end - 1);
+  int nbr_failed = 0;
+  for (size_t k = 1; k < tiers.size(); ++k)
+  {
+    const Tier &t = *tiers[k];
+    if (t.nbr_diff == 0)
+      printf("%-6s ok\n", t.name);
+    else
+    {
+      printf("%-6s %d frames differ, first: %s\n", t.name, t.nbr_diff, t.first_diff.c_str());
+      ++nbr_failed;
+    }
+  }
+  if (tiers.size() < 2)
+    printf("no SIMD tier to compare\n");
+
+  // clips first, they may use their environment when destroyed
+  for (auto &t : tiers)
+  {
+    t->out = nullptr;
+    t->runner.reset();
+  }
+  return nbr_failed;
+}
+
+} // namespace
+
+
+
+int main(int argc, char *argv[])
+{
+  Options opt;
+  for (int i = 1; i < argc; i++)
+  {
+    const std::string arg = argv[i];
+    const bool has_val = (i + 1 < argc);
+    if (arg == "--chain" && has_val)
+      opt.chain = argv[++i];
+    else if (arg == "--tr" && has_val)
+      opt.tr = atoi(argv[++i]);
+    else if (arg == "-p" && has_val)
+      opt.params.push_back(argv[++i]);
+    else if (arg == "--raw" && has_val)
+    {
+      if (sscanf(argv[++i], "%dx%d", &opt.raw_w, &opt.raw_h) != 2)
+      {
+        fprintf(stderr, "mvtools-run: invalid size \"%s\"\n", argv[i]);
+        return 1;
+      }
+    }
+    else if (arg == "--format" && has_val)
+      opt.raw_format = argv[++i];
+    else if (arg == "--fps" && has_val)
+    {
+      if (sscanf(argv[++i], "%d:%d", &opt.fps_num, &opt.fps_den) != 2 || opt.fps_num <= 0 || opt.fps_den <= 0)
+      {
+        fprintf(stderr, "mvtools-run: invalid frame rate \"%s\"\n", argv[i]);
+        return 1;
+      }
+    }
+    else if (arg == "--start" && has_val)
+      opt.start = atoi(argv[++i]);
+    else if (arg == "--frames" && has_val)
+      opt.frames = atoi(argv[++i]);
+    else if (arg == "--cache" && has_val)
+      opt.cache = atoi(argv[++i]);
+    else if (arg == "-a" && has_val)
+    {
+      const char *name = argv[++i];
+      auto it = std::find_if(std::begin(arch_list), std::end(arch_list),
+        [name](const ArchInfo &a) { return strcmp(a.name, name) == 0; });
+      if (it == std::end(arch_list))
+      {
+        fprintf(stderr, "mvtools-run: unknown arch \"%s\"\n", name);
+        return 1;
+      }
+      opt.cpu_mask = it->cpu_flags;
+    }
+    else if (arg == "-o" && has_val)
+      opt.output = argv[++i];
+    else if (arg == "--verify")
+      opt.verify = true;
+    else if (arg == "--props")
+      opt.props = true;
+    else if (arg == "--kernels")
+      opt.kernels = true;
+    else if (arg == "--memory")
+      opt.memory = true;
+    else if (arg == "--plugin" && has_val)
+      opt.plugin = argv[++i];
+    else if (arg [0] != '-' && opt.input.empty())
+      opt.input = arg;
+    else
+    {
+      usage();
+      return (arg == "-h" || arg == "--help") ? 0 : 1;
+    }
+  }
+  if (opt.input.empty())
+  {
+    usage();
+    return 1;
+  }
+
+  if (opt.verify)
+  {
+    try
+    {
+      return (verify(opt) > 0) ? 1 : 0;
+    }
+    catch (const AvisynthError &e)
+    {
+      fprintf(stderr, "%s\n", e.msg);
+      return 1;
+    }
+  }
+
+  int ret = 0;
+  ScriptEnvironment env(detect_cpu_flags() & opt.cpu_mask);
+  try
+  {
+    env.LoadPlugin(opt.plugin.c_str());
+
+    Runner runner(opt, env);
+    PClip out = runner.build();
+    const VideoInfo &vi = out->GetVideoInfo();
+    if (opt.kernels)
+      printf("%s\n", env.Invoke("MToolsInfo", AVSValue(nullptr, 0)).AsString(""));
+    const int start = std::max(0, std::min(opt.start, vi.num_frames));
+    const int end = (opt.frames < 0) ? vi.num_frames : std::min(start + opt.frames, vi.num_frames);
+    if (end <= start)
+      env.ThrowError("mvtools-run: no frame to process");
+
+    std::unique_ptr<Output> output;
+    if (!opt.output.empty())
+      output.reset(new Output(opt.output, vi, &env));
+
+    const Clock::time_point beg = Clock::now();
+    for (int n = start; n < end; ++n)
+    {
+      const PVideoFrame frame = out->GetFrame(n, &env);
+      if (output)
+        output->write(frame);
+      if (opt.props)
+        print_props(n, frame, env);
+    }
+    const double wall_s = std::chrono::duration<double>(Clock::now() - beg).count();
+
+    printf("%s: %dx%d, %d-bit, chain %s\n", opt.input.c_str(), vi.width, vi.height, vi.BitsPerComponent(), opt.chain.c_str());
+    runner.report(end - start, wall_s);
+    if (opt.memory)
+      printf("%s", env.Invoke("MToolsMemory", AVSValue(nullptr, 0)).AsString(""));
+  }
+  catch (const AvisynthError &e)
+  {
+    fprintf(stderr, "%s\n", e.msg);
+    ret = 1;
+  }
+
+  return ret;
+}
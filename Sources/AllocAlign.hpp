@@ -23,6 +23,7 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 #include	"def.h"
+#include	"MemInfo.h"
 
 #include	<cassert>
 
@@ -80,12 +81,14 @@ typename aligned_allocator<T, N>::pointer aligned_allocator<T, N>::allocate(size
   pointer res = reinterpret_cast<pointer>(_aligned_malloc(sizeof(T) * n, N));
   if (res == 0)
     throw std::bad_alloc();
+  MemInfo::OnAlloc(res, sizeof(T) * n);
   return res;
 }
 
 template <class T, int N>
 void aligned_allocator<T, N>::deallocate(pointer p, size_type)
 {
+  MemInfo::OnFree(p);
   _aligned_free(p);
 }
 #endif	// AllocAlign_CODEHEADER_INCLUDED
@@ -55,7 +55,14 @@ enum AnaFlags
 
   // force MVAnalyse to use a different function for SAD / SADCHROMA (debug)
 	MOTION_USE_SSD             = 0x08000000,
-	MOTION_USE_SATD            = 0x10000000
+	MOTION_USE_SATD            = 0x10000000,
+
+  // luma SAD of zero and global vectors composed from overlap-sized tiles
+  MOTION_USE_TILE_SAD_CACHE  = 0x40000000,
+
+  // vector data is carried by a frame property (AviSynth+ v8), the frame
+  // content holds only the header
+  MOTION_VECTORS_IN_FRAMEPROP = 0x20000000
 };
 
 
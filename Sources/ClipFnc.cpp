@@ -191,6 +191,49 @@ sad_t	ClipFnc::interpolate_thsad (sad_t thsad1, sad_t thsad2, int d, int tr)
 
 
 
+// Vector data attached to a vector clip frame, frame property transport.
+// The pointer refers to the property storage, no copy is done. It remains
+// valid as long as the frame is alive and its properties are not modified.
+// len_i32 receives the data length in 32-bit words.
+const int *	ClipFnc::get_vector_prop (const ::PVideoFrame &frame, int &len_i32, IScriptEnvironment *env)
+{
+  assert (env != 0);
+
+  const AVSMap *	props_ptr = env->getFramePropsRO (frame);
+  int				err = 0;
+  const char *	data_ptr = env->propGetData (props_ptr, _vector_prop_name_0, 0, &err);
+  if (err != 0 || data_ptr == 0)
+  {
+    env->ThrowError ("MVTools: vector frame property is missing");
+  }
+  const int		len_bytes = env->propGetDataSize (props_ptr, _vector_prop_name_0, 0, &err);
+  len_i32 = len_bytes / int (sizeof (int));
+
+  return (reinterpret_cast <const int *> (data_ptr));
+}
+
+
+
+void	ClipFnc::set_vector_prop (::PVideoFrame &frame, const int *data_ptr, int len_i32, IScriptEnvironment *env)
+{
+  assert (data_ptr != 0);
+  assert (len_i32 > 0);
+  assert (env != 0);
+
+  AVSMap *			props_ptr = env->getFramePropsRW (frame);
+  env->propSetData (
+    props_ptr, _vector_prop_name_0,
+    reinterpret_cast <const char *> (data_ptr), len_i32 * int (sizeof (int)),
+    PROPAPPENDMODE_REPLACE
+  );
+}
+
+
+
+const char	ClipFnc::_vector_prop_name_0 [] = "MVTools_Vectors";
+
+
+
 /*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 
@@ -51,6 +51,7 @@ Various utility functions related to avisynth clips.
 // avisynth.h forward declarations
 class IScriptEnvironment;
 class PClip;
+class PVideoFrame;
 struct VideoInfo;
 
 
@@ -66,6 +67,12 @@ public:
   static void		format_vector_clip (::VideoInfo &vi, bool single_line_flag, int nbr_blk_x, const char *vccs_0, int size_bytes, const char *funcname_0, IScriptEnvironment *env);
   static int		compute_mvclip_best_width (int nbr_blk_x, int unit_size, int align);
   static sad_t		interpolate_thsad (sad_t thsad1, sad_t thsad2, int d, int tr);
+  static const int *	get_vector_prop (const ::PVideoFrame &frame, int &len_i32, IScriptEnvironment *env);
+  static void		set_vector_prop (::PVideoFrame &frame, const int *data_ptr, int len_i32, IScriptEnvironment *env);
+
+  // Name of the frame property holding the vector data when the vector clip
+  // is built with MOTION_VECTORS_IN_FRAMEPROP
+  static const char	_vector_prop_name_0 [];
 
 
 
@@ -103,96 +103,100 @@ void Copy_C (uint8_t *pDst, int nDstPitch, const uint8_t *pSrc, int nSrcPitch)
 COPYFunction* get_copy_function(int BlockX, int BlockY, int pixelsize, arch_t arch)
 {
     // BlkSizeX, BlkSizeY, pixelsize, arch_t
-    std::map<std::tuple<int, int, int, arch_t>, COPYFunction*> func_copy;
     using std::make_tuple;
+    static const std::map<std::tuple<int, int, int, arch_t>, COPYFunction*> func_copy_table = []() {
+      std::map<std::tuple<int, int, int, arch_t>, COPYFunction*> func_copy;
 #define MAKE_COPY_FN(x, y) func_copy[make_tuple(x, y, 1, NO_SIMD)] = Copy_C<x, y, uint8_t>; \
 func_copy[make_tuple(x, y, 2, NO_SIMD)] = Copy_C<x, y, uint16_t>; \
 func_copy[make_tuple(x, y, 4, NO_SIMD)] = Copy_C<x, y, float>;
-    // same list as in overlap.cpp SadFunction.cpp, Sad_C selector
-    MAKE_COPY_FN(64, 64)
-      MAKE_COPY_FN(64, 48)
-      MAKE_COPY_FN(64, 32)
-      MAKE_COPY_FN(64, 16)
-      MAKE_COPY_FN(48, 64)
-      MAKE_COPY_FN(48, 48)
-      MAKE_COPY_FN(48, 24)
-      MAKE_COPY_FN(48, 12)
-      MAKE_COPY_FN(32, 64)
-      MAKE_COPY_FN(32, 32)
-      MAKE_COPY_FN(32, 24)
-      MAKE_COPY_FN(32, 16)
-      MAKE_COPY_FN(32, 8)
-      MAKE_COPY_FN(24, 48)
-      MAKE_COPY_FN(24, 32)
-      MAKE_COPY_FN(24, 24)
-      MAKE_COPY_FN(24, 12)
-      MAKE_COPY_FN(24, 6)
-      MAKE_COPY_FN(16, 64)
-      MAKE_COPY_FN(16, 32)
-      MAKE_COPY_FN(16, 16)
-      MAKE_COPY_FN(16, 12)
-      MAKE_COPY_FN(16, 8)
-      MAKE_COPY_FN(16, 4)
-      MAKE_COPY_FN(16, 2)
-      MAKE_COPY_FN(16, 1)
-      MAKE_COPY_FN(12, 48)
-      MAKE_COPY_FN(12, 24)
-      MAKE_COPY_FN(12, 16)
-      MAKE_COPY_FN(12, 12)
-      MAKE_COPY_FN(12, 6)
-      MAKE_COPY_FN(12, 3)
-      MAKE_COPY_FN(8, 32)
-      MAKE_COPY_FN(8, 16)
-      MAKE_COPY_FN(8, 8)
-      MAKE_COPY_FN(8, 4)
-      MAKE_COPY_FN(8, 2)
-      MAKE_COPY_FN(8, 1)
-      MAKE_COPY_FN(6, 24)
-      MAKE_COPY_FN(6, 12)
-      MAKE_COPY_FN(6, 6)
-      MAKE_COPY_FN(6, 3)
-      MAKE_COPY_FN(4, 8)
-      MAKE_COPY_FN(4, 4)
-      MAKE_COPY_FN(4, 2)
-      MAKE_COPY_FN(4, 1)
-      MAKE_COPY_FN(3, 6)
-      MAKE_COPY_FN(3, 3)
-      MAKE_COPY_FN(2, 4)
-      MAKE_COPY_FN(2, 2)
-      MAKE_COPY_FN(2, 1)
+      // same list as in overlap.cpp SadFunction.cpp, Sad_C selector
+      MAKE_COPY_FN(64, 64)
+        MAKE_COPY_FN(64, 48)
+        MAKE_COPY_FN(64, 32)
+        MAKE_COPY_FN(64, 16)
+        MAKE_COPY_FN(48, 64)
+        MAKE_COPY_FN(48, 48)
+        MAKE_COPY_FN(48, 24)
+        MAKE_COPY_FN(48, 12)
+        MAKE_COPY_FN(32, 64)
+        MAKE_COPY_FN(32, 32)
+        MAKE_COPY_FN(32, 24)
+        MAKE_COPY_FN(32, 16)
+        MAKE_COPY_FN(32, 8)
+        MAKE_COPY_FN(24, 48)
+        MAKE_COPY_FN(24, 32)
+        MAKE_COPY_FN(24, 24)
+        MAKE_COPY_FN(24, 12)
+        MAKE_COPY_FN(24, 6)
+        MAKE_COPY_FN(16, 64)
+        MAKE_COPY_FN(16, 32)
+        MAKE_COPY_FN(16, 16)
+        MAKE_COPY_FN(16, 12)
+        MAKE_COPY_FN(16, 8)
+        MAKE_COPY_FN(16, 4)
+        MAKE_COPY_FN(16, 2)
+        MAKE_COPY_FN(16, 1)
+        MAKE_COPY_FN(12, 48)
+        MAKE_COPY_FN(12, 24)
+        MAKE_COPY_FN(12, 16)
+        MAKE_COPY_FN(12, 12)
+        MAKE_COPY_FN(12, 6)
+        MAKE_COPY_FN(12, 3)
+        MAKE_COPY_FN(8, 32)
+        MAKE_COPY_FN(8, 16)
+        MAKE_COPY_FN(8, 8)
+        MAKE_COPY_FN(8, 4)
+        MAKE_COPY_FN(8, 2)
+        MAKE_COPY_FN(8, 1)
+        MAKE_COPY_FN(6, 24)
+        MAKE_COPY_FN(6, 12)
+        MAKE_COPY_FN(6, 6)
+        MAKE_COPY_FN(6, 3)
+        MAKE_COPY_FN(4, 8)
+        MAKE_COPY_FN(4, 4)
+        MAKE_COPY_FN(4, 2)
+        MAKE_COPY_FN(4, 1)
+        MAKE_COPY_FN(3, 6)
+        MAKE_COPY_FN(3, 3)
+        MAKE_COPY_FN(2, 4)
+        MAKE_COPY_FN(2, 2)
+        MAKE_COPY_FN(2, 1)
 #undef MAKE_COPY_FN
 
 #ifdef USE_COPYCODE_ASM
-    // we could even ignore copy sse2 assemblers, compilers are smart nowadays
-    // no mmx copy for block sizes over 32
-    // CopyCode-a.asm
-    func_copy[make_tuple(32, 32, 1, USE_SSE2)] = Copy32x32_sse2;
-    func_copy[make_tuple(32, 16, 1, USE_SSE2)] = Copy32x16_sse2;
-    func_copy[make_tuple(32, 8 , 1, USE_SSE2)] = Copy32x8_sse2;
-    func_copy[make_tuple(16, 32, 1, USE_SSE2)] = Copy16x32_sse2;
-    func_copy[make_tuple(16, 16, 1, USE_SSE2)] = Copy16x16_sse2;
-    func_copy[make_tuple(16, 8 , 1, USE_SSE2)] = Copy16x8_sse2;
-    func_copy[make_tuple(16, 4 , 1, USE_SSE2)] = Copy16x4_sse2;
-    func_copy[make_tuple(16, 2 , 1, USE_SSE2)] = Copy16x2_sse2;
-    func_copy[make_tuple(8 , 16, 1, USE_SSE2)] = Copy8x16_sse2;
-    func_copy[make_tuple(8 , 8 , 1, USE_SSE2)] = Copy8x8_sse2;
-    func_copy[make_tuple(8 , 4 , 1, USE_SSE2)] = Copy8x4_sse2;
-    func_copy[make_tuple(8 , 2 , 1, USE_SSE2)] = Copy8x2_sse2;
-    func_copy[make_tuple(8 , 1 , 1, USE_SSE2)] = Copy8x1_sse2;
-    func_copy[make_tuple(4 , 8 , 1, USE_SSE2)] = Copy4x8_sse2;
-    func_copy[make_tuple(4 , 4 , 1, USE_SSE2)] = Copy4x4_sse2;
-    func_copy[make_tuple(4 , 2 , 1, USE_SSE2)] = Copy4x2_sse2;
-    func_copy[make_tuple(2 , 4 , 1, USE_SSE2)] = Copy2x4_sse2;
-    func_copy[make_tuple(2 , 2 , 1, USE_SSE2)] = Copy2x2_sse2;
-    //func_copy[make_tuple(2 , 1 , 1, USE_SSE2)] = Copy2x1_sse2; no such
+      // we could even ignore copy sse2 assemblers, compilers are smart nowadays
+      // no mmx copy for block sizes over 32
+      // CopyCode-a.asm
+      func_copy[make_tuple(32, 32, 1, USE_SSE2)] = Copy32x32_sse2;
+      func_copy[make_tuple(32, 16, 1, USE_SSE2)] = Copy32x16_sse2;
+      func_copy[make_tuple(32, 8 , 1, USE_SSE2)] = Copy32x8_sse2;
+      func_copy[make_tuple(16, 32, 1, USE_SSE2)] = Copy16x32_sse2;
+      func_copy[make_tuple(16, 16, 1, USE_SSE2)] = Copy16x16_sse2;
+      func_copy[make_tuple(16, 8 , 1, USE_SSE2)] = Copy16x8_sse2;
+      func_copy[make_tuple(16, 4 , 1, USE_SSE2)] = Copy16x4_sse2;
+      func_copy[make_tuple(16, 2 , 1, USE_SSE2)] = Copy16x2_sse2;
+      func_copy[make_tuple(8 , 16, 1, USE_SSE2)] = Copy8x16_sse2;
+      func_copy[make_tuple(8 , 8 , 1, USE_SSE2)] = Copy8x8_sse2;
+      func_copy[make_tuple(8 , 4 , 1, USE_SSE2)] = Copy8x4_sse2;
+      func_copy[make_tuple(8 , 2 , 1, USE_SSE2)] = Copy8x2_sse2;
+      func_copy[make_tuple(8 , 1 , 1, USE_SSE2)] = Copy8x1_sse2;
+      func_copy[make_tuple(4 , 8 , 1, USE_SSE2)] = Copy4x8_sse2;
+      func_copy[make_tuple(4 , 4 , 1, USE_SSE2)] = Copy4x4_sse2;
+      func_copy[make_tuple(4 , 2 , 1, USE_SSE2)] = Copy4x2_sse2;
+      func_copy[make_tuple(2 , 4 , 1, USE_SSE2)] = Copy2x4_sse2;
+      func_copy[make_tuple(2 , 2 , 1, USE_SSE2)] = Copy2x2_sse2;
+      //func_copy[make_tuple(2 , 1 , 1, USE_SSE2)] = Copy2x1_sse2; no such
 #endif
+      return func_copy;
+    }();
+
     COPYFunction *result = nullptr;
     arch_t archlist[] = { USE_AVX2, USE_AVX, USE_SSE41, USE_SSE2, NO_SIMD };
     int index = 0;
     while (result == nullptr) {
       arch_t current_arch_try = archlist[index++];
       if (current_arch_try > arch) continue;
-      result = func_copy[make_tuple(BlockX, BlockY, pixelsize, current_arch_try)];
+      result = find_function(func_copy_table, make_tuple(BlockX, BlockY, pixelsize, current_arch_try));
       if (result == nullptr && current_arch_try == NO_SIMD)
         break;
     }
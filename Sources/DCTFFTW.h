@@ -72,9 +72,11 @@ class DCTFFTW
 
   DCTFFTW::Bytes2FloatFunction get_bytesToFloatPROC_function(int BlockX, int BlockY, int pixelsize, arch_t arch);
   DCTFFTW::Bytes2FloatFunction bytesToFloatPROC;
-  static std::mutex _fftw_mutex;
 
 public:
+  // FFTW plan construction and destruction are not thread-safe (shared with GlobalMotionPC)
+  static std::mutex _fftw_mutex;
+
   DCTFFTW(int _sizex, int _sizey, FFTFunctionPointers &fftfp_preloaded, int _dctmode, int _pixelsize, int _bits_per_pixel, int cpu);
   ~DCTFFTW();
   // works internally by pixelsize:
@@ -29,6 +29,8 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 #include	"DCTFactory.h"
 #include	"DCTFFTW.h"
 #include	"DCTINT.h"
+#include	"KernelInfo.h"
+#include	"MemInfo.h"
 
 #include	<cassert>
 
@@ -48,7 +50,7 @@ DCTFactory::DCTFactory(int dctmode, bool isse, int blksizex, int blksizey, int p
 #endif
   , _pixelsize(pixelsize)
   , _bits_per_pixel(bits_per_pixel)
-
+  , _mem_info_ptr(MemInfo::GetCurrent())
 {
   assert(dctmode != 0);
   
@@ -92,12 +94,38 @@ bool	DCTFactory::use_fftw() const
 
 
 
+// For MToolsInfo(): integer 8x8 asm transform or FFTW
+void	DCTFactory::describe(KernelInfo &info) const
+{
+  const std::string	config = KernelInfo::Config(_blksizex, _blksizey, _bits_per_pixel);
+  const bool			int_size_flag = (_blksizex == 8 && _blksizey == 8 && _pixelsize == 1);
+#ifdef USE_FDCT88INT_ASM
+  if (! _fftw_flag)
+  {
+    info.Add("DCT", config, "int asm", "");
+  }
+  else
+  {
+    info.Add("DCT", config, "FFTW",
+      (int_size_flag) ? "integer 8x8 asm disabled (isse=false)"
+      : "integer asm is 8x8 8-bit only");
+  }
+#else
+  info.Add("DCT", config, "FFTW",
+    (int_size_flag) ? "integer 8x8 asm not built (USE_FDCT88INT_ASM)" : "");
+#endif
+}
+
+
+
 /*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 
 
+// The pools create the objects on the threads of the frame requests
 DCTClass *	DCTFactory::do_create()
 {
+  MemInfo::Scope mem_scope(_mem_info_ptr);
 #ifdef USE_FDCT88INT_ASM
   if (_fftw_flag)
   {
@@ -33,6 +33,8 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 
 
 class IScriptEnvironment;
+class KernelInfo;
+class MemInfo;
 
 class DCTFactory
   : public conc::ObjFactoryInterface <DCTClass>
@@ -47,6 +49,7 @@ public:
 
   int get_dctmode() const;
   bool use_fftw() const;
+  void describe(KernelInfo &info) const;
   int cpuflags;
 
 
@@ -72,6 +75,7 @@ private:
   const bool _fftw_flag;
   const int _pixelsize; // PF
   const int _bits_per_pixel;
+  MemInfo * const _mem_info_ptr; // Charged with the DCT objects, 0 if none
 
 
 
@@ -24,6 +24,7 @@
 
 #include "def.h"
 #include "DCTINT.h"
+#include "MemInfo.h"
 #include "types.h"
 
 #include "malloc.h"
@@ -55,6 +56,7 @@ DCTINT::DCTINT(int _sizex, int _sizey, int _dctmode)
 // 64 words working buffer followed by a 64 word internal temp buffer (multithreading)
 
   pWorkArea = (short * const)_aligned_malloc(2 * (8 * 8 * sizeof(short)), 128);
+  MemInfo::OnAlloc(pWorkArea, 2 * (8 * 8 * sizeof(short)));
 
 
 }
@@ -63,6 +65,7 @@ DCTINT::DCTINT(int _sizex, int _sizey, int _dctmode)
 
 DCTINT::~DCTINT()
 {
+  MemInfo::OnFree(pWorkArea);
   _aligned_free(pWorkArea);
   pWorkArea = 0;
 }
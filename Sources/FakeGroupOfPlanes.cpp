@@ -56,6 +56,7 @@ FakeGroupOfPlanes::FakeGroupOfPlanes()
 {
   //InitializeCriticalSection(&cs); // 16.03.08 moved here from ::Create
   planes = 0;
+  scene_stat_flag = false;
 }
 
 FakeGroupOfPlanes::~FakeGroupOfPlanes()
@@ -72,7 +73,7 @@ FakeGroupOfPlanes::~FakeGroupOfPlanes()
 
 // data_size = available data, in 32-bit words
 // Returns false on error.
-bool FakeGroupOfPlanes::Update(const int *array, int data_size)
+bool FakeGroupOfPlanes::Update(const int *array, int data_size, const MVSceneStat *stat_ptr)
 {
   //::EnterCriticalSection (&cs);
   std::lock_guard<std::mutex> lock(cs);
@@ -119,6 +120,11 @@ bool FakeGroupOfPlanes::Update(const int *array, int data_size)
     }
   }
 
+  // statistics of another block layout cannot be used
+  scene_stat_flag = (stat_ptr != nullptr && stat_ptr->nBlkCount == planes[0]->GetBlockCount());
+  if (scene_stat_flag)
+    scene_stat = *stat_ptr;
+
   //::LeaveCriticalSection (&cs);
 
   return (ok_flag);
@@ -126,5 +132,11 @@ bool FakeGroupOfPlanes::Update(const int *array, int data_size)
 
 bool FakeGroupOfPlanes::IsSceneChange(sad_t nThSCD1, int nThSCD2) const
 {
+  if (scene_stat_flag)
+  {
+    const int res = scene_stat.IsSceneChange(nThSCD1, nThSCD2);
+    if (res >= 0)
+      return (res != 0);
+  }
   return planes[0]->IsSceneChange(nThSCD1, nThSCD2);
 }
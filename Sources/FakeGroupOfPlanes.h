@@ -19,6 +19,7 @@
 #define	__MV_FakeGroupOfPlanes__
 
 #include "def.h"
+#include "MVSceneStat.h"
 #include "types.h"
 #include <mutex>
 
@@ -39,6 +40,8 @@ class FakeGroupOfPlanes
 //   const unsigned char *compensatedPlaneV;
   MV_FORCEINLINE static bool GetValidity(const int *array) { return (array[1] == 1); }
   std::mutex cs;
+  MVSceneStat scene_stat; // copy of the vector frame header statistics
+  bool scene_stat_flag;
 
 public :
    FakeGroupOfPlanes();
@@ -47,7 +50,7 @@ public :
     // we need for _xRatioUV, but _yRatioUV is not used
    void Create(int _nBlkSizeX, int _nBlkSizeY, int _nLevelCount, int _nPel, int _nOverlapX, int _nOverlapY, int _xRatioUV, int _yRatioUV, int _nBlkX, int _nBlkY); 
 
-  bool Update(const int *array, int data_size);
+  bool Update(const int *array, int data_size, const MVSceneStat *stat_ptr = nullptr);
   bool IsSceneChange(sad_t nThSCD1, int nThSCD2) const;
 
   MV_FORCEINLINE const FakePlaneOfBlocks& operator[](const int i) const {
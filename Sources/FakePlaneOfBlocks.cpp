@@ -43,7 +43,7 @@ FakePlaneOfBlocks::FakePlaneOfBlocks(int sizeX, int sizeY, int lv, int pel, int
   nLogScale = lv;
   nScale = iexp2(nLogScale);
 
-  blocks = new FakeBlockData [nBlkCount];
+  blocks.resize(nBlkCount);
   for ( int j = 0, blkIdx = 0; j < nBlkY; j++ )
     for ( int i = 0; i < nBlkX; i++, blkIdx++ )
       blocks[blkIdx].Init(i * (nBlkSizeX - nOverlapX), j * (nBlkSizeY - nOverlapY));
@@ -55,8 +55,6 @@ FakePlaneOfBlocks::~FakePlaneOfBlocks()
 {
 //	for ( int i = 0; i < nBlkCount; i++ )
 //		delete blocks[i];
-
-  delete[] blocks;
 }
 
 void FakePlaneOfBlocks::Update(const int *array)
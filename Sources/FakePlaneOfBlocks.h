@@ -21,6 +21,9 @@
 
 
 #include	"FakeBlockData.h"
+#include	"fstb/AllocAlign.h"
+
+#include	<vector>
 
 
 
@@ -41,7 +44,7 @@ class FakePlaneOfBlocks
   int nOverlapX;
   int nOverlapY;
 
-  FakeBlockData *blocks;
+  std::vector <FakeBlockData, fstb::AllocAlign <FakeBlockData> > blocks; // through the allocation hook
 
 public :
 
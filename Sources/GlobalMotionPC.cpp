@@ -0,0 +1,179 @@
+// Global motion estimation by phase correlation (fftw)
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#include "GlobalMotionPC.h"
+#include "DCTFFTW.h"
+
+#include <cassert>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+
+
+GlobalMotionPC::GlobalMotionPC(int width, int height, int pixelsize)
+  : _width(width)
+  , _height(height)
+  , _pixelsize(pixelsize)
+  , _width_c(width / 2 + 1)
+  , _real_ptr(nullptr)
+  , _spec_src_ptr(nullptr)
+  , _spec_ref_ptr(nullptr)
+  , _plan_fwd(nullptr)
+  , _plan_inv(nullptr)
+  , _win_x(width)
+  , _win_y(height)
+{
+  assert(width > 0);
+  assert(height > 0);
+
+  fftfp.load(0); // no existing, load library
+
+  const double pi = 3.14159265358979323846;
+  for (int x = 0; x < _width; x++)
+    _win_x[x] = float(0.5 - 0.5 * cos(2 * pi * (x + 0.5) / _width));
+  for (int y = 0; y < _height; y++)
+    _win_y[y] = float(0.5 - 0.5 * cos(2 * pi * (y + 0.5) / _height));
+
+  // FFTW plan construction and destruction are not thread-safe.
+  std::lock_guard<std::mutex> lock(DCTFFTW::_fftw_mutex);
+
+  _real_ptr = (float *)fftfp.fftwf_malloc(sizeof(float) * _width * _height);
+  _spec_src_ptr = fftfp.fftwf_malloc(sizeof(fftwf_complex) * _width_c * _height);
+  _spec_ref_ptr = fftfp.fftwf_malloc(sizeof(fftwf_complex) * _width_c * _height);
+
+  const int n[2] = { _height, _width };
+  _plan_fwd = fftfp.fftwf_plan_many_dft_r2c(2, n, 1, _real_ptr, nullptr, 1, 0, _spec_src_ptr, nullptr, 1, 0, FFTW_ESTIMATE);
+  _plan_inv = fftfp.fftwf_plan_many_dft_c2r(2, n, 1, _spec_ref_ptr, nullptr, 1, 0, _real_ptr, nullptr, 1, 0, FFTW_ESTIMATE);
+  if (_plan_fwd == nullptr || _plan_inv == nullptr)
+    throw std::runtime_error("cannot create the fftw plans");
+}
+
+
+
+GlobalMotionPC::~GlobalMotionPC()
+{
+  std::lock_guard<std::mutex> lock(DCTFFTW::_fftw_mutex);
+
+  if (_plan_fwd != nullptr)
+    fftfp.fftwf_destroy_plan(_plan_fwd);
+  if (_plan_inv != nullptr)
+    fftfp.fftwf_destroy_plan(_plan_inv);
+  fftfp.fftwf_free(_real_ptr);
+  fftfp.fftwf_free(_spec_src_ptr);
+  fftfp.fftwf_free(_spec_ref_ptr);
+  fftfp.freelib();
+}
+
+
+
+// Mean removed and windowed plane, then its spectrum
+template<typename pixel_t>
+void GlobalMotionPC::load_plane(const uint8_t *src_ptr, int src_pitch, fftwf_complex *spec_ptr)
+{
+  double sum = 0;
+  for (int y = 0; y < _height; y++)
+  {
+    const pixel_t *row_ptr = reinterpret_cast<const pixel_t *>(src_ptr + y * src_pitch);
+    for (int x = 0; x < _width; x++)
+      sum += row_ptr[x];
+  }
+  const float mean = float(sum / (_width * _height));
+
+  for (int y = 0; y < _height; y++)
+  {
+    const pixel_t *row_ptr = reinterpret_cast<const pixel_t *>(src_ptr + y * src_pitch);
+    float *dst_ptr = _real_ptr + y * _width;
+    for (int x = 0; x < _width; x++)
+      dst_ptr[x] = (float(row_ptr[x]) - mean) * _win_x[x] * _win_y[y];
+  }
+
+  fftfp.fftwf_execute_dft_r2c(_plan_fwd, _real_ptr, spec_ptr);
+}
+
+
+
+bool GlobalMotionPC::Estimate(const uint8_t *src_ptr, int src_pitch, const uint8_t *ref_ptr, int ref_pitch, int &dx, int &dy)
+{
+  dx = 0;
+  dy = 0;
+
+  if (_pixelsize == 1)
+  {
+    load_plane<uint8_t>(src_ptr, src_pitch, _spec_src_ptr);
+    load_plane<uint8_t>(ref_ptr, ref_pitch, _spec_ref_ptr);
+  }
+  else if (_pixelsize == 2)
+  {
+    load_plane<uint16_t>(src_ptr, src_pitch, _spec_src_ptr);
+    load_plane<uint16_t>(ref_ptr, ref_pitch, _spec_ref_ptr);
+  }
+  else
+  {
+    load_plane<float>(src_ptr, src_pitch, _spec_src_ptr);
+    load_plane<float>(ref_ptr, ref_pitch, _spec_ref_ptr);
+  }
+
+  // normalized cross-power spectrum: ref * conj(src) / |ref * conj(src)|
+  const int spec_size = _width_c * _height;
+  for (int i = 0; i < spec_size; i++)
+  {
+    const float sr = _spec_src_ptr[i][0];
+    const float si = _spec_src_ptr[i][1];
+    const float rr = _spec_ref_ptr[i][0];
+    const float ri = _spec_ref_ptr[i][1];
+    const float re = rr * sr + ri * si;
+    const float im = ri * sr - rr * si;
+    const float mag = sqrtf(re * re + im * im);
+    const float scale = (mag > 1e-20f) ? 1.0f / mag : 0.0f;
+    _spec_ref_ptr[i][0] = re * scale;
+    _spec_ref_ptr[i][1] = im * scale;
+  }
+
+  // the correlation surface peaks at the shift
+  fftfp.fftwf_execute_dft_c2r(_plan_inv, _spec_ref_ptr, _real_ptr);
+
+  const int size = _width * _height;
+  int peak_pos = 0;
+  float peak = _real_ptr[0];
+  double sum2 = 0;
+  for (int i = 0; i < size; i++)
+  {
+    const float v = _real_ptr[i];
+    sum2 += double(v) * v;
+    if (v > peak)
+    {
+      peak = v;
+      peak_pos = i;
+    }
+  }
+
+  // a single peak well above the noise floor of the surface
+  const double rms = sqrt(sum2 / size);
+  if (!(peak > 6 * rms))
+    return false;
+
+  dx = peak_pos % _width;
+  dy = peak_pos / _width;
+  if (dx > _width / 2)
+    dx -= _width;
+  if (dy > _height / 2)
+    dy -= _height;
+
+  return true;
+}
@@ -0,0 +1,62 @@
+// Global motion estimation by phase correlation (fftw)
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#ifndef __MV_GLOBALMOTIONPC__
+#define __MV_GLOBALMOTIONPC__
+
+#include "fftwlite.h"
+#include <cstdint>
+#include <vector>
+
+// Estimates the dominant translation between two frames with the same
+// method as DePanEstimate. Used by MAnalyse to seed the global predictor
+// of the coarsest level. The library is loaded in the constructor, which
+// throws std::runtime_error when it is not available.
+class GlobalMotionPC
+{
+public:
+  GlobalMotionPC(int width, int height, int pixelsize);
+  ~GlobalMotionPC();
+
+  // Shift (dx, dy) of ref relative to src, in pixels: the content at (x, y)
+  // in src is found at (x + dx, y + dy) in ref, as a motion vector.
+  // Returns false when the correlation peak is too weak to be trusted.
+  bool Estimate(const uint8_t *src_ptr, int src_pitch, const uint8_t *ref_ptr, int ref_pitch, int &dx, int &dy);
+
+private:
+  template<typename pixel_t>
+  void load_plane(const uint8_t *src_ptr, int src_pitch, fftwf_complex *spec_ptr);
+
+  FFTFunctionPointers fftfp;
+
+  const int _width;
+  const int _height;
+  const int _pixelsize;
+  const int _width_c; // number of complex columns: width / 2 + 1
+
+  float *_real_ptr;
+  fftwf_complex *_spec_src_ptr;
+  fftwf_complex *_spec_ref_ptr;
+  fftwf_plan _plan_fwd;
+  fftwf_plan _plan_inv;
+
+  std::vector<float> _win_x; // Hann window, reduces the border effects
+  std::vector<float> _win_y;
+};
+
+#endif
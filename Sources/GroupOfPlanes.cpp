@@ -24,10 +24,13 @@
 #include "profile.h"
 #include "avisynth.h"
 
+#include <string>
+#include <vector>
+
 
 
 GroupOfPlanes::GroupOfPlanes(
-  int _nBlkSizeX, int _nBlkSizeY, int _nLevelCount, int _nPel, int _nFlags,
+  int _nBlkSizeX, int _nBlkSizeY, int _nLevelCount, int _nLevelOffset, int _nPel, int _nFlags,
   int _nOverlapX, int _nOverlapY, int _nBlkX, int _nBlkY, int _xRatioUV, int _yRatioUV,
   int _divideExtra, int _pixelsize, int _bits_per_pixel,
   conc::ObjPool <DCTClass> *dct_pool_ptr,
@@ -37,6 +40,7 @@ GroupOfPlanes::GroupOfPlanes(
   : nBlkSizeX(_nBlkSizeX)
   , nBlkSizeY(_nBlkSizeY)
   , nLevelCount(_nLevelCount)
+  , nLevelOffset(_nLevelOffset)
   , nPel(_nPel)
   , nFlags(_nFlags)
   , nOverlapX(_nOverlapX)
@@ -47,6 +51,8 @@ GroupOfPlanes::GroupOfPlanes(
   , divideExtra(_divideExtra)
   , bits_per_pixel(_bits_per_pixel)
   , _mt_flag(mt_flag)
+  , _glob_seed_flag(false)
+  , _glob_seed()
   , chromaSADScale(_chromaSADScale)
   , _dct_pool_ptr(dct_pool_ptr)
 {
@@ -74,6 +80,14 @@ GroupOfPlanes::GroupOfPlanes(
       mt_flag, chromaSADScale, env);
     nPelCurrent = 1;
   }
+
+  if (divideExtra == 3 && !planes[0]->CanSearchSubBlocks())
+  {
+    env->ThrowError(
+      "MVTools: divide=3: no SAD function for the sub-block size %dx%d",
+      nBlkSizeX / 2, nBlkSizeY / 2
+    );
+  }
 }
 
 
@@ -91,6 +105,32 @@ GroupOfPlanes::~GroupOfPlanes()
 
 
 
+// Searches with the same source frame id share the source block data
+// (multi mode). -1 disables the sharing.
+void	GroupOfPlanes::SetSrcFrameId(int src_frame_id)
+{
+  for (int i = 0; i < nLevelCount; i++)
+  {
+    planes[i]->SetSrcFrameId(src_frame_id);
+  }
+}
+
+
+
+// Global motion predictor of the next SearchMVs() coarsest level, in pixels
+// of this level (phase correlation in MAnalyse). 0: zero or estimated
+// from the vectors as usual.
+void	GroupOfPlanes::SetGlobalMVSeed(const VECTOR *seed_ptr)
+{
+  _glob_seed_flag = (seed_ptr != 0);
+  if (_glob_seed_flag)
+  {
+    _glob_seed = *seed_ptr;
+  }
+}
+
+
+
 void	GroupOfPlanes::SearchMVs(
   MVGroupOfFrames *pSrcGOF,
   MVGroupOfFrames *pRefGOF,
@@ -112,7 +152,9 @@ void	GroupOfPlanes::SearchMVs(
   int    badrange,
   bool   meander,
   int *  vecPrev,
-  bool   tryMany)
+  bool   tryMany,
+  sad_t  skipSAD,
+  bool   adaptive)
 {
   nFlags |= flags;
 
@@ -136,6 +178,11 @@ void	GroupOfPlanes::SearchMVs(
   globalMV.x = zeroMV.x;
   globalMV.y = zeroMV.y;
   globalMV.sad = zeroMV.sad;
+  if (_glob_seed_flag)
+  {
+    globalMV.x = _glob_seed.x;
+    globalMV.y = _glob_seed.y;
+  }
 
   if (!global)
   {
@@ -154,8 +201,8 @@ void	GroupOfPlanes::SearchMVs(
   DebugPrintf("SearchType %i", searchType);
   bool				tryManyLevel = (tryMany && nLevelCount > 1);
   planes[nLevelCount - 1]->SearchMVs(
-    pSrcGOF->GetFrame(nLevelCount - 1),
-    pRefGOF->GetFrame(nLevelCount - 1),
+    pSrcGOF->GetFrame(nLevelOffset + nLevelCount - 1),
+    pRefGOF->GetFrame(nLevelOffset + nLevelCount - 1),
     searchTypeSmallest,
     nSearchParamSmallest,
     nLambda,
@@ -175,7 +222,9 @@ void	GroupOfPlanes::SearchMVs(
     badrange,
     meander,
     vecPrev,
-    tryManyLevel
+    tryManyLevel,
+    skipSAD,
+    adaptive
   );
 
   out += planes[nLevelCount - 1]->GetArraySize(divideExtra);
@@ -202,6 +251,12 @@ void	GroupOfPlanes::SearchMVs(
       planes[i + 1]->EstimateGlobalMVDoubled(&globalMV, slicer_glob);
       //			DebugPrintf("SearchMV globalMV %i, %i", globalMV.x, globalMV.y);
     }
+    else if (_glob_seed_flag)
+    {
+      // the seed is only scaled to the finer levels
+      globalMV.x *= 2;
+      globalMV.y *= 2;
+    }
 
     if (pixelsize == 1) {
       if (planes[i]->GetnBlkSizeX()*planes[i]->GetnBlkSizeY() < 280) // for why 280: see calculation inside InterpolatePrediction
@@ -222,8 +277,8 @@ void	GroupOfPlanes::SearchMVs(
 //		DebugPrintf("SearchMV level %i", i);
     tryManyLevel = (tryMany && i > 0); // not for finest level to not decrease speed
     planes[i]->SearchMVs(
-      pSrcGOF->GetFrame(i),
-      pRefGOF->GetFrame(i),
+      pSrcGOF->GetFrame(nLevelOffset + i),
+      pRefGOF->GetFrame(nLevelOffset + i),
       searchTypeLevel,
       nSearchParamLevel,
       nLambda,
@@ -243,7 +298,9 @@ void	GroupOfPlanes::SearchMVs(
       badrange,
       meander,
       vecPrev,
-      tryManyLevel
+      tryManyLevel,
+      skipSAD,
+      adaptive
     );
 
     out += planes[i]->GetArraySize(divideExtra);
@@ -256,6 +313,80 @@ void	GroupOfPlanes::SearchMVs(
 
 
 
+// Ratio of the static blocks (no search) of the last SearchMVs(), all levels
+double	GroupOfPlanes::GetSkipRatio()
+{
+  int nbr_skip = 0;
+  int nbr_blk = 0;
+  for (int i = 0; i < nLevelCount; i++)
+  {
+    nbr_skip += planes[i]->GetSkipCount();
+    nbr_blk += planes[i]->GetnBlkCount();
+  }
+
+  return (nbr_blk > 0) ? double(nbr_skip) / nbr_blk : 0.0;
+}
+
+
+
+// Search counters of all levels (PlaneOfBlocks::EnableStats)
+void	GroupOfPlanes::EnableStats(bool flag)
+{
+  for (int i = 0; i < nLevelCount; i++)
+  {
+    planes[i]->EnableStats(flag);
+  }
+}
+
+
+
+// The levels share the block size, the finest one has all the kernels
+void	GroupOfPlanes::DescribeKernels(KernelInfo &info) const
+{
+  planes[0]->DescribeKernels(info);
+}
+
+
+
+// Search counters of the last search as frame properties, one array element
+// per level, finest first. Property names are prefix + counter name.
+void	GroupOfPlanes::WriteStatProps(::PVideoFrame &frame, const char *prefix, int nbr_levels, IScriptEnvironment *env) const
+{
+  enum { NBR_INT_PROPS = 3 + PlaneOfBlocks::WIN_NBR_ELT };
+  static const char * const int_name_arr[NBR_INT_PROPS] =
+  {
+    "Blocks", "SADs", "BadCount", "WinZero", "WinGlobal", "WinMedian", "WinTemporal"
+  };
+
+  std::vector <int64_t> int_arr[NBR_INT_PROPS];
+  std::vector <double> plane_sad_arr;
+  std::vector <double> time_arr;
+  for (int i = 0; i < nbr_levels; i++)
+  {
+    const PlaneOfBlocks::SearchStats stats = planes[i]->GetStats();
+    int_arr[0].push_back(stats.nbr_blk);
+    int_arr[1].push_back(stats.nbr_sad);
+    int_arr[2].push_back(stats.nbr_bad);
+    for (int k = 0; k < PlaneOfBlocks::WIN_NBR_ELT; k++)
+    {
+      int_arr[3 + k].push_back(stats.nbr_win[k]);
+    }
+    plane_sad_arr.push_back(double(stats.plane_sad));
+    time_arr.push_back(stats.time_us);
+  }
+
+  AVSMap *props_ptr = env->getFramePropsRW(frame);
+  const std::string prefix_str(prefix);
+  for (int k = 0; k < NBR_INT_PROPS; k++)
+  {
+    env->propSetIntArray(props_ptr, (prefix_str + int_name_arr[k]).c_str(), &int_arr[k][0], nbr_levels);
+  }
+  env->propSetFloatArray(props_ptr, (prefix_str + "PlaneSAD").c_str(), &plane_sad_arr[0], nbr_levels);
+  env->propSetFloatArray(props_ptr, (prefix_str + "TimeUs").c_str(), &time_arr[0], nbr_levels);
+}
+
+
+
 void	GroupOfPlanes::RecalculateMVs(
   MVClip &mvClip,
   MVGroupOfFrames *pSrcGOF,
@@ -382,7 +513,8 @@ void	 GetMedian(int *vx, int *vy, int vx1, int vy1, int vx2, int vy2, int vx3, i
   }
 }
 
-void GroupOfPlanes::ExtraDivide(int *out, int flags)
+// splitSAD: divide=3 only, SAD threshold of the blocks to split
+void GroupOfPlanes::ExtraDivide(int *out, int flags, sad_t splitSAD)
 {
   // skip full size and validity
   out += 2;
@@ -405,6 +537,9 @@ void GroupOfPlanes::ExtraDivide(int *out, int flags)
   out[0] = 0xFFFFFFFF;
   out++; // skip length
 
+  int *          out_beg = out;
+  const int *    inp_beg = inp;
+
   int            nBlkY = planes[0]->GetnBlkY();
   int            nBlkXN = planes[0]->GetnBlkX() * N_PER_BLOCK;	// 6 stored variables
 
@@ -452,7 +587,7 @@ void GroupOfPlanes::ExtraDivide(int *out, int flags)
 
     for (bx = N_PER_BLOCK; bx < nBlkXN - N_PER_BLOCK; bx += N_PER_BLOCK)
     {
-      if (divideExtra == 1)
+      if (divideExtra != 2) // 1, or 3: the blocks which are not split keep their vector
       {
         out[bx * 2] = inp[bx]; // top left subblock
         out[bx * 2 + N_PER_BLOCK] = inp[bx]; // top right subblock
@@ -552,4 +687,71 @@ void GroupOfPlanes::ExtraDivide(int *out, int flags)
       out[bx * 2 + N_PER_BLOCK + nBlkXN * 2 + i] = inp[bx + i] >> 2; // bottom right subblock
     }
   }
+
+  if (divideExtra == 3)
+  {
+    QuadtreeSplit(inp_beg, out_beg, splitSAD);
+  }
+}
+
+
+
+// divide=3: the sub-blocks of the blocks with a SAD above splitSAD are
+// searched on their own, around the vectors of the block, of its neighbours
+// and their median.
+void GroupOfPlanes::QuadtreeSplit(const int *inp, int *out, sad_t splitSAD)
+{
+  const int      nBlkX = planes[0]->GetnBlkX();
+  const int      nBlkY = planes[0]->GetnBlkY();
+  const VECTOR * blk_arr = reinterpret_cast <const VECTOR *> (inp);
+  VECTOR *       sub_arr = reinterpret_cast <VECTOR *> (out);
+
+  for (int by = 0; by < nBlkY; by++)
+  {
+    for (int bx = 0; bx < nBlkX; bx++)
+    {
+      const VECTOR & blk = blk_arr[by * nBlkX + bx];
+      if (blk.sad <= splitSAD)
+      {
+        continue;
+      }
+
+      for (int qy = 0; qy < 2; qy++)
+      {
+        for (int qx = 0; qx < 2; qx++)
+        {
+          VECTOR         cand_arr[4];
+          int            nbr_cand = 0;
+          cand_arr[nbr_cand++] = blk;
+
+          // neighbours on the side of the sub-block
+          const int      nx = bx + qx * 2 - 1;
+          const int      ny = by + qy * 2 - 1;
+          const bool     nx_flag = (nx >= 0 && nx < nBlkX);
+          const bool     ny_flag = (ny >= 0 && ny < nBlkY);
+          if (nx_flag)
+          {
+            cand_arr[nbr_cand++] = blk_arr[by * nBlkX + nx];
+          }
+          if (ny_flag)
+          {
+            cand_arr[nbr_cand++] = blk_arr[ny * nBlkX + bx];
+          }
+          if (nx_flag && ny_flag)
+          {
+            const VECTOR & vh = blk_arr[by * nBlkX + nx];
+            const VECTOR & vv = blk_arr[ny * nBlkX + bx];
+            VECTOR         med;
+            GetMedian(&med.x, &med.y, blk.x, blk.y, vh.x, vh.y, vv.x, vv.y);
+            cand_arr[nbr_cand++] = med;
+          }
+
+          const int      sbx = bx * 2 + qx;
+          const int      sby = by * 2 + qy;
+          sub_arr[sby * nBlkX * 2 + sbx] =
+            planes[0]->SearchSubBlock(sbx, sby, cand_arr, nbr_cand);
+        }
+      }
+    }
+  }
 }
@@ -31,6 +31,7 @@ class GroupOfPlanes
   int            nBlkSizeX;
   int            nBlkSizeY;
   int            nLevelCount;
+  int            nLevelOffset; // super clip level of the finest searched level
   int            nPel;
   int            nFlags;
   int            nOverlapX;
@@ -42,15 +43,19 @@ class GroupOfPlanes
     int bits_per_pixel;
   int            divideExtra;
   bool           _mt_flag;
+  bool           _glob_seed_flag; // the coarsest global predictor is given
+  VECTOR         _glob_seed;
 
   conc::ObjPool <DCTClass> *
                  _dct_pool_ptr;
   PlaneOfBlocks **
                  planes;
 
+  void           QuadtreeSplit (const int *inp, int *out, sad_t splitSAD);
+
 public :
   GroupOfPlanes(
-    int _nBlkSizeX, int _nBlkSizeY, int _nLevelCount, int _nPel, int _nFlags,
+    int _nBlkSizeX, int _nBlkSizeY, int _nLevelCount, int _nLevelOffset, int _nPel, int _nFlags,
     int _nOverlapX, int _nOverlapY, int _nBlkX, int _nBlkY, int _xRatioUV, int _yRatioUV, int _divideExtra, int _pixelsize, int _bits_per_pixel, 
     conc::ObjPool <DCTClass> *dct_pool_ptr,
     bool mt_flag, int _chromaSADScale,
@@ -61,15 +66,23 @@ public :
     SearchType searchType, int nSearchParam, int _PelSearch, int _nLambda,
     sad_t _lsad, int _pnew, int _plevel, bool _global, int flags, int *out,
     short * outfilebuf, int fieldShift, int _pzero, int _pglobal, sad_t badSAD,
-    int badrange, bool meander, int *vecPrev, bool tryMany);
+    int badrange, bool meander, int *vecPrev, bool tryMany, sad_t skipSAD,
+    bool adaptive);
+  double         GetSkipRatio ();
+  void           EnableStats (bool flag);
+  void           DescribeKernels (KernelInfo &info) const;
+  void           WriteStatProps (::PVideoFrame &frame, const char *prefix, int nbr_levels, IScriptEnvironment *env) const;
+  int            GetLevelCount () const { return nLevelCount; }
   void           WriteDefaultToArray (int *array);
   int            GetArraySize ();
-  void           ExtraDivide (int *out, int flags);
+  void           ExtraDivide (int *out, int flags, sad_t splitSAD);
   void           RecalculateMVs (
     MVClip &mvClip, MVGroupOfFrames *pSrcGOF, MVGroupOfFrames *pRefGOF,
     SearchType _searchType, int _nSearchParam, int _nLambda, sad_t _lsad,
     int _pnew, int flags, int *out, short * outfilebuf, int fieldShift,
     sad_t thSAD, int smooth, bool meander);
+  void           SetSrcFrameId (int src_frame_id);
+  void           SetGlobalMVSeed (const VECTOR *seed_ptr);
 };
 
 #endif
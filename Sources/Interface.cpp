@@ -47,10 +47,13 @@
 
 // Test & helpers filters
 #include "Padding.h"
+#include "KernelInfo.h"
+#include "MemInfo.h"
 #include "MVFinest.h"
 #include "MRestoreVect.h"
 #include "MScaleVect.h"
 #include "MStoreVect.h"
+#include "MTTrace.h"
 
 #include <avisynth.h>
 #include <stdint.h>
@@ -70,6 +73,7 @@ AVSValue __cdecl Create_Padding(AVSValue args, void* user_data, IScriptEnvironme
 
 AVSValue __cdecl Create_MVShow(AVSValue args, void* user_data, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope; // The allocations of the filter created here are charged to it
   int sc = 1;
   int sil = 0;
   int tol = 20000;
@@ -91,6 +95,7 @@ AVSValue __cdecl Create_MVShow(AVSValue args, void* user_data, IScriptEnvironmen
 
 AVSValue __cdecl Create_MVCompensate(AVSValue args, void* user_data, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   const sad_t thsad = args[5].AsInt(10000);   // thSAD
 
   return new MVCompensate(
@@ -117,6 +122,7 @@ AVSValue __cdecl Create_MVCompensate(AVSValue args, void* user_data, IScriptEnvi
 
 AVSValue __cdecl Create_MVSCDetection(AVSValue args, void* user_data, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   return new MVSCDetection(
     args[0].AsClip(),
     args[1].AsClip(),
@@ -130,6 +136,7 @@ AVSValue __cdecl Create_MVSCDetection(AVSValue args, void* user_data, IScriptEnv
 
 AVSValue __cdecl Create_MVAnalyse(AVSValue args, void* user_data, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   int blksize = args[1].AsInt(8);       // block size horizontal
   int blksizeV = args[2].AsInt(blksize); // block size vertical
 
@@ -191,12 +198,20 @@ AVSValue __cdecl Create_MVAnalyse(AVSValue args, void* user_data, IScriptEnviron
     args[30].AsBool(false),  // multi
     args[31].AsBool(true),   // mt
     args[32].AsInt(0),   // scaleCSAD
+    args[33].AsBool(false),  // fprop: vectors as frame property
+    args[34].AsBool(false),  // sadcache: tile SAD cache for overlapped blocks
+    args[35].AsInt(0),       // skipsad: SAD threshold of static blocks
+    args[36].AsBool(false),  // adaptive: search range of each block from its predictor quality
+    args[37].AsBool(false),  // phasecorr: phase correlation global motion seeds the coarsest level
+    args[38].AsInt(1),       // analysis_scale: search on a reduced super clip level, full size vectors
+    args[39].AsBool(false),  // stats: search counters per level as frame properties
     env
   );
 }
 
 AVSValue __cdecl Create_MVMask(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   double ml = args[2].AsFloat(100);
   if (ml <= 0)
     env->ThrowError("MVMask: ML must be > 0.0");
@@ -220,6 +235,7 @@ AVSValue __cdecl Create_MVMask(AVSValue args, void*, IScriptEnvironment* env)
 
 AVSValue __cdecl Create_MVDepan(AVSValue args, void*, IScriptEnvironment* env) // Added by Fizick
 {
+  MemInfo::Scope mem_scope;
   return new MVDepan(
     args[0].AsClip(),
     args[1].AsClip(),
@@ -244,6 +260,7 @@ AVSValue __cdecl Create_MVDepan(AVSValue args, void*, IScriptEnvironment* env) /
 
 AVSValue __cdecl Create_MVFlow(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   double time = args[3].AsFloat(100.0);
   if (time < 0 || time>100)
   {
@@ -268,6 +285,7 @@ AVSValue __cdecl Create_MVFlow(AVSValue args, void*, IScriptEnvironment* env)
 
 AVSValue __cdecl Create_MVFlowInter(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   double time = args[4].AsFloat(50.0);
   if (time < 0 || time>100)
   {
@@ -296,6 +314,7 @@ AVSValue __cdecl Create_MVFlowInter(AVSValue args, void*, IScriptEnvironment* en
 
 AVSValue __cdecl Create_MVFlowFps(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   double ml = args[7].AsFloat(100);
   if (ml <= 0)
   {
@@ -322,6 +341,7 @@ AVSValue __cdecl Create_MVFlowFps(AVSValue args, void*, IScriptEnvironment* env)
 
 AVSValue __cdecl Create_MVFlowBlur(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   double time = args[4].AsFloat(50.0);
   if (time < 0 || time>200)
   {
@@ -345,6 +365,7 @@ AVSValue __cdecl Create_MVFlowBlur(AVSValue args, void*, IScriptEnvironment* env
 
 AVSValue __cdecl Create_MVDegrainX(AVSValue args, void* user_data, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   int level = (int)(intptr_t)user_data;
 
   int plane_param_index = 6; // base: MDegrain1
@@ -421,6 +442,7 @@ AVSValue __cdecl Create_MVDegrainX(AVSValue args, void* user_data, IScriptEnviro
 
 AVSValue __cdecl Create_MDegrainN(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   int plane = args[6].AsInt(4);
   int YUVplanes;
 
@@ -518,6 +540,7 @@ AVSValue __cdecl Create_MDegrainN(AVSValue args, void*, IScriptEnvironment* env)
 
 AVSValue __cdecl Create_MVRecalculate(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   int blksize = args[4].AsInt(8);       // block size horizontal
   int blksizeV = args[5].AsInt(blksize); // block size vertical
 
@@ -560,12 +583,14 @@ AVSValue __cdecl Create_MVRecalculate(AVSValue args, void*, IScriptEnvironment*
     args[20].AsInt(0),       // tr
     args[21].AsBool(true),   // mt
     args[22].AsInt(0), // scaleCSAD
+    args[23].AsBool(false),  // stats: search counters as frame properties
     env
   );
 }
 
 AVSValue __cdecl Create_MVBlockFps(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   return new MVBlockFps(
     args[0].AsClip(),       // src
     args[1].AsClip(),       // super
@@ -587,6 +612,7 @@ AVSValue __cdecl Create_MVBlockFps(AVSValue args, void*, IScriptEnvironment* env
 
 AVSValue __cdecl Create_MVSuper(AVSValue args, void*, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope;
   return new MVSuper(
     args[0].AsClip(),      // source
     args[1].AsInt(8),      // hpad
@@ -600,6 +626,8 @@ AVSValue __cdecl Create_MVSuper(AVSValue args, void*, IScriptEnvironment* env)
     args[9].AsBool(true),   // isse2
     args[10].AsBool(false), // planar
     args[11].AsBool(true), // mt
+    args[12].AsBool(false), // ondemand: sub-pixel planes are interpolated by the clients
+    args[13].AsBool(false), // virtualpad: padding is not stored, the clients clamp the blocks
     env
   );
 }
@@ -659,6 +687,37 @@ AVSValue __cdecl Create_MScaleVect(AVSValue args, void*, IScriptEnvironment* env
     env);
 }
 
+static void __cdecl Write_MTrace(void*, IScriptEnvironment*)
+{
+  MTTrace::use_instance().write();
+}
+
+// Starts the recording of the multithreaded tasks, written to the file
+// when the script environment is closed
+AVSValue __cdecl Create_MTrace(AVSValue args, void*, IScriptEnvironment* env)
+{
+  const char *filename = args[0].AsString("");
+  if (filename[0] == '\0')
+    env->ThrowError("MTrace: file name is empty");
+  MTTrace::use_instance().start(filename);
+  env->AtExit(Write_MTrace, 0);
+  return AVSValue();
+}
+
+// Kernels selected by the live filter instances, all or of one filter type
+AVSValue __cdecl Create_MToolsInfo(AVSValue args, void*, IScriptEnvironment* env)
+{
+  const std::string text = KernelInfo::Report(args[0].AsString(""));
+  return env->SaveString(text.c_str());
+}
+
+// Memory allocated by the live filter instances, all or of one filter type
+AVSValue __cdecl Create_MToolsMemory(AVSValue args, void*, IScriptEnvironment* env)
+{
+  const std::string text = MemInfo::Report(args[0].AsString(""));
+  return env->SaveString(text.c_str());
+}
+
 
 #ifdef AVISYNTH_PLUGIN_25
 extern "C" __declspec(dllexport) const char* __stdcall AvisynthPluginInit2(IScriptEnvironment* env) {
@@ -677,7 +736,7 @@ AvisynthPluginInit3(IScriptEnvironment* env, const AVS_Linkage* const vectors) {
   AVS_linkage = vectors;
 #endif
   env->AddFunction("MShow", "cc[scale]i[sil]i[tol]i[showsad]b[number]i[thSCD1]i[thSCD2]i[isse]b[planar]b", Create_MVShow, 0);
-  env->AddFunction("MAnalyse", "c[blksize]i[blksizeV]i[levels]i[search]i[searchparam]i[pelsearch]i[isb]b[lambda]i[chroma]b[delta]i[truemotion]b[lsad]i[plevel]i[global]b[pnew]i[pzero]i[pglobal]i[overlap]i[overlapV]i[outfile]s[dct]i[divide]i[sadx264]i[badSAD]i[badrange]i[isse]b[meander]b[temporal]b[trymany]b[multi]b[mt]b[scaleCSAD]i", Create_MVAnalyse, 0);
+  env->AddFunction("MAnalyse", "c[blksize]i[blksizeV]i[levels]i[search]i[searchparam]i[pelsearch]i[isb]b[lambda]i[chroma]b[delta]i[truemotion]b[lsad]i[plevel]i[global]b[pnew]i[pzero]i[pglobal]i[overlap]i[overlapV]i[outfile]s[dct]i[divide]i[sadx264]i[badSAD]i[badrange]i[isse]b[meander]b[temporal]b[trymany]b[multi]b[mt]b[scaleCSAD]i[fprop]b[sadcache]b[skipsad]i[adaptive]b[phasecorr]b[analysis_scale]i[stats]b", Create_MVAnalyse, 0);
   env->AddFunction("MMask", "cc[ml]f[gamma]f[kind]i[time]f[Ysc]i[thSCD1]i[thSCD2]i[isse]b[planar]b", Create_MVMask, 0);
   env->AddFunction("MCompensate", "ccc[scbehavior]b[recursion]f[thSAD]i[fields]b[time]f[thSCD1]i[thSCD2]i[isse]b[planar]b[mt]b[tr]i[center]b[cclip]c[thSAD2]i", Create_MVCompensate, 0);
   env->AddFunction("MSCDetection", "cc[Ysc]i[thSCD1]i[thSCD2]i[isse]b", Create_MVSCDetection, 0);
@@ -693,12 +752,16 @@ AvisynthPluginInit3(IScriptEnvironment* env, const AVS_Linkage* const vectors) {
   env->AddFunction("MDegrain5", "cccccccccccc[thSAD]i[thSADC]i[plane]i[limit]f[limitC]f[thSCD1]i[thSCD2]i[isse]b[planar]b[lsb]b[mt]b[out16]b[out32]b", Create_MVDegrainX, (void *)5);
   env->AddFunction("MDegrain6", "cccccccccccccc[thSAD]i[thSADC]i[plane]i[limit]f[limitC]f[thSCD1]i[thSCD2]i[isse]b[planar]b[lsb]b[mt]b[out16]b[out32]b", Create_MVDegrainX, (void *)6);
   env->AddFunction("MDegrainN", "ccci[thSAD]i[thSADC]i[plane]i[limit]f[limitC]f[thSCD1]i[thSCD2]i[isse]b[planar]b[lsb]b[thsad2]i[thsadc2]i[mt]b[out16]b", Create_MDegrainN, 0);
-  env->AddFunction("MRecalculate", "cc[thsad]i[smooth]i[blksize]i[blksizeV]i[search]i[searchparam]i[lambda]i[chroma]b[truemotion]b[pnew]i[overlap]i[overlapV]i[outfile]s[dct]i[divide]i[sadx264]i[isse]b[meander]b[tr]i[mt]b[scaleCSAD]i", Create_MVRecalculate, 0);
+  env->AddFunction("MRecalculate", "cc[thsad]i[smooth]i[blksize]i[blksizeV]i[search]i[searchparam]i[lambda]i[chroma]b[truemotion]b[pnew]i[overlap]i[overlapV]i[outfile]s[dct]i[divide]i[sadx264]i[isse]b[meander]b[tr]i[mt]b[scaleCSAD]i[stats]b", Create_MVRecalculate, 0);
   env->AddFunction("MBlockFps", "cccc[num]i[den]i[mode]i[ml]f[blend]b[thSCD1]i[thSCD2]i[isse]b[planar]b[mt]b", Create_MVBlockFps, 0);
-  env->AddFunction("MSuper", "c[hpad]i[vpad]i[pel]i[levels]i[chroma]b[sharp]i[rfilter]i[pelclip]c[isse]b[planar]b[mt]b", Create_MVSuper, 0);
+  env->AddFunction("MSuper", "c[hpad]i[vpad]i[pel]i[levels]i[chroma]b[sharp]i[rfilter]i[pelclip]c[isse]b[planar]b[mt]b[ondemand]b[virtualpad]b", Create_MVSuper, 0);
   env->AddFunction("MStoreVect", "c+[vccs]s", Create_MStoreVect, 0);
   env->AddFunction("MRestoreVect", "c[index]i", Create_MRestoreVect, 0);
   env->AddFunction("MScaleVect", "c[scale]f[scaleV]f[mode]i[flip]b[adjustSubPel]b[bits]i", Create_MScaleVect, 0);
+  env->AddFunction("MTrace", "s", Create_MTrace, 0);
+  env->AddFunction("MToolsInfo", "[filter]s", Create_MToolsInfo, 0);
+  env->AddFunction("MToolsMemory", "[filter]s", Create_MToolsMemory, 0);
+  MTTrace::use_instance(); // MVTOOLS_TRACE
   //	env->AddFunction("MVFinest",     "c[isse]b", Create_MVFinest, 0);
   return("MVTools : set of tools based on a motion estimation engine");
 }
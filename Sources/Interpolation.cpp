@@ -174,7 +174,7 @@ void RB2F_sse2(
         if constexpr (hasSSE41)
           res = _mm_packus_epi32(res, res);
         else
-          m2 = _MM_PACKUS_EPI32(res, res);
+          res = _MM_PACKUS_EPI32(res, res);
       }
       _mm_storel_epi64((__m128i*) & pDst[x], res);
     }
@@ -1956,7 +1956,7 @@ void VerticalWiener_sse2(unsigned char *pDst8, const unsigned char *pSrc8, int n
   auto zeroes = _mm_setzero_si128();
 
   for (int y = 0; y < 2; y++) {
-    for (int x = 0; x < nWidth * (int)sizeof(pixel_t); x += 16 / sizeof(pixel_t)) {
+    for (int x = 0; x < nWidth; x += 16 / sizeof(pixel_t)) {
       __m128i m0 = _mm_loadu_si128((const __m128i *)&pSrc[x]);
       __m128i m1 = _mm_loadu_si128((const __m128i *)&pSrc[x + nSrcPitch]);
 
@@ -2045,7 +2045,7 @@ void VerticalWiener_sse2(unsigned char *pDst8, const unsigned char *pSrc8, int n
   }
 
   for (int y = nHeight - 4; y < nHeight - 1; y++) {
-    for (int x = 0; x < nWidth * (int)sizeof(pixel_t); x += 16 / sizeof(pixel_t)) {
+    for (int x = 0; x < nWidth; x += 16 / sizeof(pixel_t)) {
       __m128i m0 = _mm_loadu_si128((const __m128i *)&pSrc[x]);
       __m128i m1 = _mm_loadu_si128((const __m128i *)&pSrc[x + nSrcPitch]);
 
@@ -2366,7 +2366,7 @@ void VerticalBicubic_sse2(unsigned char* pDst8, const unsigned char* pSrc8, int
   auto zeroes = _mm_setzero_si128();
 
   for (int y = 0; y < 1; y++) {
-    for (int x = 0; x < nWidth * (int)sizeof(pixel_t); x += 16 / sizeof(pixel_t)) {
+    for (int x = 0; x < nWidth; x += 16 / sizeof(pixel_t)) {
       __m128i m0 = _mm_loadu_si128((const __m128i*) & pSrc[x]);
       __m128i m1 = _mm_loadu_si128((const __m128i*) & pSrc[x + nSrcPitch]);
 
@@ -2444,7 +2444,7 @@ void VerticalBicubic_sse2(unsigned char* pDst8, const unsigned char* pSrc8, int
   }
 
   for (int y = nHeight - 3; y < nHeight - 1; y++) {
-    for (int x = 0; x < nWidth * (int)sizeof(pixel_t); x += 16 / sizeof(pixel_t)) {
+    for (int x = 0; x < nWidth; x += 16 / sizeof(pixel_t)) {
       __m128i m0 = _mm_loadu_si128((const __m128i*) & pSrc[x]);
       __m128i m1 = _mm_loadu_si128((const __m128i*) & pSrc[x + nSrcPitch]);
 
@@ -0,0 +1,212 @@
+// Kernel implementations selected by the filter instances
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "KernelInfo.h"
+
+#include <avisynth.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+const arch_t KernelInfo::_tier_arr[NBR_TIERS] = { NO_SIMD, USE_SSE2, USE_SSE41, USE_AVX, USE_AVX2 };
+
+std::mutex KernelInfo::_mtx;
+std::vector<const KernelInfo *> KernelInfo::_instances;
+
+
+
+// Instances are numbered per filter, from 1, in creation order
+KernelInfo::KernelInfo(const std::string &filter_name)
+{
+  static std::map<std::string, int> counters;
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  const int index = ++counters[filter_name];
+  _name = filter_name + " #" + std::to_string(index);
+  _instances.push_back(this);
+}
+
+
+
+KernelInfo::~KernelInfo()
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+  _instances.erase(std::remove(_instances.begin(), _instances.end(), this), _instances.end());
+}
+
+
+
+void KernelInfo::Add(const char *kernel, const std::string &config, const char *impl, const std::string &reason)
+{
+  Entry entry;
+  entry.kernel = kernel;
+  entry.config = config;
+  entry.impl = impl;
+  entry.reason = reason;
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  _entries.push_back(entry);
+}
+
+
+
+void KernelInfo::Publish() const
+{
+  const char *log_0 = getenv("MVTOOLS_KERNEL_LOG");
+  if (log_0 == nullptr || log_0[0] == '\0')
+    return;
+
+  std::string text;
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    text = Describe();
+  }
+
+  const bool stderr_flag = (strcmp(log_0, "stderr") == 0 || strcmp(log_0, "-") == 0);
+  FILE *f_ptr = stderr_flag ? stderr : fopen(log_0, "a");
+  if (f_ptr == nullptr)
+    return;
+  fputs(text.c_str(), f_ptr);
+  if (stderr_flag)
+    fflush(f_ptr);
+  else
+    fclose(f_ptr);
+}
+
+
+
+std::string KernelInfo::Report(const std::string &filter_name)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  std::string text;
+  for (const KernelInfo *info_ptr : _instances)
+  {
+    const std::string &name = info_ptr->_name;
+    if (filter_name.empty()
+      || (name.compare(0, filter_name.size(), filter_name) == 0
+        && name.compare(filter_name.size(), 2, " #") == 0))
+    {
+      text += info_ptr->Describe();
+    }
+  }
+
+  return text;
+}
+
+
+
+arch_t KernelInfo::GetArch(int cpu_flags)
+{
+  if ((cpu_flags & CPUF_AVX2) != 0)
+    return USE_AVX2;
+  if ((cpu_flags & CPUF_AVX) != 0)
+    return USE_AVX;
+  if ((cpu_flags & CPUF_SSE4_1) != 0)
+    return USE_SSE41;
+  if ((cpu_flags & CPUF_SSE2) != 0)
+    return USE_SSE2;
+  return NO_SIMD;
+}
+
+
+
+const char *KernelInfo::GetArchName(arch_t arch)
+{
+  switch (arch)
+  {
+  case NO_SIMD: return "C";
+  case USE_MMX: return "MMX";
+  case USE_SSE2: return "SSE2";
+  case USE_SSE41: return "SSE4.1";
+  case USE_SSE42: return "SSE4.2";
+  case USE_AVX: return "AVX";
+  case USE_AVX2: return "AVX2";
+  }
+  return "?";
+}
+
+
+
+std::string KernelInfo::Config(int blksizex, int blksizey, int bits_per_pixel)
+{
+  char txt_0[64];
+  if (bits_per_pixel == 32)
+    snprintf(txt_0, sizeof(txt_0), "%dx%d float", blksizex, blksizey);
+  else
+    snprintf(txt_0, sizeof(txt_0), "%dx%d %d-bit", blksizex, blksizey, bits_per_pixel);
+  return txt_0;
+}
+
+
+
+// sel: index of the selected tier, -1 if none. next: index of the next
+// tier having another kernel, NBR_TIERS if none.
+void KernelInfo::AddTier(const char *kernel, const std::string &config, int sel, int next, arch_t arch_cpu,
+  const char *no_simd_reason)
+{
+  std::string reason;
+  if (next < NBR_TIERS)
+  {
+    const arch_t faster = _tier_arr[next];
+    reason = std::string(GetArchName(faster)) + " kernel not used: "
+      + ((faster > arch_cpu) ? "not supported by the CPU" : "asm disabled (isse=false)");
+  }
+  else if (sel < 0)
+  {
+    reason = "no kernel for " + config;
+  }
+  else if (_tier_arr[sel] < arch_cpu)
+  {
+    if (_tier_arr[sel] == NO_SIMD && no_simd_reason != nullptr)
+      reason = no_simd_reason;
+    else
+      reason = std::string("no ") + GetArchName(_tier_arr[sel + 1]) + " or faster kernel for " + config;
+  }
+
+  Add(kernel, config, (sel < 0) ? "none" : GetArchName(_tier_arr[sel]), reason);
+}
+
+
+
+std::string KernelInfo::Describe() const
+{
+  std::string text = _name + "\n";
+  for (const Entry &entry : _entries)
+  {
+    char txt_0[256];
+    snprintf(txt_0, sizeof(txt_0), "  %-16s %-16s %-7s",
+      entry.kernel.c_str(), entry.config.c_str(), entry.impl.c_str());
+    std::string line = txt_0;
+    if (!entry.reason.empty())
+      line += " " + entry.reason;
+    else
+    {
+      while (!line.empty() && line.back() == ' ')
+        line.pop_back();
+    }
+    text += line + "\n";
+  }
+
+  return text;
+}
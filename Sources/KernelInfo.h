@@ -0,0 +1,116 @@
+// Kernel implementations selected by the filter instances
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#ifndef __MV_KernelInfo__
+#define __MV_KernelInfo__
+
+#include "types.h"
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Per filter instance: the implementation tier of each kernel and, when a
+// faster tier exists or the CPU could run one, why it was not used.
+// The live instances are listed by MToolsInfo(). With the MVTOOLS_KERNEL_LOG
+// environment variable set to a file name (or "stderr"), each instance is
+// also logged once its kernels are selected.
+class KernelInfo
+{
+public:
+
+  explicit KernelInfo(const std::string &filter_name);
+  ~KernelInfo();
+
+  // Kernel from a function table. getter(a) returns the kernel for the
+  // highest tier up to a, or nullptr. arch is the tier allowed for the
+  // instance, arch_cpu the one of the CPU (they differ with isse=false).
+  // no_simd_reason explains a C-only kernel, when the reason is known.
+  template <class G>
+  void Add(const char *kernel, const std::string &config, arch_t arch, arch_t arch_cpu,
+    G getter, const char *no_simd_reason = nullptr);
+
+  // Kernel selected without a function table
+  void Add(const char *kernel, const std::string &config, const char *impl, const std::string &reason);
+
+  // All the kernels are added: logs the instance if requested
+  void Publish() const;
+
+  // Description of the live instances, of all the filters or only of
+  // filter_name when not empty
+  static std::string Report(const std::string &filter_name);
+
+  // Highest tier for the Avisynth CPUF_ flags
+  static arch_t GetArch(int cpu_flags);
+  static const char *GetArchName(arch_t arch);
+
+  // "16x16 8-bit"
+  static std::string Config(int blksizex, int blksizey, int bits_per_pixel);
+
+private:
+
+  struct Entry
+  {
+    std::string kernel;
+    std::string config;
+    std::string impl;
+    std::string reason;
+  };
+
+  enum { NBR_TIERS = 5 };
+  static const arch_t _tier_arr[NBR_TIERS]; // increasing
+
+  void AddTier(const char *kernel, const std::string &config, int sel, int next, arch_t arch_cpu,
+    const char *no_simd_reason);
+  std::string Describe() const;
+
+  KernelInfo(const KernelInfo &other) = delete;
+  KernelInfo &operator = (const KernelInfo &other) = delete;
+
+  std::string _name; // "MAnalyse #2"
+  std::vector<Entry> _entries;
+
+  static std::mutex _mtx; // instance list and entries
+  static std::vector<const KernelInfo *> _instances;
+};
+
+
+
+template <class G>
+void KernelInfo::Add(const char *kernel, const std::string &config, arch_t arch, arch_t arch_cpu,
+  G getter, const char *no_simd_reason)
+{
+  // The tables fall back to the lower tiers: the selected tier is the
+  // lowest one giving the same kernel, the next faster one gives another.
+  // sel is -1 when there is no kernel up to arch.
+  const auto fnc = getter(arch);
+  int sel = -1;
+  if (fnc != nullptr)
+  {
+    sel = 0;
+    while (sel < NBR_TIERS - 1 && _tier_arr[sel] < arch && getter(_tier_arr[sel]) != fnc)
+      ++sel;
+  }
+  int next = sel + 1;
+  while (next < NBR_TIERS && getter(_tier_arr[next]) == fnc)
+    ++next;
+
+  AddTier(kernel, config, sel, next, arch_cpu, no_simd_reason);
+}
+
+#endif // __MV_KernelInfo__
@@ -367,8 +367,6 @@ MDegrainN::DenoiseNFunction* MDegrainN::get_denoiseN_function(int BlockX, int Bl
   const int DEGRAIN_TYPE_10to14BIT = 8;
   const int DEGRAIN_TYPE_16BIT = 16;
   const int DEGRAIN_TYPE_32BIT = 32;
-  // BlkSizeX, BlkSizeY, degrain_type, arch_t
-  std::map<std::tuple<int, int, int, arch_t>, DenoiseNFunction*> func_degrain;
   using std::make_tuple;
 
   int type_to_search;
@@ -390,7 +388,10 @@ MDegrainN::DenoiseNFunction* MDegrainN::get_denoiseN_function(int BlockX, int Bl
     return nullptr;
 
 
-  // 8bit C, 8bit lsb C, 8bit out16 C, 10-16 bit C, float C (same for all, no blocksize templates)
+  // BlkSizeX, BlkSizeY, degrain_type, arch_t
+  static const std::map<std::tuple<int, int, int, arch_t>, DenoiseNFunction*> func_degrain_table = [&]() {
+    std::map<std::tuple<int, int, int, arch_t>, DenoiseNFunction*> func_degrain;
+    // 8bit C, 8bit lsb C, 8bit out16 C, 10-16 bit C, float C (same for all, no blocksize templates)
 #define MAKE_FN(x, y) \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT, NO_SIMD)] = DegrainN_C<uint8_t, x, y, 0>; \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT_STACKED, NO_SIMD)] = DegrainN_C<uint8_t, x, y, 1>; \
@@ -398,61 +399,61 @@ func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT_OUT16, NO_SIMD)] = DegrainN_C<ui
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_10to14BIT, NO_SIMD)] = DegrainN_C<uint16_t, x, y, 0>; \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_16BIT, NO_SIMD)] = DegrainN_C<uint16_t, x, y, 0>; \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_32BIT, NO_SIMD)] = DegrainN_C<float, x, y, 0>;
-    MAKE_FN(64, 64)
-    MAKE_FN(64, 48)
-    MAKE_FN(64, 32)
-    MAKE_FN(64, 16)
-    MAKE_FN(48, 64)
-    MAKE_FN(48, 48)
-    MAKE_FN(48, 24)
-    MAKE_FN(48, 12)
-    MAKE_FN(32, 64)
-    MAKE_FN(32, 32)
-    MAKE_FN(32, 24)
-    MAKE_FN(32, 16)
-    MAKE_FN(32, 8)
-    MAKE_FN(24, 48)
-    MAKE_FN(24, 32)
-    MAKE_FN(24, 24)
-    MAKE_FN(24, 12)
-    MAKE_FN(24, 6)
-    MAKE_FN(16, 64)
-    MAKE_FN(16, 32)
-    MAKE_FN(16, 16)
-    MAKE_FN(16, 12)
-    MAKE_FN(16, 8)
-    MAKE_FN(16, 4)
-    MAKE_FN(16, 2)
-    MAKE_FN(16, 1)
-    MAKE_FN(12, 48)
-    MAKE_FN(12, 24)
-    MAKE_FN(12, 16)
-    MAKE_FN(12, 12)
-    MAKE_FN(12, 6)
-    MAKE_FN(12, 3)
-    MAKE_FN(8, 32)
-    MAKE_FN(8, 16)
-    MAKE_FN(8, 8)
-    MAKE_FN(8, 4)
-    MAKE_FN(8, 2)
-    MAKE_FN(8, 1)
-    MAKE_FN(6, 24)
-    MAKE_FN(6, 12)
-    MAKE_FN(6, 6)
-    MAKE_FN(6, 3)
-    MAKE_FN(4, 8)
-    MAKE_FN(4, 4)
-    MAKE_FN(4, 2)
-    MAKE_FN(4, 1)
-    MAKE_FN(3, 6)
-    MAKE_FN(3, 3)
-    MAKE_FN(2, 4)
-    MAKE_FN(2, 2)
-    MAKE_FN(2, 1)
+      MAKE_FN(64, 64)
+      MAKE_FN(64, 48)
+      MAKE_FN(64, 32)
+      MAKE_FN(64, 16)
+      MAKE_FN(48, 64)
+      MAKE_FN(48, 48)
+      MAKE_FN(48, 24)
+      MAKE_FN(48, 12)
+      MAKE_FN(32, 64)
+      MAKE_FN(32, 32)
+      MAKE_FN(32, 24)
+      MAKE_FN(32, 16)
+      MAKE_FN(32, 8)
+      MAKE_FN(24, 48)
+      MAKE_FN(24, 32)
+      MAKE_FN(24, 24)
+      MAKE_FN(24, 12)
+      MAKE_FN(24, 6)
+      MAKE_FN(16, 64)
+      MAKE_FN(16, 32)
+      MAKE_FN(16, 16)
+      MAKE_FN(16, 12)
+      MAKE_FN(16, 8)
+      MAKE_FN(16, 4)
+      MAKE_FN(16, 2)
+      MAKE_FN(16, 1)
+      MAKE_FN(12, 48)
+      MAKE_FN(12, 24)
+      MAKE_FN(12, 16)
+      MAKE_FN(12, 12)
+      MAKE_FN(12, 6)
+      MAKE_FN(12, 3)
+      MAKE_FN(8, 32)
+      MAKE_FN(8, 16)
+      MAKE_FN(8, 8)
+      MAKE_FN(8, 4)
+      MAKE_FN(8, 2)
+      MAKE_FN(8, 1)
+      MAKE_FN(6, 24)
+      MAKE_FN(6, 12)
+      MAKE_FN(6, 6)
+      MAKE_FN(6, 3)
+      MAKE_FN(4, 8)
+      MAKE_FN(4, 4)
+      MAKE_FN(4, 2)
+      MAKE_FN(4, 1)
+      MAKE_FN(3, 6)
+      MAKE_FN(3, 3)
+      MAKE_FN(2, 4)
+      MAKE_FN(2, 2)
+      MAKE_FN(2, 1)
 #undef MAKE_FN
 #undef MAKE_FN_LEVEL
 
-      // and the SSE2 versions for 8 bit
+        // and the SSE2 versions for 8 bit
 #define MAKE_FN(x, y) \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT, USE_SSE2)] = DegrainN_sse2<x, y, 0>; \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT_STACKED, USE_SSE2)] = DegrainN_sse2<x, y, 1>; \
@@ -460,59 +461,61 @@ func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT_OUT16, USE_SSE2)] = DegrainN_sse
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_10to14BIT, USE_SSE41)] = DegrainN_16_sse41<x, y, true>; \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_16BIT, USE_SSE41)] = DegrainN_16_sse41<x, y, false>;
 
-  MAKE_FN(64, 64)
-    MAKE_FN(64, 48)
-    MAKE_FN(64, 32)
-    MAKE_FN(64, 16)
-    MAKE_FN(48, 64)
-    MAKE_FN(48, 48)
-    MAKE_FN(48, 24)
-    MAKE_FN(48, 12)
-    MAKE_FN(32, 64)
-    MAKE_FN(32, 32)
-    MAKE_FN(32, 24)
-    MAKE_FN(32, 16)
-    MAKE_FN(32, 8)
-    MAKE_FN(24, 48)
-    MAKE_FN(24, 32)
-    MAKE_FN(24, 24)
-    MAKE_FN(24, 12)
-    MAKE_FN(24, 6)
-    MAKE_FN(16, 64)
-    MAKE_FN(16, 32)
-    MAKE_FN(16, 16)
-    MAKE_FN(16, 12)
-    MAKE_FN(16, 8)
-    MAKE_FN(16, 4)
-    MAKE_FN(16, 2)
-    MAKE_FN(16, 1)
-    MAKE_FN(12, 48)
-    MAKE_FN(12, 24)
-    MAKE_FN(12, 16)
-    MAKE_FN(12, 12)
-    MAKE_FN(12, 6)
-    MAKE_FN(12, 3) 
-    MAKE_FN(8, 32)
-    MAKE_FN(8, 16)
-    MAKE_FN(8, 8)
-    MAKE_FN(8, 4)
-    MAKE_FN(8, 2)
-    MAKE_FN(8, 1)
-    //MAKE_FN(6, 24) // w is mod4 only supported
-    //MAKE_FN(6, 12)
-    //MAKE_FN(6, 6)
-    //MAKE_FN(6, 3)
-    MAKE_FN(4, 8)
-    MAKE_FN(4, 4)
-    MAKE_FN(4, 2)
-    MAKE_FN(4, 1)
-    //MAKE_FN(3, 6) // w is mod4 only supported
-    //MAKE_FN(3, 3)
-    //MAKE_FN(2, 4) // no 2 byte width, only C
-    //MAKE_FN(2, 2) // no 2 byte width, only C
-    //MAKE_FN(2, 1) // no 2 byte width, only C
+    MAKE_FN(64, 64)
+      MAKE_FN(64, 48)
+      MAKE_FN(64, 32)
+      MAKE_FN(64, 16)
+      MAKE_FN(48, 64)
+      MAKE_FN(48, 48)
+      MAKE_FN(48, 24)
+      MAKE_FN(48, 12)
+      MAKE_FN(32, 64)
+      MAKE_FN(32, 32)
+      MAKE_FN(32, 24)
+      MAKE_FN(32, 16)
+      MAKE_FN(32, 8)
+      MAKE_FN(24, 48)
+      MAKE_FN(24, 32)
+      MAKE_FN(24, 24)
+      MAKE_FN(24, 12)
+      MAKE_FN(24, 6)
+      MAKE_FN(16, 64)
+      MAKE_FN(16, 32)
+      MAKE_FN(16, 16)
+      MAKE_FN(16, 12)
+      MAKE_FN(16, 8)
+      MAKE_FN(16, 4)
+      MAKE_FN(16, 2)
+      MAKE_FN(16, 1)
+      MAKE_FN(12, 48)
+      MAKE_FN(12, 24)
+      MAKE_FN(12, 16)
+      MAKE_FN(12, 12)
+      MAKE_FN(12, 6)
+      MAKE_FN(12, 3) 
+      MAKE_FN(8, 32)
+      MAKE_FN(8, 16)
+      MAKE_FN(8, 8)
+      MAKE_FN(8, 4)
+      MAKE_FN(8, 2)
+      MAKE_FN(8, 1)
+      //MAKE_FN(6, 24) // w is mod4 only supported
+      //MAKE_FN(6, 12)
+      //MAKE_FN(6, 6)
+      //MAKE_FN(6, 3)
+      MAKE_FN(4, 8)
+      MAKE_FN(4, 4)
+      MAKE_FN(4, 2)
+      MAKE_FN(4, 1)
+      //MAKE_FN(3, 6) // w is mod4 only supported
+      //MAKE_FN(3, 3)
+      //MAKE_FN(2, 4) // no 2 byte width, only C
+      //MAKE_FN(2, 2) // no 2 byte width, only C
+      //MAKE_FN(2, 1) // no 2 byte width, only C
 #undef MAKE_FN
 #undef MAKE_FN_LEVEL
+    return func_degrain;
+  }();
 
   DenoiseNFunction* result = nullptr;
   arch_t archlist[] = { USE_AVX2, USE_AVX, USE_SSE41, USE_SSE2, NO_SIMD };
@@ -520,7 +523,7 @@ func_degrain[make_tuple(x, y, DEGRAIN_TYPE_16BIT, USE_SSE41)] = DegrainN_16_sse4
   while (result == nullptr) {
     arch_t current_arch_try = archlist[index++];
     if (current_arch_try > arch) continue;
-    result = func_degrain[make_tuple(BlockX, BlockY, type_to_search, current_arch_try)];
+    result = find_function(func_degrain_table, make_tuple(BlockX, BlockY, type_to_search, current_arch_try));
     if (result == nullptr && current_arch_try == NO_SIMD)
       break;
   }
@@ -563,6 +566,7 @@ MDegrainN::MDegrainN(
   , _overschroma_lsb_ptr(0)
   , _degrainluma_ptr(0)
   , _degrainchroma_ptr(0)
+  , _kernel_info("MDegrainN")
   , _dst_short()
   , _dst_short_pitch()
   , _dst_int()
@@ -637,6 +641,14 @@ MDegrainN::MDegrainN(
 // get parameters of prepared super clip - v2.0
   SuperParams64Bits params;
   memcpy(&params, &vi_super.num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env_ptr->ThrowError("MDegrainN: super clip with ondemand=true is not supported");
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env_ptr->ThrowError("MDegrainN: super clip with virtualpad=true is not supported");
+  }
   const int nHeightS = params.nHeight;
   const int nSuperHPad = params.nHPad;
   const int nSuperVPad = params.nVPad;
@@ -795,6 +807,42 @@ MDegrainN::MDegrainN(
   if (!_degrainchroma_ptr)
     env_ptr->ThrowError("MDegrainN : no valid _degrainchroma_ptr function for %dx%d, pixelsize=%d, lsb_flag=%d", nBlkSizeX, nBlkSizeY, pixelsize_super, (int)lsb_flag);
 
+  {
+    const arch_t arch_cpu = KernelInfo::GetArch(env_ptr->GetCPUFlags());
+    const int bx = nBlkSizeX;
+    const int by = nBlkSizeY;
+    const int bxc = nBlkSizeX / xRatioUV_super;
+    const int byc = nBlkSizeY / yRatioUV_super;
+    const int bpp = bits_per_pixel_super;
+    const bool chroma_flag = (_yuvplanes & (UPLANE | VPLANE)) != 0;
+    _kernel_info.Add("DegrainN", KernelInfo::Config(bx, by, bpp), arch, arch_cpu,
+      [=](arch_t a) { return get_denoiseN_function(bx, by, bpp, lsb_flag, out16_flag, a); });
+    if (chroma_flag)
+    {
+      _kernel_info.Add("DegrainN chroma", KernelInfo::Config(bxc, byc, bpp), arch, arch_cpu,
+        [=](arch_t a) { return get_denoiseN_function(bxc, byc, bpp, lsb_flag, out16_flag, a); });
+    }
+    if (nOverlapX > 0 || nOverlapY > 0)
+    {
+      // same selection as the processing: lsb, then output pixel size
+      const int ovr_size = out16_flag ? 2 : pixelsize_super;
+      const int ovr_bpp = out16_flag ? 16 : bpp;
+      for (int p = 0; p < (chroma_flag ? 2 : 1); ++p)
+      {
+        const int w = (p == 0) ? bx : bxc;
+        const int h = (p == 0) ? by : byc;
+        const char *name = (p == 0) ? "Overlaps" : "Overlaps chroma";
+        if (lsb_flag)
+          _kernel_info.Add(name, KernelInfo::Config(w, h, 16) + " lsb", NO_SIMD, arch_cpu,
+            [=](arch_t a) { return get_overlaps_lsb_function(w, h, sizeof(uint8_t), a); });
+        else
+          _kernel_info.Add(name, KernelInfo::Config(w, h, ovr_bpp), arch, arch_cpu,
+            [=](arch_t a) { return get_overlaps_function(w, h, ovr_size, false, a); });
+      }
+    }
+    _kernel_info.Publish();
+  }
+
   if ((_cpuFlags & CPUF_SSE2) != 0)
   {
     if(out16_flag)
@@ -864,6 +912,8 @@ static void plane_copy_8_to_16_c(uint8_t *dstp, int dstpitch, const uint8_t *src
 
 ::PVideoFrame __stdcall MDegrainN::GetFrame(int n, ::IScriptEnvironment* env_ptr)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   _covered_width = nBlkX * (nBlkSizeX - nOverlapX) + nOverlapX;
   _covered_height = nBlkY * (nBlkSizeY - nOverlapY) + nOverlapY;
 
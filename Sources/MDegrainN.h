@@ -4,6 +4,7 @@
 
 
 #include	"conc/AtomicInt.h"
+#include "KernelInfo.h"
 #include "MTSlicer.h"
 #include "MVClip.h"
 #include "MVFilter.h"
@@ -12,6 +13,7 @@
 #include "SharedPtr.h"
 #include "yuy2planes.h"
 #include "def.h"
+#include "fstb/AllocAlign.h"
 
 #include	<memory>
 #include	<vector>
@@ -43,12 +45,6 @@ public:
     return cachehints == CACHE_GET_MTMODE ? MT_MULTI_INSTANCE : 0;
   }
 
-
-protected:
-
-private:
-  bool has_at_least_v8;
-
   typedef void (DenoiseNFunction)(
     BYTE *pDst, BYTE *pDstLsb, int nDstPitch,
     const BYTE *pSrc, int nSrcPitch,
@@ -58,7 +54,13 @@ private:
     int Wall[], int trad
     );
 
-  DenoiseNFunction* get_denoiseN_function(int BlockX, int BlockY, int _bits_per_pixel, bool _lsb_flag, bool _out16_flag, arch_t arch);
+  static DenoiseNFunction* get_denoiseN_function(int BlockX, int BlockY, int _bits_per_pixel, bool _lsb_flag, bool _out16_flag, arch_t arch);
+
+
+protected:
+
+private:
+  bool has_at_least_v8;
 
   class MvClipInfo
   {
@@ -161,12 +163,14 @@ private:
 
   LimitFunction_t *LimitFunction;
 
+  KernelInfo _kernel_info; // selected kernels, for MToolsInfo()
+
 // -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 // Processing variables
 
-  std::vector <uint16_t> _dst_short;
+  std::vector <uint16_t, fstb::AllocAlignHuge <uint16_t, 32> > _dst_short;
   int _dst_short_pitch;
-  std::vector <int> _dst_int;
+  std::vector <int, fstb::AllocAlignHuge <int, 32> > _dst_int;
   int _dst_int_pitch;
 
   bool _usable_flag_arr[MAX_TEMP_RAD * 2];
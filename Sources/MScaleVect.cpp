@@ -4,9 +4,12 @@
 //
 // Scale MVTools motion vectors. Can scale the blocks themselves to create vectors for a different frame size (powers of 2 only)
 
+#include "ClipFnc.h"
 #include "MScaleVect.h"
+#include "MVSceneStat.h"
 #include "VECTOR.h"
 #include <cmath>
+#include <vector>
 
 // Constructor - Copy motion vector information. Scale if required for use on different sized frame
 MScaleVect::MScaleVect( PClip Child, double ScaleX, double ScaleY, ScaleMode Mode, bool Flip, bool AdjustSubpel, int Bits, IScriptEnvironment* Env )
@@ -168,6 +171,8 @@ PVideoFrame __stdcall MScaleVect::GetFrame( int FrameNum, IScriptEnvironment* En
   // Copy and fix header
   int headerSize = *pData;
   memcpy(pDst, pData, headerSize);
+  // the block layout and the SAD change
+  MVSceneStat::Invalidate(reinterpret_cast<unsigned char*>(pDst), headerSize);
 
   const MVAnalysisData &	hdr_src =
     *reinterpret_cast <const MVAnalysisData *> (pData + 1);
@@ -182,8 +187,22 @@ PVideoFrame __stdcall MScaleVect::GetFrame( int FrameNum, IScriptEnvironment* En
   hdr_dst.isBackward  = (!! hdr_src.isBackward) ^ mRevert;
 
   // Copy all planes
-  pData = reinterpret_cast<const int*>(reinterpret_cast<const char*>(pData) + headerSize);
-  pDst  = reinterpret_cast<int*>(reinterpret_cast<char*>(pDst) + headerSize);
+  // When vectors are transported as frame property, the property was already
+  // inherited by dst. It is replaced with the scaled data at the end.
+  const bool fprop_flag = (hdr_src.nFlags & MOTION_VECTORS_IN_FRAMEPROP) != 0;
+  std::vector<int> fprop_buf;
+  if (fprop_flag)
+  {
+    int len_i32;
+    pData = ClipFnc::get_vector_prop(src, len_i32, Env);
+    fprop_buf.resize(len_i32);
+    pDst = &fprop_buf[0];
+  }
+  else
+  {
+    pData = reinterpret_cast<const int*>(reinterpret_cast<const char*>(pData) + headerSize);
+    pDst  = reinterpret_cast<int*>(reinterpret_cast<char*>(pDst) + headerSize);
+  }
   memcpy(pDst, pData, *pData * sizeof(int));
 
   // Size and validity of all block data
@@ -327,6 +346,11 @@ PVideoFrame __stdcall MScaleVect::GetFrame( int FrameNum, IScriptEnvironment* En
     if (pPlanes != pEnd) Env->ThrowError("MScaleVect: Internal error"); // Debugging check
   }
 
+  if (fprop_flag)
+  {
+    ClipFnc::set_vector_prop(dst, &fprop_buf[0], int(fprop_buf.size()), Env);
+  }
+
   return dst;
 }
 
@@ -76,6 +76,12 @@ MStoreVect::MStoreVect(std::vector <::PClip> clip_arr, const char *vccs_0, IScri
     {
       env->ThrowError("MStoreVect: invalid vector stream.");
     }
+    if ((mad.GetFlags() & MOTION_VECTORS_IN_FRAMEPROP) != 0)
+    {
+      env->ThrowError(
+        "MStoreVect: vectors transported as frame property cannot be stored, use MAnalyse with fprop=false."
+      );
+    }
 
     max_blk_x = std::max(max_blk_x, mad.nBlkX);
 
@@ -70,6 +70,7 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 
 
 class AvstpWrapper;
+class MemInfo;
 
 template <class T, class GR, class GD, int MAXT>
 class MTFlowGraphSched
@@ -116,6 +117,8 @@ private:
 	void				complete_task (TaskData &td);
 
 	static void		redirect_task (avstp_TaskDispatcher *dispatcher_ptr, void *data_ptr);
+	static inline void
+						process_task (T &obj, ProcPtr proc_ptr, TaskData &td);
 
 	AvstpWrapper &	_avstp;
 
@@ -128,6 +131,7 @@ private:
 						_task_data_arr;
 	std::array <conc::AtomicInt <int>, MAXT>
 						_in_cnt_arr;
+	MemInfo *		_mem_info_ptr;	// Charged with the allocations of the tasks, 0 if none
 
 	const bool		_mt_flag;
 
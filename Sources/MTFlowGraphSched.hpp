@@ -23,9 +23,12 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 #include	"AvstpWrapper.h"
+#include	"MemInfo.h"
+#include	"MTTrace.h"
 
 #include	<cassert>
 #include	<cstring>
+#include	<typeinfo>
 
 
 
@@ -69,6 +72,7 @@ MTFlowGraphSched <T, GR, GD, MAXT>::MTFlowGraphSched (bool mt_flag)
 ,	_dep_graph_ptr (0)
 ,	_task_data_arr ()
 ,	_in_cnt_arr ()
+,	_mem_info_ptr (0)
 ,	_mt_flag ()
 {
 	// Nothing
@@ -150,6 +154,7 @@ void	MTFlowGraphSched <T, GR, GD, MAXT>::start (const GR &dep_graph, GD &glob_da
 
 	_proc_ptr      = proc_ptr;
 	_dep_graph_ptr = &dep_graph;
+	_mem_info_ptr  = MemInfo::GetCurrent ();
 
 	const int		last_node_index = _dep_graph_ptr->get_last_node ();
 	memset (	// Not very clean but should work correctly.
@@ -173,7 +178,7 @@ void	MTFlowGraphSched <T, GR, GD, MAXT>::start (const GR &dep_graph, GD &glob_da
 	{
 		T *				this_ptr =
 			MTFlowGraphSched_Access <T, GD>::access (&glob_data);
-		((*this_ptr).*(proc_ptr)) (root);
+		process_task (*this_ptr, proc_ptr, root);
 
 		complete_task (root);
 	}
@@ -278,7 +283,7 @@ void	MTFlowGraphSched <T, GR, GD, MAXT>::complete_task (TaskData &td)
 				T *				this_ptr =
 					MTFlowGraphSched_Access <T, GD>::access (out_node._glob_data_ptr);
 
-				((*this_ptr).*(_proc_ptr)) (out_node);
+				process_task (*this_ptr, _proc_ptr, out_node);
 
 				complete_task (out_node);
 			}
@@ -304,13 +309,38 @@ void	MTFlowGraphSched <T, GR, GD, MAXT>::redirect_task (avstp_TaskDispatcher *di
 	ProcPtr			proc_ptr = scheduler._proc_ptr;
 	assert (proc_ptr != 0);
 
-	((*this_ptr).*(proc_ptr)) (*td_ptr);
+	// Same owner as the thread which started the tasks
+	MemInfo::Scope	mem_scope (scheduler._mem_info_ptr);
+
+	process_task (*this_ptr, proc_ptr, *td_ptr);
 
 	scheduler.complete_task (*td_ptr);
 }
 
 
 
+// Calls the processing function, recording the task when tracing is enabled
+template <class T, class GR, class GD, int MAXT>
+void	MTFlowGraphSched <T, GR, GD, MAXT>::process_task (T &obj, ProcPtr proc_ptr, TaskData &td)
+{
+	if (MTTrace::is_active ())
+	{
+		MTTrace &		trace = MTTrace::use_instance ();
+		const int64_t	ts_beg = trace.get_time ();
+		(obj.*(proc_ptr)) (td);
+		trace.record (
+			typeid (T).name (), MTTrace::Kind_GRAPH, td._task_index, 0,
+			ts_beg, trace.get_time ()
+		);
+	}
+	else
+	{
+		(obj.*(proc_ptr)) (td);
+	}
+}
+
+
+
 #endif	// MTFlowGraphSched_CODEHEADER_INCLUDED
 
 
@@ -50,6 +50,7 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 
 
 class AvstpWrapper;
+class MemInfo;
 
 template <class T, class GD = T, int MAXT = 64>
 class MTSlicer
@@ -95,6 +96,8 @@ protected:
 private:
 
 	static void		redirect_task (avstp_TaskDispatcher *dispatcher_ptr, void *data_ptr);
+	static inline void
+						process_task (T &obj, ProcPtr proc_ptr, TaskData &td);
 
 	AvstpWrapper &	_avstp;
 
@@ -104,6 +107,7 @@ private:
 						_dispatcher_ptr;
 	std::array <TaskData, MAXT>
 						_task_data_arr;
+	MemInfo *		_mem_info_ptr;	// Charged with the allocations of the tasks, 0 if none
 	const bool		_mt_flag;	// No need to be const, but must not be changed while task are enqueued.
 
 
@@ -23,8 +23,11 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 #include	"AvstpWrapper.h"
+#include	"MemInfo.h"
+#include	"MTTrace.h"
 
 #include <algorithm>
+#include <typeinfo>
 
 #include	<cassert>
 
@@ -68,6 +71,7 @@ MTSlicer <T, GD, MAXT>::MTSlicer (bool mt_flag)
 ,	_proc_ptr (0)
 ,	_dispatcher_ptr (0)
 ,	_task_data_arr ()
+,	_mem_info_ptr (0)
 ,	_mt_flag (mt_flag)
 {
 	// Nothing
@@ -148,7 +152,8 @@ void	MTSlicer <T, GD, MAXT>::start (int height, GD &glob_data, ProcPtr proc_ptr,
 	assert (proc_ptr != 0);
 	assert (min_slice_h > 0);
 
-	_proc_ptr = proc_ptr;
+	_proc_ptr     = proc_ptr;
+	_mem_info_ptr = MemInfo::GetCurrent ();
 
 	if (_mt_flag)
 	{
@@ -193,7 +198,7 @@ void	MTSlicer <T, GD, MAXT>::start (int height, GD &glob_data, ProcPtr proc_ptr,
 
 		T *				this_ptr =
 			MTSlicer_Access <T, GD>::access (&glob_data);
-		((*this_ptr).*(proc_ptr)) (task_data);
+		process_task (*this_ptr, proc_ptr, task_data);
 	}
 }
 
@@ -278,7 +283,32 @@ void	MTSlicer <T, GD, MAXT>::redirect_task (avstp_TaskDispatcher * /*dispatcher_
 	ProcPtr			proc_ptr = td_ptr->_slicer_ptr->_proc_ptr;
 	assert (proc_ptr != 0);
 
-	((*this_ptr).*(proc_ptr)) (*td_ptr);
+	// Same owner as the thread which started the tasks
+	MemInfo::Scope	mem_scope (td_ptr->_slicer_ptr->_mem_info_ptr);
+
+	process_task (*this_ptr, proc_ptr, *td_ptr);
+}
+
+
+
+// Calls the processing function, recording the task when tracing is enabled
+template <class T, class GD, int MAXT>
+void	MTSlicer <T, GD, MAXT>::process_task (T &obj, ProcPtr proc_ptr, TaskData &td)
+{
+	if (MTTrace::is_active ())
+	{
+		MTTrace &		trace = MTTrace::use_instance ();
+		const int64_t	ts_beg = trace.get_time ();
+		(obj.*(proc_ptr)) (td);
+		trace.record (
+			typeid (T).name (), MTTrace::Kind_SLICE, td._y_beg, td._y_end,
+			ts_beg, trace.get_time ()
+		);
+	}
+	else
+	{
+		(obj.*(proc_ptr)) (td);
+	}
 }
 
 
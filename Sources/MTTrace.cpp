@@ -0,0 +1,316 @@
+/*****************************************************************************
+
+        MTTrace.cpp
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://sam.zoy.org/wtfpl/COPYING for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if defined (_MSC_VER)
+	#pragma warning (1 : 4130 4223 4705 4706)
+	#pragma warning (4 : 4355 4786 4800)
+	#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include "MTTrace.h"
+
+#include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+/*
+==============================================================================
+Name: dtor
+	Writes the trace if recording is enabled. Do not destroy directly the
+	object, this is done automatically at the end of the process.
+==============================================================================
+*/
+
+MTTrace::~MTTrace ()
+{
+	if (is_active ())
+	{
+		write ();
+	}
+}
+
+
+
+/*
+==============================================================================
+Name: use_instance
+Description:
+	Obtain an access to the MTTrace singleton. It is created if not accessed
+	previously, and starts recording if MVTOOLS_TRACE is set.
+Returns:
+	A reference on the tracer.
+Throws: Nothing
+==============================================================================
+*/
+
+MTTrace &	MTTrace::use_instance ()
+{
+	static MTTrace	instance;
+
+	return (instance);
+}
+
+
+
+/*
+==============================================================================
+Name: start
+Description:
+	Starts recording, or only changes the output file if already started.
+Input parameters:
+	- filename_0: name of the JSON file written by write().
+Throws: std::string related exceptions
+==============================================================================
+*/
+
+void	MTTrace::start (const char *filename_0)
+{
+	assert (filename_0 != 0);
+
+	std::lock_guard <std::mutex>	lock (_mtx);
+	_filename = filename_0;
+	_active_flag = true;
+}
+
+
+
+/*
+==============================================================================
+Name: record
+Description:
+	Stores a task event in the buffer of the calling thread. Events are
+	dropped when the buffer is full.
+Input parameters:
+	- name_0: name of the processing class, static storage.
+	- kind: scheduler type, gives the meaning of a and b.
+	- ts_beg, ts_end: task timestamps, from get_time().
+Throws: memory allocation exceptions, the first time a thread records.
+==============================================================================
+*/
+
+void	MTTrace::record (const char *name_0, Kind kind, int a, int b, int64_t ts_beg, int64_t ts_end)
+{
+	assert (name_0 != 0);
+	assert (kind >= 0);
+	assert (kind < Kind_NBR_ELT);
+
+	ThreadBuf &		buf = use_thread_buf ();
+	const int		pos = buf._nbr_evt.load (std::memory_order_relaxed);
+	if (pos >= BUF_SIZE)
+	{
+		++ buf._nbr_lost;
+		return;
+	}
+
+	Event &			evt = buf._evt_arr [pos];
+	evt._ts_beg = ts_beg;
+	evt._ts_end = ts_end;
+	evt._name_0 = name_0;
+	evt._kind   = kind;
+	evt._a      = a;
+	evt._b      = b;
+	buf._nbr_evt.store (pos + 1, std::memory_order_release);
+}
+
+
+
+/*
+==============================================================================
+Name: write
+Description:
+	Writes the events recorded so far as Chrome trace-event JSON, to the file
+	given to start() or to the specified one. Can be called while tasks are
+	running.
+Returns: true if the file was written.
+Throws: std::string related exceptions
+==============================================================================
+*/
+
+bool	MTTrace::write () const
+{
+	std::string		filename;
+	{
+		std::lock_guard <std::mutex>	lock (_mtx);
+		filename = _filename;
+	}
+
+	return (! filename.empty () && write (filename.c_str ()));
+}
+
+
+
+bool	MTTrace::write (const char *filename_0) const
+{
+	assert (filename_0 != 0);
+
+	FILE *			f_ptr = fopen (filename_0, "w");
+	if (f_ptr == 0)
+	{
+		return (false);
+	}
+
+	static const char * const	cat_0_arr [Kind_NBR_ELT] = { "slice", "graph" };
+
+	std::lock_guard <std::mutex>	lock (_mtx);
+
+	fprintf (f_ptr, "{\"traceEvents\":[\n");
+	fprintf (
+		f_ptr,
+		"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+		"\"args\":{\"name\":\"MVTools\"}}"
+	);
+	for (const auto &buf_uptr : _buf_list)
+	{
+		const ThreadBuf &	buf = *buf_uptr;
+		fprintf (
+			f_ptr,
+			",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+			"\"args\":{\"name\":\"thread %d\",\"lost_events\":%d}}",
+			buf._tid, buf._tid, buf._nbr_lost.load ()
+		);
+
+		const int		nbr_evt = buf._nbr_evt.load (std::memory_order_acquire);
+		for (int pos = 0; pos < nbr_evt; ++pos)
+		{
+			const Event &	evt = buf._evt_arr [pos];
+			const std::string	name = clean_name (evt._name_0);
+			fprintf (
+				f_ptr,
+				",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,"
+				"\"dur\":%lld,\"pid\":1,\"tid\":%d,\"args\":{",
+				name.c_str (), cat_0_arr [evt._kind],
+				(long long) evt._ts_beg, (long long) (evt._ts_end - evt._ts_beg),
+				buf._tid
+			);
+			if (evt._kind == Kind_SLICE)
+			{
+				fprintf (f_ptr, "\"y_beg\":%d,\"y_end\":%d}}", evt._a, evt._b);
+			}
+			else
+			{
+				fprintf (f_ptr, "\"task\":%d}}", evt._a);
+			}
+		}
+	}
+	fprintf (f_ptr, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	const bool		ok_flag = (ferror (f_ptr) == 0);
+	fclose (f_ptr);
+
+	return (ok_flag);
+}
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+MTTrace::MTTrace ()
+:	_t_beg (Clock::now ())
+,	_filename ()
+,	_mtx ()
+,	_buf_list ()
+{
+	const char *	env_0 = getenv ("MVTOOLS_TRACE");
+	if (env_0 != 0 && env_0 [0] != '\0')
+	{
+		start (env_0);
+	}
+}
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+
+
+// Buffer of the calling thread, registered on first use
+MTTrace::ThreadBuf &	MTTrace::use_thread_buf ()
+{
+	static thread_local ThreadBuf *	buf_ptr = 0;
+
+	if (buf_ptr == 0)
+	{
+		std::unique_ptr <ThreadBuf>	buf_uptr (new ThreadBuf);
+		buf_uptr->_nbr_evt  = 0;
+		buf_uptr->_nbr_lost = 0;
+		buf_uptr->_evt_arr.resize (BUF_SIZE);
+
+		std::lock_guard <std::mutex>	lock (_mtx);
+		buf_uptr->_tid = int (_buf_list.size ()) + 1;
+		buf_ptr = buf_uptr.get ();
+		_buf_list.push_back (std::move (buf_uptr));
+	}
+
+	return (*buf_ptr);
+}
+
+
+
+// Class name from typeid().name(): drops the "class " or "struct " prefix
+// (MSVC) or the length prefix of the simple names (GCC, Clang).
+std::string	MTTrace::clean_name (const char *name_0)
+{
+	assert (name_0 != 0);
+
+	if (strncmp (name_0, "class ", 6) == 0)
+	{
+		name_0 += 6;
+	}
+	else if (strncmp (name_0, "struct ", 7) == 0)
+	{
+		name_0 += 7;
+	}
+	else
+	{
+		while (isdigit (static_cast <unsigned char> (*name_0)))
+		{
+			++ name_0;
+		}
+	}
+
+	std::string		name;
+	for ( ; *name_0 != '\0'; ++name_0)
+	{
+		if (*name_0 != '"' && *name_0 != '\\')
+		{
+			name += *name_0;
+		}
+	}
+
+	return (name);
+}
+
+
+
+std::atomic <bool>	MTTrace::_active_flag (false);
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
@@ -0,0 +1,178 @@
+/*****************************************************************************
+
+        MTTrace.h
+
+Optional recording of the tasks run by MTSlicer and MTFlowGraphSched, to
+find load imbalance between slices and idle time in the task graphs.
+
+Each task gives one event: start and end timestamps, thread and task bounds
+(slice rows, or task index for the graphs). The events are stored in
+per-thread buffers without lock; a mutex is only taken the first time a
+thread records an event. Buffers have a fixed capacity, events are dropped
+when a buffer is full.
+
+The trace is written as Chrome trace-event JSON (chrome://tracing, Perfetto).
+Recording is enabled with the MVTOOLS_TRACE environment variable set to the
+output file name, or with the MTrace() script function. The file is written
+when the plugin is unloaded and when the script environment is closed.
+
+This is a singleton, use use_instance() to access it. When tracing is
+disabled, the only cost is the is_active() test for each task.
+
+--- Legal stuff ---
+
+This program is free software. It comes without any warranty, to
+the extent permitted by applicable law. You can redistribute it
+and/or modify it under the terms of the Do What The Fuck You Want
+To Public License, Version 2, as published by Sam Hocevar. See
+http://sam.zoy.org/wtfpl/COPYING for more details.
+
+*Tab=3***********************************************************************/
+
+
+
+#if ! defined (MTTrace_HEADER_INCLUDED)
+#define	MTTrace_HEADER_INCLUDED
+
+#if defined (_MSC_VER)
+	#pragma once
+	#pragma warning (4 : 4250)
+#endif
+
+
+
+/*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cstdint>
+
+
+
+class MTTrace
+{
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	enum Kind
+	{
+		Kind_SLICE = 0,	// MTSlicer: a and b are the row bounds [a ; b[
+		Kind_GRAPH,			// MTFlowGraphSched: a is the task index
+
+		Kind_NBR_ELT
+	};
+
+	virtual        ~MTTrace ();
+
+	static MTTrace &
+	               use_instance ();
+	static inline bool
+	               is_active ();
+
+	void           start (const char *filename_0);
+	inline int64_t get_time () const;
+	void           record (const char *name_0, Kind kind, int a, int b, int64_t ts_beg, int64_t ts_end);
+	bool           write () const;
+	bool           write (const char *filename_0) const;
+
+
+
+/*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+protected:
+
+	               MTTrace ();
+
+
+
+/*\\\ PRIVATE \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	enum {         BUF_SIZE = 1 << 15 };	// Events per thread
+
+	class Event
+	{
+	public:
+		int64_t        _ts_beg;	// Microseconds from the trace start
+		int64_t        _ts_end;
+		const char *   _name_0;
+		int            _kind;
+		int            _a;
+		int            _b;
+	};
+
+	class ThreadBuf
+	{
+	public:
+		int            _tid;
+		std::atomic <int>
+		               _nbr_evt;	// Events are complete below this index
+		std::atomic <int>
+		               _nbr_lost;
+		std::vector <Event>
+		               _evt_arr;
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	ThreadBuf &    use_thread_buf ();
+	static std::string
+	               clean_name (const char *name_0);
+
+	static std::atomic <bool>
+	               _active_flag;
+
+	const Clock::time_point
+	               _t_beg;
+	std::string    _filename;
+	mutable std::mutex
+	               _mtx;	// Buffer list and file name
+	std::vector <std::unique_ptr <ThreadBuf> >
+	               _buf_list;
+
+
+
+/*\\\ FORBIDDEN MEMBER FUNCTIONS \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+private:
+
+	               MTTrace (const MTTrace &other)           = delete;
+	               MTTrace (MTTrace &&other)                = delete;
+	MTTrace &      operator = (const MTTrace &other)        = delete;
+	MTTrace &      operator = (MTTrace &&other)             = delete;
+	bool           operator == (const MTTrace &other) const = delete;
+	bool           operator != (const MTTrace &other) const = delete;
+
+};	// class MTTrace
+
+
+
+bool	MTTrace::is_active ()
+{
+	return (_active_flag.load (std::memory_order_relaxed));
+}
+
+
+
+int64_t	MTTrace::get_time () const
+{
+	return (std::chrono::duration_cast <std::chrono::microseconds> (
+		Clock::now () - _t_beg
+	).count ());
+}
+
+
+
+#endif	// MTTrace_HEADER_INCLUDED
+
+
+
+/*\\\ EOF \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
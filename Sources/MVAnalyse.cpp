@@ -27,11 +27,15 @@
 #include "DCTFFTW.h"
 #include "DCTINT.h"
 #include "MVAnalyse.h"
+#include "MVFrame.h"
 #include "MVGroupOfFrames.h"
+#include "MVPlane.h"
+#include "MVSceneStat.h"
 #include "MVSuper.h"
 #include "profile.h"
 #include "SuperParams64Bits.h"
 
+#include <cassert>
 #include <cmath>
 #include <cstdio>
 #include <algorithm>
@@ -43,16 +47,25 @@ MVAnalyse::MVAnalyse(
   int _overlapx, int _overlapy, const char* _outfilename, int _dctmode,
   int _divide, int _sadx264, sad_t _badSAD, int _badrange, bool _isse,
   bool _meander, bool temporal_flag, bool _tryMany, bool multi_flag,
-  bool mt_flag, int _chromaSADScale, IScriptEnvironment* env
+  bool mt_flag, int _chromaSADScale, bool fprop_flag, bool sadcache_flag, sad_t _skipSAD,
+  bool adaptive_flag, bool phasecorr_flag, int analysis_scale, bool stats_flag,
+  IScriptEnvironment* env
 )
   : ::GenericVideoFilter(_child)
+  , _mem_info("MAnalyse")
   , _srd_arr(1)
   , _vectorfields_aptr()
   , _multi_flag(multi_flag)
   , _temporal_flag(temporal_flag)
   , _mt_flag(mt_flag)
+  , _fprop_flag(false)
+  , _stats_flag(false)
+  , _kernel_info("MAnalyse")
   , _dct_factory_ptr()
   , _dct_pool()
+  , _gmpc_ptr()
+  , _gmpc_level(0)
+  , _scale_shift(0)
   , _delta_max(0)
 
 {
@@ -115,7 +128,30 @@ MVAnalyse::MVAnalyse(
     env->ThrowError("MAnalyse: wrong super clip (pseudoaudio) parameters");
   }
 
-  analysisData.nWidth = vi.width - nSuperHPad * 2;
+  if (analysis_scale != 1 && analysis_scale != 2 && analysis_scale != 4 && analysis_scale != 8)
+  {
+    env->ThrowError("MAnalyse: analysis_scale must be 1, 2, 4 or 8");
+  }
+  while ((1 << _scale_shift) < analysis_scale)
+  {
+    ++_scale_shift;
+  }
+  if (_scale_shift >= nSuperLevels)
+  {
+    env->ThrowError(
+      "MAnalyse: analysis_scale=%d needs at least %d levels in super clip",
+      analysis_scale, _scale_shift + 1
+    );
+  }
+  if (_scale_shift > 0 && lstrlen(_outfilename) > 0)
+  {
+    env->ThrowError("MAnalyse: outfile is not supported with analysis_scale");
+  }
+
+  // the padding is not stored with MSuper virtualpad=true
+  const int		nSuperHPadStored = (params.param & SUPER_PARAM_VIRTUAL_PAD) ? 0 : nSuperHPad;
+  const int		nSuperWidth = vi.width - nSuperHPadStored * 2;
+  analysisData.nWidth = nSuperWidth;
   analysisData.nHeight = nHeight;
   analysisData.pixelType = vi.pixel_type;
   if (!vi.IsY()) {
@@ -129,6 +165,16 @@ MVAnalyse::MVAnalyse(
   analysisData.pixelsize = pixelsize;
   analysisData.bits_per_pixel = bits_per_pixel;
 
+  // the search runs on a reduced level of the super clip. The GOFs are
+  // built with the full size, they derive the size of each level from it.
+  int nSearchWidth = nSuperWidth;
+  int nSearchHeight = nHeight;
+  if (_scale_shift > 0)
+  {
+    nSearchWidth = PlaneWidthLuma(nSuperWidth, _scale_shift, analysisData.xRatioUV, nSuperHPad);
+    nSearchHeight = PlaneHeightLuma(nHeight, _scale_shift, analysisData.yRatioUV, nSuperVPad);
+  }
+
   if (_chromaSADScale < -2 || _chromaSADScale>2)
     env->ThrowError(
       "MAnalyze: scaleCSAD must be -2..2"
@@ -136,6 +182,11 @@ MVAnalyse::MVAnalyse(
 
   analysisData.chromaSADScale = _chromaSADScale;
 
+  if (_skipSAD < 0)
+  {
+    env->ThrowError("MAnalyse: skipsad must be >= 0");
+  }
+
   pSrcGOF = new MVGroupOfFrames(
     nSuperLevels, analysisData.nWidth, analysisData.nHeight,
     nSuperPel, nSuperHPad, nSuperVPad, nSuperModeYUV,
@@ -146,6 +197,20 @@ MVAnalyse::MVAnalyse(
     nSuperPel, nSuperHPad, nSuperVPad, nSuperModeYUV,
     _isse, analysisData.xRatioUV, analysisData.yRatioUV, pixelsize, bits_per_pixel, mt_flag
   );
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    // MSuper ondemand=true: sub-pixel blocks are interpolated while searching
+    const int nSuperSharp = (params.param >> SUPER_PARAM_SHARP_SHIFT) & SUPER_PARAM_SHARP_MASK;
+    pRefGOF->set_interp(MVPlaneSet(nSuperModeYUV), 2, nSuperSharp);
+    pRefGOF->set_pel_on_demand(true);
+    pSrcGOF->set_pel_on_demand(true);
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    // MSuper virtualpad=true: blocks crossing the frame borders are clamped
+    pRefGOF->set_virtual_pad(true);
+    pSrcGOF->set_virtual_pad(true);
+  }
 
   analysisData.nBlkSizeX = _blksizex;
   analysisData.nBlkSizeY = _blksizey;
@@ -176,6 +241,21 @@ MVAnalyse::MVAnalyse(
     env->ThrowError(
       "MAnalyse: Invalid block size: %d x %d", analysisData.nBlkSizeX, analysisData.nBlkSizeY);
   }
+  if (_scale_shift > 0)
+  {
+    // block size of the emitted vectors
+    const std::pair< int, int > scaled_blksize(
+      analysisData.nBlkSizeX << _scale_shift,
+      analysisData.nBlkSizeY << _scale_shift
+    );
+    if (std::find(allowed_blksizes.begin(), allowed_blksizes.end(), scaled_blksize) == allowed_blksizes.end())
+    {
+      env->ThrowError(
+        "MAnalyse: analysis_scale gives an invalid block size: %d x %d",
+        scaled_blksize.first, scaled_blksize.second
+      );
+    }
+  }
 
   analysisData.nPel = nSuperPel;
   if (analysisData.nPel != 1
@@ -184,6 +264,10 @@ MVAnalyse::MVAnalyse(
   {
     env->ThrowError("MAnalyse: pel has to be 1 or 2 or 4");
   }
+  if (_scale_shift > 0)
+  {
+    analysisData.nPel = 1; // reduced levels are full-pel only
+  }
 
   analysisData.nDeltaFrame = df;
 //	if (analysisData.nDeltaFrame < 1)
@@ -224,17 +308,29 @@ MVAnalyse::MVAnalyse(
   analysisData.nOverlapX = _overlapx;
   analysisData.nOverlapY = _overlapy;
 
-  int		nBlkX = (analysisData.nWidth - analysisData.nOverlapX)
+  int		nBlkX = (nSearchWidth - analysisData.nOverlapX)
     / (analysisData.nBlkSizeX - analysisData.nOverlapX);
-  int		nBlkY = (analysisData.nHeight - analysisData.nOverlapY)
+  int		nBlkY = (nSearchHeight - analysisData.nOverlapY)
     / (analysisData.nBlkSizeY - analysisData.nOverlapY);
 
   // 2.7.36: fallback to no overlap when either nBlk count is less that 2
   if (nBlkX < 2 || nBlkY < 2) {
     analysisData.nOverlapX = 0;
     analysisData.nOverlapY = 0;
-    nBlkX = analysisData.nWidth / analysisData.nBlkSizeX;
-    nBlkY = analysisData.nHeight / analysisData.nBlkSizeY;
+    nBlkX = nSearchWidth / analysisData.nBlkSizeX;
+    nBlkY = nSearchHeight / analysisData.nBlkSizeY;
+  }
+
+  // scaled blocks must stay inside the full size frame
+  while (nBlkX > 1
+    && (((analysisData.nBlkSizeX - analysisData.nOverlapX) * nBlkX + analysisData.nOverlapX) << _scale_shift) > nSuperWidth)
+  {
+    --nBlkX;
+  }
+  while (nBlkY > 1
+    && (((analysisData.nBlkSizeY - analysisData.nOverlapY) * nBlkY + analysisData.nOverlapY) << _scale_shift) > nHeight)
+  {
+    --nBlkY;
   }
 
   analysisData.nBlkX = nBlkX;
@@ -259,11 +355,11 @@ MVAnalyse::MVAnalyse(
   }
 
   analysisData.nLvCount = (lv > 0) ? lv : nLevelsMax + lv;
-  if (analysisData.nLvCount > nSuperLevels)
+  if (analysisData.nLvCount > nSuperLevels - _scale_shift)
   {
     env->ThrowError(
       "MAnalyse: it is not enough levels  in super clip (%d), "
-      "while MAnalyse asks %d", nSuperLevels, analysisData.nLvCount
+      "while MAnalyse asks %d", nSuperLevels, analysisData.nLvCount + _scale_shift
     );
   }
   if (analysisData.nLvCount < 1
@@ -295,8 +391,10 @@ MVAnalyse::MVAnalyse(
   pzero = _pzero;
   badSAD = _badSAD * (_blksizex * _blksizey) / 64 * (1 << (bits_per_pixel - 8));
   badrange = _badrange;
+  skipSAD = _skipSAD * (_blksizex * _blksizey) / 64 * (1 << (bits_per_pixel - 8));
   meander = _meander;
   tryMany = _tryMany;
+  adaptive = adaptive_flag;
 
   if (_dctmode != 0)
   {
@@ -350,6 +448,7 @@ MVAnalyse::MVAnalyse(
   analysisData.nFlags |= (_isse) ? MOTION_USE_ISSE : 0;
   analysisData.nFlags |= (analysisData.isBackward) ? MOTION_IS_BACKWARD : 0;
   analysisData.nFlags |= (chroma) ? MOTION_USE_CHROMA_MOTION : 0;
+  analysisData.nFlags |= (sadcache_flag) ? MOTION_USE_TILE_SAD_CACHE : 0;
 
   analysisData.nFlags |= conv_cpuf_flags_to_cpu(env->GetCPUFlags());
   // cpu flags has different layout that Avisynth's CPUF_xxx layout.
@@ -367,6 +466,7 @@ MVAnalyse::MVAnalyse(
     analysisData.nBlkSizeX,
     analysisData.nBlkSizeY,
     analysisData.nLvCount,
+    _scale_shift,
     analysisData.nPel,
     analysisData.nFlags,
     analysisData.nOverlapX,
@@ -384,6 +484,45 @@ MVAnalyse::MVAnalyse(
     env
   ));
 
+  _stats_flag = stats_flag && has_at_least_v8;
+  _vectorfields_aptr->EnableStats(_stats_flag);
+  _vectorfields_aptr->DescribeKernels(_kernel_info);
+  _kernel_info.Publish();
+
+  if (phasecorr_flag)
+  {
+    // finest level of the super clip with a small enough FFT
+    _gmpc_level = nSuperLevels - 1;
+    while (_gmpc_level > 0
+      && pSrcGOF->GetFrame(_gmpc_level - 1)->GetPlane(YPLANE)->GetWidth() <= 512)
+    {
+      --_gmpc_level;
+    }
+    const MVPlane *plane_ptr = pSrcGOF->GetFrame(_gmpc_level)->GetPlane(YPLANE);
+    try
+    {
+      _gmpc_ptr = std::unique_ptr <GlobalMotionPC>(
+        new GlobalMotionPC(plane_ptr->GetWidth(), plane_ptr->GetHeight(), pixelsize)
+      );
+    }
+    catch (const std::exception &e)
+    {
+      env->ThrowError("MAnalyse: phasecorr: %s", e.what());
+    }
+    catch (const char *msg)
+    {
+      env->ThrowError("MAnalyse: phasecorr: %s", msg);
+    }
+  }
+
+  // Frame property transport: the vector clip content is reduced to the
+  // header, vector data are attached to the frame (AviSynth+ v8 only)
+  _fprop_flag = fprop_flag && has_at_least_v8;
+  if (_fprop_flag)
+  {
+    analysisData.nFlags |= MOTION_VECTORS_IN_FRAMEPROP;
+  }
+
   analysisData.nMagicKey = MVAnalysisData::MOTION_MAGIC_KEY;
   analysisData.nHPadding = nSuperHPad; // v2.0
   analysisData.nVPadding = nSuperVPad;
@@ -415,10 +554,17 @@ MVAnalyse::MVAnalyse(
 
   // Defines the format of the output vector clip
   // count of 32 bit integers: 2_size_validity+(foreachblock(1_validity+blockCount*3))
-  const int		width_bytes = headerSize + _vectorfields_aptr->GetArraySize() * 4;
+  const int		width_bytes =
+    (_fprop_flag)
+    ? headerSize
+    : headerSize + _vectorfields_aptr->GetArraySize() * 4;
   ClipFnc::format_vector_clip(
     vi, true, nBlkX, "rgb32", width_bytes, "MAnalyse", env
   );
+  if (_fprop_flag)
+  {
+    _fprop_buf.resize(_vectorfields_aptr->GetArraySize());
+  }
 
   if (divideExtra)	//v1.8.1
   {
@@ -432,6 +578,21 @@ MVAnalyse::MVAnalyse(
     analysisDataDivided.nLvCount = analysisData.nLvCount + 1;
   }
 
+  if (_scale_shift > 0)
+  {
+    // vectors are emitted at full resolution, with the MScaleVect semantics
+    MVAnalysisData *	ana_ptr_arr[2] = { &analysisData, &analysisDataDivided };
+    for (int i = 0; i < ((divideExtra) ? 2 : 1); ++i)
+    {
+      MVAnalysisData &	ana = *ana_ptr_arr[i];
+      ana.nBlkSizeX <<= _scale_shift;
+      ana.nBlkSizeY <<= _scale_shift;
+      ana.nOverlapX <<= _scale_shift;
+      ana.nOverlapY <<= _scale_shift;
+      ana.nPel = nSuperPel;
+    }
+  }
+
   if (_temporal_flag)
   {
     _srd_arr[0]._vec_prev.resize(_vectorfields_aptr->GetArraySize()); // array for prev vectors
@@ -524,6 +685,8 @@ MVAnalyse::~MVAnalyse()
 
 PVideoFrame __stdcall MVAnalyse::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   _RPT2(0, "MAnalyze GetFrame, frame=%d id=%d\n", n, _instance_id);
   const int		ndiv = (_multi_flag) ? _delta_max * 2 : 1;
   const int		nsrc = n / ndiv;
@@ -554,6 +717,7 @@ PVideoFrame __stdcall MVAnalyse::GetFrame(int n, IScriptEnvironment* env)
 
   PVideoFrame			dst = env->NewVideoFrame(vi); // frameprop inheritance later (if there is source)
   unsigned char *	pDst = dst->GetWritePtr();
+  unsigned char *	pHeader = pDst;
 
   // 0 headersize (max(4+sizeof(analysisData),256)
   // 4: analysysData
@@ -579,6 +743,10 @@ PVideoFrame __stdcall MVAnalyse::GetFrame(int n, IScriptEnvironment* env)
     );
   }
   pDst += headerSize;
+  if (_fprop_flag)
+  {
+    pDst = reinterpret_cast <unsigned char *> (&_fprop_buf[0]);
+  }
 
   if (nsrc < minframe || nsrc >= maxframe)
   {
@@ -605,7 +773,7 @@ PVideoFrame __stdcall MVAnalyse::GetFrame(int n, IScriptEnvironment* env)
     const int		fieldShift = ClipFnc::compute_fieldshift(
       child,
       vi.IsFieldBased(),
-      srd._analysis_data.nPel,
+      (_scale_shift > 0) ? 1 : srd._analysis_data.nPel, // search pel
       nsrc,
       nref
     );
@@ -622,13 +790,53 @@ PVideoFrame __stdcall MVAnalyse::GetFrame(int n, IScriptEnvironment* env)
       pVecPrevOrNull = &srd._vec_prev[0];
     }
 
+    if (_gmpc_ptr)
+    {
+      // global shift by phase correlation, seeds the coarsest level
+      const MVPlane *src_plane_ptr = pSrcGOF->GetFrame(_gmpc_level)->GetPlane(YPLANE);
+      const MVPlane *ref_plane_ptr = pRefGOF->GetFrame(_gmpc_level)->GetPlane(YPLANE);
+      int dx;
+      int dy;
+      if (_gmpc_ptr->Estimate(
+        src_plane_ptr->GetPointer(0, 0), src_plane_ptr->GetPitch(),
+        ref_plane_ptr->GetPointer(0, 0), ref_plane_ptr->GetPitch(), dx, dy))
+      {
+        const int level_shift = _gmpc_level - (_scale_shift + srd._analysis_data.nLvCount - 1);
+        VECTOR seed;
+        seed.x = int(std::lround(std::ldexp(double(dx), level_shift)));
+        seed.y = int(std::lround(std::ldexp(double(dy), level_shift)));
+        seed.sad = 0;
+        _vectorfields_aptr->SetGlobalMVSeed(&seed);
+      }
+      else
+      {
+        _vectorfields_aptr->SetGlobalMVSeed(0);
+      }
+    }
+
+    // all the deltas of a source frame share its source blocks
+    _vectorfields_aptr->SetSrcFrameId((_multi_flag) ? nsrc : -1);
     _vectorfields_aptr->SearchMVs(
       pSrcGOF, pRefGOF,
       searchType, nSearchParam, nPelSearch, nLambda, lsad, pnew, plevel,
       global, srd._analysis_data.nFlags, reinterpret_cast<int*>(pDst),
       outfilebuf, fieldShift, pzero, pglobal, badSAD, badrange,
-      meander, pVecPrevOrNull, tryMany
+      meander, pVecPrevOrNull, tryMany, skipSAD, adaptive
     );
+    if (skipSAD > 0 && has_at_least_v8)
+    {
+      // ratio of the static blocks, to tune skipsad
+      env->propSetFloat(
+        env->getFramePropsRW(dst), "MAnalyse_SkipRatio",
+        _vectorfields_aptr->GetSkipRatio(), PROPAPPENDMODE_REPLACE
+      );
+    }
+    if (_stats_flag)
+    {
+      _vectorfields_aptr->WriteStatProps(
+        dst, "MAnalyse_", _vectorfields_aptr->GetLevelCount(), env
+      );
+    }
 
     if (divideExtra)
     {
@@ -636,7 +844,8 @@ PVideoFrame __stdcall MVAnalyse::GetFrame(int n, IScriptEnvironment* env)
       // motion
       _vectorfields_aptr->ExtraDivide(
         reinterpret_cast <int *> (pDst),
-        srd._analysis_data.nFlags
+        srd._analysis_data.nFlags,
+        lsad
       );
     }
 
@@ -664,12 +873,72 @@ PVideoFrame __stdcall MVAnalyse::GetFrame(int n, IScriptEnvironment* env)
     srd._vec_prev_frame = nsrc;
   }
 
+  if (_scale_shift > 0)
+  {
+    scale_vectors(reinterpret_cast <int *> (pDst), srd._analysis_data);
+  }
+
+  // scene change statistics of the exposed finest level
+  MVSceneStat::Write(
+    pHeader,
+    (divideExtra) ? srd._analysis_data_divided : srd._analysis_data,
+    reinterpret_cast <const int *> (pDst)
+  );
+
+  if (_fprop_flag)
+  {
+    ClipFnc::set_vector_prop(
+      dst, &_fprop_buf[0], int(_fprop_buf.size()), env
+    );
+  }
+
   _RPT3(0, "MAnalyze GetFrame END, frame_nsrc=%d nref=%d id=%d\n", nsrc, nref, _instance_id);
   return dst;
 }
 
 
 
+// analysis_scale: from the units of the reduced level to the full size
+// frame, as MScaleVect. Invalid data are left as they are.
+// With divide, the divided plane follows the finest level. Its length is the
+// 0xFFFFFFFF marker of GroupOfPlanes::ExtraDivide, it holds 4 sub-blocks per
+// block and ends the data.
+void	MVAnalyse::scale_vectors(int *data_ptr, const MVAnalysisData &ana_data) const
+{
+  if (data_ptr[1] == 0)
+  {
+    return;
+  }
+  const int		vec_mul = (1 << _scale_shift) * ana_data.nPel;
+  const int		sad_mul = 1 << (_scale_shift * 2);
+  int *			end_ptr = data_ptr + data_ptr[0];
+  int *			plane_ptr = data_ptr + 2;
+  while (plane_ptr != end_ptr)
+  {
+    const int		blocks_size = *plane_ptr;
+    VECTOR *		blk_ptr = reinterpret_cast <VECTOR *> (plane_ptr + 1);
+    if (blocks_size == int (0xFFFFFFFF))
+    {
+      const int		nbr_blk = ana_data.nBlkX * ana_data.nBlkY * 4;
+      assert (reinterpret_cast <int *> (blk_ptr + nbr_blk) == end_ptr);
+      plane_ptr = end_ptr;
+    }
+    else
+    {
+      plane_ptr += blocks_size;
+    }
+    while (reinterpret_cast <int *> (blk_ptr) != plane_ptr)
+    {
+      blk_ptr->x *= vec_mul;
+      blk_ptr->y *= vec_mul;
+      blk_ptr->sad *= sad_mul;
+      ++blk_ptr;
+    }
+  }
+}
+
+
+
 void	MVAnalyse::load_src_frame(MVGroupOfFrames &gof, ::PVideoFrame &src, const MVAnalysisData &ana_data)
 {
   PROFILE_START(MOTION_PROFILE_YUY2CONVERT);
@@ -22,7 +22,10 @@
 
 #include "conc/ObjPool.h"
 #include "DCTFactory.h"
+#include "GlobalMotionPC.h"
 #include "GroupOfPlanes.h"
+#include "KernelInfo.h"
+#include "MemInfo.h"
 #include "MVAnalysisData.h"
 #include "yuy2planes.h"
 
@@ -37,6 +40,8 @@ class MVAnalyse
   : public GenericVideoFilter
 {
 protected:
+  MemInfo _mem_info; // First member: the other ones are charged to it
+
   bool has_at_least_v8;
 
   int _instance_id; // debug unique id
@@ -85,12 +90,17 @@ protected:
   const char* outfilename;// vectors output file
   int divideExtra; // divide blocks on sublocks with median motion
   sad_t badSAD; //  SAD threshold to make more wide search for bad vectors
+  sad_t skipSAD; // SAD threshold of static blocks, no search below (0: disabled)
+  bool adaptive; // search range of each block from its predictor quality
   int badrange;// range (radius) of wide search
   bool meander; //meander (alternate) scan blocks (even row left to right, odd row right to left
   bool tryMany; // try refine around many predictors
   const bool _multi_flag;
   const bool _temporal_flag;
   const bool _mt_flag;
+  bool _fprop_flag; // vectors are transported as frame property (v8 only)
+  bool _stats_flag; // search counters per level as frame properties (v8 only)
+  KernelInfo _kernel_info; // selected kernels, for MToolsInfo()
 
   int pixelsize; // PF
   int bits_per_pixel;
@@ -102,10 +112,15 @@ protected:
   //	YUY2Planes * RefPlanes;
 
   std::unique_ptr<DCTFactory> _dct_factory_ptr; // Not instantiated if not needed
+  std::unique_ptr<GlobalMotionPC> _gmpc_ptr; // phase correlation global motion, not instantiated if not needed
+  int _gmpc_level; // super clip level of the phase correlation
+  int _scale_shift; // analysis_scale: log2 of the reduction, the search starts at this super clip level
   conc::ObjPool<DCTClass> _dct_pool;
 
   int headerSize;
 
+  std::vector<int> _fprop_buf; // vector data before storage as frame property
+
   MVGroupOfFrames *pSrcGOF, *pRefGOF; //v2.0. Temporary data, structure initialised once.
 
   int nModeYUV;
@@ -121,7 +136,9 @@ public:
     int _overlapx, int _overlapy, const char* _outfilename, int _dctmode,
     int _divide, int _sadx264, sad_t _badSAD, int _badrange, bool _isse,
     bool _meander, bool temporal_flag, bool _tryMany, bool multi_flag,
-    bool mt_flag, int _chromaSADScale, IScriptEnvironment* env);
+    bool mt_flag, int _chromaSADScale, bool fprop_flag, bool sadcache_flag, sad_t _skipSAD,
+    bool adaptive_flag, bool phasecorr_flag, int analysis_scale, bool stats_flag,
+    IScriptEnvironment* env);
   ~MVAnalyse();
 
   ::PVideoFrame __stdcall	GetFrame(int n, ::IScriptEnvironment* env) override;
@@ -135,6 +152,7 @@ public:
 private:
 
   void load_src_frame(MVGroupOfFrames &gof, ::PVideoFrame &src, const MVAnalysisData &ana_data);
+  void scale_vectors(int *data_ptr, const MVAnalysisData &ana_data) const;
 };
 
 #endif
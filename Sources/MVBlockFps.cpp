@@ -30,6 +30,7 @@
 #include "profile.h"
 #include "SuperParams64Bits.h"
 #include "Time256ProviderCst.h"
+#include "fstb/AllocAlign.h"
 
 //#include <intrin.h>
 #include "math.h"
@@ -96,6 +97,14 @@ MVBlockFps::MVBlockFps(
   // get parameters of prepared super clip - v2.0
   SuperParams64Bits params;
   memcpy(&params, &super->GetVideoInfo().num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env->ThrowError("MBlockFps: super clip with ondemand=true is not supported");
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env->ThrowError("MBlockFps: super clip with virtualpad=true is not supported");
+  }
   int nHeightS = params.nHeight;
   nSuperHPad = params.nHPad;
   nSuperVPad = params.nVPad;
@@ -219,7 +228,7 @@ MVBlockFps::MVBlockFps(
   const int tmpBlkAlign = 16;
 
   nBlkPitch = AlignNumber(nBlkSizeX, tmpBlkAlign); // padded to 16 , 2.5.11.22
-  TmpBlock = (BYTE *)_aligned_malloc(nBlkPitch*nBlkSizeY*pixelsize_super, tmpBlkAlign); // new BYTE[nBlkPitch*nBlkSizeY*pixelsize_super]; // may be more padding?
+  TmpBlock = (BYTE *)fstb::AllocHuge::allocate(nBlkPitch*nBlkSizeY*pixelsize_super, tmpBlkAlign); // new BYTE[nBlkPitch*nBlkSizeY*pixelsize_super]; // may be more padding?
 
   int CPUF_Resize = env->GetCPUFlags();
 
@@ -246,10 +255,10 @@ MVBlockFps::MVBlockFps(
     // todo: rename to DstTemp and make BYTE *, cast later.
     // DstInt can hold 32 bit floats as well
     DestBufElementSize = pixelsize_super == 1 ? sizeof(short) : pixelsize_super == 2 ? sizeof(int) : sizeof(float);
-    DstShort = (uint16_t *)_aligned_malloc(dstShortPitch*nHeight * DestBufElementSize, tmpDstAlign); // PF aligned
+    DstShort = (uint16_t *)fstb::AllocHuge::allocate(dstShortPitch*nHeight * DestBufElementSize, tmpDstAlign); // PF aligned
     if (!isGrey) {
-      DstShortU = (uint16_t *)_aligned_malloc(dstShortPitchUV*nHeight * DestBufElementSize, tmpDstAlign);
-      DstShortV = (uint16_t *)_aligned_malloc(dstShortPitchUV*nHeight * DestBufElementSize, tmpDstAlign);
+      DstShortU = (uint16_t *)fstb::AllocHuge::allocate(dstShortPitchUV*nHeight * DestBufElementSize, tmpDstAlign);
+      DstShortV = (uint16_t *)fstb::AllocHuge::allocate(dstShortPitchUV*nHeight * DestBufElementSize, tmpDstAlign);
     }
   }
 }
@@ -273,7 +282,7 @@ MVBlockFps::~MVBlockFps()
   delete[] smallMaskB;
   delete[] smallMaskO;
 
-  _aligned_free(TmpBlock); // PF 161116
+  fstb::AllocHuge::deallocate(TmpBlock); // PF 161116
 
 
   if ((pixelType & VideoInfo::CS_YUY2) == VideoInfo::CS_YUY2 && !planar)
@@ -287,10 +296,10 @@ MVBlockFps::~MVBlockFps()
     delete OverWins;
     if (!isGrey)
       delete OverWinsUV;
-    _aligned_free(DstShort); // PF 161116
+    fstb::AllocHuge::deallocate(DstShort); // PF 161116
     if (!isGrey) {
-      _aligned_free(DstShortU);
-      _aligned_free(DstShortV);
+      fstb::AllocHuge::deallocate(DstShortU);
+      fstb::AllocHuge::deallocate(DstShortV);
     }
   }
 }
@@ -569,6 +578,8 @@ void MVBlockFps::ResultBlock(BYTE *pDst8, int dst_pitch, const BYTE * pMCB8, int
 
 PVideoFrame __stdcall MVBlockFps::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   int nWidth_B = nBlkX*(nBlkSizeX - nOverlapX) + nOverlapX;
   int nHeight_B = nBlkY*(nBlkSizeY - nOverlapY) + nOverlapY;
   int nHeightUV = nHeight / yRatioUVs[1];
@@ -17,6 +17,7 @@
 // Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
 // http://www.gnu.org/copyleft/gpl.html .
 
+#include "ClipFnc.h"
 #include "MVClip.h"
 
 #include <cassert>
@@ -147,6 +148,14 @@ int	MVClip::get_child_frame_index (int n) const
 
 
 
+// Identifies the vector stream, whatever the MVClip instance reading it
+const ::IClip *	MVClip::get_child_clip () const
+{
+  return (child.operator-> ());
+}
+
+
+
 ::PVideoFrame __stdcall MVClip::GetFrame (int n, IScriptEnvironment* env_ptr)
 {
   const int		child_n = get_child_frame_index (n);
@@ -212,11 +221,24 @@ void MVClip::Update (PVideoFrame &fn, IScriptEnvironment *env)
     env->ThrowError("MVTools: incompatible version of vector stream");
   }
 
-  // 17.05.22 filling from motion vector clip
-  const int		hs_i32 = header_size / sizeof(int);
-  pMv       += hs_i32;									// go to data - v1.8.1
-  data_size -= hs_i32;
-  const bool		ok_flag = FakeGroupOfPlanes::Update(pMv, data_size);	// fixed a bug with lost frames
+  const MVAnalysisData &	hdr =
+    *reinterpret_cast <const MVAnalysisData *> (pMv + 1);
+  const MVSceneStat *	stat_ptr = MVSceneStat::Read(
+    reinterpret_cast <const unsigned char *> (pMv), header_size
+  );
+  if ((hdr.nFlags & MOTION_VECTORS_IN_FRAMEPROP) != 0)
+  {
+    // vectors travel as frame property, read them in place
+    pMv = ClipFnc::get_vector_prop(fn, data_size, env);
+  }
+  else
+  {
+    // 17.05.22 filling from motion vector clip
+    const int		hs_i32 = header_size / sizeof(int);
+    pMv       += hs_i32;									// go to data - v1.8.1
+    data_size -= hs_i32;
+  }
+  const bool		ok_flag = FakeGroupOfPlanes::Update(pMv, data_size, stat_ptr);	// fixed a bug with lost frames
   if (! ok_flag)
   {
     env->ThrowError("MVTools: vector clip is too small (corrupted?)");
@@ -58,6 +58,7 @@ public :
    ~MVClip();
 
   int				get_child_frame_index (int n) const;
+  const ::IClip *	get_child_clip () const;
   void				update_analysis_data (const MVAnalysisData &adata);
 
   ::PVideoFrame __stdcall GetFrame (int n, IScriptEnvironment* env_ptr);
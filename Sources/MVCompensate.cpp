@@ -28,6 +28,7 @@
 #include "profile.h"
 #include "SuperParams64Bits.h"
 #include "Time256ProviderCst.h"
+#include "fstb/AllocAlign.h"
 
 #include	<mmintrin.h>
 
@@ -48,6 +49,7 @@ MVCompensate::MVCompensate(
   , _multi_flag(trad > 0)
   , _center_flag(center_flag)
   , _mt_flag(mt_flag)
+  , _kernel_info("MCompensate")
   //,	nLogxRatioUV (( xRatioUV == 2) ? 1 : 0) MVFilter has nLogxRatioUV
   //,	nLogyRatioUV ((yRatioUV == 2) ? 1 : 0)
   , _boundary_cnt_arr()
@@ -191,12 +193,51 @@ MVCompensate::MVCompensate(
 
   pRefGOF = new MVGroupOfFrames(nSuperLevels, nWidth, nHeight, nSuperPel, nSuperHPad, nSuperVPad, nSuperModeYUV, cpuFlags, xRatioUVs[1], yRatioUVs[1], pixelsize_super, bits_per_pixel_super, mt_flag);
   pSrcGOF = new MVGroupOfFrames(nSuperLevels, nWidth, nHeight, nSuperPel, nSuperHPad, nSuperVPad, nSuperModeYUV, cpuFlags, xRatioUVs[1], yRatioUVs[1], pixelsize_super, bits_per_pixel_super, mt_flag);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    // MSuper ondemand=true: sub-pixel blocks are interpolated while compensating
+    const int nSuperSharp = (params.param >> SUPER_PARAM_SHARP_SHIFT) & SUPER_PARAM_SHARP_MASK;
+    pRefGOF->set_interp(MVPlaneSet(nSuperModeYUV), 2, nSuperSharp);
+    pSrcGOF->set_interp(MVPlaneSet(nSuperModeYUV), 2, nSuperSharp);
+    pRefGOF->set_pel_on_demand(true);
+    pSrcGOF->set_pel_on_demand(true);
+  }
+  const bool virtual_pad_flag = ((params.param & SUPER_PARAM_VIRTUAL_PAD) != 0);
+  if (virtual_pad_flag)
+  {
+    // MSuper virtualpad=true: blocks crossing the frame borders are clamped
+    pRefGOF->set_virtual_pad(true);
+    pSrcGOF->set_virtual_pad(true);
+  }
+
+  {
+    const arch_t arch_cpu = KernelInfo::GetArch(env_ptr->GetCPUFlags());
+    const int bpp = bits_per_pixel_super;
+    const int psz = pixelsize_super;
+    const bool chroma_flag = (nSuperModeYUV & UVPLANES) != 0;
+    for (int p = 0; p < (chroma_flag ? 2 : 1); ++p)
+    {
+      const int w = (p == 0) ? nBlkSizeX : nBlkSizeX >> nLogxRatioUVs[1];
+      const int h = (p == 0) ? nBlkSizeY : nBlkSizeY >> nLogyRatioUVs[1];
+      _kernel_info.Add((p == 0) ? "Copy" : "Copy chroma", KernelInfo::Config(w, h, bpp), arch, arch_cpu,
+        [=](arch_t a) { return get_copy_function(w, h, psz, a); });
+      if (nOverlapX > 0 || nOverlapY > 0)
+      {
+        _kernel_info.Add((p == 0) ? "Overlaps" : "Overlaps chroma", KernelInfo::Config(w, h, bpp), arch, arch_cpu,
+          [=](arch_t a) { return get_overlaps_function(w, h, psz, false, a); });
+      }
+    }
+    _kernel_info.Publish();
+  }
+
+  nHPadStored = (virtual_pad_flag) ? 0 : nHPadding;
+  nVPadStored = (virtual_pad_flag) ? 0 : nVPadding;
   nSuperWidth = super->GetVideoInfo().width;
   nSuperHeight = super->GetVideoInfo().height;
 
   if (nHeight != nHeightS
     || nHeight != vi.height
-    || nWidth != nSuperWidth - nSuperHPad * 2
+    || nWidth != nSuperWidth - ((virtual_pad_flag) ? 0 : nSuperHPad * 2)
     || nWidth != vi.width
     || nPel != nSuperPel)
   {
@@ -217,10 +258,10 @@ MVCompensate::MVCompensate(
     if (!vi.IsY())
       OverWinsUV = new OverlapWindows(nBlkSizeX >> nLogxRatioUVs[1], nBlkSizeY >> nLogyRatioUVs[1], nOverlapX >> nLogxRatioUVs[1], nOverlapY >> nLogyRatioUVs[1]);
 
-    DstShort = (BYTE *)_aligned_malloc(dstShortPitch * nHeight *  ovrBufferElementSize, 32);
+    DstShort = (BYTE *)fstb::AllocHuge::allocate(dstShortPitch * nHeight *  ovrBufferElementSize, 32);
     if (!vi.IsY()) {
-      DstShortU = (BYTE *)_aligned_malloc(dstShortPitchUV * nHeight * ovrBufferElementSize, 32);
-      DstShortV = (BYTE *)_aligned_malloc(dstShortPitchUV * nHeight * ovrBufferElementSize, 32);
+      DstShortU = (BYTE *)fstb::AllocHuge::allocate(dstShortPitchUV * nHeight * ovrBufferElementSize, 32);
+      DstShortV = (BYTE *)fstb::AllocHuge::allocate(dstShortPitchUV * nHeight * ovrBufferElementSize, 32);
     }
   }
 
@@ -236,18 +277,18 @@ MVCompensate::MVCompensate(
       nLoopPitches[0] = AlignNumber(nSuperWidth * 2, 16);
       nLoopPitches[1] = nLoopPitches[0];
       nLoopPitches[2] = nLoopPitches[1];
-      pLoop[0] = (unsigned char *)_aligned_malloc(nLoopPitches[0] * nSuperHeight, 32);
+      pLoop[0] = (unsigned char *)fstb::AllocHuge::allocate(nLoopPitches[0] * nSuperHeight, 32);
       pLoop[1] = pLoop[0] + nSuperWidth;
       pLoop[2] = pLoop[1] + nSuperWidth / 2;
     }
     else
     {
       nLoopPitches[0] = AlignNumber(nSuperWidth*pixelsize_super, 32);
-      pLoop[0] = (unsigned char*)_aligned_malloc(nLoopPitches[0] * nSuperHeight, 32);
+      pLoop[0] = (unsigned char*)fstb::AllocHuge::allocate(nLoopPitches[0] * nSuperHeight, 32);
       if (!vi.IsY()) {
         nLoopPitches[1] = nLoopPitches[2] = AlignNumber((nSuperWidth >> nLogxRatioUVs[1]) * pixelsize_super, 32);
-        pLoop[1] = (unsigned char*)_aligned_malloc(nLoopPitches[1] * nSuperHeight, 32);
-        pLoop[2] = (unsigned char*)_aligned_malloc(nLoopPitches[2] * nSuperHeight, 32);
+        pLoop[1] = (unsigned char*)fstb::AllocHuge::allocate(nLoopPitches[1] * nSuperHeight, 32);
+        pLoop[2] = (unsigned char*)fstb::AllocHuge::allocate(nLoopPitches[2] * nSuperHeight, 32);
       }
     }
   }
@@ -265,10 +306,10 @@ MVCompensate::~MVCompensate()
     delete OverWins;
     if (!vi.IsY())
       delete OverWinsUV;
-    _aligned_free(DstShort);
+    fstb::AllocHuge::deallocate(DstShort);
     if (!vi.IsY()) {
-      _aligned_free(DstShortU);
-      _aligned_free(DstShortV);
+      fstb::AllocHuge::deallocate(DstShortU);
+      fstb::AllocHuge::deallocate(DstShortV);
     }
   }
   delete pRefGOF; // v2.0
@@ -276,17 +317,19 @@ MVCompensate::~MVCompensate()
 
   if (recursion > 0)
   {
-    _aligned_free(pLoop[0]);
+    fstb::AllocHuge::deallocate(pLoop[0]);
     if ((pixelType & VideoInfo::CS_YUY2) != VideoInfo::CS_YUY2 && !vi.IsY())
     {
-      _aligned_free(pLoop[1]);
-      _aligned_free(pLoop[2]);
+      fstb::AllocHuge::deallocate(pLoop[1]);
+      fstb::AllocHuge::deallocate(pLoop[2]);
     }
   }
 }
 
 PVideoFrame __stdcall MVCompensate::GetFrame(int n, IScriptEnvironment* env_ptr)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   int nsrc;
   int nvec;
   int vindex;
@@ -309,8 +352,8 @@ PVideoFrame __stdcall MVCompensate::GetFrame(int n, IScriptEnvironment* env_ptr)
   int nOffset[3];
 
   if (recursion > 0) {
-    nOffset[0] = (nHPadding << pixelsize_super_shift) + nVPadding * nLoopPitches[0];
-    nOffset[1] = nOffset[2] = ((nHPadding >> nLogxRatioUVs[1]) << pixelsize_super_shift) + (nVPadding >> nLogyRatioUVs[1]) * nLoopPitches[1];
+    nOffset[0] = (nHPadStored << pixelsize_super_shift) + nVPadStored * nLoopPitches[0];
+    nOffset[1] = nOffset[2] = ((nHPadStored >> nLogxRatioUVs[1]) << pixelsize_super_shift) + (nVPadStored >> nLogyRatioUVs[1]) * nLoopPitches[1];
   }
 
   PVideoFrame mvn = _mv_clip_ptr->GetFrame(nvec, env_ptr);
@@ -519,7 +562,7 @@ PVideoFrame __stdcall MVCompensate::GetFrame(int n, IScriptEnvironment* env_ptr)
       for (int i = 0; i < planecount; i++) {
         if (pPlanes[i])
           BitBlt(pDst[i] + ((nWidth_B >> nLogxRatioUVs[i]) << pixelsize_super_shift), nDstPitches[i],
-            pSrcMapped[i] + (((nWidth_B >> nLogxRatioUVs[i]) + (nHPadding >> nLogxRatioUVs[i])) << pixelsize_super_shift) + (nVPadding >> nLogyRatioUVs[i]) * pPitchesMapped[i], pPitchesMapped[i],
+            pSrcMapped[i] + (((nWidth_B >> nLogxRatioUVs[i]) + (nHPadStored >> nLogxRatioUVs[i])) << pixelsize_super_shift) + (nVPadStored >> nLogyRatioUVs[i]) * pPitchesMapped[i], pPitchesMapped[i],
             ((nWidth - nWidth_B) >> nLogxRatioUVs[i]) << pixelsize_super_shift, nHeight_B >> nLogyRatioUVs[i]);
       }
     }
@@ -529,7 +572,7 @@ PVideoFrame __stdcall MVCompensate::GetFrame(int n, IScriptEnvironment* env_ptr)
       for (int i = 0; i < planecount; i++) {
         if (pPlanes[i])
           BitBlt(pDst[i] + (nHeight_B >> nLogyRatioUVs[i])*nDstPitches[i], nDstPitches[i],
-            pSrcMapped[i] + ((nHPadding >> nLogxRatioUVs[i]) << pixelsize_super_shift) + ((nHeight_B + nVPadding) >> nLogyRatioUVs[i]) * pPitchesMapped[i], pPitchesMapped[i],
+            pSrcMapped[i] + ((nHPadStored >> nLogxRatioUVs[i]) << pixelsize_super_shift) + ((nHeight_B + nVPadStored) >> nLogyRatioUVs[i]) * pPitchesMapped[i], pPitchesMapped[i],
             (nWidth >> nLogxRatioUVs[i]) << pixelsize_super_shift, (nHeight - nHeight_B) >> nLogyRatioUVs[i]);
       }
         // PF fix 161117: nHPadding was not shifted for bottom padding, exists in 2.5.11.22??
@@ -609,8 +652,8 @@ PVideoFrame __stdcall MVCompensate::GetFrame(int n, IScriptEnvironment* env_ptr)
       }
     }
 
-    nOffset[0] = nHPadding * pixelsize_super + nVPadding * nSrcPitches[0];
-    nOffset[1] = nOffset[2] = (nHPadding >> nLogxRatioUV) * pixelsize_super + (nVPadding >> nLogyRatioUVs[1]) * nSrcPitches[1];
+    nOffset[0] = nHPadStored * pixelsize_super + nVPadStored * nSrcPitches[0];
+    nOffset[1] = nOffset[2] = (nHPadStored >> nLogxRatioUV) * pixelsize_super + (nVPadStored >> nLogyRatioUVs[1]) * nSrcPitches[1];
 
     for (int i = 0; i < planecount; i++) {
       env_ptr->BitBlt(pDst[i], nDstPitches[i], pSrc[i] + nOffset[i], nSrcPitches[i], (nWidth >> nLogxRatioUVs[i]) << pixelsize_super_shift, nHeight >> nLogyRatioUVs[i]);
@@ -645,6 +688,7 @@ PVideoFrame __stdcall MVCompensate::GetFrame(int n, IScriptEnvironment* env_ptr)
 void	MVCompensate::compensate_slice_normal(Slicer::TaskData &td)
 {
   assert(&td != 0);
+  MVPelBlockBuf  pel_buf[3];       // sub-pixel blocks of a super clip with ondemand=true
 
   BYTE *         pDstCur[3];
   const BYTE *   pSrcCur[3];
@@ -677,13 +721,13 @@ void	MVCompensate::compensate_slice_normal(Slicer::TaskData &td)
         // luma
         BLITLUMA(
           pDstCur[0] + xx, nDstPitches[0],
-          pPlanes[0]->GetPointer(blx, bly), pPlanes[0]->GetPitch()
+          pPlanes[0]->GetPointerBlock(blx, bly, nBlkSizeX, nBlkSizeY, pel_buf[0]), pPlanes[0]->GetPitch()
         );
         for (int i = 1; i < planecount; i++) {
           if (pPlanes[i])
           {
             BLITCHROMA(pDstCur[i] + (xx >> nLogxRatioUVs[i]), nDstPitches[i],
-              pPlanes[i]->GetPointer(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i]), pPlanes[i]->GetPitch()
+              pPlanes[i]->GetPointerBlock(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pPlanes[i]->GetPitch()
             );
           }
         }
@@ -695,13 +739,13 @@ void	MVCompensate::compensate_slice_normal(Slicer::TaskData &td)
 
         BLITLUMA(
           pDstCur[0] + xx, nDstPitches[0],
-          pSrcPlanes[0]->GetPointer(blxsrc, blysrc), pSrcPlanes[0]->GetPitch()
+          pSrcPlanes[0]->GetPointerBlock(blxsrc, blysrc, nBlkSizeX, nBlkSizeY, pel_buf[0]), pSrcPlanes[0]->GetPitch()
         );
         for (int i = 1; i < planecount; i++) {
           if (pSrcPlanes[i])
             BLITCHROMA(
               pDstCur[i] + (xx >> nLogxRatioUVs[i]), nDstPitches[i],
-              pSrcPlanes[i]->GetPointer(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i]), pSrcPlanes[i]->GetPitch()
+              pSrcPlanes[i]->GetPointerBlock(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pSrcPlanes[i]->GetPitch()
             );
         }
       }
@@ -765,6 +809,7 @@ void	MVCompensate::compensate_slice_overlap(Slicer::TaskData &td)
 
 void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
 {
+  MVPelBlockBuf  pel_buf[3];       // sub-pixel blocks of a super clip with ondemand=true
   int rowsizes[3];
 
   BYTE *pDstShorts[3];
@@ -827,14 +872,14 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
           // luma
           OVERSLUMA(
             (uint16_t *)(pDstShorts[0] + xx), dstShortPitches[0],
-            pPlanes[0]->GetPointer(blx, bly), pPlanes[0]->GetPitch(),
+            pPlanes[0]->GetPointerBlock(blx, bly, nBlkSizeX, nBlkSizeY, pel_buf[0]), pPlanes[0]->GetPitch(),
             winOver, nBlkSizeX
           );
           for (int i = 1; i < planecount; i++) {
             if (pPlanes[i])
               OVERSCHROMA(
               (uint16_t *)(pDstShorts[i] + (xx >> nLogxRatioUVs[i])), dstShortPitches[i],
-                pPlanes[i]->GetPointer(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i]), pPlanes[i]->GetPitch(),
+                pPlanes[i]->GetPointerBlock(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pPlanes[i]->GetPitch(),
                 winOverUV, nBlkSizeX >> nLogxRatioUVs[i]
               );
           }
@@ -843,7 +888,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
           // luma
           OVERSLUMA16(
             (uint16_t *)(pDstShorts[0] + xx), dstShortPitches[0],
-            pPlanes[0]->GetPointer(blx, bly), pPlanes[0]->GetPitch(),
+            pPlanes[0]->GetPointerBlock(blx, bly, nBlkSizeX, nBlkSizeY, pel_buf[0]), pPlanes[0]->GetPitch(),
             winOver, nBlkSizeX
           );
           // chroma uv
@@ -851,7 +896,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
             if (pPlanes[i])
               OVERSCHROMA16(
               (uint16_t *)(pDstShorts[i] + (xx >> nLogxRatioUVs[i])), dstShortPitches[i],
-                pPlanes[i]->GetPointer(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i]), pPlanes[i]->GetPitch(),
+                pPlanes[i]->GetPointerBlock(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pPlanes[i]->GetPitch(),
                 winOverUV, nBlkSizeX >> nLogxRatioUVs[i]
               );
           }
@@ -860,7 +905,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
      // luma
           OVERSLUMA32(
             (uint16_t *)(pDstShorts[0] + xx), dstShortPitches[0],
-            pPlanes[0]->GetPointer(blx, bly), pPlanes[0]->GetPitch(),
+            pPlanes[0]->GetPointerBlock(blx, bly, nBlkSizeX, nBlkSizeY, pel_buf[0]), pPlanes[0]->GetPitch(),
             winOver, nBlkSizeX
           );
           // chroma uv
@@ -868,7 +913,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
             if (pPlanes[i])
               OVERSCHROMA32(
               (uint16_t *)(pDstShorts[i] + (xx >> nLogxRatioUVs[i])), dstShortPitches[i],
-                pPlanes[i]->GetPointer(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i]), pPlanes[i]->GetPitch(),
+                pPlanes[i]->GetPointerBlock(blx >> nLogxRatioUVs[i], bly >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pPlanes[i]->GetPitch(),
                 winOverUV, nBlkSizeX >> nLogxRatioUVs[i]
               );
           }
@@ -884,7 +929,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
         if (pixelsize_super == 1) {
           OVERSLUMA(
             (uint16_t *)(pDstShorts[0] + xx), dstShortPitches[0],
-            pSrcPlanes[0]->GetPointer(blxsrc, blysrc), pSrcPlanes[0]->GetPitch(),
+            pSrcPlanes[0]->GetPointerBlock(blxsrc, blysrc, nBlkSizeX, nBlkSizeY, pel_buf[0]), pSrcPlanes[0]->GetPitch(),
             winOver, nBlkSizeX
           );
           // chroma uv
@@ -892,7 +937,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
             if (pSrcPlanes[i])
               OVERSCHROMA(
               (uint16_t *)(pDstShorts[i] + (xx >> nLogxRatioUVs[i])), dstShortPitches[i],
-                pSrcPlanes[i]->GetPointer(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i]), pSrcPlanes[i]->GetPitch(),
+                pSrcPlanes[i]->GetPointerBlock(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pSrcPlanes[i]->GetPitch(),
                 winOverUV, nBlkSizeX >> nLogxRatioUVs[i]
               );
           }
@@ -901,7 +946,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
           // pixelsize == 2
           OVERSLUMA16(
             (uint16_t *)(pDstShorts[0] + xx), dstShortPitches[0],
-            pSrcPlanes[0]->GetPointer(blxsrc, blysrc), pSrcPlanes[0]->GetPitch(),
+            pSrcPlanes[0]->GetPointerBlock(blxsrc, blysrc, nBlkSizeX, nBlkSizeY, pel_buf[0]), pSrcPlanes[0]->GetPitch(),
             winOver, nBlkSizeX
           );
           // chroma uv
@@ -909,7 +954,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
             if (pSrcPlanes[i])
               OVERSCHROMA16(
               (uint16_t *)(pDstShorts[i] + (xx >> nLogxRatioUVs[i])), dstShortPitches[i],
-                pSrcPlanes[i]->GetPointer(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i]), pSrcPlanes[i]->GetPitch(),
+                pSrcPlanes[i]->GetPointerBlock(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pSrcPlanes[i]->GetPitch(),
                 winOverUV, nBlkSizeX >> nLogxRatioUVs[i]
               );
           }
@@ -917,7 +962,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
         else { // if (pixelsize_super == 4)
           OVERSLUMA32(
             (uint16_t *)(pDstShorts[0] + xx), dstShortPitches[0],
-            pSrcPlanes[0]->GetPointer(blxsrc, blysrc), pSrcPlanes[0]->GetPitch(),
+            pSrcPlanes[0]->GetPointerBlock(blxsrc, blysrc, nBlkSizeX, nBlkSizeY, pel_buf[0]), pSrcPlanes[0]->GetPitch(),
             winOver, nBlkSizeX
           );
           // chroma uv
@@ -925,7 +970,7 @@ void	MVCompensate::compensate_slice_overlap(int y_beg, int y_end)
             if (pSrcPlanes[i])
               OVERSCHROMA32(
               (uint16_t *)(pDstShorts[i] + (xx >> nLogxRatioUVs[i])), dstShortPitches[i],
-              pSrcPlanes[i]->GetPointer(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i]), pSrcPlanes[i]->GetPitch(),
+              pSrcPlanes[i]->GetPointerBlock(blxsrc >> nLogxRatioUVs[i], blysrc >> nLogyRatioUVs[i], nBlkSizeX >> nLogxRatioUVs[i], nBlkSizeY >> nLogyRatioUVs[i], pel_buf[i]), pSrcPlanes[i]->GetPitch(),
               winOverUV, nBlkSizeX >> nLogxRatioUVs[i]
             );
           }
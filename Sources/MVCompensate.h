@@ -3,6 +3,7 @@
 
 #include	"conc/AtomicInt.h"
 #include "CopyCode.h"
+#include "KernelInfo.h"
 #include	"MTSlicer.h"
 #include "MVClip.h"
 #include "MVFilter.h"
@@ -93,6 +94,8 @@ private:
   int nSuperHeight;
   int nSuperHPad;
   int nSuperVPad;
+  int nHPadStored; // padding in the super frame, 0 with virtual padding
+  int nVPadStored;
   MVGroupOfFrames *pRefGOF;
   MVGroupOfFrames *pSrcGOF;
 
@@ -105,6 +108,7 @@ private:
   bool           _center_flag;  // Indicates if the output frames should be in the order -tr, ..., -1, C, +1, ..., +tr (true) or -1, +1, -2, +2,..., -tr, +tr (false).
 
   bool           _mt_flag;
+  KernelInfo     _kernel_info;  // selected kernels, for MToolsInfo()
 
   // Processing variables
   MVClip *       _mv_clip_ptr;  // Vector clip used to process this frame
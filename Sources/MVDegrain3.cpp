@@ -32,6 +32,7 @@
 #include <stdint.h>
 #include <commonfunctions.h>
 #include "def.h"
+#include "fstb/AllocAlign.h"
 
 //#include	<mmintrin.h>
 
@@ -50,8 +51,6 @@ Denoise1to6Function* MVDegrainX::get_denoise123_function(int BlockX, int BlockY,
   const int DEGRAIN_TYPE_32BIT = 32;
 
   constexpr int OUT32_MARKER = 128;
-  // BlkSizeX, BlkSizeY, degrain_type, level_of_MDegrain, arch_t
-  std::map<std::tuple<int, int, int, int, arch_t>, Denoise1to6Function*> func_degrain;
   using std::make_tuple;
 
   int type_to_search;
@@ -74,7 +73,10 @@ Denoise1to6Function* MVDegrainX::get_denoise123_function(int BlockX, int BlockY,
 
   if (out32_flag)
     type_to_search |= OUT32_MARKER;
-  // level 1-6, 8bit C, 8bit lsb C, 16 bit C (same for all, no blocksize templates)
+  // BlkSizeX, BlkSizeY, degrain_type, level_of_MDegrain, arch_t
+  static const std::map<std::tuple<int, int, int, int, arch_t>, Denoise1to6Function*> func_degrain_table = [&]() {
+    std::map<std::tuple<int, int, int, int, arch_t>, Denoise1to6Function*> func_degrain;
+    // level 1-6, 8bit C, 8bit lsb C, 16 bit C (same for all, no blocksize templates)
 #define MAKE_FN_LEVEL(x, y, level) \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT, level, NO_SIMD)] = Degrain1to6_C<uint8_t, 0, level>; \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT_STACKED, level, NO_SIMD)] = Degrain1to6_C<uint8_t, 1, level>; \
@@ -92,65 +94,65 @@ MAKE_FN_LEVEL(x,y,3) \
 MAKE_FN_LEVEL(x,y,4) \
 MAKE_FN_LEVEL(x,y,5) \
 MAKE_FN_LEVEL(x,y,6)
-  MAKE_FN(64, 64)
-    MAKE_FN(64, 48)
-    MAKE_FN(64, 32)
-    MAKE_FN(64, 16)
-    MAKE_FN(48, 64)
-    MAKE_FN(48, 48)
-    MAKE_FN(48, 24)
-    MAKE_FN(48, 12)
-    MAKE_FN(32, 64)
-    MAKE_FN(32, 32)
-    MAKE_FN(32, 24)
-    MAKE_FN(32, 16)
-    MAKE_FN(32, 8)
-    MAKE_FN(24, 48)
-    MAKE_FN(24, 32)
-    MAKE_FN(24, 24)
-    MAKE_FN(24, 12)
-    MAKE_FN(24, 6)
-    MAKE_FN(16, 64)
-    MAKE_FN(16, 32)
-    MAKE_FN(16, 16)
-    MAKE_FN(16, 12)
-    MAKE_FN(16, 8)
-    MAKE_FN(16, 4)
-    MAKE_FN(16, 2)
-    MAKE_FN(16, 1)
-    MAKE_FN(12, 48)
-    MAKE_FN(12, 24)
-    MAKE_FN(12, 16)
-    MAKE_FN(12, 12)
-    MAKE_FN(12, 6)
-    MAKE_FN(12, 3)
-    MAKE_FN(8, 32)
-    MAKE_FN(8, 16)
-    MAKE_FN(8, 8)
-    MAKE_FN(8, 4)
-    MAKE_FN(8, 2)
-MAKE_FN(8, 1)
-MAKE_FN(6, 24)
-MAKE_FN(6, 12)
-MAKE_FN(6, 6)
-MAKE_FN(6, 3)
-MAKE_FN(4, 8)
-MAKE_FN(4, 4)
-MAKE_FN(4, 2)
-MAKE_FN(4, 1)
-MAKE_FN(3, 6)
-MAKE_FN(3, 3)
-MAKE_FN(2, 4)
-MAKE_FN(2, 2)
-MAKE_FN(2, 1)
+    MAKE_FN(64, 64)
+      MAKE_FN(64, 48)
+      MAKE_FN(64, 32)
+      MAKE_FN(64, 16)
+      MAKE_FN(48, 64)
+      MAKE_FN(48, 48)
+      MAKE_FN(48, 24)
+      MAKE_FN(48, 12)
+      MAKE_FN(32, 64)
+      MAKE_FN(32, 32)
+      MAKE_FN(32, 24)
+      MAKE_FN(32, 16)
+      MAKE_FN(32, 8)
+      MAKE_FN(24, 48)
+      MAKE_FN(24, 32)
+      MAKE_FN(24, 24)
+      MAKE_FN(24, 12)
+      MAKE_FN(24, 6)
+      MAKE_FN(16, 64)
+      MAKE_FN(16, 32)
+      MAKE_FN(16, 16)
+      MAKE_FN(16, 12)
+      MAKE_FN(16, 8)
+      MAKE_FN(16, 4)
+      MAKE_FN(16, 2)
+      MAKE_FN(16, 1)
+      MAKE_FN(12, 48)
+      MAKE_FN(12, 24)
+      MAKE_FN(12, 16)
+      MAKE_FN(12, 12)
+      MAKE_FN(12, 6)
+      MAKE_FN(12, 3)
+      MAKE_FN(8, 32)
+      MAKE_FN(8, 16)
+      MAKE_FN(8, 8)
+      MAKE_FN(8, 4)
+      MAKE_FN(8, 2)
+  MAKE_FN(8, 1)
+  MAKE_FN(6, 24)
+  MAKE_FN(6, 12)
+  MAKE_FN(6, 6)
+  MAKE_FN(6, 3)
+  MAKE_FN(4, 8)
+  MAKE_FN(4, 4)
+  MAKE_FN(4, 2)
+  MAKE_FN(4, 1)
+  MAKE_FN(3, 6)
+  MAKE_FN(3, 3)
+  MAKE_FN(2, 4)
+  MAKE_FN(2, 2)
+  MAKE_FN(2, 1)
 #undef MAKE_FN
 #undef MAKE_FN_LEVEL
 
-// 8 bit sse2 degrain function (mmx is replaced with sse2 for x86 width 4)
-// and 16 bit SSE4 function
-// for no_template_by_y: special height==0 -> internally nHeight comes from variable (for C: both width and height is variable)
-// Degrain1to6_avx2: not worth, probably the excessive ymm register saving prolog and epilog overhead?
-//                   above fixed (no manual vzeroupper!) not worth, 
+  // 8 bit sse2 degrain function (mmx is replaced with sse2 for x86 width 4)
+  // and 16 bit SSE4 function
+  // for no_template_by_y: special height==0 -> internally nHeight comes from variable (for C: both width and height is variable)
+  // Degrain1to6_avx2: not worth, probably the excessive ymm register saving prolog and epilog overhead?
+  //                   above fixed (no manual vzeroupper!) not worth, 
 #define MAKE_FN_LEVEL(x, y, level, yy) \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT, level, USE_SSE2)] = Degrain1to6_sse2<x, yy, 0, level>; \
 func_degrain[make_tuple(x, y, DEGRAIN_TYPE_8BIT, level, USE_AVX2)] = Degrain1to6_avx2<x, yy, 0, level>; \
@@ -171,59 +173,61 @@ MAKE_FN_LEVEL(x,y,4, yy) \
 MAKE_FN_LEVEL(x,y,5, yy) \
 MAKE_FN_LEVEL(x,y,6, yy)
 
-MAKE_FN(64, 64, 0)
-MAKE_FN(64, 48, 0)
-MAKE_FN(64, 32, 0)
-MAKE_FN(64, 16, 0)
-MAKE_FN(48, 64, 0)
-MAKE_FN(48, 48, 0)
-MAKE_FN(48, 24, 0)
-MAKE_FN(48, 12, 0)
-MAKE_FN(32, 64, 0)
-MAKE_FN(32, 32, 0)
-MAKE_FN(32, 24, 0)
-MAKE_FN(32, 16, 0)
-MAKE_FN(32, 8, 0)
-MAKE_FN(24, 48, 0)
-MAKE_FN(24, 32, 0)
-MAKE_FN(24, 24, 0)
-MAKE_FN(24, 12, 0)
-MAKE_FN(24, 6, 0)
-MAKE_FN(16, 64, 0)
-MAKE_FN(16, 32, 0)
-MAKE_FN(16, 16, 0)
-MAKE_FN(16, 12, 0)
-MAKE_FN(16, 8, 0)
-MAKE_FN(16, 4, 4)
-MAKE_FN(16, 2, 2)
-MAKE_FN(16, 1, 1)
-MAKE_FN(12, 48, 0)
-MAKE_FN(12, 24, 0)
-MAKE_FN(12, 16, 0)
-MAKE_FN(12, 12, 0)
-MAKE_FN(12, 6, 6)
-MAKE_FN(12, 3, 3)
-MAKE_FN(8, 32, 0)
-MAKE_FN(8, 16, 0)
-MAKE_FN(8, 8, 8)
-MAKE_FN(8, 4, 4)
-MAKE_FN(8, 2, 2)
-MAKE_FN(8, 1, 1)
-MAKE_FN(6, 24, 0)
-MAKE_FN(6, 12, 0)
-MAKE_FN(6, 6, 6)
-MAKE_FN(6, 3, 3)
-MAKE_FN(4, 8, 8)
-MAKE_FN(4, 4, 4)
-MAKE_FN(4, 2, 2)
-MAKE_FN(4, 1, 1)
-MAKE_FN(3, 6, 6)
-MAKE_FN(3, 3, 3)
-MAKE_FN(2, 4, 4)
-MAKE_FN(2, 2, 2)
-MAKE_FN(2, 1, 1)
+  MAKE_FN(64, 64, 0)
+  MAKE_FN(64, 48, 0)
+  MAKE_FN(64, 32, 0)
+  MAKE_FN(64, 16, 0)
+  MAKE_FN(48, 64, 0)
+  MAKE_FN(48, 48, 0)
+  MAKE_FN(48, 24, 0)
+  MAKE_FN(48, 12, 0)
+  MAKE_FN(32, 64, 0)
+  MAKE_FN(32, 32, 0)
+  MAKE_FN(32, 24, 0)
+  MAKE_FN(32, 16, 0)
+  MAKE_FN(32, 8, 0)
+  MAKE_FN(24, 48, 0)
+  MAKE_FN(24, 32, 0)
+  MAKE_FN(24, 24, 0)
+  MAKE_FN(24, 12, 0)
+  MAKE_FN(24, 6, 0)
+  MAKE_FN(16, 64, 0)
+  MAKE_FN(16, 32, 0)
+  MAKE_FN(16, 16, 0)
+  MAKE_FN(16, 12, 0)
+  MAKE_FN(16, 8, 0)
+  MAKE_FN(16, 4, 4)
+  MAKE_FN(16, 2, 2)
+  MAKE_FN(16, 1, 1)
+  MAKE_FN(12, 48, 0)
+  MAKE_FN(12, 24, 0)
+  MAKE_FN(12, 16, 0)
+  MAKE_FN(12, 12, 0)
+  MAKE_FN(12, 6, 6)
+  MAKE_FN(12, 3, 3)
+  MAKE_FN(8, 32, 0)
+  MAKE_FN(8, 16, 0)
+  MAKE_FN(8, 8, 8)
+  MAKE_FN(8, 4, 4)
+  MAKE_FN(8, 2, 2)
+  MAKE_FN(8, 1, 1)
+  MAKE_FN(6, 24, 0)
+  MAKE_FN(6, 12, 0)
+  MAKE_FN(6, 6, 6)
+  MAKE_FN(6, 3, 3)
+  MAKE_FN(4, 8, 8)
+  MAKE_FN(4, 4, 4)
+  MAKE_FN(4, 2, 2)
+  MAKE_FN(4, 1, 1)
+  MAKE_FN(3, 6, 6)
+  MAKE_FN(3, 3, 3)
+  MAKE_FN(2, 4, 4)
+  MAKE_FN(2, 2, 2)
+  MAKE_FN(2, 1, 1)
 #undef MAKE_FN
 #undef MAKE_FN_LEVEL
+    return func_degrain;
+  }();
 
   Denoise1to6Function* result = nullptr;
   arch_t archlist[] = { USE_AVX2, USE_AVX, USE_SSE41, USE_SSE2, NO_SIMD };
@@ -231,7 +235,7 @@ MAKE_FN(2, 1, 1)
   while (result == nullptr) {
     arch_t current_arch_try = archlist[index++];
     if (current_arch_try > arch) continue;
-    result = func_degrain[make_tuple(BlockX, BlockY, type_to_search, _level, current_arch_try)];
+    result = find_function(func_degrain_table, make_tuple(BlockX, BlockY, type_to_search, _level, current_arch_try));
     if (result == nullptr && current_arch_try == NO_SIMD)
       break;
   }
@@ -267,6 +271,7 @@ MVDegrainX::MVDegrainX(
   , level( _level )
   , DstPlanes(0)
   , SrcPlanes(0)
+  , kernel_info("MDegrain" + std::to_string(_level))
 {
 
   has_at_least_v8 = true;
@@ -380,6 +385,14 @@ MVDegrainX::MVDegrainX(
   // get parameters of prepared super clip - v2.0
   SuperParams64Bits params;
   memcpy(&params, &vi_super.num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env_ptr->ThrowError("MDegrain%d: super clip with ondemand=true is not supported", level);
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env_ptr->ThrowError("MDegrain%d: super clip with virtualpad=true is not supported", level);
+  }
   int nHeightS = params.nHeight;
   int nSuperHPad = params.nHPad;
   int nSuperVPad = params.nVPad;
@@ -436,15 +449,15 @@ MVDegrainX::MVDegrainX(
     OverWins = new OverlapWindows(nBlkSizeX, nBlkSizeY, nOverlapX, nOverlapY);
     OverWinsUV = new OverlapWindows(nBlkSizeX >> nLogxRatioUV_super, nBlkSizeY >> nLogyRatioUV_super, nOverlapX >> nLogxRatioUV_super, nOverlapY >> nLogyRatioUV_super);
     if (out32_flag) {
-      DstInt = (int*)_aligned_malloc(dstIntPitch * nHeight * sizeof(float), 32); // also for float sizeof(int)==sizeof(float)
+      DstInt = (int*)fstb::AllocHuge::allocate(dstIntPitch * nHeight * sizeof(float), 32); // also for float sizeof(int)==sizeof(float)
     }
     else if (lsb_flag || pixelsize_output > 1)
     {
-      DstInt = (int *)_aligned_malloc(dstIntPitch * nHeight * sizeof(int), 32); // also for float sizeof(int)==sizeof(float)
+      DstInt = (int *)fstb::AllocHuge::allocate(dstIntPitch * nHeight * sizeof(int), 32); // also for float sizeof(int)==sizeof(float)
     }
     else
     {
-      DstShort = (uint16_t *)_aligned_malloc(dstShortPitch * nHeight * sizeof(short), 32); 
+      DstShort = (uint16_t *)fstb::AllocHuge::allocate(dstShortPitch * nHeight * sizeof(short), 32); 
     }
   }
 
@@ -489,6 +502,42 @@ MVDegrainX::MVDegrainX(
   if (!DEGRAINCHROMA)
     env_ptr->ThrowError("MDegrain%d : no valid DEGRAINCHROMA function for %dx%d, bitsperpixel=%d, lsb_flag=%d, level=%d", level, nBlkSizeX, nBlkSizeY, bits_per_pixel_super, (int)lsb_flag, level);
 
+  {
+    const arch_t arch_cpu = KernelInfo::GetArch(env_ptr->GetCPUFlags());
+    const int bx = nBlkSizeX;
+    const int by = nBlkSizeY;
+    const int bxc = nBlkSizeX >> nLogxRatioUV_super;
+    const int byc = nBlkSizeY >> nLogyRatioUV_super;
+    const int bpp = bits_per_pixel_super;
+    const bool chroma_flag = (YUVplanes & (UPLANE | VPLANE)) != 0;
+    kernel_info.Add("Degrain", KernelInfo::Config(bx, by, bpp), arch, arch_cpu,
+      [=](arch_t a) { return get_denoise123_function(bx, by, bpp, lsb_flag, out16_flag, out32_flag, level, a); });
+    if (chroma_flag)
+    {
+      kernel_info.Add("Degrain chroma", KernelInfo::Config(bxc, byc, bpp), arch, arch_cpu,
+        [=](arch_t a) { return get_denoise123_function(bxc, byc, bpp, lsb_flag, out16_flag, out32_flag, level, a); });
+    }
+    if (nOverlapX > 0 || nOverlapY > 0)
+    {
+      // same selection as the processing: lsb, then output pixel size
+      const int ovr_size = out16_flag ? 2 : pixelsize_super;
+      const int ovr_bpp = out16_flag ? 16 : bpp;
+      for (int p = 0; p < (chroma_flag ? 2 : 1); ++p)
+      {
+        const int w = (p == 0) ? bx : bxc;
+        const int h = (p == 0) ? by : byc;
+        const char *name = (p == 0) ? "Overlaps" : "Overlaps chroma";
+        if (lsb_flag)
+          kernel_info.Add(name, KernelInfo::Config(w, h, 16) + " lsb", NO_SIMD, arch_cpu,
+            [=](arch_t a) { return get_overlaps_lsb_function(w, h, sizeof(uint8_t), a); });
+        else
+          kernel_info.Add(name, KernelInfo::Config(w, h, ovr_bpp) + (out32_flag ? " out32" : ""), arch, arch_cpu,
+            [=](arch_t a) { return get_overlaps_function(w, h, ovr_size, out32_flag, a); });
+      }
+    }
+    kernel_info.Publish();
+  }
+
   switch (level) {
   case 1: NORMWEIGHTS = norm_weights<1>; break;
   case 2: NORMWEIGHTS = norm_weights<2>; break;
@@ -500,7 +549,7 @@ MVDegrainX::MVDegrainX(
 
   // max blocksize = 32, 170507: 64 (moved to const)
   const int		tmp_size = MAX_BLOCK_SIZE * MAX_BLOCK_SIZE * (out32_flag ? sizeof(float) : pixelsize_super);
-  tmpBlock = (uint8_t *)_aligned_malloc(tmp_size * height_lsb_or_out16_mul, 64); // new BYTE[tmp_size * height_lsb_or_out16_mul]; PF. 16.10.26
+  tmpBlock = (uint8_t *)fstb::AllocHuge::allocate(tmp_size * height_lsb_or_out16_mul, 64); // new BYTE[tmp_size * height_lsb_or_out16_mul]; PF. 16.10.26
   tmpBlockLsb = (lsb_flag) ? (tmpBlock + tmp_size) : 0;
 
   if ((cpuFlags & CPUF_SSE2) != 0)
@@ -560,10 +609,10 @@ MVDegrainX::~MVDegrainX()
   {
     delete OverWins;
     delete OverWinsUV;
-    _aligned_free(DstShort);
-    _aligned_free(DstInt);
+    fstb::AllocHuge::deallocate(DstShort);
+    fstb::AllocHuge::deallocate(DstInt);
   }
-  _aligned_free(tmpBlock);
+  fstb::AllocHuge::deallocate(tmpBlock);
   for (int i = 0; i < level; i++) {
     delete pRefBGOF[i];
     delete pRefFGOF[i];
@@ -587,6 +636,8 @@ static void plane_copy_8_to_16_c(uint8_t *dstp, int dstpitch, const uint8_t *src
 
 PVideoFrame __stdcall MVDegrainX::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   int nWidth_B = nBlkX*(nBlkSizeX - nOverlapX) + nOverlapX;
   int nHeight_B = nBlkY*(nBlkSizeY - nOverlapY) + nOverlapY;
 
@@ -2,6 +2,7 @@
 #define __MV_DEGRAIN3__
 
 #include "CopyCode.h"
+#include "KernelInfo.h"
 #include "MVClip.h"
 #include "MVFilter.h"
 #include "overlap.h"
@@ -99,6 +100,8 @@ private:
   int dstIntPitch;
 
   const int level;
+
+  KernelInfo kernel_info; // selected kernels, for MToolsInfo()
   int framenumber;
 
 public:
@@ -438,6 +438,8 @@ void MVDepan::RejectBadBlocks(transform tr, float blockDx[], float blockDy[], sa
 
 PVideoFrame __stdcall MVDepan::GetFrame(int ndest, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
 //	isBackward = false;
 //	bool ifZoom = true;
 //	bool ifRot = true;
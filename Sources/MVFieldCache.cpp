@@ -0,0 +1,149 @@
+// Full frame vector fields shared between filter instances
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#include "MVFieldCache.h"
+#include "commonfunctions.h"
+#include "fstb/AllocAlign.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+std::mutex MVFieldCache::_registry_mtx;
+std::vector<std::weak_ptr<MVFieldCache> > MVFieldCache::_registry;
+
+
+
+bool MVFieldCache::Geometry::operator == (const Geometry &other) const
+{
+  return memcmp(this, &other, sizeof(*this)) == 0;
+}
+
+
+
+// Same layout as the former per-instance buffers: X and Y adjacent,
+// 128-byte aligned slots with a margin.
+MVFieldCache::Field::Field(const Geometry &geom)
+  : VXSmallUV(nullptr)
+  , VYSmallUV(nullptr)
+  , VXFullUV(nullptr)
+  , VYFullUV(nullptr)
+  , ready(false)
+{
+  const size_t sz_small = AlignNumber<size_t>(sizeof(short) * geom.nBlkXP*geom.nBlkYP + 128, 128);
+  const size_t sz_full_y = AlignNumber<size_t>(sizeof(short) * geom.nHeightP*geom.VPitchY + 128, 128);
+  const size_t sz_small_uv = geom.chroma ? sz_small : 0;
+  const size_t sz_full_uv = geom.chroma ? AlignNumber<size_t>(sizeof(short) * geom.nHeightPUV*geom.VPitchUV + 128, 128) : 0;
+  const size_t sz_arena = 2 * (sz_small + sz_small_uv + sz_full_y + sz_full_uv);
+  arena = (BYTE*)fstb::AllocHuge::allocate(sz_arena, 128);
+  if (arena == nullptr)
+    throw std::bad_alloc();
+
+  BYTE *pos = arena;
+  VXSmallY = (short*)pos; pos += sz_small;
+  VYSmallY = (short*)pos; pos += sz_small;
+  if (geom.chroma)
+  {
+    VXSmallUV = (short*)pos; pos += sz_small;
+    VYSmallUV = (short*)pos; pos += sz_small;
+  }
+  VXFullY = (short*)pos; pos += sz_full_y;
+  VYFullY = (short*)pos; pos += sz_full_y;
+  if (geom.chroma)
+  {
+    VXFullUV = (short*)pos; pos += sz_full_uv;
+    VYFullUV = (short*)pos; pos += sz_full_uv;
+  }
+  assert(pos == arena + sz_arena);
+}
+
+
+
+MVFieldCache::Field::~Field()
+{
+  fstb::AllocHuge::deallocate(arena);
+}
+
+
+
+std::shared_ptr<MVFieldCache> MVFieldCache::Use(const void *clip_id, const Geometry &geom)
+{
+  std::lock_guard<std::mutex> lock(_registry_mtx);
+
+  _registry.erase(
+    std::remove_if(_registry.begin(), _registry.end(),
+      [](const std::weak_ptr<MVFieldCache> &w) { return w.expired(); }),
+    _registry.end()
+  );
+
+  for (auto &w : _registry)
+  {
+    std::shared_ptr<MVFieldCache> cache = w.lock();
+    if (cache && cache->_clip_id == clip_id && cache->_geom == geom)
+      return cache;
+  }
+
+  std::shared_ptr<MVFieldCache> cache = std::make_shared<MVFieldCache>(clip_id, geom);
+  _registry.push_back(cache);
+
+  return cache;
+}
+
+
+
+MVFieldCache::MVFieldCache(const void *clip_id, const Geometry &geom)
+  : _clip_id(clip_id)
+  , _geom(geom)
+{
+}
+
+
+
+MVFieldCache::FieldSPtr MVFieldCache::Get(int n, const MakeFunc &make_field)
+{
+  FieldSPtr field;
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+
+    auto it = std::find_if(_fields.begin(), _fields.end(),
+      [n](const std::pair<int, FieldSPtr> &f) { return f.first == n; });
+    if (it != _fields.end())
+    {
+      field = it->second;
+      _fields.erase(it);
+    }
+    else
+    {
+      field = std::make_shared<Field>(_geom);
+      if (_fields.size() >= CAPACITY)
+        _fields.pop_front();
+    }
+    _fields.push_back(std::make_pair(n, field));
+  }
+
+  // planes are computed out of the cache lock
+  std::lock_guard<std::mutex> lock(field->mtx);
+  if (!field->ready)
+  {
+    make_field(*field);
+    field->ready = true;
+  }
+
+  return field;
+}
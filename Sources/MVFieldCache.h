@@ -0,0 +1,112 @@
+// Full frame vector fields shared between filter instances
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#ifndef __MV_MVFieldCache__
+#define __MV_MVFieldCache__
+
+#include "types.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Vector planes (block and full resolution, X and Y) derived from the frames
+// of a vector clip. With AviSynth+ MT, consecutive output frames using the
+// same vector frame land on different filter instances. The instances
+// reading the same vector clip with the same geometry share one cache, so
+// each vector frame is upsized once.
+// Fields are reference-counted: an evicted field stays valid for the
+// instances still using it.
+class MVFieldCache
+{
+public:
+
+  // Everything the derived planes depend on, besides the vector data.
+  // Only ints, compared as a whole.
+  struct Geometry
+  {
+    int nBlkX, nBlkY;
+    int nBlkXP, nBlkYP;
+    int nWidth, nHeight;
+    int nWidthP, nHeightP;
+    int nWidthUV, nHeightUV;
+    int nWidthPUV, nHeightPUV;
+    int VPitchY, VPitchUV;
+    int nPel;
+    int xRatioUV, yRatioUV;
+    int chroma; // distinct chroma planes
+
+    bool operator == (const Geometry &other) const;
+  };
+
+  class Field
+  {
+  public:
+    explicit Field(const Geometry &geom);
+    ~Field();
+
+    short *VXSmallY;
+    short *VYSmallY;
+    short *VXSmallUV;
+    short *VYSmallUV;
+    short *VXFullY;
+    short *VYFullY;
+    short *VXFullUV;
+    short *VYFullUV;
+
+  private:
+    friend class MVFieldCache;
+
+    Field(const Field &other) = delete;
+    Field &operator = (const Field &other) = delete;
+
+    BYTE *arena;
+    std::mutex mtx; // held while the planes are computed
+    bool ready;
+  };
+  typedef std::shared_ptr<Field> FieldSPtr;
+  typedef std::function<void(Field &field)> MakeFunc;
+
+  // Cache shared by all the users of the vector clip with this geometry
+  static std::shared_ptr<MVFieldCache> Use(const void *clip_id, const Geometry &geom);
+
+  explicit MVFieldCache(const void *clip_id, const Geometry &geom);
+
+  // Field of the vector clip frame n. make_field fills it on the first
+  // request; concurrent requests for the same frame wait for it.
+  // If make_field throws, the field is left for the next request to fill.
+  FieldSPtr Get(int n, const MakeFunc &make_field);
+
+private:
+
+  enum { CAPACITY = 8 }; // fields kept after their last use
+
+  const void *_clip_id;
+  const Geometry _geom;
+
+  std::mutex _mtx;
+  std::deque<std::pair<int, FieldSPtr> > _fields; // most recently used last
+
+  static std::mutex _registry_mtx;
+  static std::vector<std::weak_ptr<MVFieldCache> > _registry;
+};
+
+#endif // __MV_MVFieldCache__
@@ -26,6 +26,7 @@
 
 
 MVFilter::MVFilter(const PClip &vector, const char *filterName, IScriptEnvironment *env, int group_len, int group_ofs)
+  : _mem_info(filterName)
 {
   if (vector == 0)
     env->ThrowError("Error in %s : vector clip must be specified", filterName); //v1.8
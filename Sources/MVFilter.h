@@ -21,6 +21,8 @@
 
 
 
+#include "MemInfo.h"
+
 class IScriptEnvironment;
 class PClip;
 
@@ -80,6 +82,9 @@ protected:
 //   std::string name;
    const char * name; //v1.8 replaced std::string (why it was used?)
 
+   // Constructed before the members of the filter, which are charged to it
+   MemInfo _mem_info;
+
   MVFilter(const ::PClip &vector, const char *filterName, ::IScriptEnvironment *env, int group_len, int group_ofs);
 
   void CheckSimilarity(const MVClip &vector, const char *vectorName, ::IScriptEnvironment *env);
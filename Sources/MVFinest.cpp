@@ -40,6 +40,14 @@ GenericVideoFilter(_super)
   // get parameters of prepared super clip - v2.0
   SuperParams64Bits params;
   memcpy(&params, &child->GetVideoInfo().num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env->ThrowError("MFinest: super clip with ondemand=true is not supported");
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env->ThrowError("MFinest: super clip with virtualpad=true is not supported");
+  }
   int nHeightS = params.nHeight;
   nSuperHPad = params.nHPad;
   nSuperVPad = params.nVPad;
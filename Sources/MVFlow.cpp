@@ -24,6 +24,7 @@
 #include "MVFlow.h"
 #include "SuperParams64Bits.h"
 #include "commonfunctions.h"
+#include "fstb/AllocAlign.h"
 
 MVFlow::MVFlow(PClip _child, PClip super, PClip _mvec, int _time256, int _mode, bool _fields,
   sad_t nSCD1, int nSCD2, bool _isse, bool _planar, PClip _timeclip, IScriptEnvironment* env) :
@@ -44,6 +45,14 @@ MVFlow::MVFlow(PClip _child, PClip super, PClip _mvec, int _time256, int _mode,
 
   SuperParams64Bits params;
   memcpy(&params, &super->GetVideoInfo().num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env->ThrowError("MFlow: super clip with ondemand=true is not supported");
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env->ThrowError("MFlow: super clip with virtualpad=true is not supported");
+  }
   int nHeightS = params.nHeight;
   int nSuperHPad = params.nHPad;
   //int nSuperVPad = params.nVPad;
@@ -123,18 +132,18 @@ MVFlow::MVFlow(PClip _child, PClip super, PClip _mvec, int _time256, int _mode,
   //needDistinctChroma = !is444 && !isGrey && !isRGB;
 
   // 128 align: something about pentium cache line
-  VXFullY = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFullY = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
+  VXFullY = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
+  VYFullY = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
   if (!isGrey) {
-    VYFullUV = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-    VXFullUV = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
+    VYFullUV = (short*)fstb::AllocHuge::allocate(2 * nHeightPUV*VPitchUV + 128, 128);
+    VXFullUV = (short*)fstb::AllocHuge::allocate(2 * nHeightPUV*VPitchUV + 128, 128);
   }
 
-  VXSmallY = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallY = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+  VXSmallY = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+  VYSmallY = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   if (!isGrey) {
-    VXSmallUV = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUV = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+    VXSmallUV = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+    VYSmallUV = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   }
 
   upsizer = new SimpleResize(nWidthP, nHeightP, nBlkXP, nBlkYP, cpuFlags);
@@ -158,17 +167,17 @@ MVFlow::~MVFlow()
   if(!isGrey)
     delete upsizerUV;
 
-  _aligned_free(VXFullY);
-  _aligned_free(VYFullY);
+  fstb::AllocHuge::deallocate(VXFullY);
+  fstb::AllocHuge::deallocate(VYFullY);
   if (!isGrey) {
-    _aligned_free(VXFullUV);
-    _aligned_free(VYFullUV);
+    fstb::AllocHuge::deallocate(VXFullUV);
+    fstb::AllocHuge::deallocate(VYFullUV);
   }
-  _aligned_free(VXSmallY);
-  _aligned_free(VYSmallY);
+  fstb::AllocHuge::deallocate(VXSmallY);
+  fstb::AllocHuge::deallocate(VYSmallY);
   if (!isGrey) {
-    _aligned_free(VXSmallUV);
-    _aligned_free(VYSmallUV);
+    fstb::AllocHuge::deallocate(VXSmallUV);
+    fstb::AllocHuge::deallocate(VYSmallUV);
   }
 }
 
@@ -279,6 +288,8 @@ void MVFlow::Fetch_NPel(BYTE * pdst8, int dst_pitch, const BYTE *pref8, int ref_
 //-------------------------------------------------------------------------
 PVideoFrame __stdcall MVFlow::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   PVideoFrame dst, ref;
   BYTE *pDst[3];
   const BYTE *pRef[3];
@@ -23,6 +23,7 @@
 #include "MVFlowBlur.h"
 #include "SuperParams64Bits.h"
 #include "commonfunctions.h"
+#include "fstb/AllocAlign.h"
 
 
 MVFlowBlur::MVFlowBlur(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, int _blur256, int _prec,
@@ -49,6 +50,14 @@ MVFlowBlur::MVFlowBlur(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, int
 
   SuperParams64Bits params;
   memcpy(&params, &super->GetVideoInfo().num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env->ThrowError("MFlowBlur: super clip with ondemand=true is not supported");
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env->ThrowError("MFlowBlur: super clip with virtualpad=true is not supported");
+  }
   int nHeightS = params.nHeight;
   int nSuperHPad = params.nHPad;
   //int nSuperVPad = params.nVPad;
@@ -114,43 +123,43 @@ MVFlowBlur::MVFlowBlur(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, int
   isRGB = vi.IsPlanarRGB() || vi.IsPlanarRGBA(); // planar only
   //needDistinctChroma = !is444 && !isGrey && !isRGB;
 
-  VXFullYB = (short*)_aligned_malloc(2 * nHeight*VPitchY + 128, 128);
-  VYFullYB = (short*)_aligned_malloc(2 * nHeight*VPitchY + 128, 128);
+  VXFullYB = (short*)fstb::AllocHuge::allocate(2 * nHeight*VPitchY + 128, 128);
+  VYFullYB = (short*)fstb::AllocHuge::allocate(2 * nHeight*VPitchY + 128, 128);
   if (!isGrey) {
-    VXFullUVB = (short*)_aligned_malloc(2 * nHeightUV*VPitchUV + 128, 128);
-    VYFullUVB = (short*)_aligned_malloc(2 * nHeightUV*VPitchUV + 128, 128);
+    VXFullUVB = (short*)fstb::AllocHuge::allocate(2 * nHeightUV*VPitchUV + 128, 128);
+    VYFullUVB = (short*)fstb::AllocHuge::allocate(2 * nHeightUV*VPitchUV + 128, 128);
   }
 
-  VXFullYF = (short*)_aligned_malloc(2 * nHeight*VPitchY + 128, 128);
-  VYFullYF = (short*)_aligned_malloc(2 * nHeight*VPitchY + 128, 128);
+  VXFullYF = (short*)fstb::AllocHuge::allocate(2 * nHeight*VPitchY + 128, 128);
+  VYFullYF = (short*)fstb::AllocHuge::allocate(2 * nHeight*VPitchY + 128, 128);
   if (!isGrey) {
-    VXFullUVF = (short*)_aligned_malloc(2 * nHeightUV*VPitchUV + 128, 128);
-    VYFullUVF = (short*)_aligned_malloc(2 * nHeightUV*VPitchUV + 128, 128);
+    VXFullUVF = (short*)fstb::AllocHuge::allocate(2 * nHeightUV*VPitchUV + 128, 128);
+    VYFullUVF = (short*)fstb::AllocHuge::allocate(2 * nHeightUV*VPitchUV + 128, 128);
   }
 
-  VXSmallYB = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
-  VYSmallYB = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
+  VXSmallYB = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
+  VYSmallYB = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
   if (!isGrey) {
-    VXSmallUVB = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
-    VYSmallUVB = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
+    VXSmallUVB = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
+    VYSmallUVB = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
   }
 
-  VXSmallYF = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
-  VYSmallYF = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
+  VXSmallYF = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
+  VYSmallYF = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
   if (!isGrey) {
-    VXSmallUVF = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
-    VYSmallUVF = (short*)_aligned_malloc(2 * nBlkX*nBlkY + 128, 128);
+    VXSmallUVF = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
+    VYSmallUVF = (short*)fstb::AllocHuge::allocate(2 * nBlkX*nBlkY + 128, 128);
   }
 
-  MaskSmallB = (unsigned char*)_aligned_malloc(nBlkX*nBlkY + 128, 128);
-  MaskFullYB = (unsigned char*)_aligned_malloc(nHeight*VPitchY + 128, 128);
+  MaskSmallB = (unsigned char*)fstb::AllocHuge::allocate(nBlkX*nBlkY + 128, 128);
+  MaskFullYB = (unsigned char*)fstb::AllocHuge::allocate(nHeight*VPitchY + 128, 128);
   if (!isGrey)
-    MaskFullUVB = (unsigned char*)_aligned_malloc(nHeightUV*VPitchUV + 128, 128);
+    MaskFullUVB = (unsigned char*)fstb::AllocHuge::allocate(nHeightUV*VPitchUV + 128, 128);
 
-  MaskSmallF = (unsigned char*)_aligned_malloc(nBlkX*nBlkY + 128, 128);
-  MaskFullYF = (unsigned char*)_aligned_malloc(nHeight*VPitchY + 128, 128);
+  MaskSmallF = (unsigned char*)fstb::AllocHuge::allocate(nBlkX*nBlkY + 128, 128);
+  MaskFullYF = (unsigned char*)fstb::AllocHuge::allocate(nHeight*VPitchY + 128, 128);
   if (!isGrey)
-    MaskFullUVF = (unsigned char*)_aligned_malloc(nHeightUV*VPitchUV + 128, 128);
+    MaskFullUVF = (unsigned char*)fstb::AllocHuge::allocate(nHeightUV*VPitchUV + 128, 128);
 
   upsizer = new SimpleResize(nWidth, nHeight, nBlkX, nBlkY, cpuFlags);
   if (!isGrey) 
@@ -173,38 +182,38 @@ MVFlowBlur::~MVFlowBlur()
   if(!isGrey)
     delete upsizerUV;
 
-  _aligned_free(VXFullYB);
-  _aligned_free(VYFullYB);
+  fstb::AllocHuge::deallocate(VXFullYB);
+  fstb::AllocHuge::deallocate(VYFullYB);
   if (!isGrey) {
-    _aligned_free(VXFullUVB);
-    _aligned_free(VYFullUVB);
+    fstb::AllocHuge::deallocate(VXFullUVB);
+    fstb::AllocHuge::deallocate(VYFullUVB);
   }
-  _aligned_free(VXSmallYB);
-  _aligned_free(VYSmallYB);
+  fstb::AllocHuge::deallocate(VXSmallYB);
+  fstb::AllocHuge::deallocate(VYSmallYB);
   if (!isGrey) {
-    _aligned_free(VXSmallUVB);
-    _aligned_free(VYSmallUVB);
+    fstb::AllocHuge::deallocate(VXSmallUVB);
+    fstb::AllocHuge::deallocate(VYSmallUVB);
   }
-  _aligned_free(VXFullYF);
-  _aligned_free(VYFullYF);
+  fstb::AllocHuge::deallocate(VXFullYF);
+  fstb::AllocHuge::deallocate(VYFullYF);
   if (!isGrey) {
-    _aligned_free(VXFullUVF);
-    _aligned_free(VYFullUVF);
+    fstb::AllocHuge::deallocate(VXFullUVF);
+    fstb::AllocHuge::deallocate(VYFullUVF);
   }
-  _aligned_free(VXSmallYF);
-  _aligned_free(VYSmallYF);
+  fstb::AllocHuge::deallocate(VXSmallYF);
+  fstb::AllocHuge::deallocate(VYSmallYF);
   if (!isGrey) {
-    _aligned_free(VXSmallUVF);
-    _aligned_free(VYSmallUVF);
+    fstb::AllocHuge::deallocate(VXSmallUVF);
+    fstb::AllocHuge::deallocate(VYSmallUVF);
   }
-  _aligned_free(MaskSmallB);
-  _aligned_free(MaskFullYB);
+  fstb::AllocHuge::deallocate(MaskSmallB);
+  fstb::AllocHuge::deallocate(MaskFullYB);
   if (!isGrey)
-    _aligned_free(MaskFullUVB);
-  _aligned_free(MaskSmallF);
-  _aligned_free(MaskFullYF);
+    fstb::AllocHuge::deallocate(MaskFullUVB);
+  fstb::AllocHuge::deallocate(MaskSmallF);
+  fstb::AllocHuge::deallocate(MaskFullYF);
   if (!isGrey)
-    _aligned_free(MaskFullUVF);
+    fstb::AllocHuge::deallocate(MaskFullUVF);
 }
 
 template<typename pixel_t, int nLOGPEL>
@@ -286,6 +295,8 @@ void MVFlowBlur::FlowBlur(BYTE * pdst8, int dst_pitch, const BYTE *pref8, int re
 //-------------------------------------------------------------------------
 PVideoFrame __stdcall MVFlowBlur::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   PVideoFrame dst;
   BYTE *pDst[3];
   const BYTE *pRef[3];
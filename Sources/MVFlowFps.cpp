@@ -25,6 +25,9 @@
 #include "profile.h"
 #include "SuperParams64Bits.h"
 #include "info.h"
+#include "fstb/AllocAlign.h"
+
+#include <new>
 
 
 MVFlowFps::MVFlowFps(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, unsigned int _num, unsigned int _den, int _maskmode, double _ml,
@@ -96,6 +99,14 @@ MVFlowFps::MVFlowFps(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, unsign
     // get parameters of prepared super clip - v2.0
   SuperParams64Bits params;
   memcpy(&params, &super->GetVideoInfo().num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env->ThrowError("MFlowFps: super clip with ondemand=true is not supported");
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env->ThrowError("MFlowFps: super clip with virtualpad=true is not supported");
+  }
   int nHeightS = params.nHeight;
   int nSuperHPad = params.nHPad;
   //int nSuperVPad = params.nVPad;
@@ -178,84 +189,60 @@ MVFlowFps::MVFlowFps(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, unsign
   isRGB = vi.IsPlanarRGB() || vi.IsPlanarRGBA(); // planar only
   needDistinctChroma = !is444 && !isGrey && !isRGB;
 
-  // 2*: sizeof(short)
-  VXFullYB = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFullYB = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  if (needDistinctChroma) {
-    VYFullUVB = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-    VXFullUVB = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-  }
-
-  VXFullYF = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFullYF = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  if (needDistinctChroma) {
-    VXFullUVF = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-    VYFullUVF = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-  }
-
-  VXSmallYB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  if (needDistinctChroma) {
-    VXSmallUVB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  }
-
-  VXSmallYF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  if (needDistinctChroma) {
-    VXSmallUVF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  }
-
-  VXFullYBB = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFullYBB = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  if (needDistinctChroma) {
-    VXFullUVBB = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-    VYFullUVBB = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-  }
-
-  VXFullYFF = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFullYFF = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  if (needDistinctChroma) {
-    VXFullUVFF = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-    VYFullUVFF = (short*)_aligned_malloc(2 * nHeightPUV*VPitchUV + 128, 128);
-  }
-
-  VXSmallYBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  if (needDistinctChroma) {
-    VXSmallUVBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  }
-
-  VXSmallYFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  if (needDistinctChroma) {
-    VXSmallUVFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  }
-
+  // The vector fields depend only on the vector frame and the geometry.
+  // They are shared with the other instances (MT) and with the BB and FF
+  // fields of the neighbour frames, used by maskmode=2.
+  MVFieldCache::Geometry geom;
+  geom.nBlkX = nBlkX;
+  geom.nBlkY = nBlkY;
+  geom.nBlkXP = nBlkXP;
+  geom.nBlkYP = nBlkYP;
+  geom.nWidth = nWidth;
+  geom.nHeight = nHeight;
+  geom.nWidthP = nWidthP;
+  geom.nHeightP = nHeightP;
+  geom.nWidthUV = nWidthUV;
+  geom.nHeightUV = nHeightUV;
+  geom.nWidthPUV = nWidthPUV;
+  geom.nHeightPUV = nHeightPUV;
+  geom.VPitchY = VPitchY;
+  geom.VPitchUV = VPitchUV;
+  geom.nPel = nPel;
+  geom.xRatioUV = xRatioUVs[1];
+  geom.yRatioUV = yRatioUVs[1];
+  geom.chroma = needDistinctChroma ? 1 : 0;
+  fieldCacheB = MVFieldCache::Use(mvClipB.get_child_clip(), geom);
+  fieldCacheF = MVFieldCache::Use(mvClipF.get_child_clip(), geom);
+
+  // The occlusion masks depend on the time and stay per instance,
+  // in a single block.
   // PF remark: masks are 8 bits
-  MaskSmallB = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
-  MaskFullYB = (unsigned char*)_aligned_malloc(nHeightP*VPitchY + 128, 128);
-  if(needDistinctChroma)
-    MaskFullUVB = (unsigned char*)_aligned_malloc(nHeightPUV*VPitchUV + 128, 128);
-
-  MaskSmallF = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
-  MaskFullYF = (unsigned char*)_aligned_malloc(nHeightP*VPitchY + 128, 128);
-  if(needDistinctChroma)
-    MaskFullUVF = (unsigned char*)_aligned_malloc(nHeightPUV*VPitchUV + 128, 128);
-
-  SADMaskSmallB = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
-  SADMaskSmallF = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
+  const size_t sz_mask_small = AlignNumber<size_t>(nBlkXP*nBlkYP + 128, 128);
+  const size_t sz_mask_y = AlignNumber<size_t>(nHeightP*VPitchY + 128, 128);
+  const size_t sz_mask_uv = needDistinctChroma ? AlignNumber<size_t>(nHeightPUV*VPitchUV + 128, 128) : 0;
+  arena_size = 2 * (sz_mask_small + sz_mask_y + sz_mask_uv);
+  arena = (BYTE*)fstb::AllocHuge::allocate(arena_size, 128);
+  if (arena == nullptr)
+    throw std::bad_alloc();
+
+  BYTE *pos = arena;
+  auto carve = [&pos](size_t sz) {
+    BYTE *ptr = (sz > 0) ? pos : nullptr;
+    pos += sz;
+    return ptr;
+  };
+  MaskSmallB = carve(sz_mask_small);
+  MaskFullYB = carve(sz_mask_y);
+  MaskFullUVB = carve(sz_mask_uv);
+  MaskSmallF = carve(sz_mask_small);
+  MaskFullYF = carve(sz_mask_y);
+  MaskFullUVF = carve(sz_mask_uv);
+  assert(pos == arena + arena_size);
 
   upsizer = new SimpleResize(nWidthP, nHeightP, nBlkXP, nBlkYP, cpuFlags);
   if(needDistinctChroma)
     upsizerUV = new SimpleResize(nWidthPUV, nHeightPUV, nBlkXP, nBlkYP, cpuFlags);
 
-  nleftLast = -1000;
-  nrightLast = -1000;
-
   if ((pixelType & VideoInfo::CS_YUY2) == VideoInfo::CS_YUY2 && !planar)
   {
     DstPlanes = new YUY2Planes(nWidth, nHeight);
@@ -274,80 +261,42 @@ MVFlowFps::~MVFlowFps()
   if(needDistinctChroma)
     delete upsizerUV;
 
-  _aligned_free(MaskSmallB);
-  _aligned_free(MaskFullYB);
-  if(needDistinctChroma)
-    _aligned_free(MaskFullUVB);
-  _aligned_free(MaskSmallF);
-  _aligned_free(MaskFullYF);
-  if (needDistinctChroma)
-    _aligned_free(MaskFullUVF);
-
-  _aligned_free(VXFullYB);
-  _aligned_free(VYFullYB);
-  if (needDistinctChroma) {
-    _aligned_free(VYFullUVB);
-    _aligned_free(VXFullUVB);
-  }
-
-  _aligned_free(VXFullYF);
-  _aligned_free(VYFullYF);
-  if (needDistinctChroma) {
-    _aligned_free(VXFullUVF);
-    _aligned_free(VYFullUVF);
-  }
+  fstb::AllocHuge::deallocate(arena);
 
-  _aligned_free(VXSmallYB);
-  _aligned_free(VYSmallYB);
-  if (needDistinctChroma) {
-    _aligned_free(VXSmallUVB);
-    _aligned_free(VYSmallUVB);
-  }
-
-  _aligned_free(VXSmallYF);
-  _aligned_free(VYSmallYF);
-  if (needDistinctChroma) {
-    _aligned_free(VXSmallUVF);
-    _aligned_free(VYSmallUVF);
-  }
+}
 
-  _aligned_free(VXFullYBB);
-  _aligned_free(VYFullYBB);
-  if (needDistinctChroma) {
-    _aligned_free(VXFullUVBB);
-    _aligned_free(VYFullUVBB);
-  }
+// Vector planes of the current vector frame, upsized to full frame size
+void MVFlowFps::MakeVectorField(MVClip &mvClip, MVFieldCache::Field &field)
+{
+  PROFILE_START(MOTION_PROFILE_MASK);
+  // make  vector vx and vy small masks
+  MakeVectorSmallMasks(mvClip, nBlkX, nBlkY, field.VXSmallY, nBlkXP, field.VYSmallY, nBlkXP);
 
-  _aligned_free(VXSmallYBB);
-  _aligned_free(VYSmallYBB);
-  if (needDistinctChroma) {
-    _aligned_free(VXSmallUVBB);
-    _aligned_free(VYSmallUVBB);
-  }
+  CheckAndPadSmallY(field.VXSmallY, field.VYSmallY, nBlkXP, nBlkYP, nBlkX, nBlkY);
 
-  _aligned_free(VXFullYFF);
-  _aligned_free(VYFullYFF);
   if (needDistinctChroma) {
-    _aligned_free(VXFullUVFF);
-    _aligned_free(VYFullUVFF);
+    VectorSmallMaskYToHalfUV(field.VXSmallY, nBlkXP, nBlkYP, field.VXSmallUV, xRatioUVs[1]);
+    VectorSmallMaskYToHalfUV(field.VYSmallY, nBlkXP, nBlkYP, field.VYSmallUV, yRatioUVs[1]);
   }
 
+  PROFILE_STOP(MOTION_PROFILE_MASK);
+  // upsize (bilinear interpolate) vector masks to fullframe size
+  PROFILE_START(MOTION_PROFILE_RESIZE);
 
-  _aligned_free(VXSmallYFF);
-  _aligned_free(VYSmallYFF);
+  upsizer->SimpleResizeDo_int16(field.VXFullY, nWidthP, nHeightP, VPitchY, field.VXSmallY, nBlkXP, nBlkXP, nPel, true, nWidth, nHeight);
+  upsizer->SimpleResizeDo_int16(field.VYFullY, nWidthP, nHeightP, VPitchY, field.VYSmallY, nBlkXP, nBlkXP, nPel, false, nWidth, nHeight);
   if (needDistinctChroma) {
-    _aligned_free(VXSmallUVFF);
-    _aligned_free(VYSmallUVFF);
+    upsizerUV->SimpleResizeDo_int16(field.VXFullUV, nWidthPUV, nHeightPUV, VPitchUV, field.VXSmallUV, nBlkXP, nBlkXP, nPel, true, nWidthUV, nHeightUV);
+    upsizerUV->SimpleResizeDo_int16(field.VYFullUV, nWidthPUV, nHeightPUV, VPitchUV, field.VYSmallUV, nBlkXP, nBlkXP, nPel, false, nWidthUV, nHeightUV);
   }
-
-  _aligned_free(SADMaskSmallB);
-  _aligned_free(SADMaskSmallF);
-
+  PROFILE_STOP(MOTION_PROFILE_RESIZE);
 }
 
 //-------------------------------------------------------------------------
 PVideoFrame __stdcall MVFlowFps::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   if (reentrancy_check) {
     env->ThrowError("MFlowFps: error in frame %d: Previous GetFrame did not finished properly. There was a crash or filter was set to reentrant multithread mode!", n);
   }
@@ -498,32 +447,14 @@ PVideoFrame __stdcall MVFlowFps::GetFrame(int n, IScriptEnvironment* env)
     int nOffsetY = nRefPitches[0] * nVPadding*nPel + nHPadding*nPel*pixelsize_super;
     int nOffsetUV = nRefPitches[1] * nVPaddingUV*nPel + nHPaddingUV*nPel*pixelsize_super;
 
-    if (nright != nrightLast)
-    {
-      PROFILE_START(MOTION_PROFILE_MASK);
-      // make  vector vx and vy small masks
-      MakeVectorSmallMasks(mvClipB, nBlkX, nBlkY, VXSmallYB, nBlkXP, VYSmallYB, nBlkXP);
-
-      CheckAndPadSmallY(VXSmallYB, VYSmallYB, nBlkXP, nBlkYP, nBlkX, nBlkY);
-
-      if (needDistinctChroma) {
-        VectorSmallMaskYToHalfUV(VXSmallYB, nBlkXP, nBlkYP, VXSmallUVB, xRatioUVs[1]);
-        VectorSmallMaskYToHalfUV(VYSmallYB, nBlkXP, nBlkYP, VYSmallUVB, yRatioUVs[1]);
-      }
-
-      PROFILE_STOP(MOTION_PROFILE_MASK);
-      // upsize (bilinear interpolate) vector masks to fullframe size
-      PROFILE_START(MOTION_PROFILE_RESIZE);
+    // vector fields, shared with the other instances reading the same vectors
+    MVFieldCache::FieldSPtr fieldB = fieldCacheB->Get(mvClipB.get_child_frame_index(nleft),
+      [this](MVFieldCache::Field &field) { MakeVectorField(mvClipB, field); });
+    short *VXFullYB = fieldB->VXFullY;
+    short *VYFullYB = fieldB->VYFullY;
+    short *VXFullUVB = fieldB->VXFullUV;
+    short *VYFullUVB = fieldB->VYFullUV;
 
-      upsizer->SimpleResizeDo_int16(VXFullYB, nWidthP, nHeightP, VPitchY, VXSmallYB, nBlkXP, nBlkXP, nPel, true, nWidth, nHeight);
-      upsizer->SimpleResizeDo_int16(VYFullYB, nWidthP, nHeightP, VPitchY, VYSmallYB, nBlkXP, nBlkXP, nPel, false, nWidth, nHeight);
-      if (needDistinctChroma) {
-        upsizerUV->SimpleResizeDo_int16(VXFullUVB, nWidthPUV, nHeightPUV, VPitchUV, VXSmallUVB, nBlkXP, nBlkXP, nPel, true, nWidthUV, nHeightUV);
-        upsizerUV->SimpleResizeDo_int16(VYFullUVB, nWidthPUV, nHeightPUV, VPitchUV, VYSmallUVB, nBlkXP, nBlkXP, nPel, false, nWidthUV, nHeightUV);
-      }
-      PROFILE_STOP(MOTION_PROFILE_RESIZE);
-
-    }
    // analyse vectors field to detect occlusion
    // Backward part
     PROFILE_START(MOTION_PROFILE_MASK);
@@ -539,35 +470,14 @@ PVideoFrame __stdcall MVFlowFps::GetFrame(int n, IScriptEnvironment* env)
       upsizerUV->SimpleResizeDo_uint8(MaskFullUVB, nWidthPUV, nHeightPUV, VPitchUV, MaskSmallB, nBlkXP, nBlkXP);
     PROFILE_STOP(MOTION_PROFILE_RESIZE);
 
-    nrightLast = nright;
-
     // Forward part
-    if (nleft != nleftLast)
-    {
-     // make  vector vx and vy small masks
-      PROFILE_START(MOTION_PROFILE_MASK);
-      MakeVectorSmallMasks(mvClipF, nBlkX, nBlkY, VXSmallYF, nBlkXP, VYSmallYF, nBlkXP);
+    MVFieldCache::FieldSPtr fieldF = fieldCacheF->Get(mvClipF.get_child_frame_index(nright),
+      [this](MVFieldCache::Field &field) { MakeVectorField(mvClipF, field); });
+    short *VXFullYF = fieldF->VXFullY;
+    short *VYFullYF = fieldF->VYFullY;
+    short *VXFullUVF = fieldF->VXFullUV;
+    short *VYFullUVF = fieldF->VYFullUV;
 
-      CheckAndPadSmallY(VXSmallYF, VYSmallYF, nBlkXP, nBlkYP, nBlkX, nBlkY);
-
-      if (needDistinctChroma) {
-        VectorSmallMaskYToHalfUV(VXSmallYF, nBlkXP, nBlkYP, VXSmallUVF, xRatioUVs[1]);
-        VectorSmallMaskYToHalfUV(VYSmallYF, nBlkXP, nBlkYP, VYSmallUVF, yRatioUVs[1]);
-      }
-
-      PROFILE_STOP(MOTION_PROFILE_MASK);
-      // upsize (bilinear interpolate) vector masks to fullframe size
-      PROFILE_START(MOTION_PROFILE_RESIZE);
-
-      upsizer->SimpleResizeDo_int16(VXFullYF, nWidthP, nHeightP, VPitchY, VXSmallYF, nBlkXP, nBlkXP, nPel, true, nWidth, nHeight);
-      upsizer->SimpleResizeDo_int16(VYFullYF, nWidthP, nHeightP, VPitchY, VYSmallYF, nBlkXP, nBlkXP, nPel, false, nWidth, nHeight);
-      if (needDistinctChroma) {
-        upsizerUV->SimpleResizeDo_int16(VXFullUVF, nWidthPUV, nHeightPUV, VPitchUV, VXSmallUVF, nBlkXP, nBlkXP, nPel, true, nWidthUV, nHeightUV);
-        upsizerUV->SimpleResizeDo_int16(VYFullUVF, nWidthPUV, nHeightPUV, VPitchUV, VYSmallUVF, nBlkXP, nBlkXP, nPel, false, nWidthUV, nHeightUV);
-      }
-      PROFILE_STOP(MOTION_PROFILE_RESIZE);
-
-    }
    // analyse vectors field to detect occlusion
    // Forward part
     PROFILE_START(MOTION_PROFILE_MASK);
@@ -583,8 +493,6 @@ PVideoFrame __stdcall MVFlowFps::GetFrame(int n, IScriptEnvironment* env)
       upsizerUV->SimpleResizeDo_uint8(MaskFullUVF, nWidthPUV, nHeightPUV, VPitchUV, MaskSmallF, nBlkXP, nBlkXP);
     PROFILE_STOP(MOTION_PROFILE_RESIZE);
 
-    nleftLast = nleft;
-
     // Backward and forward is ready
 
   // Get motion info from more frames for occlusion areas
@@ -603,36 +511,19 @@ PVideoFrame __stdcall MVFlowFps::GetFrame(int n, IScriptEnvironment* env)
     if (maskmode == 2 && isUsableB && isUsableF) // slow method with extra frames
     {
      // get vector mask from extra frames
-      PROFILE_START(MOTION_PROFILE_MASK);
-      MakeVectorSmallMasks(mvClipB, nBlkX, nBlkY, VXSmallYBB, nBlkXP, VYSmallYBB, nBlkXP);
-      MakeVectorSmallMasks(mvClipF, nBlkX, nBlkY, VXSmallYFF, nBlkXP, VYSmallYFF, nBlkXP);
-
-      CheckAndPadSmallY_BF(VXSmallYBB, VXSmallYFF, VYSmallYBB, VYSmallYFF, nBlkXP, nBlkYP, nBlkX, nBlkY);
-
-      if (needDistinctChroma) {
-        VectorSmallMaskYToHalfUV(VXSmallYBB, nBlkXP, nBlkYP, VXSmallUVBB, xRatioUVs[1]);
-        VectorSmallMaskYToHalfUV(VYSmallYBB, nBlkXP, nBlkYP, VYSmallUVBB, yRatioUVs[1]);
-        VectorSmallMaskYToHalfUV(VXSmallYFF, nBlkXP, nBlkYP, VXSmallUVFF, xRatioUVs[1]);
-        VectorSmallMaskYToHalfUV(VYSmallYFF, nBlkXP, nBlkYP, VYSmallUVFF, yRatioUVs[1]);
-      }
-      PROFILE_STOP(MOTION_PROFILE_MASK);
-
-      PROFILE_START(MOTION_PROFILE_RESIZE);
-    // upsize vectors to full frame
-      upsizer->SimpleResizeDo_int16(VXFullYBB, nWidthP, nHeightP, VPitchY, VXSmallYBB, nBlkXP, nBlkXP, nPel, true, nWidth, nHeight);
-      upsizer->SimpleResizeDo_int16(VYFullYBB, nWidthP, nHeightP, VPitchY, VYSmallYBB, nBlkXP, nBlkXP, nPel, false, nWidth, nHeight);
-      if (needDistinctChroma) {
-        upsizerUV->SimpleResizeDo_int16(VXFullUVBB, nWidthPUV, nHeightPUV, VPitchUV, VXSmallUVBB, nBlkXP, nBlkXP, nPel, true, nWidthUV, nHeightUV);
-        upsizerUV->SimpleResizeDo_int16(VYFullUVBB, nWidthPUV, nHeightPUV, VPitchUV, VYSmallUVBB, nBlkXP, nBlkXP, nPel, false, nWidthUV, nHeightUV);
-      }
-
-      upsizer->SimpleResizeDo_int16(VXFullYFF, nWidthP, nHeightP, VPitchY, VXSmallYFF, nBlkXP, nBlkXP, nPel, true, nWidth, nHeight);
-      upsizer->SimpleResizeDo_int16(VYFullYFF, nWidthP, nHeightP, VPitchY, VYSmallYFF, nBlkXP, nBlkXP, nPel, false, nWidth, nHeight);
-      if (needDistinctChroma) {
-        upsizerUV->SimpleResizeDo_int16(VXFullUVFF, nWidthPUV, nHeightPUV, VPitchUV, VXSmallUVFF, nBlkXP, nBlkXP, nPel, true, nWidthUV, nHeightUV);
-        upsizerUV->SimpleResizeDo_int16(VYFullUVFF, nWidthPUV, nHeightPUV, VPitchUV, VYSmallUVFF, nBlkXP, nBlkXP, nPel, false, nWidthUV, nHeightUV);
-      }
-      PROFILE_STOP(MOTION_PROFILE_RESIZE);
+     // BB is the B field of the next pair, FF the F field of the previous one
+      MVFieldCache::FieldSPtr fieldBB = fieldCacheB->Get(mvClipB.get_child_frame_index(nright),
+        [this](MVFieldCache::Field &field) { MakeVectorField(mvClipB, field); });
+      MVFieldCache::FieldSPtr fieldFF = fieldCacheF->Get(mvClipF.get_child_frame_index(nleft),
+        [this](MVFieldCache::Field &field) { MakeVectorField(mvClipF, field); });
+      short *VXFullYBB = fieldBB->VXFullY;
+      short *VYFullYBB = fieldBB->VYFullY;
+      short *VXFullUVBB = fieldBB->VXFullUV;
+      short *VYFullUVBB = fieldBB->VYFullUV;
+      short *VXFullYFF = fieldFF->VXFullY;
+      short *VYFullYFF = fieldFF->VYFullY;
+      short *VXFullUVFF = fieldFF->VXFullUV;
+      short *VYFullUVFF = fieldFF->VYFullUV;
 
       PROFILE_START(MOTION_PROFILE_FLOWINTER);
       {
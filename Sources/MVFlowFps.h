@@ -3,9 +3,11 @@
 
 #include "MVClip.h"
 #include "MVFilter.h"
+#include "MVFieldCache.h"
 #include "SimpleResize.h"
 #include "yuy2planes.h"
 #include <atomic>
+#include <memory>
 
 class MVFlowFps
   : public GenericVideoFilter
@@ -33,47 +35,13 @@ private:
   std::atomic<bool> reentrancy_check;
   int optDebug;
 
-  int nleftLast;
-  int nrightLast;
-
   int64_t fa, fb;
 
-  // fullframe vector mask
-  short *VXFullYB; //backward
-  short *VXFullUVB;
-  short *VYFullYB;
-  short *VYFullUVB;
-  short *VXFullYF;
-  short *VXFullUVF;
-  short *VYFullYF;
-  short *VYFullUVF;
-  short *VXFullYBB; //backward backward
-  short *VXFullUVBB;
-  short *VYFullYBB;
-  short *VYFullUVBB;
-  short *VXFullYFF; // forward forward
-  short *VXFullUVFF;
-  short *VYFullYFF;
-  short *VYFullUVFF;
-
-  // Small vector mask
-  short *VXSmallYB;
-  short *VXSmallUVB;
-  short *VYSmallYB;
-  short *VYSmallUVB;
-  short *VXSmallYF;
-  short *VXSmallUVF;
-  short *VYSmallYF;
-  short *VYSmallUVF;
-  short *VXSmallYBB;
-  short *VXSmallUVBB;
-  short *VYSmallYBB;
-  short *VYSmallUVBB;
-  short *VXSmallYFF;
-  short *VXSmallUVFF;
-  short *VYSmallYFF;
-  short *VYSmallUVFF;
+  // vector fields, shared between instances
+  std::shared_ptr<MVFieldCache> fieldCacheB;
+  std::shared_ptr<MVFieldCache> fieldCacheF;
 
+  // occlusion masks
   BYTE *MaskSmallB;
   BYTE *MaskFullYB;
   BYTE *MaskFullUVB;
@@ -81,8 +49,9 @@ private:
   BYTE *MaskFullYF;
   BYTE *MaskFullUVF;
 
-  BYTE *SADMaskSmallB;
-  BYTE *SADMaskSmallF;
+  // single block holding the masks above
+  BYTE *arena;
+  size_t arena_size;
 
   int nWidthUV;
   int nHeightUV;
@@ -117,6 +86,8 @@ private:
   int nLogxRatioUVs[3];
   int nLogyRatioUVs[3];
 
+  void MakeVectorField(MVClip &mvClip, MVFieldCache::Field &field);
+
 public:
   MVFlowFps(PClip _child, PClip _super, PClip _mvbw, PClip _mvfw, unsigned int _num, unsigned int _den, int _maskmode, double _ml,
     bool _blend, sad_t nSCD1, int nSCD2, bool isse, bool _planar, int _optDebug, IScriptEnvironment* env);
@@ -26,6 +26,7 @@
 //#include "Time256ProviderCst.h"
 //#include "Time256ProviderPlane.h"
 #include "commonfunctions.h"
+#include "fstb/AllocAlign.h"
 
 MVFlowInter::MVFlowInter(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, int _time256, double _ml,
   bool _blend, sad_t nSCD1, int nSCD2, bool _isse, bool _planar, IScriptEnvironment* env) :
@@ -52,6 +53,14 @@ MVFlowInter::MVFlowInter(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, in
 
   SuperParams64Bits params;
   memcpy(&params, &super->GetVideoInfo().num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    env->ThrowError("MFlowInter: super clip with ondemand=true is not supported");
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env->ThrowError("MFlowInter: super clip with virtualpad=true is not supported");
+  }
   int nHeightS = params.nHeight;
   int nSuperHPad = params.nHPad;
   int nSuperVPad = params.nVPad;
@@ -136,54 +145,54 @@ MVFlowInter::MVFlowInter(PClip _child, PClip super, PClip _mvbw, PClip _mvfw, in
   //needDistinctChroma = !is444 && !isGrey && !isRGB;
 
   // v2.7.34 common full size buffers for all planes, eliminates ten large buffer
-  VXFull_B = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFull_B = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
+  VXFull_B = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
+  VYFull_B = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
 
-  VXFull_F = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFull_F = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
+  VXFull_F = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
+  VYFull_F = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
 
-  VXSmallYB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+  VXSmallYB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+  VYSmallYB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   if (!isGrey) {
-    VXSmallUVB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+    VXSmallUVB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+    VYSmallUVB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   }
 
-  VXSmallYF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+  VXSmallYF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+  VYSmallYF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   if (!isGrey) {
-    VXSmallUVF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+    VXSmallUVF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+    VYSmallUVF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   }
 
-  VXFull_BB = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFull_BB = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
+  VXFull_BB = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
+  VYFull_BB = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
 
-  VXFull_FF = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
-  VYFull_FF = (short*)_aligned_malloc(2 * nHeightP*VPitchY + 128, 128);
+  VXFull_FF = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
+  VYFull_FF = (short*)fstb::AllocHuge::allocate(2 * nHeightP*VPitchY + 128, 128);
 
-  VXSmallYBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+  VXSmallYBB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+  VYSmallYBB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   if (!isGrey) {
-    VXSmallUVBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVBB = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+    VXSmallUVBB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+    VYSmallUVBB = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   }
 
-  VXSmallYFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-  VYSmallYFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+  VXSmallYFF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+  VYSmallYFF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   if (!isGrey) {
-    VXSmallUVFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
-    VYSmallUVFF = (short*)_aligned_malloc(2 * nBlkXP*nBlkYP + 128, 128);
+    VXSmallUVFF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
+    VYSmallUVFF = (short*)fstb::AllocHuge::allocate(2 * nBlkXP*nBlkYP + 128, 128);
   }
 
-  MaskSmallB = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
-  MaskFull_B = (unsigned char*)_aligned_malloc(nHeightP*VPitchY + 128, 128);
+  MaskSmallB = (unsigned char*)fstb::AllocHuge::allocate(nBlkXP*nBlkYP + 128, 128);
+  MaskFull_B = (unsigned char*)fstb::AllocHuge::allocate(nHeightP*VPitchY + 128, 128);
 
-  MaskSmallF = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
-  MaskFull_F = (unsigned char*)_aligned_malloc(nHeightP*VPitchY + 128, 128);
+  MaskSmallF = (unsigned char*)fstb::AllocHuge::allocate(nBlkXP*nBlkYP + 128, 128);
+  MaskFull_F = (unsigned char*)fstb::AllocHuge::allocate(nHeightP*VPitchY + 128, 128);
 
-  SADMaskSmallB = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
-  SADMaskSmallF = (unsigned char*)_aligned_malloc(nBlkXP*nBlkYP + 128, 128);
+  SADMaskSmallB = (unsigned char*)fstb::AllocHuge::allocate(nBlkXP*nBlkYP + 128, 128);
+  SADMaskSmallF = (unsigned char*)fstb::AllocHuge::allocate(nBlkXP*nBlkYP + 128, 128);
 
   upsizer = new SimpleResize(nWidthP, nHeightP, nBlkXP, nBlkYP, cpuFlags);
   if (!isGrey) {
@@ -208,54 +217,56 @@ MVFlowInter::~MVFlowInter()
   if(!isGrey)
     delete upsizerUV;
 
-  _aligned_free(VXFull_B);
-  _aligned_free(VYFull_B);
-  _aligned_free(VXSmallYB);
-  _aligned_free(VYSmallYB);
+  fstb::AllocHuge::deallocate(VXFull_B);
+  fstb::AllocHuge::deallocate(VYFull_B);
+  fstb::AllocHuge::deallocate(VXSmallYB);
+  fstb::AllocHuge::deallocate(VYSmallYB);
   if (!isGrey) {
-    _aligned_free(VXSmallUVB);
-    _aligned_free(VYSmallUVB);
+    fstb::AllocHuge::deallocate(VXSmallUVB);
+    fstb::AllocHuge::deallocate(VYSmallUVB);
   }
 
-  _aligned_free(VXFull_F);
-  _aligned_free(VYFull_F);
-  _aligned_free(VXSmallYF);
-  _aligned_free(VYSmallYF);
+  fstb::AllocHuge::deallocate(VXFull_F);
+  fstb::AllocHuge::deallocate(VYFull_F);
+  fstb::AllocHuge::deallocate(VXSmallYF);
+  fstb::AllocHuge::deallocate(VYSmallYF);
   if (!isGrey) {
-    _aligned_free(VXSmallUVF);
-    _aligned_free(VYSmallUVF);
+    fstb::AllocHuge::deallocate(VXSmallUVF);
+    fstb::AllocHuge::deallocate(VYSmallUVF);
   }
 
-  _aligned_free(MaskSmallB);
-  _aligned_free(MaskFull_B);
-  _aligned_free(MaskSmallF);
-  _aligned_free(MaskFull_F);
+  fstb::AllocHuge::deallocate(MaskSmallB);
+  fstb::AllocHuge::deallocate(MaskFull_B);
+  fstb::AllocHuge::deallocate(MaskSmallF);
+  fstb::AllocHuge::deallocate(MaskFull_F);
 
-  _aligned_free(VXFull_BB);
-  _aligned_free(VYFull_BB);
-  _aligned_free(VXSmallYBB);
-  _aligned_free(VYSmallYBB);
+  fstb::AllocHuge::deallocate(VXFull_BB);
+  fstb::AllocHuge::deallocate(VYFull_BB);
+  fstb::AllocHuge::deallocate(VXSmallYBB);
+  fstb::AllocHuge::deallocate(VYSmallYBB);
   if (!isGrey) {
-    _aligned_free(VXSmallUVBB);
-    _aligned_free(VYSmallUVBB);
+    fstb::AllocHuge::deallocate(VXSmallUVBB);
+    fstb::AllocHuge::deallocate(VYSmallUVBB);
   }
 
-  _aligned_free(VXFull_FF);
-  _aligned_free(VYFull_FF);
-  _aligned_free(VXSmallYFF);
-  _aligned_free(VYSmallYFF);
+  fstb::AllocHuge::deallocate(VXFull_FF);
+  fstb::AllocHuge::deallocate(VYFull_FF);
+  fstb::AllocHuge::deallocate(VXSmallYFF);
+  fstb::AllocHuge::deallocate(VYSmallYFF);
   if (!isGrey) {
-    _aligned_free(VXSmallUVFF);
-    _aligned_free(VYSmallUVFF);
+    fstb::AllocHuge::deallocate(VXSmallUVFF);
+    fstb::AllocHuge::deallocate(VYSmallUVFF);
   }
 
-  _aligned_free(SADMaskSmallB);
-  _aligned_free(SADMaskSmallF);
+  fstb::AllocHuge::deallocate(SADMaskSmallB);
+  fstb::AllocHuge::deallocate(SADMaskSmallF);
 }
 
 //-------------------------------------------------------------------------
 PVideoFrame __stdcall MVFlowInter::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   PVideoFrame dst;
   BYTE *pDst[3];
   const BYTE *pRef[3], *pSrc[3];
@@ -120,6 +120,42 @@ void	MVFrame::set_interp (MVPlaneSet _nMode, int rfilter, int sharp)
 
 
 
+void	MVFrame::set_pel_on_demand (bool flag)
+{
+   if (nMode & YPLANE)
+  {
+      pYPlane->set_pel_on_demand (flag);
+  }
+   if (nMode & UPLANE)
+  {
+      pUPlane->set_pel_on_demand (flag);
+  }
+   if (nMode & VPLANE)
+  {
+      pVPlane->set_pel_on_demand (flag);
+  }
+}
+
+
+
+void	MVFrame::set_virtual_pad (bool flag)
+{
+   if (nMode & YPLANE)
+  {
+      pYPlane->set_virtual_pad (flag);
+  }
+   if (nMode & UPLANE)
+  {
+      pUPlane->set_virtual_pad (flag);
+  }
+   if (nMode & VPLANE)
+  {
+      pVPlane->set_virtual_pad (flag);
+  }
+}
+
+
+
 void MVFrame::Refine(MVPlaneSet _nMode)
 {
    if (nMode & YPLANE & _nMode)
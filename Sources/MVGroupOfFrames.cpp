@@ -44,6 +44,8 @@ MVGroupOfFrames::MVGroupOfFrames(int _nLevelCount, int _nWidth, int _nHeight, in
 ,	yRatioUV (_yRatioUV)
 , pixelsize(_pixelsize)
 , bits_per_pixel(_bits_per_pixel)
+, nPelStored(_nPel)
+, vpad_stored(true)
 {
 
    pFrames[0] = new MVFrame(nWidth, nHeight, nPel, nHPad, nVPad, nMode, cpuFlags, xRatioUV, yRatioUV, pixelsize, bits_per_pixel, mt_flag);
@@ -60,9 +62,9 @@ void MVGroupOfFrames::Update(int nMode, uint8_t * pSrcY, int pitchY, uint8_t * p
   for ( int i = 0; i < nLevelCount; i++ )
   {
         // offsets are pixelsize-aware because pitch is in bytes
-    unsigned int offY = PlaneSuperOffset(false, nHeight, i, nPel, nVPad, pitchY, yRatioUV); // no need here xRatioUV and pixelsize
-    unsigned int offU = PlaneSuperOffset(true, nHeight/yRatioUV, i, nPel, nVPad/yRatioUV, pitchU, yRatioUV);
-    unsigned int offV = PlaneSuperOffset(true, nHeight/yRatioUV, i, nPel, nVPad/yRatioUV, pitchV, yRatioUV);
+    unsigned int offY = PlaneSuperOffset(false, nHeight, i, nPelStored, nVPad, pitchY, yRatioUV, vpad_stored); // no need here xRatioUV and pixelsize
+    unsigned int offU = PlaneSuperOffset(true, nHeight/yRatioUV, i, nPelStored, nVPad/yRatioUV, pitchU, yRatioUV, vpad_stored);
+    unsigned int offV = PlaneSuperOffset(true, nHeight/yRatioUV, i, nPelStored, nVPad/yRatioUV, pitchV, yRatioUV, vpad_stored);
     pFrames[i]->Update (nMode, pSrcY+offY, pitchY, pSrcU+offU, pitchU, pSrcV+offV, pitchV);
   }
 }
@@ -97,6 +99,27 @@ void	MVGroupOfFrames::set_interp (MVPlaneSet nMode, int rfilter, int sharp)
 
 
 
+// Sub-pixel planes of the finest level are not stored in the super frame
+void	MVGroupOfFrames::set_pel_on_demand (bool flag)
+{
+   nPelStored = (flag) ? 1 : nPel;
+   pFrames[0]->set_pel_on_demand (flag);
+}
+
+
+
+// The planes of all levels are stored without padding
+void	MVGroupOfFrames::set_virtual_pad (bool flag)
+{
+   vpad_stored = !flag;
+   for ( int i = 0; i < nLevelCount; i++ )
+  {
+      pFrames[i]->set_virtual_pad (flag);
+  }
+}
+
+
+
 void MVGroupOfFrames::Refine(MVPlaneSet nMode)
 {
    pFrames[0]->Refine(nMode);
@@ -43,6 +43,8 @@ class MVGroupOfFrames
    int yRatioUV;
    int pixelsize; // PF 160729
    int bits_per_pixel; // PF 160927
+   int nPelStored;     // pel of the finest level in the super frame, 1 for sub-pixel planes on demand
+   bool vpad_stored;   // false when the padding is not in the super frame (virtual padding)
 
 public :
     // xRatioUV PF 160729
@@ -53,6 +55,8 @@ public :
    MVFrame *GetFrame(int nLevel);
    void SetPlane(const uint8_t *pNewSrc, int nNewPitch, MVPlaneSet nMode);
    void set_interp (MVPlaneSet nMode, int rfilter, int sharp);
+   void set_pel_on_demand (bool flag);
+   void set_virtual_pad (bool flag);
    void Refine(MVPlaneSet nMode);
    void Pad(MVPlaneSet nMode);
    void Reduce(MVPlaneSet nMode);
@@ -169,6 +169,8 @@ unsigned char MVMask::SAD(unsigned int s)
 */
 PVideoFrame __stdcall MVMask::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   const bool needSrcFrame = (kind == 5); // at other types input only provides format
   PVideoFrame src;
   if (needSrcFrame)
@@ -34,11 +34,15 @@ boundaries.
 
 #include "CopyCode.h"
 #include "Interpolation.h"
+#include "KernelInfo.h"
 #include "MVPlane.h"
 #include "Padding.h"
 #include <stdint.h>
 #include <commonfunctions.h>
 
+#include <algorithm>
+#include <cstring>
+
 
 MVPlane::MVPlane(int _nWidth, int _nHeight, int _nPel, int _nHPad, int _nVPad, int _pixelsize, int _bits_per_pixel, int _cpuFlags, bool mt_flag)
   : pPlane(new uint8_t*[_nPel * _nPel * _pixelsize])
@@ -62,6 +66,8 @@ MVPlane::MVPlane(int _nWidth, int _nHeight, int _nPel, int _nHPad, int _nVPad, i
   , isPadded(false)
   , isRefined(false)
   , isFilled(false)
+  , _pel_on_demand_flag(false)
+  , _virtual_pad_flag(false)
   , _sched_refine(mt_flag)
   , _plan_refine()
   , _slicer_reduce(mt_flag)
@@ -116,6 +122,43 @@ MVPlane::~MVPlane()
 
 
 
+// For MToolsInfo(), follows the selection in the constructor. cpuFlags is
+// 0 with isse=false, cpu_flags_host gives what the CPU can do.
+void MVPlane::describe_kernels(KernelInfo &info, int rfilter, bool pelclip_flag, int cpu_flags_host) const
+{
+  static const char * const sharp_name_arr[3] = { "bilinear", "bicubic", "wiener" };
+  const std::string bits = (pixelsize == 4) ? "float" : std::to_string(bits_per_pixel) + "-bit";
+  const bool host_sse2 = (cpu_flags_host & CPUF_SSE2) != 0;
+  const bool host_sse41 = (cpu_flags_host & CPUF_SSE4_1) != 0;
+
+  if (nPel > 1 && pelclip_flag)
+  {
+    info.Add("Interpolation", "pelclip " + bits, "none", "");
+  }
+  else if (nPel > 1)
+  {
+    const std::string config = std::string(sharp_name_arr[std::min(std::max(nSharp, 0), 2)]) + " " + bits;
+    // the 16-bit kernels and the 8-bit vertical bicubic have an SSE4.1 variant
+    const bool sse41_variant = (pixelsize == 2 || (pixelsize == 1 && nSharp == 1));
+    if (pixelsize == 4)
+      info.Add("Interpolation", config, "C", host_sse2 ? "no SSE2 or faster kernel for float" : "");
+    else if ((cpuFlags & CPUF_SSE2) == 0)
+      info.Add("Interpolation", config, "C",
+        std::string("SSE2 kernel not used: ") + (host_sse2 ? "asm disabled (isse=false)" : "not supported by the CPU"));
+    else if (sse41_variant && (cpuFlags & CPUF_SSE4_1) != 0)
+      info.Add("Interpolation", config, "SSE4.1", "");
+    else if (sse41_variant)
+      info.Add("Interpolation", config, "SSE2",
+        host_sse41 ? "" : "SSE4.1 kernel not used: not supported by the CPU");
+    else
+      info.Add("Interpolation", config, "SSE2", host_sse41 ? "no SSE4.1 or faster kernel for " + config : "");
+  }
+
+  info.Add("Reduce", "rfilter=" + std::to_string(rfilter) + " " + bits, "C", host_sse2 ? "no SIMD kernel" : "");
+}
+
+
+
 void MVPlane::set_interp(int rfilter, int sharp)
 {
   nSharp = sharp; // for pel>1
@@ -195,6 +238,24 @@ void MVPlane::set_interp(int rfilter, int sharp)
 
 
 
+// Only the full-pel plane is in the frame, sub-pixel planes are not available.
+// Set the sharp mode of MSuper with set_interp before rendering blocks.
+void MVPlane::set_pel_on_demand(bool flag)
+{
+  _pel_on_demand_flag = flag && (nPel > 1);
+}
+
+
+
+// The padding is not in the frame, the plane starts at the frame origin.
+// Pad() does nothing and the sub-pixel planes cover the frame only.
+void MVPlane::set_virtual_pad(bool flag)
+{
+  _virtual_pad_flag = flag;
+}
+
+
+
 void MVPlane::Update(uint8_t* pSrc, int _nPitch) //v2.0
 {
   // npitch is pixelsize aware
@@ -202,9 +263,12 @@ void MVPlane::Update(uint8_t* pSrc, int _nPitch) //v2.0
 
   nOffsetPadding = nPitch * nVPadding + (nHPadding << pixelsize_shift);
 
+  // with virtual padding, pPlane still points to the (missing) padded origin
+  const int nStoredHeight = (_virtual_pad_flag) ? nHeight : nExtendedHeight;
+  const int nStoredOffset = (_virtual_pad_flag) ? nOffsetPadding : 0;
   for (int i = 0; i < nPel * nPel; i++)
   {
-    pPlane[i] = pSrc + i * nPitch * nExtendedHeight;
+    pPlane[i] = (i > 0 && _pel_on_demand_flag) ? 0 : pSrc + i * nPitch * nStoredHeight - nStoredOffset;
   }
 
   ResetState();
@@ -227,7 +291,7 @@ void MVPlane::ChangePlane(const uint8_t *pNewPlane, int nNewPitch)
 void MVPlane::Pad()
 {
   // npitch is pixelsize aware
-  if (!isPadded)
+  if (!isPadded && !_virtual_pad_flag)
   {
     if (pixelsize == 1)
       Padding::PadReferenceFrame<uint8_t>(pPlane[0], nPitch, nHPadding, nVPadding, nWidth, nHeight);
@@ -243,7 +307,7 @@ void MVPlane::Pad()
 
 void MVPlane::refine_start()
 {
-  if (!isRefined)
+  if (!isRefined && !_pel_on_demand_flag)
   {
     if (nPel == 2)
     {
@@ -262,7 +326,7 @@ void MVPlane::refine_wait()
 {
   if (!isRefined)
   {
-    if (nPel > 1)
+    if (nPel > 1 && !_pel_on_demand_flag)
     {
       _sched_refine.wait();
     }
@@ -431,34 +495,75 @@ void MVPlane::WritePlane(FILE *pFile)
 
 
 
+// Sub-pixel planes are rendered on the padded area, or on the frame only
+// with virtual padding.
+void MVPlane::get_refine_planes(uint8_t **pp) const
+{
+  const int offset = (_virtual_pad_flag) ? nOffsetPadding : 0;
+  for (int k = 0; k < nPel * nPel; k++)
+  {
+    pp[k] = pPlane[k] + offset;
+  }
+}
+
+
+
 void MVPlane::refine_pel2(SchedulerRefine::TaskData &td)
 {
   assert(&td != 0);
 
-  switch (td._task_index)
+  uint8_t *pp[4];
+  get_refine_planes(pp);
+  if (_virtual_pad_flag)
+    interp_pel2(td._task_index, pp, nPitch, nWidth, nHeight);
+  else
+    interp_pel2(td._task_index, pp, nPitch, nExtendedWidth, nExtendedHeight);
+}
+
+
+
+void MVPlane::refine_pel4(SchedulerRefine::TaskData &td)
+{
+  assert(&td != 0);
+
+  uint8_t *pp[16];
+  get_refine_planes(pp);
+  if (_virtual_pad_flag)
+    interp_pel4(td._task_index, pp, nPitch, nWidth, nHeight);
+  else
+    interp_pel4(td._task_index, pp, nPitch, nExtendedWidth, nExtendedHeight);
+}
+
+
+
+// Renders a sub-pixel plane from the planes it depends on (see set_interp)
+// pp: plane pointers, all planes have the same pitch and size
+void MVPlane::interp_pel2(int task_index, uint8_t * const *pp, int pitch, int width, int height) const
+{
+  switch (task_index)
   {
   case 0:  break;	// Nothing on the root node
   case 1:
     switch (nSharp)
     {
-    case 0: _bilin_hor_ptr(pPlane[1], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    case 1: _bicubic_hor_ptr(pPlane[1], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    default: _wiener_hor_ptr(pPlane[1], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
+    case 0: _bilin_hor_ptr(pp[1], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    case 1: _bicubic_hor_ptr(pp[1], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    default: _wiener_hor_ptr(pp[1], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
     }
   case 2:
     switch (nSharp)
     {
-    case 0: _bilin_ver_ptr(pPlane[2], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    case 1: _bicubic_ver_ptr(pPlane[2], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    default: _wiener_ver_ptr(pPlane[2], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
+    case 0: _bilin_ver_ptr(pp[2], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    case 1: _bicubic_ver_ptr(pp[2], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    default: _wiener_ver_ptr(pp[2], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
     }
     break;
   case 3:
     switch (nSharp)
     {
-    case 0: _bilin_dia_ptr(pPlane[3], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    case 1: _bicubic_hor_ptr(pPlane[3], pPlane[2], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;	// faster from ready-made horizontal
-    default: _wiener_hor_ptr(pPlane[3], pPlane[2], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;	// faster from ready-made horizontal
+    case 0: _bilin_dia_ptr(pp[3], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    case 1: _bicubic_hor_ptr(pp[3], pp[2], pitch, pitch, width, height, bits_per_pixel); break;	// faster from ready-made horizontal
+    default: _wiener_hor_ptr(pp[3], pp[2], pitch, pitch, width, height, bits_per_pixel); break;	// faster from ready-made horizontal
     }
     break;
   default:
@@ -469,49 +574,47 @@ void MVPlane::refine_pel2(SchedulerRefine::TaskData &td)
 
 
 
-void MVPlane::refine_pel4(SchedulerRefine::TaskData &td)
+void MVPlane::interp_pel4(int task_index, uint8_t * const *pp, int pitch, int width, int height) const
 {
-  assert(&td != 0);
-
-  switch (td._task_index)
+  switch (task_index)
   {
   case 0:  break;	// Nothing on the root node
-  case 1:  _average_ptr(pPlane[1], pPlane[0], pPlane[2], nPitch, nExtendedWidth, nExtendedHeight); break;
+  case 1:  _average_ptr(pp[1], pp[0], pp[2], pitch, width, height); break;
   case 2:
     switch (nSharp)
     {
-    case 0: _bilin_hor_ptr(pPlane[2], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    case 1: _bicubic_hor_ptr(pPlane[2], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    default: _wiener_hor_ptr(pPlane[2], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
+    case 0: _bilin_hor_ptr(pp[2], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    case 1: _bicubic_hor_ptr(pp[2], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    default: _wiener_hor_ptr(pp[2], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
     }
     break;
-  case 3:  _average_ptr(pPlane[3], pPlane[0] + 1 * pixelsize, pPlane[2], nPitch, nExtendedWidth - 1, nExtendedHeight); break;
-  case 4:  _average_ptr(pPlane[4], pPlane[0], pPlane[8], nPitch, nExtendedWidth, nExtendedHeight); break;
-  case 5:  _average_ptr(pPlane[5], pPlane[4], pPlane[6], nPitch, nExtendedWidth, nExtendedHeight); break;
-  case 6:  _average_ptr(pPlane[6], pPlane[2], pPlane[10], nPitch, nExtendedWidth, nExtendedHeight); break;
-  case 7:  _average_ptr(pPlane[7], pPlane[4] + 1 * pixelsize, pPlane[6], nPitch, nExtendedWidth - 1, nExtendedHeight); break;
+  case 3:  _average_ptr(pp[3], pp[0] + 1 * pixelsize, pp[2], pitch, width - 1, height); break;
+  case 4:  _average_ptr(pp[4], pp[0], pp[8], pitch, width, height); break;
+  case 5:  _average_ptr(pp[5], pp[4], pp[6], pitch, width, height); break;
+  case 6:  _average_ptr(pp[6], pp[2], pp[10], pitch, width, height); break;
+  case 7:  _average_ptr(pp[7], pp[4] + 1 * pixelsize, pp[6], pitch, width - 1, height); break;
   case 8:
     switch (nSharp)
     {
-    case 0: _bilin_ver_ptr(pPlane[8], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    case 1: _bicubic_ver_ptr(pPlane[8], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    default: _wiener_ver_ptr(pPlane[8], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
+    case 0: _bilin_ver_ptr(pp[8], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    case 1: _bicubic_ver_ptr(pp[8], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    default: _wiener_ver_ptr(pp[8], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
     }
     break;
-  case 9:  _average_ptr(pPlane[9], pPlane[8], pPlane[10], nPitch, nExtendedWidth, nExtendedHeight); break;
+  case 9:  _average_ptr(pp[9], pp[8], pp[10], pitch, width, height); break;
   case 10:
     switch (nSharp)
     {
-    case 0: _bilin_dia_ptr(pPlane[10], pPlane[0], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;
-    case 1: _bicubic_hor_ptr(pPlane[10], pPlane[8], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;	// faster from ready-made horizontal
-    default: _wiener_hor_ptr(pPlane[10], pPlane[8], nPitch, nPitch, nExtendedWidth, nExtendedHeight, bits_per_pixel); break;	// faster from ready-made horizontal
+    case 0: _bilin_dia_ptr(pp[10], pp[0], pitch, pitch, width, height, bits_per_pixel); break;
+    case 1: _bicubic_hor_ptr(pp[10], pp[8], pitch, pitch, width, height, bits_per_pixel); break;	// faster from ready-made horizontal
+    default: _wiener_hor_ptr(pp[10], pp[8], pitch, pitch, width, height, bits_per_pixel); break;	// faster from ready-made horizontal
     }
     break;
-  case 11: _average_ptr(pPlane[11], pPlane[8] + 1*pixelsize, pPlane[10], nPitch, nExtendedWidth - 1, nExtendedHeight); break;
-  case 12: _average_ptr(pPlane[12], pPlane[0] + nPitch, pPlane[8], nPitch, nExtendedWidth, nExtendedHeight - 1); break;
-  case 13: _average_ptr(pPlane[13], pPlane[12], pPlane[14], nPitch, nExtendedWidth, nExtendedHeight); break;
-  case 14: _average_ptr(pPlane[14], pPlane[2] + nPitch, pPlane[10], nPitch, nExtendedWidth, nExtendedHeight - 1); break;
-  case 15: _average_ptr(pPlane[15], pPlane[12] + 1 * pixelsize, pPlane[14], nPitch, nExtendedWidth - 1, nExtendedHeight); break;
+  case 11: _average_ptr(pp[11], pp[8] + 1*pixelsize, pp[10], pitch, width - 1, height); break;
+  case 12: _average_ptr(pp[12], pp[0] + pitch, pp[8], pitch, width, height - 1); break;
+  case 13: _average_ptr(pp[13], pp[12], pp[14], pitch, width, height); break;
+  case 14: _average_ptr(pp[14], pp[2] + pitch, pp[10], pitch, width, height - 1); break;
+  case 15: _average_ptr(pp[15], pp[12] + 1 * pixelsize, pp[14], pitch, width - 1, height); break;
   default:
     assert(false);
     break;
@@ -520,6 +623,161 @@ void MVPlane::refine_pel4(SchedulerRefine::TaskData &td)
 
 
 
+// nX, nY: absolute position in sub-pixel units
+const uint8_t* MVPlane::GetAbsoluteBlockOnDemand(int nX, int nY, int nBlkW, int nBlkH, MVPelBlockBuf &buf) const
+{
+  const int pel_shift = (nPel == 4) ? 2 : ((nPel == 2) ? 1 : 0);
+  const int mask = nPel - 1;
+  const int idx = (nX & mask) | ((nY & mask) << pel_shift);
+  const int x = nX >> pel_shift;
+  const int y = nY >> pel_shift;
+  if (idx == 0)
+  {
+    return pPlane[0] + (x << pixelsize_shift) + y * nPitch;
+  }
+
+  // Window around the block. The margins cover the support of the filters
+  // (6 taps at most) and their special borders, so the window gives the same
+  // values as the whole plane.
+  const int wx0 = std::min(std::max(x - 4, 0), x);
+  const int wy0 = std::min(std::max(y - 4, 0), y);
+  const int wx1 = std::max(std::min(x + nBlkW + 5, nExtendedWidth), x + nBlkW);
+  const int wy1 = std::max(std::min(y + nBlkH + 5, nExtendedHeight), y + nBlkH);
+  const int ww = wx1 - wx0;
+  const int wh = wy1 - wy0;
+  // SIMD filters may write up to 16 bytes past the width
+  const int wpitch = AlignNumber((ww << pixelsize_shift) + 32, 32);
+  const int wsize = wpitch * wh;
+  const size_t win_size = size_t(wsize) * (nPel * nPel) + wpitch;
+  if (buf.win.size() < win_size)
+  {
+    buf.win.resize(win_size);
+  }
+  uint8_t *pp[16];
+  for (int k = 0; k < nPel * nPel; k++)
+  {
+    pp[k] = &buf.win[0] + k * wsize;
+  }
+
+  // Planes needed for idx, as bitmasks (same dependencies as set_interp)
+  static const int deps_pel2[4] = { 0, 0x0001, 0x0001, 0x0004 };
+  static const int deps_pel4[16] = {
+    0,      0x0005, 0x0001, 0x0005, 0x0101, 0x0050, 0x0404, 0x0050,
+    0x0001, 0x0500, 0x0100, 0x0500, 0x0101, 0x5000, 0x0404, 0x5000
+  };
+  const int *deps = (nPel == 2) ? deps_pel2 : deps_pel4;
+  int need = 1 << idx;
+  for (int need_old = 0; need != need_old; )
+  {
+    need_old = need;
+    for (int k = 1; k < nPel * nPel; k++)
+    {
+      if (need & (1 << k))
+      {
+        int d = deps[k];
+        if (nSharp == 0 && ((nPel == 2 && k == 3) || (nPel == 4 && k == 10)))
+        {
+          d = 0x0001; // diagonal from the full-pel plane
+        }
+        need |= d;
+      }
+    }
+  }
+
+  BitBlt(pp[0], wpitch, pPlane[0] + (wx0 << pixelsize_shift) + wy0 * nPitch, nPitch, ww << pixelsize_shift, wh);
+
+  static const int order_pel2[3] = { 2, 1, 3 };
+  static const int order_pel4[15] = { 2, 8, 10, 1, 3, 4, 12, 9, 11, 6, 14, 5, 7, 13, 15 };
+  const int *order = (nPel == 2) ? order_pel2 : order_pel4;
+  for (int i = 0; i < nPel * nPel - 1; i++)
+  {
+    const int k = order[i];
+    if (need & (1 << k))
+    {
+      if (nPel == 2)
+        interp_pel2(k, pp, wpitch, ww, wh);
+      else
+        interp_pel4(k, pp, wpitch, ww, wh);
+    }
+  }
+
+  const size_t blk_size = size_t(nPitch) * nBlkH;
+  if (buf.blk.size() < blk_size)
+  {
+    buf.blk.resize(blk_size);
+  }
+  BitBlt(&buf.blk[0], nPitch, pp[idx] + ((x - wx0) << pixelsize_shift) + (y - wy0) * wpitch, wpitch, nBlkW << pixelsize_shift, nBlkH);
+
+  return &buf.blk[0];
+}
+
+
+
+// nX, nY: absolute position in sub-pixel units
+// The positions are clamped to the frame in sub-pixel units, so the sub-pixel
+// values are never read past the last row or column, which are not rendered
+// for all the planes.
+const uint8_t* MVPlane::GetAbsoluteBlockClamped(int nX, int nY, int nBlkW, int nBlkH, MVPelBlockBuf &buf) const
+{
+  if (IsBlockStored(nX, nY, nBlkW, nBlkH))
+  {
+    return GetAbsolutePointer(nX, nY);
+  }
+
+  const int pel_shift = (nPel == 4) ? 2 : ((nPel == 2) ? 1 : 0);
+  const int mask = nPel - 1;
+  const int x_min = nHPadding << pel_shift;
+  const int x_max = (nHPadding + nWidth - 1) << pel_shift;
+  const int y_min = nVPadding << pel_shift;
+  const int y_max = (nVPadding + nHeight - 1) << pel_shift;
+
+  // columns [i_beg, i_end) are inside the frame
+  int i_beg = 0;
+  while (i_beg < nBlkW && nX + (i_beg << pel_shift) < x_min)
+    ++i_beg;
+  int i_end = nBlkW;
+  while (i_end > i_beg && nX + ((i_end - 1) << pel_shift) > x_max)
+    --i_end;
+
+  const size_t blk_size = size_t(nPitch) * nBlkH;
+  if (buf.blk.size() < blk_size)
+  {
+    buf.blk.resize(blk_size);
+  }
+
+  for (int j = 0; j < nBlkH; j++)
+  {
+    const int py = std::min(std::max(nY + (j << pel_shift), y_min), y_max);
+    const int y = py >> pel_shift;
+    const int idx_y = (py & mask) << pel_shift;
+    // clamped columns are on the full-pel column of the edge
+    const uint8_t *edge_ptr = pPlane[idx_y] + y * nPitch;
+    const uint8_t *row_ptr = pPlane[idx_y | (nX & mask)] + y * nPitch;
+    uint8_t *dst_ptr = &buf.blk[0] + j * nPitch;
+
+    for (int i = 0; i < i_beg; i++)
+    {
+      memcpy(dst_ptr + (i << pixelsize_shift), edge_ptr + (nHPadding << pixelsize_shift), pixelsize);
+    }
+    if (i_end > i_beg)
+    {
+      memcpy(
+        dst_ptr + (i_beg << pixelsize_shift),
+        row_ptr + (((nX >> pel_shift) + i_beg) << pixelsize_shift),
+        (i_end - i_beg) << pixelsize_shift
+      );
+    }
+    for (int i = i_end; i < nBlkW; i++)
+    {
+      memcpy(dst_ptr + (i << pixelsize_shift), edge_ptr + ((nHPadding + nWidth - 1) << pixelsize_shift), pixelsize);
+    }
+  }
+
+  return &buf.blk[0];
+}
+
+
+
 void MVPlane::reduce_slice(SlicerReduce::TaskData &td)
 {
   assert(&td != 0);
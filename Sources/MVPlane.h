@@ -23,13 +23,29 @@
 #include	"MTFlowGraphSched.h"
 #include	"MTSlicer.h"
 #include	"types.h"
+#include	"fstb/AllocAlign.h"
 
 #include	<cstdio>
 #include <stdint.h>
+#include <vector>
 #include "def.h"
 
 
 
+// Work buffers to render sub-pixel blocks on demand, one set per thread.
+// Through the allocation hook, they are resized while searching.
+class MVPelBlockBuf
+{
+public:
+  typedef std::vector <uint8_t, fstb::AllocAlign <uint8_t> > Buffer;
+  Buffer blk;  // rendered block, with the pitch of the plane
+  Buffer win;  // sub-pixel planes of the window around the block
+};
+
+
+
+class KernelInfo;
+
 class MVPlane
 {
 public:
@@ -38,6 +54,9 @@ public:
    ~MVPlane();
 
    void set_interp (int rfilter, int sharp);
+   void set_pel_on_demand (bool flag);
+   void set_virtual_pad (bool flag);
+   void describe_kernels (KernelInfo &info, int rfilter, bool pelclip_flag, int cpu_flags_host) const;
    void Update(uint8_t* pSrc, int _nPitch);
    void ChangePlane(const uint8_t *pNewPlane, int nNewPitch);
    void Pad();
@@ -72,6 +91,45 @@ public:
     return GetAbsolutePointerPel <NPELL2>(nX + nHPaddingPel, nY + nVPaddingPel);
   }
 
+  // Sub-pixel planes on demand (MSuper ondemand=true): only the full-pel
+  // plane is stored, sub-pixel blocks are interpolated into buf.
+  // Returned blocks have the pitch of the plane.
+  const uint8_t* GetAbsoluteBlockOnDemand(int nX, int nY, int nBlkW, int nBlkH, MVPelBlockBuf &buf) const;
+
+  // Virtual padding (MSuper virtualpad=true): the padding is not stored,
+  // blocks crossing the frame borders are gathered into buf with clamped
+  // coordinates, as if the edges were replicated.
+  const uint8_t* GetAbsoluteBlockClamped(int nX, int nY, int nBlkW, int nBlkH, MVPelBlockBuf &buf) const;
+
+  // nX, nY: absolute position in sub-pixel units
+  MV_FORCEINLINE const uint8_t* GetAbsoluteBlock(int nX, int nY, int nBlkW, int nBlkH, MVPelBlockBuf &buf) const
+  {
+    if (_pel_on_demand_flag)
+      return GetAbsoluteBlockOnDemand(nX, nY, nBlkW, nBlkH, buf);
+    if (_virtual_pad_flag)
+      return GetAbsoluteBlockClamped(nX, nY, nBlkW, nBlkH, buf);
+    return GetAbsolutePointer(nX, nY);
+  }
+
+  MV_FORCEINLINE const uint8_t* GetPointerBlock(int nX, int nY, int nBlkW, int nBlkH, MVPelBlockBuf &buf) const
+  {
+    return GetAbsoluteBlock(nX + nHPaddingPel, nY + nVPaddingPel, nBlkW, nBlkH, buf);
+  }
+
+  // True if the block can be read directly with GetAbsolutePointer
+  MV_FORCEINLINE bool IsBlockStored(int nX, int nY, int nBlkW, int nBlkH) const
+  {
+    if (_pel_on_demand_flag)
+      return ((nX | nY) & (nPel - 1)) == 0;
+    if (_virtual_pad_flag)
+      return nX >= nHPaddingPel && nX + (nBlkW - 1) * nPel <= nHPaddingPel + (nWidth - 1) * nPel
+        && nY >= nVPaddingPel && nY + (nBlkH - 1) * nPel <= nVPaddingPel + (nHeight - 1) * nPel;
+    return true;
+  }
+
+  MV_FORCEINLINE bool IsPelOnDemand() const { return _pel_on_demand_flag; }
+  MV_FORCEINLINE bool IsVirtualPad() const { return _virtual_pad_flag; }
+
 
   MV_FORCEINLINE int GetPitch() const { return nPitch; }
   MV_FORCEINLINE int GetWidth() const { return nWidth; }
@@ -97,8 +155,11 @@ private:
     int nWidth, int nHeight, int y_beg, int y_end, int cpuFlags
   );
 
+  void	get_refine_planes (uint8_t **pp) const;
   void	refine_pel2 (SchedulerRefine::TaskData &td);
   void	refine_pel4 (SchedulerRefine::TaskData &td);
+  void	interp_pel2 (int task_index, uint8_t * const *pp, int pitch, int width, int height) const;
+  void	interp_pel4 (int task_index, uint8_t * const *pp, int pitch, int width, int height) const;
   void	reduce_slice (SlicerReduce::TaskData &td);
 
   uint8_t **pPlane;
@@ -127,6 +188,8 @@ private:
    bool isPadded;
    bool isRefined;
    bool isFilled;
+   bool _pel_on_demand_flag;
+   bool _virtual_pad_flag;
 
   InterpFncPtr	_bilin_hor_ptr;
   InterpFncPtr	_bilin_ver_ptr;
@@ -28,6 +28,7 @@
 #include "MVClip.h"
 #include "MVGroupOfFrames.h"
 #include "MVRecalculate.h"
+#include "MVSceneStat.h"
 #include "profile.h"
 #include "SuperParams64Bits.h"
 
@@ -41,15 +42,18 @@ MVRecalculate::MVRecalculate(
   int _blksizex, int _blksizey, int st, int stp, int lambda, bool chroma,
   int _pnew, int _overlapx, int _overlapy, const char* _outfilename,
   int _dctmode, int _divide, int _sadx264, bool _isse, bool _meander,
-  int trad, bool mt_flag, int _chromaSADScale, IScriptEnvironment* env
+  int trad, bool mt_flag, int _chromaSADScale, bool stats_flag, IScriptEnvironment* env
 )
   : GenericVideoFilter(_super)
+  , _mem_info("MRecalculate")
   , _srd_arr()
   , _vectorfields_aptr()
   , _dct_factory_ptr()
   , _dct_pool()
   , _nbr_srd((trad > 0) ? trad * 2 : 1)
   , _mt_flag(mt_flag)
+  , _stats_flag(false)
+  , _kernel_info("MRecalculate")
 {
   has_at_least_v8 = true;
   try { env->CheckVersion(8); }
@@ -149,10 +153,25 @@ MVRecalculate::MVRecalculate(
     nSuperPel, nSuperHPad, nSuperVPad, nSuperModeYUV,
     cpuFlags, analysisData.xRatioUV, analysisData.yRatioUV, analysisData.pixelsize, analysisData.bits_per_pixel, mt_flag
   );
+  if (params.param & SUPER_PARAM_PEL_ON_DEMAND)
+  {
+    // MSuper ondemand=true: sub-pixel blocks are interpolated while searching
+    const int nSuperSharp = (params.param >> SUPER_PARAM_SHARP_SHIFT) & SUPER_PARAM_SHARP_MASK;
+    pRefGOF->set_interp(MVPlaneSet(nSuperModeYUV), 2, nSuperSharp);
+    pRefGOF->set_pel_on_demand(true);
+    pSrcGOF->set_pel_on_demand(true);
+  }
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    // MSuper virtualpad=true: blocks crossing the frame borders are clamped
+    pRefGOF->set_virtual_pad(true);
+    pSrcGOF->set_virtual_pad(true);
+  }
   const int nSuperWidth = child->GetVideoInfo().width;
+  const int nSuperHPadStored = (params.param & SUPER_PARAM_VIRTUAL_PAD) ? 0 : nSuperHPad;
 
   if (nHeight != analysisData.nHeight
-    || nSuperWidth - 2 * nSuperHPad != analysisData.nWidth)
+    || nSuperWidth - 2 * nSuperHPadStored != analysisData.nWidth)
   {
     env->ThrowError("MRecalculate : wrong frame size");
   }
@@ -312,6 +331,7 @@ MVRecalculate::MVRecalculate(
     analysisData.nBlkSizeX,
     analysisData.nBlkSizeY,
     analysisData.nLvCount,
+    0,
     analysisData.nPel,
     analysisData.nFlags,
     analysisData.nOverlapX,
@@ -329,6 +349,11 @@ MVRecalculate::MVRecalculate(
     env
   ));
 
+  _stats_flag = stats_flag && has_at_least_v8;
+  _vectorfields_aptr->EnableStats(_stats_flag);
+  _vectorfields_aptr->DescribeKernels(_kernel_info);
+  _kernel_info.Publish();
+
   analysisData.nMagicKey = MVAnalysisData::MOTION_MAGIC_KEY;
   analysisData.nHPadding = nSuperHPad;
   analysisData.nVPadding = nSuperVPad;
@@ -441,6 +466,8 @@ MVRecalculate::~MVRecalculate()
 
 PVideoFrame __stdcall MVRecalculate::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   const int		nsrc = n / _nbr_srd;
   const int		srd_index = n % _nbr_srd;
 
@@ -499,6 +526,7 @@ PVideoFrame __stdcall MVRecalculate::GetFrame(int n, IScriptEnvironment* env)
 
   PVideoFrame dst = env->NewVideoFrame(vi); // frame prop copy later if needed
   unsigned char *	pDst = dst->GetWritePtr();
+  unsigned char *	pHeader = pDst;
 
   // write analysis parameters as a header to frame
   memcpy(pDst, &headerSize, sizeof(int));
@@ -549,12 +577,19 @@ PVideoFrame __stdcall MVRecalculate::GetFrame(int n, IScriptEnvironment* env)
       fwrite(&n, sizeof(int), 1, outfile);	// write frame number
     }
 
+    // all the vector clips of a source frame share its source blocks
+    _vectorfields_aptr->SetSrcFrameId((_nbr_srd > 1) ? nsrc : -1);
     _vectorfields_aptr->RecalculateMVs(
       *(srd._clip_sptr), pSrcGOF, pRefGOF,
       searchType, nSearchParam, nLambda, lsad, pnew,
       srd._analysis_data.nFlags, reinterpret_cast <int *> (pDst),
       outfilebuf, fieldShift, thSAD, smooth, meander
     );
+    if (_stats_flag)
+    {
+      // only the finest level is searched
+      _vectorfields_aptr->WriteStatProps(dst, "MRecalculate_", 1, env);
+    }
 
     if (divideExtra)
     {
@@ -562,7 +597,8 @@ PVideoFrame __stdcall MVRecalculate::GetFrame(int n, IScriptEnvironment* env)
       // motion
       _vectorfields_aptr->ExtraDivide(
         reinterpret_cast <int *> (pDst),
-        srd._analysis_data.nFlags
+        srd._analysis_data.nFlags,
+        lsad
       );
     }
 
@@ -579,6 +615,13 @@ PVideoFrame __stdcall MVRecalculate::GetFrame(int n, IScriptEnvironment* env)
     }
   }
 
+  // scene change statistics of the exposed finest level
+  MVSceneStat::Write(
+    pHeader,
+    (divideExtra) ? srd._analysis_data_divided : srd._analysis_data,
+    reinterpret_cast <const int *> (pDst)
+  );
+
   return dst;
 }
 
@@ -28,6 +28,8 @@
 #include "commonfunctions.h"
 #include "DCTFactory.h"
 #include "GroupOfPlanes.h"
+#include "KernelInfo.h"
+#include "MemInfo.h"
 #include "MVAnalysisData.h"
 #include "yuy2planes.h"
 #include	"SharedPtr.h"
@@ -44,6 +46,8 @@ class MVRecalculate
 {
 protected:
 
+  MemInfo _mem_info; // First member: the other ones are charged to it
+
   class SrcRefData
   {
   public:
@@ -114,6 +118,8 @@ protected:
 
   int            _nbr_srd;
   bool           _mt_flag;
+  bool           _stats_flag; // search counters as frame properties (v8 only)
+  KernelInfo     _kernel_info; // selected kernels, for MToolsInfo()
 
     int pixelsize; // PF
     int bits_per_pixel;
@@ -125,7 +131,7 @@ public :
     int _blksizex, int _blksizey, int st, int stp, int lambda, bool chroma,
     int _pnew, int _overlapx, int _overlapy, const char* _outfilename,
     int _dctmode, int _divide, int _sadx264, bool _isse, bool _meander,
-		int trad, bool mt_flag, int _chromaSADScale, IScriptEnvironment* env
+		int trad, bool mt_flag, int _chromaSADScale, bool stats_flag, IScriptEnvironment* env
   );
   ~MVRecalculate();
 
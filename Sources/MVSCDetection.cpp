@@ -54,6 +54,8 @@ MVSCDetection::~MVSCDetection()
 
 PVideoFrame __stdcall MVSCDetection::GetFrame(int n, IScriptEnvironment* env)
 {
+   MemInfo::Scope mem_scope(&_mem_info);
+
    PVideoFrame dst = env->NewVideoFrame(vi); // no frame props here
 
   PVideoFrame mvn = mvClip.GetFrame(n, env);
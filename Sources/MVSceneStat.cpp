@@ -0,0 +1,149 @@
+// Scene change statistics stored in the vector frame header
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#include "MVSceneStat.h"
+#include "VECTOR.h"
+
+#include <algorithm>
+#include <cstring>
+
+static_assert(
+  MVSceneStat::HEADER_OFS + sizeof(MVSceneStat) <= 256,
+  "MVSceneStat does not fit in the vector frame header"
+);
+
+// round (256 * 2 ^ (k / 4))
+static const int scene_stat_edge_mul[MVSceneStat::NBR_EDGES] =
+{
+    256,   304,   362,   431,   512,   609,   724,   861,
+   1024,  1218,  1448,  1722,  2048,  2436,  2896,  3444,
+   4096,  4871,  5793,  6889,  8192,  9742, 11585, 13777,
+  16384, 19484, 23170, 27554, 32768, 38968, 46341, 55109
+};
+
+
+
+sad_t MVSceneStat::get_edge(int edge0, int k)
+{
+  const int64_t edge = (int64_t(edge0) * scene_stat_edge_mul[k]) >> 8;
+  return sad_t(std::min(edge, int64_t(INT32_MAX)));
+}
+
+
+
+void MVSceneStat::Write(unsigned char *frame_ptr, const MVAnalysisData &ana_data, const int *data_ptr)
+{
+  MVSceneStat stat;
+  stat.nMagicKey = 0;
+  stat.nEdge0 = 0;
+  stat.nBlkCount = 0;
+  std::fill(stat.nCountAbove, stat.nCountAbove + NBR_EDGES, 0);
+
+  if (data_ptr[1] != 0)
+  {
+    // finest plane is the last one. Its length may be the ExtraDivide mark.
+    const int *plane_ptr = data_ptr + 2;
+    for (int i = ana_data.nLvCount - 1; i > 0; i--)
+      plane_ptr += plane_ptr[0];
+    const VECTOR *blk_ptr = reinterpret_cast<const VECTOR *>(plane_ptr + 1);
+    const int nBlkCount = ana_data.nBlkX * ana_data.nBlkY;
+
+    // SAD of float clips are in 8-bit units
+    const int bits = (ana_data.pixelsize == 2) ? ana_data.bits_per_pixel : 8;
+    stat.nEdge0 = (ana_data.nBlkSizeX * ana_data.nBlkSizeY) << (bits - 8);
+    sad_t edges[NBR_EDGES];
+    for (int k = 0; k < NBR_EDGES; k++)
+      edges[k] = get_edge(stat.nEdge0, k);
+
+    // histogram first, then cumulated from the top
+    for (int i = 0; i < nBlkCount; i++)
+    {
+      const sad_t sad = blk_ptr[i].sad;
+      const int k = int(std::lower_bound(edges, edges + NBR_EDGES, sad) - edges);
+      if (k > 0)
+        stat.nCountAbove[k - 1]++;
+    }
+    for (int k = NBR_EDGES - 2; k >= 0; k--)
+      stat.nCountAbove[k] += stat.nCountAbove[k + 1];
+
+    stat.nBlkCount = nBlkCount;
+    stat.nMagicKey = MAGIC_KEY;
+  }
+
+  memcpy(frame_ptr + HEADER_OFS, &stat, sizeof(stat));
+}
+
+
+
+void MVSceneStat::Invalidate(unsigned char *frame_ptr, int header_size)
+{
+  if (header_size >= int(HEADER_OFS + sizeof(MVSceneStat)))
+  {
+    const int zero = 0;
+    memcpy(frame_ptr + HEADER_OFS, &zero, sizeof(zero));
+  }
+}
+
+
+
+const MVSceneStat *MVSceneStat::Read(const unsigned char *frame_ptr, int header_size)
+{
+  if (header_size < int(HEADER_OFS + sizeof(MVSceneStat)))
+    return nullptr;
+  const MVSceneStat *stat_ptr = reinterpret_cast<const MVSceneStat *>(frame_ptr + HEADER_OFS);
+  if (stat_ptr->nMagicKey != MAGIC_KEY)
+    return nullptr;
+
+  return stat_ptr;
+}
+
+
+
+// Counts the blocks with SAD > nThSCD1, as FakePlaneOfBlocks::IsSceneChange.
+// The count is between the counts of the edges bracketing the threshold.
+int MVSceneStat::IsSceneChange(sad_t nThSCD1, int nThSCD2) const
+{
+  // last edge <= nThSCD1
+  int k = NBR_EDGES - 1;
+  while (k >= 0 && get_edge(nEdge0, k) > nThSCD1)
+    k--;
+
+  int count_min;
+  int count_max;
+  if (k < 0)
+  {
+    count_min = nCountAbove[0];
+    count_max = nBlkCount;
+  }
+  else if (get_edge(nEdge0, k) == nThSCD1)
+  {
+    count_min = nCountAbove[k];
+    count_max = nCountAbove[k];
+  }
+  else
+  {
+    count_min = (k + 1 < NBR_EDGES) ? nCountAbove[k + 1] : 0;
+    count_max = nCountAbove[k];
+  }
+
+  if (count_min > nThSCD2)
+    return 1;
+  if (count_max <= nThSCD2)
+    return 0;
+  return -1;
+}
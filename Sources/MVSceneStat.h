@@ -0,0 +1,65 @@
+// Scene change statistics stored in the vector frame header
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#ifndef __MV_MVSceneStat__
+#define __MV_MVSceneStat__
+
+#include "MVAnalysisData.h"
+#include "types.h"
+
+#include <cstdint>
+
+// Number of finest level blocks whose SAD is above a set of log-spaced
+// thresholds (4 per octave). Written by MAnalyse and MRecalculate in the
+// unused part of the 256-byte vector frame header, after MVAnalysisData.
+// A scene change query is answered from the counts when the thresholds
+// bracketing thSCD1 agree on the result, otherwise the caller scans the
+// blocks.
+class MVSceneStat
+{
+public:
+
+  enum
+  {
+    MAGIC_KEY = 0x53434453, // 'SCDS'
+    NBR_EDGES = 32,
+    HEADER_OFS = (4 + sizeof(MVAnalysisData) + 15) & ~15 // bytes, from the frame start
+  };
+
+  int nMagicKey;
+  int nEdge0; // SAD of the lowest threshold, about 1 per pixel
+  int nBlkCount;
+  int nCountAbove[NBR_EDGES]; // blocks with SAD > edge k
+
+  // Computes the statistics from the vector data and stores them in the
+  // frame header. Invalid vector data are marked as having no statistics.
+  static void Write(unsigned char *frame_ptr, const MVAnalysisData &ana_data, const int *data_ptr);
+  static void Invalidate(unsigned char *frame_ptr, int header_size);
+
+  // Returns nullptr if the frame header holds no statistics.
+  static const MVSceneStat *Read(const unsigned char *frame_ptr, int header_size);
+
+  // 1: scene change, 0: no scene change, -1: undecided
+  int IsSceneChange(sad_t nThSCD1, int nThSCD2) const;
+
+private:
+
+  static sad_t get_edge(int edge0, int k);
+};
+
+#endif // __MV_MVSceneStat__
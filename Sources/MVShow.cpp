@@ -62,6 +62,10 @@ mvClip(vectors, nSCD1, nSCD2, env, 1, 0)
   // get parameters of prepared super clip - v2.0
   SuperParams64Bits params;
   memcpy(&params, &vi.num_audio_samples, 8);
+  if (params.param & SUPER_PARAM_VIRTUAL_PAD)
+  {
+    env->ThrowError("MShow: super clip with virtualpad=true is not supported");
+  }
   int nHeightS = params.nHeight;
   nSuperHPad = params.nHPad;
   nSuperVPad = params.nVPad;
@@ -94,6 +98,8 @@ MVShow::~MVShow()
 
 PVideoFrame __stdcall MVShow::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   PVideoFrame	src = child->GetFrame(n, env);
   PVideoFrame	dst = has_at_least_v8 ? env->NewVideoFrameP(vi, &src) : env->NewVideoFrame(vi); // frame property support
 
@@ -43,11 +43,15 @@ int64_t ProfCumulatedResults[MOTION_PROFILE_COUNT * 2];
 MVSuper::MVSuper(
   PClip _child, int _hPad, int _vPad, int _pel, int _levels, bool _chroma,
   int _sharp, int _rfilter, PClip _pelclip, bool _isse, bool _planar,
-  bool mt_flag, IScriptEnvironment* env
+  bool mt_flag, bool ondemand_flag, bool virtualpad_flag, IScriptEnvironment* env
 )
   : GenericVideoFilter(_child)
+  , _mem_info("MSuper")
   , pelclip(_pelclip)
   , _mt_flag(mt_flag)
+  , _pel_on_demand_flag(false)
+  , _virtual_pad_flag(virtualpad_flag)
+  , _kernel_info("MSuper")
 {
   has_at_least_v8 = true;
   try { env->CheckVersion(8); }
@@ -127,8 +131,36 @@ MVSuper::MVSuper(
     }
   }
 
-  nSuperWidth = nWidth + 2 * nHPad;
-  nSuperHeight = PlaneSuperOffset(false, nHeight, nLevels, nPel, nVPad, nSuperWidth*pixelsize, yRatioUV) / (nSuperWidth*pixelsize);
+  if (ondemand_flag && nPel > 1)
+  {
+    if (usePelClip)
+    {
+      env->ThrowError("MSuper: pelclip cannot be used with ondemand=true");
+    }
+    if (sharp < 0 || sharp > 2)
+    {
+      env->ThrowError("MSuper: sharp must be 0, 1 or 2");
+    }
+    _pel_on_demand_flag = true;
+  }
+
+  if (_virtual_pad_flag)
+  {
+    if (usePelClip)
+    {
+      env->ThrowError("MSuper: pelclip cannot be used with virtualpad=true");
+    }
+    if (_pel_on_demand_flag)
+    {
+      env->ThrowError("MSuper: ondemand and virtualpad cannot be both true");
+    }
+  }
+
+  // the padding is not stored with virtualpad
+  nSuperWidth = (_virtual_pad_flag) ? nWidth : nWidth + 2 * nHPad;
+  // only the full-pel plane of the finest level is stored with ondemand
+  const int nPelStored = (_pel_on_demand_flag) ? 1 : nPel;
+  nSuperHeight = PlaneSuperOffset(false, nHeight, nLevels, nPelStored, nVPad, nSuperWidth*pixelsize, yRatioUV, !_virtual_pad_flag) / (nSuperWidth*pixelsize);
   if (yRatioUV == 2 && nSuperHeight & 1) nSuperHeight++; // even
   vi.width = nSuperWidth;
   vi.height = nSuperHeight;
@@ -151,6 +183,15 @@ MVSuper::MVSuper(
   params.nPel = nPel;
   params.nModeYUV = nModeYUV;
   params.nLevels = nLevels;
+  params.param = 0;
+  if (_pel_on_demand_flag)
+  {
+    params.param = SUPER_PARAM_PEL_ON_DEMAND | (sharp << SUPER_PARAM_SHARP_SHIFT);
+  }
+  if (_virtual_pad_flag)
+  {
+    params.param |= SUPER_PARAM_VIRTUAL_PAD;
+  }
 
 
   // pack parameters to fake audio properties
@@ -162,6 +203,12 @@ MVSuper::MVSuper(
   pSrcGOF = new MVGroupOfFrames(nLevels, nWidth, nHeight, nPel, nHPad, nVPad, YUVPLANES, cpuFlags, xRatioUV, yRatioUV, pixelsize, bits_per_pixel, mt_flag);
 
   pSrcGOF->set_interp(nModeYUV, rfilter, sharp);
+  pSrcGOF->set_pel_on_demand(_pel_on_demand_flag);
+  pSrcGOF->set_virtual_pad(_virtual_pad_flag);
+
+  pSrcGOF->GetFrame(0)->GetPlane(YPLANE)->describe_kernels(
+    _kernel_info, rfilter, usePelClip, env->GetCPUFlags());
+  _kernel_info.Publish();
 
   PROFILE_INIT();
 }
@@ -184,6 +231,8 @@ MVSuper::~MVSuper()
 
 PVideoFrame __stdcall MVSuper::GetFrame(int n, IScriptEnvironment* env)
 {
+  MemInfo::Scope mem_scope(&_mem_info);
+
   const unsigned char *pSrc[3];
   unsigned char *pDst[3];
   const unsigned char *pSrcPel[3];
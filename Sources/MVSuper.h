@@ -22,6 +22,8 @@
 #define __MV_SUPER__
 
 #include "commonfunctions.h"
+#include "KernelInfo.h"
+#include "MemInfo.h"
 #include "yuy2planes.h"
 #include	"avisynth.h"
 #include "stdint.h"
@@ -53,8 +55,11 @@ MV_FORCEINLINE int PlaneWidthLuma(int src_width, int level, int xRatioUV, int hp
 
 // PF: OK no need for xRatioUV here
 // returned offset is pixelsize-aware because plane_pitch is in bytes
-MV_FORCEINLINE unsigned int PlaneSuperOffset(bool chroma, int src_height, int level, int pel, int vpad, int plane_pitch, int yRatioUV)
+// vpad_stored: false when the padding is not stored (MSuper virtualpad), vpad
+// still sets the sizes of the levels.
+MV_FORCEINLINE unsigned int PlaneSuperOffset(bool chroma, int src_height, int level, int pel, int vpad, int plane_pitch, int yRatioUV, bool vpad_stored = true)
 {
+  const int vpad_st = (vpad_stored) ? vpad : 0;
   // storing subplanes in superframes may be implemented by various ways
   int height = src_height; // luma or chroma
 
@@ -66,7 +71,7 @@ MV_FORCEINLINE unsigned int PlaneSuperOffset(bool chroma, int src_height, int le
   }
   else
   {
-    offset = pel * pel*plane_pitch*(src_height + vpad * 2);
+    offset = pel * pel*plane_pitch*(src_height + vpad_st * 2);
 
     for (int i = 1; i < level; i++)
     {
@@ -75,7 +80,7 @@ MV_FORCEINLINE unsigned int PlaneSuperOffset(bool chroma, int src_height, int le
         // PF 20181113: Why is it good to use yRatioUV for luma???
         PlaneHeightLuma(src_height, i, yRatioUV, vpad);
 
-      offset += plane_pitch * (height + vpad * 2);
+      offset += plane_pitch * (height + vpad_st * 2);
     }
   }
   return offset;
@@ -86,6 +91,7 @@ class MVSuper
   : public GenericVideoFilter
 {
 private:
+  MemInfo _mem_info; // First member: the other ones are charged to it
   bool has_at_least_v8;
 
 protected:
@@ -127,13 +133,16 @@ protected:
   bool           isPelClipPadded;
 
   bool           _mt_flag; // PF maybe 2.6.0.5
+  bool           _pel_on_demand_flag; // sub-pixel planes are not stored, clients interpolate them
+  bool           _virtual_pad_flag;   // padding is not stored, clients clamp the blocks
+  KernelInfo     _kernel_info;        // selected kernels, for MToolsInfo()
 
 public:
 
   MVSuper(
     PClip _child, int _hpad, int _vpad, int pel, int _levels, bool _chroma,
     int _sharp, int _rfilter, PClip _pelclip, bool _isse, bool _planar,
-    bool mt_flag, IScriptEnvironment* env
+    bool mt_flag, bool ondemand_flag, bool virtualpad_flag, IScriptEnvironment* env
   );
   ~MVSuper();
 
@@ -0,0 +1,288 @@
+// Memory allocated by the filter instances
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "MemInfo.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+
+std::mutex MemInfo::_mtx;
+std::vector<const MemInfo *> MemInfo::_instances;
+std::array<MemInfo::Shard, MemInfo::_nbr_shards> MemInfo::_shard_arr;
+std::atomic<size_t> MemInfo::_orphan_bytes(0);
+
+// Instance charged on this thread, and whether the next MemInfo
+// constructed takes this place (a filter is being created)
+static thread_local MemInfo *mem_info_cur_ptr = nullptr;
+static thread_local bool mem_info_adopt_flag = false;
+
+
+
+// Instances are numbered per filter, from 1, in creation order
+MemInfo::MemInfo(const std::string &filter_name)
+  : _filter(filter_name)
+  , _cur_bytes(0)
+  , _peak_bytes(0)
+  , _nbr_blocks(0)
+{
+  static std::map<std::string, int> counters;
+
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    const int index = ++counters[filter_name];
+    _name = filter_name + " #" + std::to_string(index);
+    _instances.push_back(this);
+  }
+
+  if (mem_info_adopt_flag && mem_info_cur_ptr == nullptr)
+  {
+    mem_info_cur_ptr = this;
+    mem_info_adopt_flag = false;
+  }
+}
+
+
+
+// The blocks still allocated (shared with other filters) are kept as
+// orphans until they are freed.
+MemInfo::~MemInfo()
+{
+  if (mem_info_cur_ptr == this)
+    mem_info_cur_ptr = nullptr;
+
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _instances.erase(std::remove(_instances.begin(), _instances.end(), this), _instances.end());
+  }
+
+  for (Shard &shard : _shard_arr)
+  {
+    if (_nbr_blocks.load(std::memory_order_relaxed) == 0)
+      break;
+    if (shard.nbr_blocks.load(std::memory_order_relaxed) == 0)
+      continue;
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    for (auto &b : shard.block_map)
+    {
+      if (b.second.owner_ptr == this)
+      {
+        b.second.owner_ptr = nullptr;
+        --_nbr_blocks;
+        _orphan_bytes += b.second.nbr_bytes;
+      }
+    }
+  }
+}
+
+
+
+MemInfo::Scope::Scope()
+  : _prev_ptr(mem_info_cur_ptr)
+  , _prev_adopt_flag(mem_info_adopt_flag)
+{
+  mem_info_cur_ptr = nullptr;
+  mem_info_adopt_flag = true;
+}
+
+
+
+MemInfo::Scope::Scope(MemInfo *info_ptr)
+  : _prev_ptr(mem_info_cur_ptr)
+  , _prev_adopt_flag(mem_info_adopt_flag)
+{
+  mem_info_cur_ptr = info_ptr;
+  mem_info_adopt_flag = false;
+}
+
+
+
+MemInfo::Scope::~Scope()
+{
+  mem_info_cur_ptr = _prev_ptr;
+  mem_info_adopt_flag = _prev_adopt_flag;
+}
+
+
+
+MemInfo *MemInfo::GetCurrent()
+{
+  return mem_info_cur_ptr;
+}
+
+
+
+void MemInfo::OnAlloc(const void *ptr, size_t nbr_bytes)
+{
+  MemInfo *info_ptr = mem_info_cur_ptr;
+  if (info_ptr == nullptr || ptr == nullptr)
+    return;
+
+  Shard &shard = UseShard(ptr);
+  {
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    Block &b = shard.block_map[ptr];
+    if (b.owner_ptr != nullptr)
+    {
+      // Freed without the hook: forget it
+      b.owner_ptr->_cur_bytes -= b.nbr_bytes;
+      --b.owner_ptr->_nbr_blocks;
+    }
+    b.owner_ptr = info_ptr;
+    b.nbr_bytes = nbr_bytes;
+    shard.nbr_blocks.store(int(shard.block_map.size()), std::memory_order_relaxed);
+  }
+
+  const size_t cur_bytes = (info_ptr->_cur_bytes += nbr_bytes);
+  size_t peak_bytes = info_ptr->_peak_bytes.load(std::memory_order_relaxed);
+  while (cur_bytes > peak_bytes
+    && !info_ptr->_peak_bytes.compare_exchange_weak(peak_bytes, cur_bytes))
+    continue;
+  ++info_ptr->_nbr_blocks;
+}
+
+
+
+void MemInfo::OnFree(const void *ptr)
+{
+  if (ptr == nullptr)
+    return;
+
+  // Nothing charged in this shard: no lock
+  Shard &shard = UseShard(ptr);
+  if (shard.nbr_blocks.load(std::memory_order_relaxed) == 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(shard.mtx);
+  auto it = shard.block_map.find(ptr);
+  if (it == shard.block_map.end())
+    return;
+
+  MemInfo *info_ptr = it->second.owner_ptr;
+  if (info_ptr != nullptr)
+  {
+    info_ptr->_cur_bytes -= it->second.nbr_bytes;
+    --info_ptr->_nbr_blocks;
+  }
+  else
+    _orphan_bytes -= it->second.nbr_bytes;
+  shard.block_map.erase(it);
+  shard.nbr_blocks.store(int(shard.block_map.size()), std::memory_order_relaxed);
+}
+
+
+
+// The blocks are aligned, the low bits of the address are dropped
+MemInfo::Shard &MemInfo::UseShard(const void *ptr)
+{
+  const uint64_t addr = uint64_t(reinterpret_cast<uintptr_t>(ptr));
+  const uint64_t hash = (addr >> 4) * 0x9E3779B97F4A7C15ULL;
+  return _shard_arr[size_t(hash >> 58)];
+}
+
+
+
+// The peak of a filter is the sum of the peaks of its instances
+std::string MemInfo::Report(const std::string &filter_name)
+{
+  struct Total
+  {
+    int nbr_inst;
+    size_t cur_bytes;
+    size_t peak_bytes;
+  };
+
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  std::string text;
+  std::vector<std::string> filter_list; // in order of first creation
+  std::map<std::string, Total> total_map;
+  Total all = { 0, 0, 0 };
+  for (const MemInfo *info_ptr : _instances)
+  {
+    if (!filter_name.empty() && info_ptr->_filter != filter_name)
+      continue;
+
+    char txt_0[256];
+    snprintf(txt_0, sizeof(txt_0), "%-22s %12s  peak %12s  %6d blocks\n",
+      info_ptr->_name.c_str(), FormatSize(info_ptr->_cur_bytes).c_str(),
+      FormatSize(info_ptr->_peak_bytes).c_str(), info_ptr->_nbr_blocks.load());
+    text += txt_0;
+
+    auto it = total_map.find(info_ptr->_filter);
+    if (it == total_map.end())
+    {
+      filter_list.push_back(info_ptr->_filter);
+      it = total_map.insert(std::make_pair(info_ptr->_filter, Total{ 0, 0, 0 })).first;
+    }
+    for (Total *t_ptr : { &it->second, &all })
+    {
+      ++t_ptr->nbr_inst;
+      t_ptr->cur_bytes += info_ptr->_cur_bytes;
+      t_ptr->peak_bytes += info_ptr->_peak_bytes;
+    }
+  }
+
+  if (all.nbr_inst == 0)
+    return text;
+
+  text += "Total\n";
+  for (const std::string &filter : filter_list)
+  {
+    const Total &t = total_map[filter];
+    char txt_0[256];
+    snprintf(txt_0, sizeof(txt_0), "  %-20s %12s  peak %12s  %6d instances\n",
+      filter.c_str(), FormatSize(t.cur_bytes).c_str(),
+      FormatSize(t.peak_bytes).c_str(), t.nbr_inst);
+    text += txt_0;
+  }
+  if (filter_name.empty())
+  {
+    char txt_0[256];
+    snprintf(txt_0, sizeof(txt_0), "  %-20s %12s  peak %12s  %6d instances\n",
+      "all", FormatSize(all.cur_bytes).c_str(),
+      FormatSize(all.peak_bytes).c_str(), all.nbr_inst);
+    text += txt_0;
+    if (_orphan_bytes > 0)
+    {
+      snprintf(txt_0, sizeof(txt_0), "  %-20s %12s\n",
+        "released filters", FormatSize(_orphan_bytes).c_str());
+      text += txt_0;
+    }
+  }
+
+  return text;
+}
+
+
+
+// "12.34 MiB"
+std::string MemInfo::FormatSize(size_t nbr_bytes)
+{
+  char txt_0[64];
+  if (nbr_bytes < 1024)
+    snprintf(txt_0, sizeof(txt_0), "%d B", int(nbr_bytes));
+  else if (nbr_bytes < 1024 * 1024)
+    snprintf(txt_0, sizeof(txt_0), "%.2f KiB", nbr_bytes / 1024.0);
+  else
+    snprintf(txt_0, sizeof(txt_0), "%.2f MiB", nbr_bytes / (1024.0 * 1024.0));
+  return txt_0;
+}
@@ -0,0 +1,112 @@
+// Memory allocated by the filter instances
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+#ifndef __MV_MemInfo__
+#define __MV_MemInfo__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per filter instance: bytes currently allocated, peak and block count.
+// The aligned allocators (fstb::AllocHuge, fstb::AllocAlign,
+// aligned_allocator) and the DCT buffers call OnAlloc() and OnFree(); a
+// block is charged to the instance of the scope open on the calling thread,
+// and is not counted when there is none. A scope is open while a filter is
+// created, in its GetFrame(), and in the tasks started from them by MTSlicer
+// and MTFlowGraphSched. The frames are allocated by Avisynth and are not
+// counted, nor the std containers with the default allocator.
+// The live instances are listed by MToolsMemory().
+class MemInfo
+{
+public:
+
+  explicit MemInfo(const std::string &filter_name);
+  ~MemInfo();
+
+  // Scope() is open while a filter is created: the first MemInfo
+  // constructed in it is charged with the allocations of the thread, until
+  // the end of the scope. Scope(info_ptr) charges info_ptr (can be 0), for
+  // the objects created later by the pools, possibly on other threads.
+  class Scope
+  {
+  public:
+    Scope();
+    explicit Scope(MemInfo *info_ptr);
+    ~Scope();
+  private:
+    MemInfo *_prev_ptr;
+    bool _prev_adopt_flag;
+    Scope(const Scope &other) = delete;
+    Scope &operator = (const Scope &other) = delete;
+  };
+
+  // Instance charged on the calling thread, 0 if none
+  static MemInfo *GetCurrent();
+
+  // Allocation hook. ptr can be 0.
+  static void OnAlloc(const void *ptr, size_t nbr_bytes);
+  static void OnFree(const void *ptr);
+
+  // Description of the live instances, of all the filters or only of
+  // filter_name when not empty, followed by the totals per filter
+  static std::string Report(const std::string &filter_name);
+
+private:
+
+  struct Block
+  {
+    MemInfo *owner_ptr; // 0: owner destroyed, the block is still in use
+    size_t nbr_bytes;
+  };
+
+  // The blocks are spread over shards by address, so that the frees of
+  // different threads seldom wait for each other. A free in an empty shard
+  // takes no lock.
+  struct alignas(64) Shard
+  {
+    std::mutex mtx;
+    std::unordered_map<const void *, Block> block_map;
+    std::atomic<int> nbr_blocks{ 0 }; // block_map.size(), read without lock
+  };
+
+  static const int _nbr_shards = 64;
+
+  static Shard &UseShard(const void *ptr);
+  static std::string FormatSize(size_t nbr_bytes);
+
+  MemInfo(const MemInfo &other) = delete;
+  MemInfo &operator = (const MemInfo &other) = delete;
+
+  std::string _filter;    // "MAnalyse"
+  std::string _name;      // "MAnalyse #2"
+  std::atomic<size_t> _cur_bytes;
+  std::atomic<size_t> _peak_bytes;
+  std::atomic<int> _nbr_blocks;
+
+  static std::mutex _mtx; // _instances and the instance counters
+  static std::vector<const MemInfo *> _instances;
+  static std::array<Shard, _nbr_shards> _shard_arr;
+  static std::atomic<size_t> _orphan_bytes; // blocks of the destroyed instances
+};
+
+#endif // __MV_MemInfo__
@@ -26,12 +26,15 @@
 #include "DCTFactory.h"
 #include "debugprintf.h"
 #include "FakePlaneOfBlocks.h"
+#include "KernelInfo.h"
+#include "MemInfo.h"
 #include "MVClip.h"
 #include "MVFrame.h"
 #include "MVPlane.h"
 #include "PlaneOfBlocks.h"
 #include "Padding.h"
 #include "profile.h"
+#include "SADFunctions_sse41.h"
 
 #include <emmintrin.h> // SSE2
 #include <pmmintrin.h> // SSE3
@@ -39,6 +42,7 @@
 #include <smmintrin.h> // SSE4
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <stdexcept>
 #include <stdint.h>
@@ -85,6 +89,12 @@ PlaneOfBlocks::PlaneOfBlocks(int _nBlkX, int _nBlkY, int _nBlkSizeX, int _nBlkSi
   , BLITCHROMA(0)
   , SADCHROMA(0)
   , SATD(0)
+  , TILESAD(0)
+  , BLITTILE(0)
+  , SADROW8(0)
+  , SADPART(0)
+  , SADSUB(0)
+  , SADCHROMASUB(0)
   , vectors(nBlkCount)
   , smallestPlane((_nFlags & MOTION_SMALLEST_PLANE) != 0)
   , isse((_nFlags & MOTION_USE_ISSE) != 0)
@@ -96,10 +106,43 @@ PlaneOfBlocks::PlaneOfBlocks(int _nBlkX, int _nBlkY, int _nBlkSizeX, int _nBlkSi
   , dctmode(0)
   , _workarea_fact(nBlkSizeX, nBlkSizeY, dctpitch, nLogxRatioUV, nLogyRatioUV, pixelsize, bits_per_pixel)
   , _workarea_pool()
+  , _skipSAD(0)
+  , _skip_count(0)
+  , _stats_flag(false)
+  , _stat_nbr_sad(0)
+  , _stat_time_us(0)
+  , _adaptive_range_flag(false)
+  , _tile_cache_flag(false)
+  , _tile_glob_flag(false)
+  , _tile_w(0)
+  , _tile_h(0)
+  , _tile_nx(0)
+  , _tile_ny(0)
+  , _tile_cols(0)
+  , _tile_rows(0)
+  , _tile_sad_zero()
+  , _tile_sad_glob()
+  , _grid_search_flag(false)
+  , _sad_part_h(0)
+  , _pel_on_demand_flag(false)
+  , _virtual_pad_flag(false)
+  , _pel_gen(0)
   , _gvect_estim_ptr(0)
   , _gvect_result_count(0)
+  , _src_frame_id(-1)
+  , _src_cache_id(-1)
+  , _src_cache_read(false)
+  , _src_cache_fill(false)
+  , _src_cache_blk_size(0)
+  , _src_cache_dct_size(0)
+  , _src_cache_blk()
+  , _src_cache_dct()
+  , _src_cache_luma()
 {
   _workarea_pool.set_factory(_workarea_fact);
+  ResetStats();
+  badcount = 0;
+  planeSAD = 0;
 
   // half must be more than max vector length, which is (framewidth + Padding) * nPel
   freqArray[0].resize(8192 * _nPel * 2);
@@ -166,6 +209,7 @@ PlaneOfBlocks::PlaneOfBlocks(int _nBlkX, int _nBlkY, int _nBlkSizeX, int _nBlkSi
     arch = USE_SSE2;
   else
     arch = NO_SIMD;
+  _arch = arch;
 
   SAD = get_sad_function(nBlkSizeX, nBlkSizeY, bits_per_pixel, arch);
   SADCHROMA = get_sad_function(nBlkSizeX / xRatioUV, nBlkSizeY / yRatioUV, bits_per_pixel, arch);
@@ -246,6 +290,56 @@ PlaneOfBlocks::PlaneOfBlocks(int _nBlkX, int _nBlkY, int _nBlkSizeX, int _nBlkSi
     }
   }
 #endif
+
+  // Tile SAD cache: only when blocks overlap and are made of whole tiles.
+  // Integer SAD is additive, so the composed SAD is exact. Not for DCT modes.
+  if ((nFlags & MOTION_USE_TILE_SAD_CACHE) != 0
+    && (nOverlapX > 0 || nOverlapY > 0)
+    && pixelsize <= 2 && dctmode == 0)
+  {
+    _tile_w = nBlkSizeX - nOverlapX;
+    _tile_h = nBlkSizeY - nOverlapY;
+    if (nBlkSizeX % _tile_w == 0 && nBlkSizeY % _tile_h == 0)
+    {
+      TILESAD = get_sad_function(_tile_w, _tile_h, bits_per_pixel, arch);
+      BLITTILE = get_copy_function(_tile_w, _tile_h, pixelsize, arch);
+      if (TILESAD != nullptr && BLITTILE != nullptr)
+      {
+        _tile_nx = nBlkSizeX / _tile_w;
+        _tile_ny = nBlkSizeY / _tile_h;
+        _tile_cols = nBlkX - 1 + _tile_nx;
+        _tile_rows = nBlkY - 1 + _tile_ny;
+        _tile_sad_zero.resize(_tile_cols * _tile_rows);
+        _tile_sad_glob.resize(_tile_cols * _tile_rows);
+        _tile_cache_flag = true;
+      }
+    }
+  }
+
+  // Exhaustive search SAD grid. Row SADs are exact, so the result is the same.
+  if (pixelsize == 1 && dctmode == 0)
+  {
+    SADROW8 = get_sad_row8_function(nBlkSizeX, nBlkSizeY, bits_per_pixel, arch);
+    _grid_search_flag = (SADROW8 != nullptr);
+  }
+
+  // Early termination by quarters of the block, only worth for large blocks
+  if (pixelsize <= 2 && dctmode == 0
+    && nBlkSizeY % 4 == 0 && nBlkSizeX * nBlkSizeY >= 32 * 16)
+  {
+    SADPART = get_sad_function(nBlkSizeX, nBlkSizeY / 4, bits_per_pixel, arch);
+    if (SADPART != nullptr)
+    {
+      _sad_part_h = nBlkSizeY / 4;
+    }
+  }
+
+  // Quadtree split of the finest plane (divide=3)
+  if (nLogScale == 0)
+  {
+    SADSUB = get_sad_function(nBlkSizeX / 2, nBlkSizeY / 2, bits_per_pixel, arch);
+    SADCHROMASUB = get_sad_function(nBlkSizeX / 2 / xRatioUV, nBlkSizeY / 2 / yRatioUV, bits_per_pixel, arch);
+  }
 }
 
 
@@ -261,7 +355,8 @@ void PlaneOfBlocks::SearchMVs(
   SearchType st, int stp, int lambda, sad_t lsad, int pnew,
   int plevel, int flags, sad_t *out, const VECTOR * globalMVec,
   short *outfilebuf, int fieldShift, sad_t * pmeanLumaChange,
-  int divideExtra, int _pzero, int _pglobal, sad_t _badSAD, int _badrange, bool meander, int *vecPrev, bool _tryMany
+  int divideExtra, int _pzero, int _pglobal, sad_t _badSAD, int _badrange, bool meander, int *vecPrev, bool _tryMany,
+  sad_t skipSAD, bool adaptive_flag
 )
 {
   // -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
@@ -278,6 +373,11 @@ void PlaneOfBlocks::SearchMVs(
 
   badSAD = _badSAD;
   badrange = _badrange;
+  _skipSAD = skipSAD;
+  _skip_count = 0;
+  const auto t_beg = (_stats_flag) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  ResetStats();
+  _adaptive_range_flag = adaptive_flag;
   _glob_mv_pred_def.x = globalMVec->x * nPel;	// v1.8.2
   _glob_mv_pred_def.y = globalMVec->y * nPel + fieldShift;
   _glob_mv_pred_def.sad = globalMVec->sad;
@@ -323,6 +423,9 @@ void PlaneOfBlocks::SearchMVs(
     nRefPitch[1] = pRefFrame->GetPlane(UPLANE)->GetPitch();
     nRefPitch[2] = pRefFrame->GetPlane(VPLANE)->GetPitch();
   }
+  _pel_on_demand_flag = (nPel > 1 && pRefFrame->GetPlane(YPLANE)->IsPelOnDemand());
+  _virtual_pad_flag = pRefFrame->GetPlane(YPLANE)->IsVirtualPad();
+  ++_pel_gen;
 
   searchType = st;		// ( nLogScale == 0 ) ? st : EXHAUSTIVE;
   nSearchParam = stp;	// *nPel;	// v1.8.2 - redesigned in v1.8.5
@@ -362,11 +465,22 @@ void PlaneOfBlocks::SearchMVs(
   penaltyNew = _pnew; // penalty for new vector
   LSAD = _lsad;    // SAD limit for lambda using
 
+  StartSrcCache();
+
   Slicer			slicer(_mt_flag); // fixme: mt bug
+
+  if (_tile_cache_flag)
+  {
+    // zero and global vector tiles, shared by the overlapping blocks
+    _tile_glob_flag = (_glob_mv_pred_def.x != zeroMVfieldShifted.x || _glob_mv_pred_def.y != zeroMVfieldShifted.y);
+    slicer.start(_tile_rows, *this, &PlaneOfBlocks::tile_sad_slice, 4);
+    slicer.wait();
+  }
+
   if(bits_per_pixel == 8)
-    slicer.start(nBlkY, *this, &PlaneOfBlocks::search_mv_slice<uint8_t>, 4);
+    slicer.start(nBlkY, *this, select_search_mv_slice<uint8_t>(), 4);
   else
-    slicer.start(nBlkY, *this, &PlaneOfBlocks::search_mv_slice<uint16_t>, 4);
+    slicer.start(nBlkY, *this, select_search_mv_slice<uint16_t>(), 4);
   slicer.wait();
 
   // -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
@@ -376,6 +490,10 @@ void PlaneOfBlocks::SearchMVs(
     *pmeanLumaChange = (sad_t)(sumLumaChange / nBlkCount); // for all finer planes
   }
 
+  if (_stats_flag)
+  {
+    _stat_time_us = std::chrono::duration <double, std::micro> (std::chrono::steady_clock::now() - t_beg).count();
+  }
 }
 
 
@@ -402,6 +520,11 @@ void PlaneOfBlocks::RecalculateMVs(
   _glob_mv_pred_def.y = fieldShift;
   _glob_mv_pred_def.sad = 9999999;
 
+  const auto t_beg = (_stats_flag) ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  ResetStats();
+  _skip_count = 0;
+  badcount = 0;
+
   //	int nOutPitchY = nBlkX * (nBlkSizeX - nOverlapX) + nOverlapX;
   //	int nOutPitchUV = (nBlkX * (nBlkSizeX - nOverlapX) + nOverlapX) / 2; // xRatioUV=2
   //	char debugbuf[128];
@@ -443,6 +566,9 @@ void PlaneOfBlocks::RecalculateMVs(
     nRefPitch[1] = pRefFrame->GetPlane(UPLANE)->GetPitch();
     nRefPitch[2] = pRefFrame->GetPlane(VPLANE)->GetPitch();
   }
+  _pel_on_demand_flag = (nPel > 1 && pRefFrame->GetPlane(YPLANE)->IsPelOnDemand());
+  _virtual_pad_flag = pRefFrame->GetPlane(YPLANE)->IsVirtualPad();
+  ++_pel_gen;
 
   searchType = st;
   nSearchParam = stp;//*nPel; // v1.8.2 - redesigned in v1.8.5
@@ -471,18 +597,118 @@ void PlaneOfBlocks::RecalculateMVs(
 
   // -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
   // fixme: consider disabling internal mt, it's giving inconsistent results when used
+  StartSrcCache();
+
   Slicer			slicer(_mt_flag);
   if(pixelsize==1)
-    slicer.start(nBlkY, *this, &PlaneOfBlocks::recalculate_mv_slice<uint8_t>, 4);
+    slicer.start(nBlkY, *this, &PlaneOfBlocks::recalculate_mv_slice<uint8_t, PEL_GENERIC>, 4);
   else
-    slicer.start(nBlkY, *this, &PlaneOfBlocks::recalculate_mv_slice<uint16_t>, 4);
+    slicer.start(nBlkY, *this, &PlaneOfBlocks::recalculate_mv_slice<uint16_t, PEL_GENERIC>, 4);
   slicer.wait();
 
+  if (_stats_flag)
+  {
+    _stat_time_us = std::chrono::duration <double, std::micro> (std::chrono::steady_clock::now() - t_beg).count();
+  }
+
   // -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -  -
 }
 
 
 
+void PlaneOfBlocks::CollectStats(const WorkingArea &workarea)
+{
+  _stat_nbr_sad += workarea.sadCount;
+  for (int k = 0; k < WIN_NBR_ELT; ++k)
+  {
+    _stat_nbr_win[k] += workarea.winCount[k];
+  }
+}
+
+
+
+void PlaneOfBlocks::ResetStats()
+{
+  _stat_nbr_sad = 0;
+  for (int k = 0; k < WIN_NBR_ELT; ++k)
+  {
+    _stat_nbr_win[k] = 0;
+  }
+  _stat_time_us = 0;
+}
+
+
+
+PlaneOfBlocks::SearchStats PlaneOfBlocks::GetStats() const
+{
+  SearchStats stats;
+  stats.nbr_blk = nBlkCount - _skip_count;
+  stats.nbr_sad = _stat_nbr_sad;
+  for (int k = 0; k < WIN_NBR_ELT; ++k)
+  {
+    stats.nbr_win[k] = _stat_nbr_win[k];
+  }
+  stats.nbr_bad = badcount;
+  stats.plane_sad = planeSAD;
+  stats.time_us = _stat_time_us;
+  return stats;
+}
+
+
+
+void PlaneOfBlocks::DescribeKernels(KernelInfo &info) const
+{
+  const arch_t arch_cpu = avx2 ? USE_AVX2 : avx ? USE_AVX : sse41 ? USE_SSE41 : sse2 ? USE_SSE2 : NO_SIMD;
+  const int bx = nBlkSizeX;
+  const int by = nBlkSizeY;
+  const int bxc = nBlkSizeX / xRatioUV;
+  const int byc = nBlkSizeY / yRatioUV;
+  const int bpp = bits_per_pixel;
+  const int psz = pixelsize;
+  const std::string config = KernelInfo::Config(bx, by, bpp);
+  const std::string config_c = KernelInfo::Config(bxc, byc, bpp);
+
+  info.Add("SAD", config, _arch, arch_cpu,
+    [=](arch_t a) { return get_sad_function(bx, by, bpp, a); });
+  if (chroma)
+  {
+    info.Add("SAD chroma", config_c, _arch, arch_cpu,
+      [=](arch_t a) { return get_sad_function(bxc, byc, bpp, a); });
+  }
+  if (pixelsize == 1 && dctmode == 0)
+  {
+    info.Add("SAD row8", config, _arch, arch_cpu,
+      [=](arch_t a) { return get_sad_row8_function(bx, by, bpp, a); });
+  }
+  if (dctmode >= 5)
+  {
+#ifdef USE_SATD_ASM
+    const char *satd_reason = nullptr;
+#else
+    const char *satd_reason = (pixelsize == 1) ? "8-bit SIMD SATD is x264 asm, not built (USE_SATD_ASM)" : nullptr;
+#endif
+    info.Add("SATD", config, _arch, arch_cpu,
+      [=](arch_t a) { return get_satd_function(bx, by, psz, a); }, satd_reason);
+  }
+  info.Add("Luma", config, _arch, arch_cpu,
+    [=](arch_t a) { return get_luma_function(bx, by, psz, a); });
+  info.Add("Copy", config, _arch, arch_cpu,
+    [=](arch_t a) { return get_copy_function(bx, by, psz, a); });
+  if (chroma)
+  {
+    info.Add("Copy chroma", config_c, _arch, arch_cpu,
+      [=](arch_t a) { return get_copy_function(bxc, byc, psz, a); });
+  }
+#ifdef ALLOW_DCT
+  if (_dct_pool_ptr != 0 && dctmode >= 1 && dctmode <= 4)
+  {
+    dynamic_cast <DCTFactory &> (_dct_pool_ptr->use_factory()).describe(info);
+  }
+#endif
+}
+
+
+
 template<typename safe_sad_t, typename smallOverlapSafeSad_t>
 void PlaneOfBlocks::InterpolatePrediction(const PlaneOfBlocks &pob)
 {
@@ -675,7 +901,7 @@ int PlaneOfBlocks::GetArraySize(int divideMode)
 
 
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::FetchPredictors(WorkingArea &workarea)
 {
   // Left (or right) predictor
@@ -787,34 +1013,46 @@ void PlaneOfBlocks::FetchPredictors(WorkingArea &workarea)
 
 
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::Refine(WorkingArea &workarea)
 {
+  const int stp = workarea.searchParam;
   // then, we refine, according to the search type
   switch (searchType) {
   case ONETIME:
-    for (int i = nSearchParam; i > 0; i /= 2)
+    for (int i = stp; i > 0; i /= 2)
     {
-      OneTimeSearch<pixel_t>(workarea, i);
+      OneTimeSearch<pixel_t, NPELL2>(workarea, i);
     }
     break;
   case NSTEP:
-    NStepSearch<pixel_t>(workarea, nSearchParam);
+    NStepSearch<pixel_t, NPELL2>(workarea, stp);
     break;
   case LOGARITHMIC:
-    for (int i = nSearchParam; i > 0; i /= 2)
+    for (int i = stp; i > 0; i /= 2)
     {
-      DiamondSearch<pixel_t>(workarea, i);
+      DiamondSearch<pixel_t, NPELL2>(workarea, i);
     }
     break;
   case EXHAUSTIVE: {
 
-    //		ExhaustiveSearch(nSearchParam);
+    //		ExhaustiveSearch(stp);
     int mvx = workarea.bestMV.x;
     int mvy = workarea.bestMV.y;
-    for (int i = 1; i <= nSearchParam; i++)// region is same as exhaustive, but ordered by radius (from near to far)
+    if (UseSearchGrid(stp))
+    {
+      InitSearchGrid(workarea, mvx, mvy, stp);
+      for (int i = 1; i <= stp; i++)
+      {
+        ExpandingSearchGrid<pixel_t, NPELL2>(workarea, i, 1, mvx, mvy);
+      }
+    }
+    else
     {
-      ExpandingSearch<pixel_t>(workarea, i, 1, mvx, mvy);
+      for (int i = 1; i <= stp; i++)// region is same as exhaustive, but ordered by radius (from near to far)
+      {
+        ExpandingSearch<pixel_t, NPELL2>(workarea, i, 1, mvx, mvy);
+      }
     }
   }
                    break;
@@ -824,19 +1062,19 @@ void PlaneOfBlocks::Refine(WorkingArea &workarea)
                    //		SquareSearch();
                    //	}
   case HEX2SEARCH:
-    Hex2Search<pixel_t>(workarea, nSearchParam);
+    Hex2Search<pixel_t, NPELL2>(workarea, stp);
     break;
   case UMHSEARCH:
-    UMHSearch<pixel_t>(workarea, nSearchParam, workarea.bestMV.x, workarea.bestMV.y);
+    UMHSearch<pixel_t, NPELL2>(workarea, stp, workarea.bestMV.x, workarea.bestMV.y);
     break;
   case HSEARCH:
   {
     int mvx = workarea.bestMV.x;
     int mvy = workarea.bestMV.y;
-    for (int i = 1; i <= nSearchParam; i++)// region is same as exhaustive, but ordered by radius (from near to far)
+    for (int i = 1; i <= stp; i++)// region is same as exhaustive, but ordered by radius (from near to far)
     {
-      CheckMV<pixel_t>(workarea, mvx - i, mvy);
-      CheckMV<pixel_t>(workarea, mvx + i, mvy);
+      CheckMV<pixel_t, NPELL2>(workarea, mvx - i, mvy);
+      CheckMV<pixel_t, NPELL2>(workarea, mvx + i, mvy);
     }
   }
   break;
@@ -844,10 +1082,10 @@ void PlaneOfBlocks::Refine(WorkingArea &workarea)
   {
     int mvx = workarea.bestMV.x;
     int mvy = workarea.bestMV.y;
-    for (int i = 1; i <= nSearchParam; i++)// region is same as exhaustive, but ordered by radius (from near to far)
+    for (int i = 1; i <= stp; i++)// region is same as exhaustive, but ordered by radius (from near to far)
     {
-      CheckMV<pixel_t>(workarea, mvx, mvy - i);
-      CheckMV<pixel_t>(workarea, mvx, mvy + i);
+      CheckMV<pixel_t, NPELL2>(workarea, mvx, mvy - i);
+      CheckMV<pixel_t, NPELL2>(workarea, mvx, mvy + i);
     }
   }
   break;
@@ -856,28 +1094,46 @@ void PlaneOfBlocks::Refine(WorkingArea &workarea)
 
 
 
-template<typename pixel_t>
+// The predictors interpolated from the coarser level are reliable when their
+// SAD is low and the neighbour predictors agree: a small range is enough.
+// Blocks with a high SAD get a wider range, as for badSAD/badrange.
+int PlaneOfBlocks::AdaptiveSearchParam(const WorkingArea &workarea) const
+{
+  int spread = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    const int d =
+        std::abs(workarea.predictors[i].x - workarea.predictor.x)
+      + std::abs(workarea.predictors[i].y - workarea.predictor.y);
+    spread = std::max(spread, d);
+  }
+
+  const sad_t sad = workarea.bestMV.sad;
+  if (sad > LSAD)
+  {
+    return nSearchParam * 2;
+  }
+  if (sad < LSAD / 4 && spread <= nPel)
+  {
+    return std::max(nSearchParam / 2, 1);
+  }
+
+  return nSearchParam;
+}
+
+
+
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
 {
   typedef typename std::conditional < sizeof(pixel_t) == 1, sad_t, bigsad_t >::type safe_sad_t;
-  FetchPredictors<pixel_t>(workarea);
+  FetchPredictors<pixel_t, NPELL2>(workarea);
+  workarea.searchParam = nSearchParam;
 
   sad_t sad;
   sad_t saduv;
 #ifdef ALLOW_DCT
-  if (dctmode != 0) // DCT method (luma only - currently use normal spatial SAD chroma)
-  {
-    // make dct of source block
-    if (dctmode <= 4) //don't do the slow dct conversion if SATD used
-    {
-      workarea.DCT->DCTBytes2D(workarea.pSrc[0], nSrcPitch[0], &workarea.dctSrc[0], dctpitch);
-      // later, workarea.dctSrc is used as a reference block
-    }
-  }
-  if (dctmode >= 3) // most use it and it should be fast anyway //if (dctmode == 3 || dctmode == 4) // check it
-  {
-    workarea.srcLuma = LUMA(workarea.pSrc[0], nSrcPitch[0]);
-  }
+  LoadSrcBlockDCT(workarea);
 #endif	// ALLOW_DCT
 
   // We treat zero alone
@@ -885,20 +1141,55 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
   workarea.bestMV.x = zeroMVfieldShifted.x;
   workarea.bestMV.y = zeroMVfieldShifted.y;
   saduv = (chroma) ? 
-    ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, 0, 0), nRefPitch[1])
-    + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, 0, 0), nRefPitch[2]), effective_chromaSADscale) : 0;
-  sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, 0, zeroMVfieldShifted.y));
+    ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, 0, 0), nRefPitch[1])
+    + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, 0, 0), nRefPitch[2]), effective_chromaSADscale) : 0;
+  sad = LumaSADCached<pixel_t, NPELL2>(workarea, 0, zeroMVfieldShifted.y);
   sad += saduv;
   workarea.bestMV.sad = sad;
   workarea.nMinCost = sad + ((penaltyZero*(safe_sad_t)sad) >> 8); // v.1.11.0.2
 
+  // Static block: the zero or the temporal vector is good enough, no search
+  if (_skipSAD > 0 && !tryMany)
+  {
+    bool skip = (sad < _skipSAD);
+    if (!skip && temporal)
+    {
+      const VECTOR &tmv = workarea.predictors[4];
+      saduv = (chroma) ?
+        ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, tmv.x, tmv.y), nRefPitch[1])
+        + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, tmv.x, tmv.y), nRefPitch[2]), effective_chromaSADscale) : 0;
+      sad = LumaSADCached<pixel_t, NPELL2>(workarea, tmv.x, tmv.y) + saduv;
+      if (sad < _skipSAD)
+      {
+        workarea.bestMV.x = tmv.x;
+        workarea.bestMV.y = tmv.y;
+        workarea.bestMV.sad = sad;
+        skip = true;
+      }
+    }
+    if (skip)
+    {
+      ++workarea.skipCount;
+      if (_stats_flag)
+      {
+        const bool zero_flag = (workarea.bestMV.x == zeroMVfieldShifted.x && workarea.bestMV.y == zeroMVfieldShifted.y);
+        ++workarea.winCount[zero_flag ? WIN_ZERO : WIN_TEMPORAL];
+      }
+      vectors[workarea.blkIdx].x = workarea.bestMV.x;
+      vectors[workarea.blkIdx].y = workarea.bestMV.y;
+      vectors[workarea.blkIdx].sad = workarea.bestMV.sad;
+      workarea.planeSAD += workarea.bestMV.sad;
+      return;
+    }
+  }
+
   VECTOR bestMVMany[8];
   int nMinCostMany[8];
 
   if (tryMany)
   {
     //  refine around zero
-    Refine<pixel_t>(workarea);
+    Refine<pixel_t, NPELL2>(workarea);
     bestMVMany[0] = workarea.bestMV;    // save bestMV
     nMinCostMany[0] = workarea.nMinCost;
   }
@@ -909,9 +1200,9 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
   //	if ( workarea.IsVectorOK(workarea.globalMVPredictor.x, workarea.globalMVPredictor.y ) )
   {
     saduv = (chroma) ? 
-      ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, workarea.globalMVPredictor.x, workarea.globalMVPredictor.y), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, workarea.globalMVPredictor.x, workarea.globalMVPredictor.y), nRefPitch[2]), effective_chromaSADscale) : 0;
-    sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, workarea.globalMVPredictor.x, workarea.globalMVPredictor.y));
+      ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, workarea.globalMVPredictor.x, workarea.globalMVPredictor.y), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, workarea.globalMVPredictor.x, workarea.globalMVPredictor.y), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad = LumaSADCached<pixel_t, NPELL2>(workarea, workarea.globalMVPredictor.x, workarea.globalMVPredictor.y);
     sad += saduv;
     sad_t cost = sad + ((pglobal*(safe_sad_t)sad) >> 8);
 
@@ -925,7 +1216,7 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
     if (tryMany)
     {
       // refine around global
-      Refine<pixel_t>(workarea);    // reset bestMV
+      Refine<pixel_t, NPELL2>(workarea);    // reset bestMV
       bestMVMany[1] = workarea.bestMV;    // save bestMV
       nMinCostMany[1] = workarea.nMinCost;
     }
@@ -934,9 +1225,9 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
     //	if (   (( workarea.predictor.x != zeroMVfieldShifted.x ) || ( workarea.predictor.y != zeroMVfieldShifted.y ))
     //	    && (( workarea.predictor.x != workarea.globalMVPredictor.x ) || ( workarea.predictor.y != workarea.globalMVPredictor.y )))
     //	{
-    saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[2]), effective_chromaSADscale) : 0;
-    sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, workarea.predictor.x, workarea.predictor.y));
+    saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad = LumaSADCached<pixel_t, NPELL2>(workarea, workarea.predictor.x, workarea.predictor.y);
     sad += saduv;
     cost = sad;
 
@@ -952,7 +1243,7 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
   if (tryMany)
   {
     // refine around predictor
-    Refine<pixel_t>(workarea);    // reset bestMV
+    Refine<pixel_t, NPELL2>(workarea);    // reset bestMV
     bestMVMany[2] = workarea.bestMV;    // save bestMV
     nMinCostMany[2] = workarea.nMinCost;
   }
@@ -966,11 +1257,11 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
     {
       workarea.nMinCost = verybigSAD + 1;
     }
-    CheckMV0<pixel_t>(workarea, workarea.predictors[i].x, workarea.predictors[i].y);
+    CheckMV0<pixel_t, NPELL2>(workarea, workarea.predictors[i].x, workarea.predictors[i].y);
     if (tryMany)
     {
       // refine around predictor
-      Refine<pixel_t>(workarea);    // reset bestMV
+      Refine<pixel_t, NPELL2>(workarea);    // reset bestMV
       bestMVMany[i + 3] = workarea.bestMV;    // save bestMV
       nMinCostMany[i + 3] = workarea.nMinCost;
     }
@@ -991,8 +1282,25 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
   }
   else
   {
+    if (_stats_flag)
+    {
+      // best candidate before the refinement
+      const VECTOR &best = workarea.bestMV;
+      if (best.x == zeroMVfieldShifted.x && best.y == zeroMVfieldShifted.y)
+        ++workarea.winCount[WIN_ZERO];
+      else if (best.x == workarea.globalMVPredictor.x && best.y == workarea.globalMVPredictor.y)
+        ++workarea.winCount[WIN_GLOBAL];
+      else if (best.x == workarea.predictors[0].x && best.y == workarea.predictors[0].y)
+        ++workarea.winCount[WIN_MEDIAN];
+      else if (temporal && best.x == workarea.predictors[4].x && best.y == workarea.predictors[4].y)
+        ++workarea.winCount[WIN_TEMPORAL];
+    }
+    if (_adaptive_range_flag && !smallestPlane)
+    {
+      workarea.searchParam = AdaptiveSearchParam(workarea);
+    }
     // then, we refine, according to the search type
-    Refine<pixel_t>(workarea);
+    Refine<pixel_t, NPELL2>(workarea);
   }
   sad_t foundSAD = workarea.bestMV.sad;
 
@@ -1036,7 +1344,7 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
       {
         // rathe good is not found, lets try around zero
 //				UMHSearch(workarea, badSADRadius, abs(mvx0)%4 - 2, abs(mvy0)%4 - 2);
-        UMHSearch<pixel_t>(workarea, badrange*nPel, 0, 0);
+        UMHSearch<pixel_t, NPELL2>(workarea, badrange*nPel, 0, 0);
       }
     }
 
@@ -1067,9 +1375,26 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
               mvx = 0; // store to not move the search center!
               mvy = 0;
       */
+      int r_max = 1;
+      while (r_max + nPel < -badrange*nPel)
+      {
+        r_max += nPel;
+      }
+      const bool grid_flag = UseSearchGrid(r_max);
+      if (grid_flag)
+      {
+        InitSearchGrid(workarea, 0, 0, r_max);
+      }
       for (int i = 1; i < -badrange*nPel; i += nPel)// at radius
       {
-        ExpandingSearch<pixel_t>(workarea, i, nPel, 0, 0);
+        if (grid_flag)
+        {
+          ExpandingSearchGrid<pixel_t, NPELL2>(workarea, i, nPel, 0, 0);
+        }
+        else
+        {
+          ExpandingSearch<pixel_t, NPELL2>(workarea, i, nPel, 0, 0);
+        }
         if (workarea.bestMV.sad < foundSAD / 4)
         {
           break; // stop search if rathe good is found
@@ -1081,7 +1406,7 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
     int mvy = workarea.bestMV.y;
     for (int i = 1; i < nPel; i++)// small radius
     {
-      ExpandingSearch<pixel_t>(workarea, i, 1, mvx, mvy);
+      ExpandingSearch<pixel_t, NPELL2>(workarea, i, 1, mvx, mvy);
     }
     DebugPrintf("best blk=%d x=%d y=%d sad=%d iter=%d", workarea.blkIdx, workarea.bestMV.x, workarea.bestMV.y, workarea.bestMV.sad, workarea.iter);
   }	// bad vector, try wide search
@@ -1096,7 +1421,7 @@ void PlaneOfBlocks::PseudoEPZSearch(WorkingArea& workarea)
 
 
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::DiamondSearch(WorkingArea &workarea, int length)
 {
   // The meaning of the directions are the following :
@@ -1124,10 +1449,10 @@ void PlaneOfBlocks::DiamondSearch(WorkingArea &workarea, int length)
     // First, we look the directions that were hinted by the previous step
     // of the algorithm. If we find one, we add it to the set of directions
     // we'll test next
-    if (lastDirection & 1) CheckMV2<pixel_t>(workarea, dx + length, dy, &direction, 1);
-    if (lastDirection & 2) CheckMV2<pixel_t>(workarea, dx - length, dy, &direction, 2);
-    if (lastDirection & 4) CheckMV2<pixel_t>(workarea, dx, dy + length, &direction, 4);
-    if (lastDirection & 8) CheckMV2<pixel_t>(workarea, dx, dy - length, &direction, 8);
+    if (lastDirection & 1) CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy, &direction, 1);
+    if (lastDirection & 2) CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy, &direction, 2);
+    if (lastDirection & 4) CheckMV2<pixel_t, NPELL2>(workarea, dx, dy + length, &direction, 4);
+    if (lastDirection & 8) CheckMV2<pixel_t, NPELL2>(workarea, dx, dy - length, &direction, 8);
 
     // If one of the directions improves the SAD, we make further tests
     // on the diagonals
@@ -1139,13 +1464,13 @@ void PlaneOfBlocks::DiamondSearch(WorkingArea &workarea, int length)
 
       if (lastDirection & 3)
       {
-        CheckMV2<pixel_t>(workarea, dx, dy + length, &direction, 4);
-        CheckMV2<pixel_t>(workarea, dx, dy - length, &direction, 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx, dy + length, &direction, 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx, dy - length, &direction, 8);
       }
       else
       {
-        CheckMV2<pixel_t>(workarea, dx + length, dy, &direction, 1);
-        CheckMV2<pixel_t>(workarea, dx - length, dy, &direction, 2);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy, &direction, 1);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy, &direction, 2);
       }
     }
 
@@ -1156,48 +1481,48 @@ void PlaneOfBlocks::DiamondSearch(WorkingArea &workarea, int length)
       switch (lastDirection)
       {
       case 1:
-        CheckMV2<pixel_t>(workarea, dx + length, dy + length, &direction, 1 + 4);
-        CheckMV2<pixel_t>(workarea, dx + length, dy - length, &direction, 1 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy + length, &direction, 1 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy - length, &direction, 1 + 8);
         break;
       case 2:
-        CheckMV2<pixel_t>(workarea, dx - length, dy + length, &direction, 2 + 4);
-        CheckMV2<pixel_t>(workarea, dx - length, dy - length, &direction, 2 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy + length, &direction, 2 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy - length, &direction, 2 + 8);
         break;
       case 4:
-        CheckMV2<pixel_t>(workarea, dx + length, dy + length, &direction, 1 + 4);
-        CheckMV2<pixel_t>(workarea, dx - length, dy + length, &direction, 2 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy + length, &direction, 1 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy + length, &direction, 2 + 4);
         break;
       case 8:
-        CheckMV2<pixel_t>(workarea, dx + length, dy - length, &direction, 1 + 8);
-        CheckMV2<pixel_t>(workarea, dx - length, dy - length, &direction, 2 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy - length, &direction, 1 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy - length, &direction, 2 + 8);
         break;
       case 1 + 4:
-        CheckMV2<pixel_t>(workarea, dx + length, dy + length, &direction, 1 + 4);
-        CheckMV2<pixel_t>(workarea, dx - length, dy + length, &direction, 2 + 4);
-        CheckMV2<pixel_t>(workarea, dx + length, dy - length, &direction, 1 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy + length, &direction, 1 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy + length, &direction, 2 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy - length, &direction, 1 + 8);
         break;
       case 2 + 4:
-        CheckMV2<pixel_t>(workarea, dx + length, dy + length, &direction, 1 + 4);
-        CheckMV2<pixel_t>(workarea, dx - length, dy + length, &direction, 2 + 4);
-        CheckMV2<pixel_t>(workarea, dx - length, dy - length, &direction, 2 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy + length, &direction, 1 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy + length, &direction, 2 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy - length, &direction, 2 + 8);
         break;
       case 1 + 8:
-        CheckMV2<pixel_t>(workarea, dx + length, dy + length, &direction, 1 + 4);
-        CheckMV2<pixel_t>(workarea, dx - length, dy - length, &direction, 2 + 8);
-        CheckMV2<pixel_t>(workarea, dx + length, dy - length, &direction, 1 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy + length, &direction, 1 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy - length, &direction, 2 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy - length, &direction, 1 + 8);
         break;
       case 2 + 8:
-        CheckMV2<pixel_t>(workarea, dx - length, dy - length, &direction, 2 + 8);
-        CheckMV2<pixel_t>(workarea, dx - length, dy + length, &direction, 2 + 4);
-        CheckMV2<pixel_t>(workarea, dx + length, dy - length, &direction, 1 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy - length, &direction, 2 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy + length, &direction, 2 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy - length, &direction, 1 + 8);
         break;
       default:
         // Even the default case may happen, in the first step of the
         // algorithm for example.
-        CheckMV2<pixel_t>(workarea, dx + length, dy + length, &direction, 1 + 4);
-        CheckMV2<pixel_t>(workarea, dx - length, dy + length, &direction, 2 + 4);
-        CheckMV2<pixel_t>(workarea, dx + length, dy - length, &direction, 1 + 8);
-        CheckMV2<pixel_t>(workarea, dx - length, dy - length, &direction, 2 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy + length, &direction, 1 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy + length, &direction, 2 + 4);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy - length, &direction, 1 + 8);
+        CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy - length, &direction, 2 + 8);
         break;
       }
     }	// if ! direction
@@ -1238,7 +1563,7 @@ void PlaneOfBlocks::ExhaustiveSearch(WorkingArea &workarea, int s)// diameter =
 
 
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::NStepSearch(WorkingArea &workarea, int stp)
 {
   int dx, dy;
@@ -1248,14 +1573,14 @@ void PlaneOfBlocks::NStepSearch(WorkingArea &workarea, int stp)
     dx = workarea.bestMV.x;
     dy = workarea.bestMV.y;
 
-    CheckMV<pixel_t>(workarea, dx + length, dy + length);
-    CheckMV<pixel_t>(workarea, dx + length, dy);
-    CheckMV<pixel_t>(workarea, dx + length, dy - length);
-    CheckMV<pixel_t>(workarea, dx, dy - length);
-    CheckMV<pixel_t>(workarea, dx, dy + length);
-    CheckMV<pixel_t>(workarea, dx - length, dy + length);
-    CheckMV<pixel_t>(workarea, dx - length, dy);
-    CheckMV<pixel_t>(workarea, dx - length, dy - length);
+    CheckMV<pixel_t, NPELL2>(workarea, dx + length, dy + length);
+    CheckMV<pixel_t, NPELL2>(workarea, dx + length, dy);
+    CheckMV<pixel_t, NPELL2>(workarea, dx + length, dy - length);
+    CheckMV<pixel_t, NPELL2>(workarea, dx, dy - length);
+    CheckMV<pixel_t, NPELL2>(workarea, dx, dy + length);
+    CheckMV<pixel_t, NPELL2>(workarea, dx - length, dy + length);
+    CheckMV<pixel_t, NPELL2>(workarea, dx - length, dy);
+    CheckMV<pixel_t, NPELL2>(workarea, dx - length, dy - length);
 
     length--;
   }
@@ -1264,15 +1589,15 @@ void PlaneOfBlocks::NStepSearch(WorkingArea &workarea, int stp)
 
 
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::OneTimeSearch(WorkingArea &workarea, int length)
 {
   int direction = 0;
   int dx = workarea.bestMV.x;
   int dy = workarea.bestMV.y;
 
-  CheckMV2<pixel_t>(workarea, dx - length, dy, &direction, 2);
-  CheckMV2<pixel_t>(workarea, dx + length, dy, &direction, 1);
+  CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy, &direction, 2);
+  CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy, &direction, 1);
 
   if (direction == 1)
   {
@@ -1280,7 +1605,7 @@ void PlaneOfBlocks::OneTimeSearch(WorkingArea &workarea, int length)
     {
       direction = 0;
       dx += length;
-      CheckMV2<pixel_t>(workarea, dx + length, dy, &direction, 1);
+      CheckMV2<pixel_t, NPELL2>(workarea, dx + length, dy, &direction, 1);
     }
   }
   else if (direction == 2)
@@ -1289,12 +1614,12 @@ void PlaneOfBlocks::OneTimeSearch(WorkingArea &workarea, int length)
     {
       direction = 0;
       dx -= length;
-      CheckMV2<pixel_t>(workarea, dx - length, dy, &direction, 1);
+      CheckMV2<pixel_t, NPELL2>(workarea, dx - length, dy, &direction, 1);
     }
   }
 
-  CheckMV2<pixel_t>(workarea, dx, dy - length, &direction, 2);
-  CheckMV2<pixel_t>(workarea, dx, dy + length, &direction, 1);
+  CheckMV2<pixel_t, NPELL2>(workarea, dx, dy - length, &direction, 2);
+  CheckMV2<pixel_t, NPELL2>(workarea, dx, dy + length, &direction, 1);
 
   if (direction == 1)
   {
@@ -1302,7 +1627,7 @@ void PlaneOfBlocks::OneTimeSearch(WorkingArea &workarea, int length)
     {
       direction = 0;
       dy += length;
-      CheckMV2<pixel_t>(workarea, dx, dy + length, &direction, 1);
+      CheckMV2<pixel_t, NPELL2>(workarea, dx, dy + length, &direction, 1);
     }
   }
   else if (direction == 2)
@@ -1311,14 +1636,14 @@ void PlaneOfBlocks::OneTimeSearch(WorkingArea &workarea, int length)
     {
       direction = 0;
       dy -= length;
-      CheckMV2<pixel_t>(workarea, dx, dy - length, &direction, 1);
+      CheckMV2<pixel_t, NPELL2>(workarea, dx, dy - length, &direction, 1);
     }
   }
 }
 
 
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::ExpandingSearch(WorkingArea &workarea, int r, int s, int mvx, int mvy) // diameter = 2*r + 1, step=s
 { // part of true enhaustive search (thin expanding square) around mvx, mvy
   int i, j;
@@ -1326,21 +1651,113 @@ void PlaneOfBlocks::ExpandingSearch(WorkingArea &workarea, int r, int s, int mvx
     // sides of square without corners
   for (i = -r + s; i < r; i += s) // without corners! - v2.1
   {
-    CheckMV<pixel_t>(workarea, mvx + i, mvy - r);
-    CheckMV<pixel_t>(workarea, mvx + i, mvy + r);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx + i, mvy - r);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx + i, mvy + r);
   }
 
   for (j = -r + s; j < r; j += s)
   {
-    CheckMV<pixel_t>(workarea, mvx - r, mvy + j);
-    CheckMV<pixel_t>(workarea, mvx + r, mvy + j);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx - r, mvy + j);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx + r, mvy + j);
   }
 
   // then corners - they are more far from cenrer
-  CheckMV<pixel_t>(workarea, mvx - r, mvy - r);
-  CheckMV<pixel_t>(workarea, mvx - r, mvy + r);
-  CheckMV<pixel_t>(workarea, mvx + r, mvy - r);
-  CheckMV<pixel_t>(workarea, mvx + r, mvy + r);
+  CheckMV<pixel_t, NPELL2>(workarea, mvx - r, mvy - r);
+  CheckMV<pixel_t, NPELL2>(workarea, mvx - r, mvy + r);
+  CheckMV<pixel_t, NPELL2>(workarea, mvx + r, mvy - r);
+  CheckMV<pixel_t, NPELL2>(workarea, mvx + r, mvy + r);
+}
+
+
+
+// Same visiting order as ExpandingSearch, luma SADs are taken from the grid
+template<typename pixel_t, int NPELL2>
+void PlaneOfBlocks::ExpandingSearchGrid(WorkingArea &workarea, int r, int s, int mvx, int mvy)
+{
+  int i, j;
+  for (i = -r + s; i < r; i += s)
+  {
+    CheckMVGrid<pixel_t, NPELL2>(workarea, mvx + i, mvy - r);
+    CheckMVGrid<pixel_t, NPELL2>(workarea, mvx + i, mvy + r);
+  }
+
+  for (j = -r + s; j < r; j += s)
+  {
+    CheckMVGrid<pixel_t, NPELL2>(workarea, mvx - r, mvy + j);
+    CheckMVGrid<pixel_t, NPELL2>(workarea, mvx + r, mvy + j);
+  }
+
+  CheckMVGrid<pixel_t, NPELL2>(workarea, mvx - r, mvy - r);
+  CheckMVGrid<pixel_t, NPELL2>(workarea, mvx - r, mvy + r);
+  CheckMVGrid<pixel_t, NPELL2>(workarea, mvx + r, mvy - r);
+  CheckMVGrid<pixel_t, NPELL2>(workarea, mvx + r, mvy + r);
+}
+
+
+
+// The grid pays off when a row of 8 positions of the same phase fits in it
+MV_FORCEINLINE bool PlaneOfBlocks::UseSearchGrid(int radius) const
+{
+  return _grid_search_flag && 2 * radius + 1 >= 4 * nPel;
+}
+
+
+
+void PlaneOfBlocks::InitSearchGrid(WorkingArea &workarea, int mvx, int mvy, int radius)
+{
+  workarea.grid_x0 = mvx - radius;
+  workarea.grid_y0 = mvy - radius;
+  workarea.grid_size = 2 * radius + 1;
+  workarea.grid_sad.assign(workarea.grid_size * workarea.grid_size, -1);
+}
+
+
+
+// Luma SAD of a vector inside the grid. On first access, the SADs of the
+// 8 positions of the same phase sharing the grid row segment are computed
+// at once, if the reference reads stay inside the padded plane.
+sad_t PlaneOfBlocks::GridSAD(WorkingArea &workarea, int vx, int vy)
+{
+  const int gx = vx - workarea.grid_x0;
+  const int gy = vy - workarea.grid_y0;
+  sad_t *grid_row_ptr = &workarea.grid_sad[gy * workarea.grid_size];
+  if (grid_row_ptr[gx] >= 0)
+  {
+    return grid_row_ptr[gx];
+  }
+
+  // first grid column of the row segment: same phase, index aligned on 8
+  const int phase = gx & (nPel - 1);
+  const int gx_seg = phase + (((gx >> nLogPel) & ~7) << nLogPel);
+  const int vx_seg = workarea.grid_x0 + gx_seg;
+
+  const MVPlane *pRefPlane = pRefFrame->GetPlane(YPLANE);
+  const int ax = (workarea.x[0] << nLogPel) + vx_seg;
+  const int ay = (workarea.y[0] << nLogPel) + vy;
+  if (ax < 0 || ay < 0
+    || (ax >> nLogPel) + ((nBlkSizeX + 7) & ~7) + 8 > pRefPlane->GetExtendedWidth()
+    || (ay >> nLogPel) + nBlkSizeY > pRefPlane->GetExtendedHeight()
+    || !pRefPlane->IsBlockStored(ax, ay, ((nBlkSizeX + 7) & ~7) + 8, nBlkSizeY)) // rendered blocks have no neighbours
+  {
+    const sad_t sad = SAD(workarea.pSrc[0], nSrcPitch[0], GetRefBlock(workarea, vx, vy), nRefPitch[0]);
+    ++workarea.sadCount;
+    grid_row_ptr[gx] = sad;
+    return sad;
+  }
+
+  unsigned int sad8[8];
+  SADROW8(sad8, workarea.pSrc[0], nSrcPitch[0], GetRefBlock(workarea, vx_seg, vy), nRefPitch[0]);
+  workarea.sadCount += 8;
+  for (int k = 0; k < 8; k++)
+  {
+    const int gx_k = gx_seg + (k << nLogPel);
+    if (gx_k >= workarea.grid_size)
+    {
+      break;
+    }
+    grid_row_ptr[gx_k] = sad_t(sad8[k]);
+  }
+  return grid_row_ptr[gx];
 }
 
 
@@ -1350,7 +1767,7 @@ static const int mod6m1[8] = { 5,0,1,2,3,4,5,0 };
 /* radius 2 hexagon. repeated entries are to avoid having to compute mod6 every time. */
 static const int hex2[8][2] = { {-1,-2}, {-2,0}, {-1,2}, {1,2}, {2,0}, {1,-2}, {-1,-2}, {-2,0} };
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::Hex2Search(WorkingArea &workarea, int i_me_range)
 {
   // adopted from x264
@@ -1369,12 +1786,12 @@ void PlaneOfBlocks::Hex2Search(WorkingArea &workarea, int i_me_range)
 //		COPY2_IF_LT( bcost, costs[3], dir, 3 );
 //		COPY2_IF_LT( bcost, costs[4], dir, 4 );
 //		COPY2_IF_LT( bcost, costs[5], dir, 5 );
-    CheckMVdir<pixel_t>(workarea, bmx - 2, bmy, &dir, 0);
-    CheckMVdir<pixel_t>(workarea, bmx - 1, bmy + 2, &dir, 1);
-    CheckMVdir<pixel_t>(workarea, bmx + 1, bmy + 2, &dir, 2);
-    CheckMVdir<pixel_t>(workarea, bmx + 2, bmy, &dir, 3);
-    CheckMVdir<pixel_t>(workarea, bmx + 1, bmy - 2, &dir, 4);
-    CheckMVdir<pixel_t>(workarea, bmx - 1, bmy - 2, &dir, 5);
+    CheckMVdir<pixel_t, NPELL2>(workarea, bmx - 2, bmy, &dir, 0);
+    CheckMVdir<pixel_t, NPELL2>(workarea, bmx - 1, bmy + 2, &dir, 1);
+    CheckMVdir<pixel_t, NPELL2>(workarea, bmx + 1, bmy + 2, &dir, 2);
+    CheckMVdir<pixel_t, NPELL2>(workarea, bmx + 2, bmy, &dir, 3);
+    CheckMVdir<pixel_t, NPELL2>(workarea, bmx + 1, bmy - 2, &dir, 4);
+    CheckMVdir<pixel_t, NPELL2>(workarea, bmx - 1, bmy - 2, &dir, 5);
 
 
     if (dir != -2)
@@ -1395,9 +1812,9 @@ void PlaneOfBlocks::Hex2Search(WorkingArea &workarea, int i_me_range)
         //				COPY2_IF_LT( bcost, costs[1], dir, odir   );
         //				COPY2_IF_LT( bcost, costs[2], dir, odir+1 );
 
-        CheckMVdir<pixel_t>(workarea, bmx + hex2[odir + 0][0], bmy + hex2[odir + 0][1], &dir, odir - 1);
-        CheckMVdir<pixel_t>(workarea, bmx + hex2[odir + 1][0], bmy + hex2[odir + 1][1], &dir, odir);
-        CheckMVdir<pixel_t>(workarea, bmx + hex2[odir + 2][0], bmy + hex2[odir + 2][1], &dir, odir + 1);
+        CheckMVdir<pixel_t, NPELL2>(workarea, bmx + hex2[odir + 0][0], bmy + hex2[odir + 0][1], &dir, odir - 1);
+        CheckMVdir<pixel_t, NPELL2>(workarea, bmx + hex2[odir + 1][0], bmy + hex2[odir + 1][1], &dir, odir);
+        CheckMVdir<pixel_t, NPELL2>(workarea, bmx + hex2[odir + 2][0], bmy + hex2[odir + 2][1], &dir, odir + 1);
         if (dir == -2)
         {
           break;
@@ -1415,24 +1832,24 @@ void PlaneOfBlocks::Hex2Search(WorkingArea &workarea, int i_me_range)
 //	omx = bmx; omy = bmy;
 //	COST_MV_X4(  0,-1,  0,1, -1,0, 1,0 );
 //	COST_MV_X4( -1,-1, -1,1, 1,-1, 1,1 );
-  ExpandingSearch<pixel_t>(workarea, 1, 1, bmx, bmy);
+  ExpandingSearch<pixel_t, NPELL2>(workarea, 1, 1, bmx, bmy);
 }
 
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::CrossSearch(WorkingArea &workarea, int start, int x_max, int y_max, int mvx, int mvy)
 {
   // part of umh  search
   for (int i = start; i < x_max; i += 2)
   {
-    CheckMV<pixel_t>(workarea, mvx - i, mvy);
-    CheckMV<pixel_t>(workarea, mvx + i, mvy);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx - i, mvy);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx + i, mvy);
   }
 
   for (int j = start; j < y_max; j += 2)
   {
-    CheckMV<pixel_t>(workarea, mvx, mvy + j);
-    CheckMV<pixel_t>(workarea, mvx, mvy - j);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx, mvy + j);
+    CheckMV<pixel_t, NPELL2>(workarea, mvx, mvy - j);
   }
 }
 
@@ -2259,7 +2676,7 @@ return bcost;
 }
 #endif // 0 x265
 
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 void PlaneOfBlocks::UMHSearch(WorkingArea &workarea, int i_me_range, int omx, int omy) // radius
 {
   // Uneven-cross Multi-Hexagon-grid Search (see x264)
@@ -2268,7 +2685,7 @@ void PlaneOfBlocks::UMHSearch(WorkingArea &workarea, int i_me_range, int omx, in
 //	int omx = workarea.bestMV.x;
 //	int omy = workarea.bestMV.y;
   // my mod: do not shift the center after Cross
-  CrossSearch<pixel_t>(workarea, 1, i_me_range, i_me_range, omx, omy);
+  CrossSearch<pixel_t, NPELL2>(workarea, 1, i_me_range, i_me_range, omx, omy);
 
   int i = 1;
   do
@@ -2296,7 +2713,7 @@ void PlaneOfBlocks::UMHSearch(WorkingArea &workarea, int i_me_range, int omx, in
     {
       int mx = omx + hex4[j][0] * i;
       int my = omy + hex4[j][1] * i;
-      CheckMV<pixel_t>(workarea, mx, my);
+      CheckMV<pixel_t, NPELL2>(workarea, mx, my);
     }
   } while (++i <= i_me_range / 4);
 
@@ -2305,7 +2722,7 @@ void PlaneOfBlocks::UMHSearch(WorkingArea &workarea, int i_me_range, int omx, in
   //		goto me_hex2;
   //	}
 
-  Hex2Search<pixel_t>(workarea, i_me_range);
+  Hex2Search<pixel_t, NPELL2>(workarea, i_me_range);
 }
 
 
@@ -2576,6 +2993,7 @@ MV_FORCEINLINE sad_t	PlaneOfBlocks::LumaSAD(WorkingArea &workarea, const unsigne
 #ifdef MOTION_DEBUG
   workarea.iter++;
 #endif
+  ++workarea.sadCount;
 #ifdef ALLOW_DCT
   // made simple SAD more prominent (~1% faster) while keeping DCT support (TSchniede)
   return !dctmode ? SAD(workarea.pSrc[0], nSrcPitch[0], pRef0, nRefPitch[0]) : LumaSADx<pixel_t>(workarea, pRef0);
@@ -2584,9 +3002,85 @@ MV_FORCEINLINE sad_t	PlaneOfBlocks::LumaSAD(WorkingArea &workarea, const unsigne
 #endif
 }
 
+// Same as LumaSAD, but stops after a group of rows once the cost with the
+// partial SAD cannot beat nMinCost anymore. The partial SAD is returned then,
+// it is enough for the caller to reject the candidate.
+// penalty: the penaltyNew factor applied by the caller on the SAD
+template<typename pixel_t>
+MV_FORCEINLINE sad_t	PlaneOfBlocks::LumaSADEarly(WorkingArea &workarea, const unsigned char *pRef0, sad_t cost, int penalty)
+{
+  if (_sad_part_h == 0)
+  {
+    return LumaSAD<pixel_t>(workarea, pRef0);
+  }
+#ifdef MOTION_DEBUG
+  workarea.iter++;
+#endif
+  ++workarea.sadCount;
+
+  typedef typename std::conditional < sizeof(pixel_t) == 1, sad_t, bigsad_t >::type safe_sad_t;
+
+  const uint8_t *pSrc0 = workarea.pSrc[0];
+  const int src_step = nSrcPitch[0] * _sad_part_h;
+  const int ref_step = nRefPitch[0] * _sad_part_h;
+  sad_t sad = 0;
+  for (int part = 0; part < 4; part++)
+  {
+    sad += SADPART(pSrc0, nSrcPitch[0], pRef0, nRefPitch[0]);
+    if (cost + sad + ((penalty*(safe_sad_t)sad) >> 8) >= workarea.nMinCost)
+    {
+      break;
+    }
+    pSrc0 += src_step;
+    pRef0 += ref_step;
+  }
+  return sad;
+}
+
+// Same as LumaSAD, but takes the vector and composes the SAD from the tile
+// cache when it is the zero or the global vector.
+template<typename pixel_t, int NPELL2>
+MV_FORCEINLINE sad_t	PlaneOfBlocks::LumaSADCached(WorkingArea &workarea, int vx, int vy)
+{
+  if (_tile_cache_flag)
+  {
+    const sad_t *tile_ptr = nullptr;
+    if (vx == zeroMVfieldShifted.x && vy == zeroMVfieldShifted.y)
+      tile_ptr = &_tile_sad_zero[0];
+    else if (_tile_glob_flag && vx == _glob_mv_pred_def.x && vy == _glob_mv_pred_def.y)
+      tile_ptr = &_tile_sad_glob[0];
+    if (tile_ptr != nullptr)
+    {
+      const sad_t sad = TileSumSAD(tile_ptr, workarea);
+      if (sad >= 0)
+        return sad;
+    }
+  }
+  return LumaSAD<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy));
+}
+
+// Sum of the tiles covered by the current block, -1 if one of them is not available
+MV_FORCEINLINE sad_t	PlaneOfBlocks::TileSumSAD(const sad_t *tile_ptr, const WorkingArea &workarea) const
+{
+  tile_ptr += workarea.blky * _tile_cols + workarea.blkx;
+  sad_t sad = 0;
+  for (int ty = 0; ty < _tile_ny; ty++)
+  {
+    for (int tx = 0; tx < _tile_nx; tx++)
+    {
+      const sad_t tile_sad = tile_ptr[tx];
+      if (tile_sad < 0)
+        return -1;
+      sad += tile_sad;
+    }
+    tile_ptr += _tile_cols;
+  }
+  return sad;
+}
+
 
 /* check if the vector (vx, vy) is better than the best vector found so far without penalty new - renamed in v.2.11*/
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 MV_FORCEINLINE void	PlaneOfBlocks::CheckMV0(WorkingArea &workarea, int vx, int vy)
 {		//here the chance for default values are high especially for zeroMVfieldShifted (on left/top border)
   if (
@@ -2598,9 +3092,9 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV0(WorkingArea &workarea, int vx, int v
     workarea.IsVectorOK(vx, vy))
   {
 #if 0
-    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
-    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy));
     sad += saduv;
     sad_t cost = sad + workarea.MotionDistorsion(vx, vy);
     //		int cost = sad + sad*workarea.MotionDistorsion(vx, vy)/(nBlkSizeX*nBlkSizeY*4);
@@ -2617,12 +3111,14 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV0(WorkingArea &workarea, int vx, int v
     sad_t cost=workarea.MotionDistorsion<pixel_t>(vx, vy);
     if(cost>=workarea.nMinCost) return;
 
-    sad_t sad=LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+    sad_t sad = (_tile_cache_flag)
+      ? LumaSADCached<pixel_t, NPELL2>(workarea, vx, vy)
+      : LumaSADEarly<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy), cost, 0);
     cost+=sad;
     if(cost>=workarea.nMinCost) return;
 
-    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
     cost += saduv;
     if(cost>=workarea.nMinCost) return;
 
@@ -2636,7 +3132,7 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV0(WorkingArea &workarea, int vx, int v
 }
 
 /* check if the vector (vx, vy) is better than the best vector found so far */
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 MV_FORCEINLINE void	PlaneOfBlocks::CheckMV(WorkingArea &workarea, int vx, int vy)
 {		//here the chance for default values are high especially for zeroMVfieldShifted (on left/top border)
   if (
@@ -2650,9 +3146,9 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV(WorkingArea &workarea, int vx, int vy
 #if 0
     sad_t saduv =
       !(chroma) ? 0 :
-      ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale);
-    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+      ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale);
+    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy));
     sad += saduv;
     sad_t cost = sad + workarea.MotionDistorsion(vx, vy) + ((penaltyNew*(bigsad_t)sad) >> 8); //v2
 //		int cost = sad + sad*workarea.MotionDistorsion(vx, vy)/(nBlkSizeX*nBlkSizeY*4);
@@ -2671,12 +3167,12 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV(WorkingArea &workarea, int vx, int vy
 
     typedef typename std::conditional < sizeof(pixel_t) == 1, sad_t, bigsad_t >::type safe_sad_t;
 
-    sad_t sad=LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+    sad_t sad=LumaSADEarly<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy), cost, penaltyNew);
     cost += sad + ((penaltyNew*(safe_sad_t)sad) >> 8);
     if(cost>=workarea.nMinCost) return;
 
-    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
     cost += saduv + ((penaltyNew*(safe_sad_t)saduv) >> 8);
     if(cost>=workarea.nMinCost) return;
 
@@ -2688,8 +3184,35 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV(WorkingArea &workarea, int vx, int vy
   }
 }
 
+/* check if the vector (vx, vy) is better than the best vector found so far, luma SAD from the grid */
+template<typename pixel_t, int NPELL2>
+MV_FORCEINLINE void	PlaneOfBlocks::CheckMVGrid(WorkingArea &workarea, int vx, int vy)
+{
+  if (workarea.IsVectorOK(vx, vy))
+  {
+    sad_t cost=workarea.MotionDistorsion<pixel_t>(vx, vy);
+    if(cost>=workarea.nMinCost) return;
+
+    typedef typename std::conditional < sizeof(pixel_t) == 1, sad_t, bigsad_t >::type safe_sad_t;
+
+    sad_t sad=GridSAD(workarea, vx, vy);
+    cost += sad + ((penaltyNew*(safe_sad_t)sad) >> 8);
+    if(cost>=workarea.nMinCost) return;
+
+    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
+    cost += saduv + ((penaltyNew*(safe_sad_t)saduv) >> 8);
+    if(cost>=workarea.nMinCost) return;
+
+    workarea.bestMV.x = vx;
+    workarea.bestMV.y = vy;
+    workarea.nMinCost = cost;
+    workarea.bestMV.sad = sad+saduv;
+  }
+}
+
 /* check if the vector (vx, vy) is better, and update dir accordingly */
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 MV_FORCEINLINE void	PlaneOfBlocks::CheckMV2(WorkingArea &workarea, int vx, int vy, int *dir, int val)
 {
   if (
@@ -2703,9 +3226,9 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV2(WorkingArea &workarea, int vx, int v
 #if 0
     sad_t saduv =
       !(chroma) ? 0 :
-      ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale);
-    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+      ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale);
+    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy));
     sad += saduv;
     sad_t cost = sad + workarea.MotionDistorsion(vx, vy) + ((penaltyNew*(bigsad_t)sad) >> 8); // v1.5.8
 //		if (sad > LSAD/4) DebugPrintf("%d %d %d %d %d %d %d", workarea.blkIdx, vx, vy, val, workarea.nMinCost, cost, sad);
@@ -2725,12 +3248,12 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV2(WorkingArea &workarea, int vx, int v
 
     typedef typename std::conditional < sizeof(pixel_t) == 1, sad_t, bigsad_t >::type safe_sad_t;
 
-    sad_t sad=LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+    sad_t sad=LumaSADEarly<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy), cost, penaltyNew);
     cost += sad + ((penaltyNew*(safe_sad_t)sad) >> 8);
     if(cost>=workarea.nMinCost) return;
 
-    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
     cost += saduv+((penaltyNew*(safe_sad_t)saduv) >> 8);
     if(cost>=workarea.nMinCost) return;
 
@@ -2744,7 +3267,7 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMV2(WorkingArea &workarea, int vx, int v
 }
 
 /* check if the vector (vx, vy) is better, and update dir accordingly, but not workarea.bestMV.x, y */
-template<typename pixel_t>
+template<typename pixel_t, int NPELL2>
 MV_FORCEINLINE void	PlaneOfBlocks::CheckMVdir(WorkingArea &workarea, int vx, int vy, int *dir, int val)
 {
   if (
@@ -2756,9 +3279,9 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMVdir(WorkingArea &workarea, int vx, int
     workarea.IsVectorOK(vx, vy))
   {
 #if 0
-    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
-    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy));
     sad += saduv;
     sad_t cost = sad + workarea.MotionDistorsion(vx, vy) + ((penaltyNew*(bigsad_t)sad) >> 8); // v1.5.8
 //		if (sad > LSAD/4) DebugPrintf("%d %d %d %d %d %d %d", workarea.blkIdx, vx, vy, val, workarea.nMinCost, cost, sad);
@@ -2776,12 +3299,12 @@ MV_FORCEINLINE void	PlaneOfBlocks::CheckMVdir(WorkingArea &workarea, int vx, int
 
     typedef typename std::conditional < sizeof(pixel_t) == 1, sad_t, bigsad_t >::type safe_sad_t;
 
-    sad_t sad=LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, vx, vy));
+    sad_t sad=LumaSADEarly<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, vx, vy), cost, penaltyNew);
     cost += sad + ((penaltyNew*(safe_sad_t)sad) >> 8);
     if(cost>=workarea.nMinCost) return;
 
-    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, vx, vy), nRefPitch[1])
-      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
+    sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, vx, vy), nRefPitch[1])
+      + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, vx, vy), nRefPitch[2]), effective_chromaSADscale) : 0;
     cost += saduv+((penaltyNew*(safe_sad_t)saduv) >> 8);
     if(cost>=workarea.nMinCost) return;
 
@@ -2862,7 +3385,28 @@ MV_FORCEINLINE bool	PlaneOfBlocks::IsInFrame(int i)
 
 
 
+// The search is instantiated for each pel value so the reference block
+// addressing is resolved at compile time. Sub-pixel planes on demand and
+// virtual padding are rare and take the generic path.
 template<typename pixel_t>
+PlaneOfBlocks::Slicer::ProcPtr	PlaneOfBlocks::select_search_mv_slice() const
+{
+  if (_pel_on_demand_flag || _virtual_pad_flag)
+  {
+    return &PlaneOfBlocks::search_mv_slice<pixel_t, PEL_GENERIC>;
+  }
+  switch (nLogPel)
+  {
+  case 0:  return &PlaneOfBlocks::search_mv_slice<pixel_t, 0>;
+  case 1:  return &PlaneOfBlocks::search_mv_slice<pixel_t, 1>;
+  case 2:  return &PlaneOfBlocks::search_mv_slice<pixel_t, 2>;
+  default: return &PlaneOfBlocks::search_mv_slice<pixel_t, PEL_GENERIC>;
+  }
+}
+
+
+
+template<typename pixel_t, int NPELL2>
 void	PlaneOfBlocks::search_mv_slice(Slicer::TaskData &td)
 {
   assert(&td != 0);
@@ -2907,6 +3451,9 @@ void	PlaneOfBlocks::search_mv_slice(Slicer::TaskData &td)
 
   workarea.planeSAD = 0; // for debug, plus fixme outer planeSAD is not used
   workarea.sumLumaChange = 0;
+  workarea.skipCount = 0;
+  workarea.sadCount = 0;
+  std::fill(workarea.winCount, workarea.winCount + WIN_NBR_ELT, 0);
 
   int nBlkSizeX_Ovr[3] = { (nBlkSizeX - nOverlapX), (nBlkSizeX - nOverlapX) >> nLogxRatioUV, (nBlkSizeX - nOverlapX) >> nLogxRatioUV };
   int nBlkSizeY_Ovr[3] = { (nBlkSizeY - nOverlapY), (nBlkSizeY - nOverlapY) >> nLogyRatioUV, (nBlkSizeY - nOverlapY) >> nLogyRatioUV };
@@ -2949,30 +3496,7 @@ void	PlaneOfBlocks::search_mv_slice(Slicer::TaskData &td)
       // fixme: why recalc is resetting only outside, why, maybe recalc is not using that at all?
       workarea.globalMVPredictor = _glob_mv_pred_def;
 
-#if (ALIGN_SOURCEBLOCK > 1)
-      //store the pitch
-      const BYTE *pY = pSrcFrame->GetPlane(YPLANE)->GetAbsolutePelPointer(workarea.x[0], workarea.y[0]);
-      //create aligned copy
-      BLITLUMA(workarea.pSrc_temp[0], nSrcPitch[0], pY, nSrcPitch_plane[0]);
-      //set the to the aligned copy
-      workarea.pSrc[0] = workarea.pSrc_temp[0];
-      if (chroma)
-      {
-        workarea.pSrc[1] = pSrcFrame->GetPlane(UPLANE)->GetAbsolutePelPointer(workarea.x[1], workarea.y[1]);
-        BLITCHROMA(workarea.pSrc_temp[1], nSrcPitch[1], workarea.pSrc[1], nSrcPitch_plane[1]);
-        workarea.pSrc[1] = workarea.pSrc_temp[1];
-        workarea.pSrc[2] = pSrcFrame->GetPlane(VPLANE)->GetAbsolutePelPointer(workarea.x[2], workarea.y[2]);
-        BLITCHROMA(workarea.pSrc_temp[2], nSrcPitch[2], workarea.pSrc[2], nSrcPitch_plane[2]);
-        workarea.pSrc[2] = workarea.pSrc_temp[2];
-      }
-#else	// ALIGN_SOURCEBLOCK
-      workarea.pSrc[0] = pSrcFrame->GetPlane(YPLANE)->GetAbsolutePelPointer(workarea.x[0], workarea.y[0]);
-      if (chroma)
-      {
-        workarea.pSrc[1] = pSrcFrame->GetPlane(UPLANE)->GetAbsolutePelPointer(workarea.x[1], workarea.y[1]);
-        workarea.pSrc[2] = pSrcFrame->GetPlane(VPLANE)->GetAbsolutePelPointer(workarea.x[2], workarea.y[2]);
-      }
-#endif	// ALIGN_SOURCEBLOCK
+      LoadSrcBlock(workarea);
 
       // fixme note:
       // MAnalyze mt-inconsistency reason #3
@@ -3017,7 +3541,7 @@ void	PlaneOfBlocks::search_mv_slice(Slicer::TaskData &td)
         workarea.predictors[4] = ClipMV(workarea, zeroMV);
       }
 
-      PseudoEPZSearch<pixel_t>(workarea);
+      PseudoEPZSearch<pixel_t, NPELL2>(workarea);
       // workarea.bestMV = zeroMV; // debug
 
       if (outfilebuf != NULL) // write vector to outfile
@@ -3057,7 +3581,7 @@ void	PlaneOfBlocks::search_mv_slice(Slicer::TaskData &td)
 
         // 161204 todo check: why is it not abs(lumadiff)?
         typedef typename std::conditional < sizeof(pixel_t) == 1, sad_t, bigsad_t >::type safe_sad_t;
-        workarea.sumLumaChange += (safe_sad_t)LUMA(GetRefBlock(workarea, 0, 0), nRefPitch[0]) - (safe_sad_t)LUMA(workarea.pSrc[0], nSrcPitch[0]);
+        workarea.sumLumaChange += (safe_sad_t)LUMA(GetRefBlock<NPELL2>(workarea, 0, 0), nRefPitch[0]) - (safe_sad_t)LUMA(workarea.pSrc[0], nSrcPitch[0]);
       }
 
       /* increment indexes & pointers */
@@ -3082,6 +3606,11 @@ void	PlaneOfBlocks::search_mv_slice(Slicer::TaskData &td)
 
   planeSAD += workarea.planeSAD; // for debug, plus fixme outer planeSAD is not used
   sumLumaChange += workarea.sumLumaChange;
+  _skip_count += workarea.skipCount;
+  if (_stats_flag)
+  {
+    CollectStats(workarea);
+  }
 
   if (isse)
   {
@@ -3103,7 +3632,361 @@ void	PlaneOfBlocks::search_mv_slice(Slicer::TaskData &td)
 
 
 
-template<typename pixel_t>
+void PlaneOfBlocks::SetSrcFrameId(int src_frame_id)
+{
+  _src_frame_id = src_frame_id;
+}
+
+
+
+// nX, nY: absolute position in sub-pixel units
+const uint8_t* PlaneOfBlocks::GetRefSubBlock(int plane, int nX, int nY, int nBlkW, int nBlkH)
+{
+  static const MVPlaneSet planes[3] = { YPLANE, UPLANE, VPLANE };
+  const MVPlane *pRefPlane = pRefFrame->GetPlane(planes[plane]);
+  return pRefPlane->GetAbsoluteBlock(nX, nY, nBlkW, nBlkH, _sub_pel_buf[plane]);
+}
+
+
+
+sad_t PlaneOfBlocks::SubBlockSAD(const uint8_t * const src_ptr_arr[3], const int x_arr[3], const int y_arr[3], int vx, int vy)
+{
+  const int w = nBlkSizeX >> 1;
+  const int h = nBlkSizeY >> 1;
+  sad_t sad = SADSUB(
+    src_ptr_arr[0], pSrcFrame->GetPlane(YPLANE)->GetPitch(),
+    GetRefSubBlock(0, (x_arr[0] << nLogPel) + vx, (y_arr[0] << nLogPel) + vy, w, h), nRefPitch[0]
+  );
+  if (chroma)
+  {
+    const int wc = w >> nLogxRatioUV;
+    const int hc = h >> nLogyRatioUV;
+    const int vxc = vx >> nLogxRatioUV;
+    const int vyc = vy >> nLogyRatioUV;
+    sad += ScaleSadChroma(
+      SADCHROMASUB(
+        src_ptr_arr[1], pSrcFrame->GetPlane(UPLANE)->GetPitch(),
+        GetRefSubBlock(1, (x_arr[1] << nLogPel) + vxc, (y_arr[1] << nLogPel) + vyc, wc, hc), nRefPitch[1])
+      + SADCHROMASUB(
+        src_ptr_arr[2], pSrcFrame->GetPlane(VPLANE)->GetPitch(),
+        GetRefSubBlock(2, (x_arr[2] << nLogPel) + vxc, (y_arr[2] << nLogPel) + vyc, wc, hc), nRefPitch[2]),
+      effective_chromaSADscale);
+  }
+  return sad;
+}
+
+
+
+// The first candidate must be valid for the sub-block: the vector of its
+// block is. The best candidate is then refined by steps of the finest
+// accuracy, no length penalty.
+VECTOR PlaneOfBlocks::SearchSubBlock(int sbx, int sby, const VECTOR cand_arr[], int nbr_cand)
+{
+  assert(nLogScale == 0);
+  assert(nbr_cand > 0);
+
+  const int w = nBlkSizeX >> 1;
+  const int h = nBlkSizeY >> 1;
+  const int ofs_x = sbx * ((nBlkSizeX - nOverlapX) >> 1);
+  const int ofs_y = sby * ((nBlkSizeY - nOverlapY) >> 1);
+
+  static const MVPlaneSet planes[3] = { YPLANE, UPLANE, VPLANE };
+  const uint8_t *src_ptr_arr[3] = { 0, 0, 0 };
+  int x_arr[3] = { 0, 0, 0 };
+  int y_arr[3] = { 0, 0, 0 };
+  for (int p = 0; p < ((chroma) ? 3 : 1); ++p)
+  {
+    const MVPlane *pSrcPlane = pSrcFrame->GetPlane(planes[p]);
+    x_arr[p] = pSrcPlane->GetHPadding() + ((p == 0) ? ofs_x : ofs_x >> nLogxRatioUV);
+    y_arr[p] = pSrcPlane->GetVPadding() + ((p == 0) ? ofs_y : ofs_y >> nLogyRatioUV);
+    src_ptr_arr[p] = pSrcPlane->GetAbsolutePelPointer(x_arr[p], y_arr[p]);
+  }
+
+  const MVPlane *pSrcPlaneY = pSrcFrame->GetPlane(YPLANE);
+  const int dx_min = -nPel * x_arr[0];
+  const int dy_min = -nPel * y_arr[0];
+  const int dx_max = nPel * (pSrcPlaneY->GetExtendedWidth() - x_arr[0] - w);
+  const int dy_max = nPel * (pSrcPlaneY->GetExtendedHeight() - y_arr[0] - h);
+
+  VECTOR best = cand_arr[0];
+  best.sad = SubBlockSAD(src_ptr_arr, x_arr, y_arr, best.x, best.y);
+  for (int i = 1; i < nbr_cand; ++i)
+  {
+    const VECTOR &cand = cand_arr[i];
+    if ((cand.x != best.x || cand.y != best.y)
+      && cand.x >= dx_min && cand.y >= dy_min && cand.x < dx_max && cand.y < dy_max)
+    {
+      const sad_t sad = SubBlockSAD(src_ptr_arr, x_arr, y_arr, cand.x, cand.y);
+      if (sad < best.sad)
+      {
+        best.x = cand.x;
+        best.y = cand.y;
+        best.sad = sad;
+      }
+    }
+  }
+
+  static const int dir_arr[4][2] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+  for (int iter = 0; iter < 4; ++iter)
+  {
+    const VECTOR center = best;
+    for (int d = 0; d < 4; ++d)
+    {
+      const int vx = center.x + dir_arr[d][0];
+      const int vy = center.y + dir_arr[d][1];
+      if (vx >= dx_min && vy >= dy_min && vx < dx_max && vy < dy_max)
+      {
+        const sad_t sad = SubBlockSAD(src_ptr_arr, x_arr, y_arr, vx, vy);
+        if (sad < best.sad)
+        {
+          best.x = vx;
+          best.y = vy;
+          best.sad = sad;
+        }
+      }
+    }
+    if (best.x == center.x && best.y == center.y)
+    {
+      break;
+    }
+  }
+
+  return best;
+}
+
+
+
+// Decides whether the search reads or fills the source block cache.
+// Call it once the source pitches are set.
+void PlaneOfBlocks::StartSrcCache()
+{
+  _src_cache_read = false;
+  _src_cache_fill = false;
+  if (_src_frame_id < 0)
+  {
+    return;
+  }
+  if (_src_frame_id == _src_cache_id)
+  {
+    _src_cache_read = true;
+    return;
+  }
+
+#if (ALIGN_SOURCEBLOCK > 1)
+  // same layout as WorkingArea::pSrc_temp
+  _src_cache_blk_size = nSrcPitch[0] * nBlkSizeY;
+  if (chroma)
+  {
+    _src_cache_blk_size += 2 * nSrcPitch[1] * (nBlkSizeY >> nLogyRatioUV);
+  }
+  _src_cache_blk.resize(size_t(_src_cache_blk_size) * nBlkCount);
+#endif	// ALIGN_SOURCEBLOCK
+#ifdef ALLOW_DCT
+  if (dctmode != 0 && dctmode <= 4)
+  {
+    _src_cache_dct_size = nBlkSizeY * dctpitch;
+    _src_cache_dct.resize(size_t(_src_cache_dct_size) * nBlkCount);
+  }
+  if (dctmode >= 3)
+  {
+    _src_cache_luma.resize(nBlkCount);
+  }
+#endif	// ALLOW_DCT
+
+  // the whole plane is searched, the cache is complete at the end
+  _src_cache_fill = true;
+  _src_cache_id = _src_frame_id;
+}
+
+
+
+// Sets workarea.pSrc to the source block workarea.blkIdx
+void PlaneOfBlocks::LoadSrcBlock(WorkingArea &workarea)
+{
+#if (ALIGN_SOURCEBLOCK > 1)
+  uint8_t *pDst[3] = { workarea.pSrc_temp[0], workarea.pSrc_temp[1], workarea.pSrc_temp[2] };
+  if (_src_cache_read || _src_cache_fill)
+  {
+    pDst[0] = &_src_cache_blk[size_t(workarea.blkIdx) * _src_cache_blk_size];
+    pDst[1] = pDst[0] + nSrcPitch[0] * nBlkSizeY;
+    pDst[2] = pDst[1] + nSrcPitch[1] * (nBlkSizeY >> nLogyRatioUV);
+  }
+  if (!_src_cache_read)
+  {
+    //create aligned copy
+    BLITLUMA(pDst[0], nSrcPitch[0], pSrcFrame->GetPlane(YPLANE)->GetAbsolutePelPointer(workarea.x[0], workarea.y[0]), nSrcPitch_plane[0]);
+    if (chroma)
+    {
+      BLITCHROMA(pDst[1], nSrcPitch[1], pSrcFrame->GetPlane(UPLANE)->GetAbsolutePelPointer(workarea.x[1], workarea.y[1]), nSrcPitch_plane[1]);
+      BLITCHROMA(pDst[2], nSrcPitch[2], pSrcFrame->GetPlane(VPLANE)->GetAbsolutePelPointer(workarea.x[2], workarea.y[2]), nSrcPitch_plane[2]);
+    }
+  }
+  //set the to the aligned copy
+  workarea.pSrc[0] = pDst[0];
+  if (chroma)
+  {
+    workarea.pSrc[1] = pDst[1];
+    workarea.pSrc[2] = pDst[2];
+  }
+#else	// ALIGN_SOURCEBLOCK
+  workarea.pSrc[0] = pSrcFrame->GetPlane(YPLANE)->GetAbsolutePelPointer(workarea.x[0], workarea.y[0]);
+  if (chroma)
+  {
+    workarea.pSrc[1] = pSrcFrame->GetPlane(UPLANE)->GetAbsolutePelPointer(workarea.x[1], workarea.y[1]);
+    workarea.pSrc[2] = pSrcFrame->GetPlane(VPLANE)->GetAbsolutePelPointer(workarea.x[2], workarea.y[2]);
+  }
+#endif	// ALIGN_SOURCEBLOCK
+}
+
+
+
+#ifdef ALLOW_DCT
+// DCT and mean luma of the source block, if the DCT mode needs them
+void PlaneOfBlocks::LoadSrcBlockDCT(WorkingArea &workarea)
+{
+  if (dctmode != 0 && dctmode <= 4) //don't do the slow dct conversion if SATD used
+  {
+    uint8_t *pCache = (_src_cache_read || _src_cache_fill) ? &_src_cache_dct[size_t(workarea.blkIdx) * _src_cache_dct_size] : 0;
+    if (_src_cache_read)
+    {
+      memcpy(&workarea.dctSrc[0], pCache, _src_cache_dct_size);
+    }
+    else
+    {
+      // later, workarea.dctSrc is used as a reference block
+      workarea.DCT->DCTBytes2D(workarea.pSrc[0], nSrcPitch[0], &workarea.dctSrc[0], dctpitch);
+      if (_src_cache_fill)
+      {
+        memcpy(pCache, &workarea.dctSrc[0], _src_cache_dct_size);
+      }
+    }
+  }
+  if (dctmode >= 3) // most use it and it should be fast anyway //if (dctmode == 3 || dctmode == 4) // check it
+  {
+    if (_src_cache_read)
+    {
+      workarea.srcLuma = _src_cache_luma[workarea.blkIdx];
+    }
+    else
+    {
+      workarea.srcLuma = LUMA(workarea.pSrc[0], nSrcPitch[0]);
+      if (_src_cache_fill)
+      {
+        _src_cache_luma[workarea.blkIdx] = workarea.srcLuma;
+      }
+    }
+  }
+}
+#endif	// ALLOW_DCT
+
+
+
+// Reference block at absolute position nX, nY (sub-pixel units) of a plane
+// whose sub-pixel planes or padding are not stored. Stored blocks are read
+// directly, the others are rendered into the working area, with a small cache
+// because the same vector is often checked twice (luma and chroma, predictors).
+const uint8_t* PlaneOfBlocks::GetRefBlockOnDemand(WorkingArea& workarea, int plane, int nX, int nY)
+{
+  static const MVPlaneSet planes[3] = { YPLANE, UPLANE, VPLANE };
+  const MVPlane *pRefPlane = pRefFrame->GetPlane(planes[plane]);
+  const int w = (plane == 0) ? nBlkSizeX : nBlkSizeX >> nLogxRatioUV;
+  const int h = (plane == 0) ? nBlkSizeY : nBlkSizeY >> nLogyRatioUV;
+  if (pRefPlane->IsBlockStored(nX, nY, w, h))
+  {
+    return pRefPlane->GetAbsolutePointer(nX, nY);
+  }
+
+  if (workarea.pel_gen != _pel_gen)
+  {
+    for (int p = 0; p < 3; ++p)
+    {
+      for (int k = 0; k < WorkingArea::PEL_CACHE_SIZE; ++k)
+      {
+        workarea.pel_key_x[p][k] = -1;
+      }
+    }
+    workarea.pel_gen = _pel_gen;
+  }
+
+  for (int k = 0; k < WorkingArea::PEL_CACHE_SIZE; ++k)
+  {
+    if (workarea.pel_key_x[plane][k] == nX && workarea.pel_key_y[plane][k] == nY)
+    {
+      return &workarea.pel_buf[plane][k].blk[0];
+    }
+  }
+
+  const int k = workarea.pel_next[plane];
+  workarea.pel_next[plane] = (k + 1) % WorkingArea::PEL_CACHE_SIZE;
+  const uint8_t *p = pRefPlane->GetAbsoluteBlock(nX, nY, w, h, workarea.pel_buf[plane][k]);
+  workarea.pel_key_x[plane][k] = nX;
+  workarea.pel_key_y[plane][k] = nY;
+
+  return p;
+}
+
+
+
+// Luma SAD of a tile at absolute position x, y (in pixels) with vector vx, vy.
+// Returns -1 if the reference tile is out of the padded plane.
+sad_t	PlaneOfBlocks::TileSAD(const uint8_t *pSrc, int nSrcPitchTile, int x, int y, int vx, int vy)
+{
+  const MVPlane *pRefPlane = pRefFrame->GetPlane(YPLANE);
+  const int ax = (x << nLogPel) + vx;
+  const int ay = (y << nLogPel) + vy;
+  if (ax < 0 || ay < 0
+    || (ax >> nLogPel) + _tile_w > pRefPlane->GetExtendedWidth()
+    || (ay >> nLogPel) + _tile_h > pRefPlane->GetExtendedHeight()
+    || !pRefPlane->IsBlockStored(ax, ay, _tile_w, _tile_h))
+  {
+    return -1;
+  }
+  return TILESAD(pSrc, nSrcPitchTile, pRefPlane->GetAbsolutePointer(ax, ay), nRefPitch[0]);
+}
+
+
+
+void	PlaneOfBlocks::tile_sad_slice(Slicer::TaskData &td)
+{
+  assert(&td != 0);
+
+  const MVPlane *pSrcPlane = pSrcFrame->GetPlane(YPLANE);
+  const int nHPadding = pSrcPlane->GetHPadding();
+  const int nVPadding = pSrcPlane->GetVPadding();
+  const int nSrcPitchPlane = pSrcPlane->GetPitch();
+
+  // aligned copy of the source tile, like the source block in search_mv_slice
+  const int nSrcPitchTile = AlignNumber(_tile_w << pixelsize_shift, ALIGN_SOURCEBLOCK);
+  WorkingArea::TmpDataArray src_tile(nSrcPitchTile * _tile_h);
+
+  for (int ty = td._y_beg; ty < td._y_end; ty++)
+  {
+    const int y = nVPadding + ty * _tile_h;
+    sad_t *pZero = &_tile_sad_zero[ty * _tile_cols];
+    sad_t *pGlob = &_tile_sad_glob[ty * _tile_cols];
+    for (int tx = 0; tx < _tile_cols; tx++)
+    {
+      const int x = nHPadding + tx * _tile_w;
+      BLITTILE(&src_tile[0], nSrcPitchTile, pSrcPlane->GetAbsolutePelPointer(x, y), nSrcPitchPlane);
+      pZero[tx] = TileSAD(&src_tile[0], nSrcPitchTile, x, y, zeroMVfieldShifted.x, zeroMVfieldShifted.y);
+      if (_tile_glob_flag)
+      {
+        pGlob[tx] = TileSAD(&src_tile[0], nSrcPitchTile, x, y, _glob_mv_pred_def.x, _glob_mv_pred_def.y);
+      }
+    }
+  }
+
+  if (isse)
+  {
+#ifndef _M_X64
+    _mm_empty();
+#endif
+  }
+}
+
+
+
+template<typename pixel_t, int NPELL2>
 void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
 {
   assert(&td != 0);
@@ -3146,6 +4029,10 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
 
   workarea.planeSAD = 0; // for debug, plus fixme outer planeSAD is not used
   workarea.sumLumaChange = 0;
+  workarea.skipCount = 0;
+  workarea.sadCount = 0;
+  std::fill(workarea.winCount, workarea.winCount + WIN_NBR_ELT, 0);
+  int nbr_bad = 0;
 
   // get old vectors plane
   const FakePlaneOfBlocks &plane = _mv_clip_ptr->GetPlane(0);
@@ -3203,30 +4090,7 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
       //		DebugPrintf("BlkIdx = %d \n", workarea.blkIdx);
       PROFILE_START(MOTION_PROFILE_ME);
 
-#if (ALIGN_SOURCEBLOCK > 1)
-      //store the pitch
-      workarea.pSrc[0] = pSrcFrame->GetPlane(YPLANE)->GetAbsolutePelPointer(workarea.x[0], workarea.y[0]);
-      //create aligned copy
-      BLITLUMA(workarea.pSrc_temp[0], nSrcPitch[0], workarea.pSrc[0], nSrcPitch_plane[0]);
-      //set the to the aligned copy
-      workarea.pSrc[0] = workarea.pSrc_temp[0];
-      if (chroma)
-      {
-        workarea.pSrc[1] = pSrcFrame->GetPlane(UPLANE)->GetAbsolutePelPointer(workarea.x[1], workarea.y[1]);
-        workarea.pSrc[2] = pSrcFrame->GetPlane(VPLANE)->GetAbsolutePelPointer(workarea.x[2], workarea.y[2]);
-        BLITCHROMA(workarea.pSrc_temp[1], nSrcPitch[1], workarea.pSrc[1], nSrcPitch_plane[1]);
-        BLITCHROMA(workarea.pSrc_temp[2], nSrcPitch[2], workarea.pSrc[2], nSrcPitch_plane[2]);
-        workarea.pSrc[1] = workarea.pSrc_temp[1];
-        workarea.pSrc[2] = workarea.pSrc_temp[2];
-      }
-#else	// ALIGN_SOURCEBLOCK
-      workarea.pSrc[0] = pSrcFrame->GetPlane(YPLANE)->GetAbsolutePelPointer(workarea.x[0], workarea.y[0]);
-      if (chroma)
-      {
-        workarea.pSrc[1] = pSrcFrame->GetPlane(UPLANE)->GetAbsolutePelPointer(workarea.x[1], workarea.y[1]);
-        workarea.pSrc[2] = pSrcFrame->GetPlane(VPLANE)->GetAbsolutePelPointer(workarea.x[2], workarea.y[2]);
-      }
-#endif	// ALIGN_SOURCEBLOCK
+      LoadSrcBlock(workarea);
 
       if (workarea.blky == workarea.blky_beg)
       {
@@ -3326,29 +4190,19 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
 
       // update SAD
 #ifdef ALLOW_DCT
-      if (dctmode != 0) // DCT method (luma only - currently use normal spatial SAD chroma)
-      {
-        // make dct of source block
-        if (dctmode <= 4) //don't do the slow dct conversion if SATD used
-        {
-          workarea.DCT->DCTBytes2D(workarea.pSrc[0], nSrcPitch[0], &workarea.dctSrc[0], dctpitch);
-        }
-      }
-      if (dctmode >= 3) // most use it and it should be fast anyway //if (dctmode == 3 || dctmode == 4) // check it
-      {
-        workarea.srcLuma = LUMA(workarea.pSrc[0], nSrcPitch[0]);
-      }
+      LoadSrcBlockDCT(workarea);
 #endif	// ALLOW_DCT
 
-      sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[1])
-        + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[2]), effective_chromaSADscale) : 0;
-      sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock(workarea, workarea.predictor.x, workarea.predictor.y));
+      sad_t saduv = (chroma) ? ScaleSadChroma(SADCHROMA(workarea.pSrc[1], nSrcPitch[1], GetRefBlockU<NPELL2>(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[1])
+        + SADCHROMA(workarea.pSrc[2], nSrcPitch[2], GetRefBlockV<NPELL2>(workarea, workarea.predictor.x, workarea.predictor.y), nRefPitch[2]), effective_chromaSADscale) : 0;
+      sad_t sad = LumaSAD<pixel_t>(workarea, GetRefBlock<NPELL2>(workarea, workarea.predictor.x, workarea.predictor.y));
       sad += saduv;
       workarea.bestMV.sad = sad;
       workarea.nMinCost = sad;
 
       if (workarea.bestMV.sad > _thSAD)// if old interpolated vector is bad
       {
+        ++nbr_bad;
         //				CheckMV(vectorOld1.x, vectorOld1.y);
         //				CheckMV(vectorOld2.x, vectorOld2.y);
         //				CheckMV(vectorOld3.x, vectorOld3.y);
@@ -3360,20 +4214,20 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
         {
           for (int i = nSearchParam; i > 0; i /= 2)
           {
-            OneTimeSearch<pixel_t>(workarea, i);
+            OneTimeSearch<pixel_t, NPELL2>(workarea, i);
           }
         }
 
         if (searchType & NSTEP)
         {
-          NStepSearch<pixel_t>(workarea, nSearchParam);
+          NStepSearch<pixel_t, NPELL2>(workarea, nSearchParam);
         }
 
         if (searchType & LOGARITHMIC)
         {
           for (int i = nSearchParam; i > 0; i /= 2)
           {
-            DiamondSearch<pixel_t>(workarea, i);
+            DiamondSearch<pixel_t, NPELL2>(workarea, i);
           }
         }
 
@@ -3382,20 +4236,31 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
           //       ExhaustiveSearch(nSearchParam);
           int mvx = workarea.bestMV.x;
           int mvy = workarea.bestMV.y;
-          for (int i = 1; i <= nSearchParam; i++)// region is same as exhaustive, but ordered by radius (from near to far)
+          if (UseSearchGrid(nSearchParam))
+          {
+            InitSearchGrid(workarea, mvx, mvy, nSearchParam);
+            for (int i = 1; i <= nSearchParam; i++)
+            {
+              ExpandingSearchGrid<pixel_t, NPELL2>(workarea, i, 1, mvx, mvy);
+            }
+          }
+          else
           {
-            ExpandingSearch<pixel_t>(workarea, i, 1, mvx, mvy);
+            for (int i = 1; i <= nSearchParam; i++)// region is same as exhaustive, but ordered by radius (from near to far)
+            {
+              ExpandingSearch<pixel_t, NPELL2>(workarea, i, 1, mvx, mvy);
+            }
           }
         }
 
         if (searchType & HEX2SEARCH)
         {
-          Hex2Search<pixel_t>(workarea, nSearchParam);
+          Hex2Search<pixel_t, NPELL2>(workarea, nSearchParam);
         }
 
         if (searchType & UMHSEARCH)
         {
-          UMHSearch<pixel_t>(workarea, nSearchParam, workarea.bestMV.x, workarea.bestMV.y);
+          UMHSearch<pixel_t, NPELL2>(workarea, nSearchParam, workarea.bestMV.x, workarea.bestMV.y);
         }
 
         if (searchType & HSEARCH)
@@ -3404,8 +4269,8 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
           int mvy = workarea.bestMV.y;
           for (int i = 1; i <= nSearchParam; i++)// region is same as exhaustive, but ordered by radius (from near to far)
           {
-            CheckMV<pixel_t>(workarea, mvx - i, mvy);
-            CheckMV<pixel_t>(workarea, mvx + i, mvy);
+            CheckMV<pixel_t, NPELL2>(workarea, mvx - i, mvy);
+            CheckMV<pixel_t, NPELL2>(workarea, mvx + i, mvy);
           }
         }
 
@@ -3415,8 +4280,8 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
           int mvy = workarea.bestMV.y;
           for (int i = 1; i <= nSearchParam; i++)// region is same as exhaustive, but ordered by radius (from near to far)
           {
-            CheckMV<pixel_t>(workarea, mvx, mvy - i);
-            CheckMV<pixel_t>(workarea, mvx, mvy + i);
+            CheckMV<pixel_t, NPELL2>(workarea, mvx, mvy - i);
+            CheckMV<pixel_t, NPELL2>(workarea, mvx, mvy + i);
           }
         }
       }	// if bestMV.sad > thSAD
@@ -3425,6 +4290,7 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
       vectors[workarea.blkIdx].x = workarea.bestMV.x;
       vectors[workarea.blkIdx].y = workarea.bestMV.y;
       vectors[workarea.blkIdx].sad = workarea.bestMV.sad;
+      workarea.planeSAD += workarea.bestMV.sad;
 
       if (outfilebuf != NULL) // write vector to outfile
       {
@@ -3446,7 +4312,7 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
       {
         // int64_t += uint32_t - uint32_t is not ok, if diff would be negative
         // 161204 todo check: why is it not abs(lumadiff)?
-        workarea.sumLumaChange += (safe_sad_t)LUMA(GetRefBlock(workarea, 0, 0), nRefPitch[0]) - (safe_sad_t)LUMA(workarea.pSrc[0], nSrcPitch[0]);
+        workarea.sumLumaChange += (safe_sad_t)LUMA(GetRefBlock<NPELL2>(workarea, 0, 0), nRefPitch[0]) - (safe_sad_t)LUMA(workarea.pSrc[0], nSrcPitch[0]);
       }
 
       if (iblkx < nBlkX - 1)
@@ -3470,6 +4336,11 @@ void	PlaneOfBlocks::recalculate_mv_slice(Slicer::TaskData &td)
 
   planeSAD += workarea.planeSAD; // for debug, plus fixme outer planeSAD is not used
   sumLumaChange += workarea.sumLumaChange;
+  if (_stats_flag)
+  {
+    badcount += nbr_bad;
+    CollectStats(workarea);
+  }
 
   if (isse)
   {
@@ -3501,7 +4372,16 @@ PlaneOfBlocks::WorkingArea::WorkingArea(int nBlkSizeX, int nBlkSizeY, int dctpit
   , dctRef(nBlkSizeY* dctpitch)
   , pixelsize(_pixelsize)
   , bits_per_pixel(_bits_per_pixel)
+  , grid_sad()
+  , grid_x0(0)
+  , grid_y0(0)
+  , grid_size(0)
+  , pel_gen(-1)
 {
+  for (int p = 0; p < 3; ++p)
+  {
+    pel_next[p] = 0;
+  }
 #if (ALIGN_SOURCEBLOCK > 1)
   int xPitch = AlignNumber(nBlkSizeX*pixelsize, ALIGN_SOURCEBLOCK);  // for memory allocation pixelsize needed
   int xPitchUV = AlignNumber((nBlkSizeX*pixelsize) >> nLogxRatioUV, ALIGN_SOURCEBLOCK);
@@ -3521,7 +4401,7 @@ PlaneOfBlocks::WorkingArea::WorkingArea(int nBlkSizeX, int nBlkSizeY, int dctpit
 
 PlaneOfBlocks::WorkingArea::~WorkingArea()
 {
-  // Nothing
+  MemInfo::OnFree(this);
 }
 
 
@@ -3566,6 +4446,7 @@ PlaneOfBlocks::WorkingAreaFactory::WorkingAreaFactory(int nBlkSizeX, int nBlkSiz
   : _blk_size_x(nBlkSizeX)
   , _blk_size_y(nBlkSizeY)
   , _dctpitch(dctpitch)
+  , _mem_info_ptr(MemInfo::GetCurrent())
   , _x_ratio_uv_log(nLogxRatioUV)
   , _y_ratio_uv_log(nLogyRatioUV)
   , _pixelsize(pixelsize)
@@ -3578,7 +4459,8 @@ PlaneOfBlocks::WorkingAreaFactory::WorkingAreaFactory(int nBlkSizeX, int nBlkSiz
 
 PlaneOfBlocks::WorkingArea *PlaneOfBlocks::WorkingAreaFactory::do_create()
 {
-  return (new WorkingArea(
+  MemInfo::Scope mem_scope(_mem_info_ptr);
+  WorkingArea *workarea_ptr = new WorkingArea(
     _blk_size_x,
     _blk_size_y,
     _dctpitch,
@@ -3586,7 +4468,9 @@ PlaneOfBlocks::WorkingArea *PlaneOfBlocks::WorkingAreaFactory::do_create()
     _y_ratio_uv_log,
     _pixelsize,
     _bits_per_pixel
-  ));
+  );
+  MemInfo::OnAlloc(workarea_ptr, sizeof(*workarea_ptr));
+  return (workarea_ptr);
 }
 
 
@@ -27,6 +27,7 @@
 #define __POBLOCKS__
 
 #include "conc/ObjPool.h"
+#include "fstb/AllocAlign.h"
 #include "CopyCode.h"
 #include "MTSlicer.h"
 #include	"MVInterface.h"	// Required for ALIGN_SOURCEBLOCK
@@ -53,6 +54,8 @@
 
 
 class DCTClass;
+class KernelInfo;
+class MemInfo;
 class MVClip;
 class MVFrame;
 
@@ -68,6 +71,23 @@ public:
 
   typedef	MTSlicer <PlaneOfBlocks>	Slicer;
 
+  // search template parameter for nPel known only at run time
+  enum { PEL_GENERIC = -1 };
+
+  // predictor types for the search counters
+  enum { WIN_ZERO = 0, WIN_GLOBAL, WIN_MEDIAN, WIN_TEMPORAL, WIN_NBR_ELT };
+
+  // Counters of the last SearchMVs() or RecalculateMVs(), see EnableStats()
+  struct SearchStats
+  {
+    int nbr_blk;                // searched blocks
+    int64_t nbr_sad;            // luma SAD evaluations
+    int nbr_win [WIN_NBR_ELT];  // blocks whose best candidate before the refinement is the predictor
+    int nbr_bad;                // bad vectors refined with the wide search (MRecalculate: above thSAD)
+    bigsad_t plane_sad;         // sum of the block SADs
+    double time_us;             // wall time of the search
+  };
+
   PlaneOfBlocks(int _nBlkX, int _nBlkY, int _nBlkSizeX, int _nBlkSizeY, int _nPel, int _nLevel, int _nFlags, int _nOverlapX, int _nOverlapY,
     int _xRatioUV, int _yRatioUV, int _pixelsize, int _bits_per_pixel,
     conc::ObjPool <DCTClass> *dct_pool_ptr,
@@ -81,7 +101,8 @@ public:
     int stp, int lambda, sad_t lsad, int pnew, int plevel,
     int flags, sad_t *out, const VECTOR *globalMVec, short * outfilebuf, int fieldShiftCur,
     int * meanLumaChange, int divideExtra,
-    int _pzero, int _pglobal, sad_t _badSAD, int _badrange, bool meander, int *vecPrev, bool _tryMany);
+    int _pzero, int _pglobal, sad_t _badSAD, int _badrange, bool meander, int *vecPrev, bool _tryMany,
+    sad_t _skipSAD, bool adaptive_flag);
 
 
   /* plane initialisation */
@@ -100,12 +121,30 @@ public:
   MV_FORCEINLINE int GetnBlkY() { return nBlkY; }
   MV_FORCEINLINE int GetnBlkSizeX() { return nBlkSizeX; }
   MV_FORCEINLINE int GetnBlkSizeY() { return nBlkSizeY; }
+  MV_FORCEINLINE int GetnBlkCount() { return nBlkCount; }
+  MV_FORCEINLINE int GetSkipCount() { return _skip_count; } // static blocks of the last SearchMVs()
+
+  // Search counters, off by default. The partial counts of the working
+  // areas are only collected and timed when enabled.
+  void EnableStats(bool flag) { _stats_flag = flag; }
+  SearchStats GetStats() const;
+
+  // Kernels selected for this plane (MToolsInfo)
+  void DescribeKernels(KernelInfo &info) const;
 
   void RecalculateMVs(MVClip & mvClip, MVFrame *_pSrcFrame, MVFrame *_pRefFrame, SearchType st,
     int stp, int _lambda, sad_t _lSAD, int _pennew,
     int flags, int *out, short * outfilebuf, int fieldShift, sad_t thSAD,
     int _divideExtra, int smooth, bool meander);
 
+  /* source frame of the next search, to share the source block data between searches (-1: not shared) */
+  void SetSrcFrameId(int src_frame_id);
+
+  /* quadtree split (divide=3), finest plane after the search: best vector of the sub-block */
+  /* (sbx, sby) of the divided grid among the candidates, with the SAD of the sub-block */
+  VECTOR SearchSubBlock(int sbx, int sby, const VECTOR cand_arr[], int nbr_cand);
+  MV_FORCEINLINE bool CanSearchSubBlocks() const { return SADSUB != nullptr && (!chroma || SADCHROMASUB != nullptr); }
+
 
 private:
 
@@ -142,8 +181,15 @@ private:
   COPYFunction * BLITCHROMA;
   SADFunction *  SADCHROMA;
   SADFunction *  SATD;              /* SATD function, (similar to SAD), used as replacement to dct */
-
-  std::vector <VECTOR>              /* motion vectors of the blocks */
+  SADFunction *  TILESAD;           /* SAD of a block step sized tile, for the tile SAD cache */
+  COPYFunction * BLITTILE;
+  SADRow8Function * SADROW8;        /* SADs of 8 horizontally adjacent positions, for the exhaustive search */
+  SADFunction *  SADPART;           /* SAD of a quarter of the block rows, for early termination */
+  SADFunction *  SADSUB;            /* SAD of a half size sub-block, for the quadtree split */
+  SADFunction *  SADCHROMASUB;
+  MVPelBlockBuf  _sub_pel_buf[3];   /* sub-pixel sub-blocks rendered on demand */
+
+  std::vector <VECTOR, fstb::AllocAlign <VECTOR> > /* motion vectors of the blocks, through the allocation hook */
     vectors;           /* before the search, contains the hierachal predictor */
                        /* after the search, contains the best motion vector */
 
@@ -155,6 +201,7 @@ private:
   bool sse41;
   bool avx;
   bool avx2;
+  arch_t _arch;  // highest kernel tier allowed: isse and CPU
 
 
   int dctpitch;
@@ -200,9 +247,51 @@ private:
   // it is not AtomicInt anymore
   std::atomic <bigsad_t> planeSAD;      // summary SAD of plane
   std::atomic <bigsad_t> sumLumaChange; // luma change sum
+  sad_t _skipSAD;             // static blocks: no search if the zero or temporal vector SAD is below (0: disabled)
+  std::atomic <int> _skip_count; // number of static blocks
+
+  // Search counters (EnableStats), summed from the working areas at the end of the slices
+  bool _stats_flag;
+  std::atomic <int64_t> _stat_nbr_sad;
+  std::atomic <int> _stat_nbr_win [WIN_NBR_ELT];
+  double _stat_time_us;
+  bool _adaptive_range_flag;  // search range of each block from its predictor quality (not on the smallest plane)
   VECTOR _glob_mv_pred_def;
   int _lambda_level;
 
+  // Tile SAD cache for overlapped blocks (MOTION_USE_TILE_SAD_CACHE)
+  // Tiles have the size of the block step, a block covers _tile_nx * _tile_ny
+  // tiles. Luma SAD of the zero and global vectors are computed once per tile
+  // and summed up for each block. Negative values mark unusable tiles.
+  bool _tile_cache_flag;
+  bool _tile_glob_flag;       // global tiles are computed (global vector != zero vector)
+  int _tile_w;
+  int _tile_h;
+  int _tile_nx;
+  int _tile_ny;
+  int _tile_cols;
+  int _tile_rows;
+  std::vector <sad_t> _tile_sad_zero;
+  std::vector <sad_t> _tile_sad_glob;
+
+  // Exhaustive search SAD grid: luma SADs of the whole search square are
+  // computed by rows of 8 positions of the same subpel phase (SADROW8) on
+  // first access, then the usual expanding order is replayed on them.
+  // 8 bit and non-DCT only.
+  bool _grid_search_flag;
+
+  // Early termination of the luma SAD in the candidate checks: large blocks
+  // are processed by groups of _sad_part_h rows (0: disabled). Non-DCT only.
+  int _sad_part_h;
+
+  // Sub-pixel planes of the reference are rendered on demand (MSuper ondemand)
+  // Set for each SearchMVs() and RecalculateMVs(), with a new cache generation.
+  bool _pel_on_demand_flag;
+  // The padding of the reference is not stored (MSuper virtualpad), blocks
+  // crossing the borders are gathered with clamped coordinates.
+  bool _virtual_pad_flag;
+  int _pel_gen;
+
   // Parameters from SearchMVs() and RecalculateMVs()
   int *_out;
   short *_outfilebuf;
@@ -239,6 +328,10 @@ private:
 
     bigsad_t planeSAD;          // partial summary SAD of plane
     bigsad_t sumLumaChange;     // partial luma change sum
+    int skipCount;              // partial number of static blocks
+    int64_t sadCount;           // partial number of luma SAD evaluations, always counted
+    int winCount[WIN_NBR_ELT];  // partial predictor wins, only when _stats_flag
+    int searchParam;            // search parameter of the current block
     int blky_beg;               // First line of blocks to process from this thread
     int blky_end;               // Last line of blocks + 1 to process from this thread
 
@@ -262,6 +355,21 @@ private:
     int pixelsize;
     int bits_per_pixel;
 
+    // Exhaustive search SAD grid, negative values are not computed yet
+    std::vector <sad_t> grid_sad;
+    int grid_x0;                // vector at the top-left of the grid
+    int grid_y0;
+    int grid_size;              // 2 * radius + 1
+
+    // Sub-pixel blocks rendered on demand: small ring per plane, keyed by the
+    // absolute position in sub-pixel units. Invalid if pel_gen != _pel_gen.
+    enum { PEL_CACHE_SIZE = 4 };
+    MVPelBlockBuf pel_buf[3][PEL_CACHE_SIZE];
+    int pel_key_x[3][PEL_CACHE_SIZE];
+    int pel_key_y[3][PEL_CACHE_SIZE];
+    int pel_next[3];
+    int pel_gen;
+
     // Data set once
     TmpDataArray dctSrc;
     TmpDataArray dctRef;
@@ -302,6 +410,7 @@ private:
     int _blk_size_x;
     int _blk_size_y;
     int _dctpitch;
+    MemInfo * _mem_info_ptr; // Charged with the working areas, 0 if none
     int _x_ratio_uv_log; // PF
     int _y_ratio_uv_log;
     int _pixelsize; // PF
@@ -318,14 +427,36 @@ private:
   VECTOR *_gvect_estim_ptr;	// Points on the global motion vector estimation result. 0 when not used.
   std::atomic<int> _gvect_result_count;
 
+  // Source block cache (multi mode): the searches of all the deltas of a
+  // source frame use the same source blocks. Their aligned copies, DCT and
+  // mean luma are stored by the first search and read back by the others.
+  int _src_frame_id;          // source frame of the next search, -1: no cache
+  int _src_cache_id;          // source frame of the cached data, -1: none
+  bool _src_cache_read;       // current search reads the cache
+  bool _src_cache_fill;       // current search fills the cache
+  int _src_cache_blk_size;    // bytes of the aligned copies per block
+  int _src_cache_dct_size;    // bytes of the DCT per block
+  WorkingArea::TmpDataArray _src_cache_blk;
+  std::vector <uint8_t, fstb::AllocAlign <uint8_t> > _src_cache_dct;
+  std::vector <int, fstb::AllocAlign <int> > _src_cache_luma;
+
+  void StartSrcCache();
+  void LoadSrcBlock(WorkingArea &workarea);
+#ifdef ALLOW_DCT
+  void LoadSrcBlockDCT(WorkingArea &workarea);
+#endif	// ALLOW_DCT
+
   /* mv search related functions */
 
     /* fill the predictors array */
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void FetchPredictors(WorkingArea &workarea);
 
+  /* search parameter of the block, from its best predictor */
+  int AdaptiveSearchParam(const WorkingArea &workarea) const;
+
   /* performs a diamond search */
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void DiamondSearch(WorkingArea &workarea, int step);
 
   /* performs a square search */
@@ -335,57 +466,81 @@ private:
   //	void ExhaustiveSearch(WorkingArea &workarea, int radius); // diameter = 2*radius - 1
 
   /* performs an n-step search */
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void NStepSearch(WorkingArea &workarea, int stp);
 
   /* performs a one time search */
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void OneTimeSearch(WorkingArea &workarea, int length);
 
   /* performs an epz search */
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void PseudoEPZSearch(WorkingArea &workarea);
 
+  void ResetStats();
+  void CollectStats(const WorkingArea &workarea);
+
   //	void PhaseShiftSearch(int vx, int vy);
 
   /* performs an exhaustive search */
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void ExpandingSearch(WorkingArea &workarea, int radius, int step, int mvx, int mvy); // diameter = 2*radius + 1
+  template<typename pixel_t, int NPELL2>
+  void ExpandingSearchGrid(WorkingArea &workarea, int radius, int step, int mvx, int mvy); // same with the SAD grid
+  MV_FORCEINLINE bool UseSearchGrid(int radius) const;
+  void InitSearchGrid(WorkingArea &workarea, int mvx, int mvy, int radius);
 
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void Hex2Search(WorkingArea &workarea, int i_me_range);
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void CrossSearch(WorkingArea &workarea, int start, int x_max, int y_max, int mvx, int mvy);
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void UMHSearch(WorkingArea &workarea, int i_me_range, int omx, int omy);
 
   /* inline functions */
 
   /* fetch the block in the reference frame, which is pointed by the vector (vx, vy) */
   // moved here from cpp in order to able to inline from other (e.g. _avx2) cpps (gcc error)
+  const uint8_t* GetRefBlockOnDemand(WorkingArea& workarea, int plane, int nX, int nY);
+
+  // NPELL2: log2 of nPel known at compile time, or PEL_GENERIC to test
+  // nPel and the on-demand mode at run time.
+  template<int NPELL2 = PEL_GENERIC>
   MV_FORCEINLINE const uint8_t* GetRefBlock(WorkingArea& workarea, int nVx, int nVy) {
-    return
-      (nPel == 2) ? pRefFrame->GetPlane(YPLANE)->GetAbsolutePointerPel <1>((workarea.x[0] << 1) + nVx, (workarea.y[0] << 1) + nVy) :
-      (nPel == 1) ? pRefFrame->GetPlane(YPLANE)->GetAbsolutePointerPel <0>((workarea.x[0]) + nVx, (workarea.y[0]) + nVy) :
-      pRefFrame->GetPlane(YPLANE)->GetAbsolutePointerPel <2>((workarea.x[0] << 2) + nVx, (workarea.y[0] << 2) + nVy);
+    return GetRefBlockPlane<NPELL2>(workarea, 0, YPLANE, nVx, nVy);
   }
 
+  template<int NPELL2 = PEL_GENERIC>
   MV_FORCEINLINE const uint8_t* GetRefBlockU(WorkingArea& workarea, int nVx, int nVy)
   {
-    return
-      (nPel == 2) ? pRefFrame->GetPlane(UPLANE)->GetAbsolutePointerPel <1>((workarea.x[1] << 1) + (nVx >> nLogxRatioUV), (workarea.y[1] << 1) + (nVy >> nLogyRatioUV)) :
-      (nPel == 1) ? pRefFrame->GetPlane(UPLANE)->GetAbsolutePointerPel <0>((workarea.x[1]) + (nVx >> nLogxRatioUV), (workarea.y[1]) + (nVy >> nLogyRatioUV)) :
-      pRefFrame->GetPlane(UPLANE)->GetAbsolutePointerPel <2>((workarea.x[1] << 2) + (nVx >> nLogxRatioUV), (workarea.y[1] << 2) + (nVy >> nLogyRatioUV));
+    return GetRefBlockPlane<NPELL2>(workarea, 1, UPLANE, nVx >> nLogxRatioUV, nVy >> nLogyRatioUV);
   }
 
+  template<int NPELL2 = PEL_GENERIC>
   MV_FORCEINLINE const uint8_t* GetRefBlockV(WorkingArea& workarea, int nVx, int nVy)
   {
+    return GetRefBlockPlane<NPELL2>(workarea, 2, VPLANE, nVx >> nLogxRatioUV, nVy >> nLogyRatioUV);
+  }
+
+  template<int NPELL2>
+  MV_FORCEINLINE const uint8_t* GetRefBlockPlane(WorkingArea& workarea, int plane, MVPlaneSet plane_flag, int nVx, int nVy)
+  {
+    if (NPELL2 >= 0)
+    {
+      enum { L2 = (NPELL2 >= 0) ? NPELL2 : 0 };
+      return pRefFrame->GetPlane(plane_flag)->GetAbsolutePointerPel <L2>((workarea.x[plane] << L2) + nVx, (workarea.y[plane] << L2) + nVy);
+    }
+    if (_pel_on_demand_flag || _virtual_pad_flag)
+      return GetRefBlockOnDemand(workarea, plane, (workarea.x[plane] << nLogPel) + nVx, (workarea.y[plane] << nLogPel) + nVy);
     return
-      (nPel == 2) ? pRefFrame->GetPlane(VPLANE)->GetAbsolutePointerPel <1>((workarea.x[2] << 1) + (nVx >> nLogxRatioUV), (workarea.y[2] << 1) + (nVy >> nLogyRatioUV)) :
-      (nPel == 1) ? pRefFrame->GetPlane(VPLANE)->GetAbsolutePointerPel <0>((workarea.x[2]) + (nVx >> nLogxRatioUV), (workarea.y[2]) + (nVy >> nLogyRatioUV)) :
-      pRefFrame->GetPlane(VPLANE)->GetAbsolutePointerPel <2>((workarea.x[2] << 2) + (nVx >> nLogxRatioUV), (workarea.y[2] << 2) + (nVy >> nLogyRatioUV));
+      (nPel == 2) ? pRefFrame->GetPlane(plane_flag)->GetAbsolutePointerPel <1>((workarea.x[plane] << 1) + nVx, (workarea.y[plane] << 1) + nVy) :
+      (nPel == 1) ? pRefFrame->GetPlane(plane_flag)->GetAbsolutePointerPel <0>((workarea.x[plane]) + nVx, (workarea.y[plane]) + nVy) :
+      pRefFrame->GetPlane(plane_flag)->GetAbsolutePointerPel <2>((workarea.x[plane] << 2) + nVx, (workarea.y[plane] << 2) + nVy);
   }
 
+  const uint8_t* GetRefSubBlock(int plane, int nX, int nY, int nBlkW, int nBlkH);
+  sad_t SubBlockSAD(const uint8_t * const src_ptr_arr[3], const int x_arr[3], const int y_arr[3], int vx, int vy);
+
   MV_FORCEINLINE const uint8_t* GetSrcBlock(int nX, int nY)
   {
     return pSrcFrame->GetPlane(YPLANE)->GetAbsolutePelPointer(nX, nY);
@@ -396,13 +551,22 @@ private:
   sad_t LumaSADx(WorkingArea &workarea, const unsigned char *pRef0);
   template<typename pixel_t>
   MV_FORCEINLINE sad_t LumaSAD(WorkingArea &workarea, const unsigned char *pRef0);
+  template<typename pixel_t, int NPELL2>
+  MV_FORCEINLINE sad_t LumaSADCached(WorkingArea &workarea, int vx, int vy);
   template<typename pixel_t>
+  MV_FORCEINLINE sad_t LumaSADEarly(WorkingArea &workarea, const unsigned char *pRef0, sad_t cost, int penalty);
+  MV_FORCEINLINE sad_t TileSumSAD(const sad_t *tile_ptr, const WorkingArea &workarea) const;
+  sad_t TileSAD(const uint8_t *pSrc, int nSrcPitchTile, int x, int y, int vx, int vy);
+  template<typename pixel_t, int NPELL2>
   MV_FORCEINLINE void CheckMV0(WorkingArea &workarea, int vx, int vy);
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   MV_FORCEINLINE void CheckMV(WorkingArea &workarea, int vx, int vy);
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
+  MV_FORCEINLINE void CheckMVGrid(WorkingArea &workarea, int vx, int vy);
+  sad_t GridSAD(WorkingArea &workarea, int vx, int vy);
+  template<typename pixel_t, int NPELL2>
   MV_FORCEINLINE void CheckMV2(WorkingArea &workarea, int vx, int vy, int *dir, int val);
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   MV_FORCEINLINE void CheckMVdir(WorkingArea &workarea, int vx, int vy, int *dir, int val);
   MV_FORCEINLINE int ClipMVx(WorkingArea &workarea, int vx);
   MV_FORCEINLINE int ClipMVy(WorkingArea &workarea, int vy);
@@ -412,15 +576,18 @@ private:
   MV_FORCEINLINE static unsigned int SquareDifferenceNorm(const VECTOR& v1, const int v2x, const int v2y);
   MV_FORCEINLINE bool IsInFrame(int i);
 
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void Refine(WorkingArea &workarea);
 
   template<typename pixel_t>
+  Slicer::ProcPtr	select_search_mv_slice() const;
+  template<typename pixel_t, int NPELL2>
   void	search_mv_slice(Slicer::TaskData &td);
-  template<typename pixel_t>
+  template<typename pixel_t, int NPELL2>
   void	recalculate_mv_slice(Slicer::TaskData &td);
 
   void	estimate_global_mv_doubled_slice(Slicer::TaskData &td);
+  void	tile_sad_slice(Slicer::TaskData &td);
 
 };
 
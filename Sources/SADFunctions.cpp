@@ -330,16 +330,24 @@ MV_FORCEINLINE int32_t compute_sum_8x8_satd16(int ln,
 
 template<int w, int h, bool hasSSSE3>
 MV_FORCEINLINE int32_t calc_satd16_4x4_blocks(const unsigned char *src, int systride, const unsigned char *ref, int rystride) {
+  // Halved per 8x4 block (4x4 when the width is not mod 8), like the C
+  // version, so that the truncations match
+  constexpr int step = (w % 8 == 0) ? 8 : 4;
   int32_t satd = 0;
   for (int i = 0; i < h; i += 4) {
-    for (int j = 0; j < w; j += 4) {
-      satd += compute_satd16_4x4_sse2<hasSSSE3>(
+    for (int j = 0; j < w; j += step) {
+      uint32_t part = compute_satd16_4x4_sse2<hasSSSE3>(
         src + i*systride + j*sizeof(uint16_t), systride,
         ref + i*rystride + j*sizeof(uint16_t), rystride);
+      if (step == 8) {
+        part += compute_satd16_4x4_sse2<hasSSSE3>(
+          src + i*systride + (j + 4)*sizeof(uint16_t), systride,
+          ref + i*rystride + (j + 4)*sizeof(uint16_t), rystride);
+      }
+      satd += part >> 1;
     }
   }
-  //return (satd + 2) >> 2;
-  return satd >> 1; // in order to match x264 C and asm version
+  return satd;
 }
 
 // declaring templates for 16 bit satd
@@ -413,14 +421,9 @@ void HADAMARD4_sse2(__m128i &d10, __m128i &d32, __m128i &s10, __m128i &s32) {
 
 }
 */
-#define SUB(a,b) \
-(uint32_t)(((int)(a & 0xFFFFFFFF)) - ((int)(b & 0xFFFFFFFF))) | \
-((uint64_t)(((int)(((int64_t)a >> 32) & 0xFFFFFFFF)) - ((int)(((int64_t)b >> 32) & 0xFFFFFFFF))) << 32)
-#define ADD(a,b) \
-(uint32_t)(((int)(a & 0xFFFFFFFF)) + ((int)(b & 0xFFFFFFFF))) | \
-((uint64_t)(((int)(((int64_t)a >> 32) & 0xFFFFFFFF)) + ((int)(((int64_t)b >> 32) & 0xFFFFFFFF))) << 32)
-
-/*
+// Plain wrapping arithmetic on the packed sums: the borrow of the low half
+// into the high one is what abs2 expects. Adding the halves separately
+// (former ADD/SUB macros) gave off-by-one results with 16 bit pixels.
 #define HADAMARD4(d0, d1, d2, d3, s0, s1, s2, s3) {\
     sum2_t t0 = s0 + s1;\
     sum2_t t1 = s0 - s1;\
@@ -431,18 +434,6 @@ void HADAMARD4_sse2(__m128i &d10, __m128i &d32, __m128i &s10, __m128i &s32) {
     d1 = t1 + t3;\
     d3 = t1 - t3;\
 }
-todo why this differs from the ADD and SUB version?
-*/
-#define HADAMARD4(d0, d1, d2, d3, s0, s1, s2, s3) {\
-    sum2_t t0 = ADD(s0,s1);\
-    sum2_t t1 = SUB(s0,s1);\
-    sum2_t t2 = ADD(s2,s3);\
-    sum2_t t3 = SUB(s2,s3);\
-    d0 = ADD(t0,t2);\
-    d2 = SUB(t0,t2);\
-    d1 = ADD(t1,t3);\
-    d3 = SUB(t1,t3);\
-}
 
 // (a+b*256) - (c+d*256) = a-c + 256*(b-d) is it OK always?
 
@@ -725,327 +716,330 @@ SADFunction* get_sad_function(int BlockX, int BlockY, int bits_per_pixel, arch_t
       bits_per_pixel_2 = 16; // if no 10-bit specific found, secondary find: 16
 
     // BlkSizeX, BlkSizeY, bits_per_pixel, arch_t
-    std::map<std::tuple<int, int, int, arch_t>, SADFunction*> func_sad;
+    static const std::map<std::tuple<int, int, int, arch_t>, SADFunction*> func_sad_table = []() {
+      std::map<std::tuple<int, int, int, arch_t>, SADFunction*> func_sad;
 #define MAKE_SAD_FN(x, y) func_sad[make_tuple(x, y, 8, NO_SIMD)] = Sad_C<x, y, uint8_t>; \
 func_sad[make_tuple(x, y, 16, NO_SIMD)] = Sad_C<x, y, uint16_t>;
-// match with CopyCode.cpp and Overlap.cpp, and luma (variance.cpp) list
-MAKE_SAD_FN(64, 64)
-MAKE_SAD_FN(64, 48)
-MAKE_SAD_FN(64, 32)
-MAKE_SAD_FN(64, 16)
-MAKE_SAD_FN(48, 64)
-MAKE_SAD_FN(48, 48)
-MAKE_SAD_FN(48, 24)
-MAKE_SAD_FN(48, 12)
-MAKE_SAD_FN(32, 64)
-MAKE_SAD_FN(32, 32)
-MAKE_SAD_FN(32, 24)
-MAKE_SAD_FN(32, 16)
-MAKE_SAD_FN(32, 8)
-MAKE_SAD_FN(24, 48)
-MAKE_SAD_FN(24, 32)
-MAKE_SAD_FN(24, 24)
-MAKE_SAD_FN(24, 12)
-MAKE_SAD_FN(24, 6)
-MAKE_SAD_FN(16, 64)
-MAKE_SAD_FN(16, 32)
-MAKE_SAD_FN(16, 16)
-MAKE_SAD_FN(16, 12)
-MAKE_SAD_FN(16, 8)
-MAKE_SAD_FN(16, 4)
-MAKE_SAD_FN(16, 2)
-MAKE_SAD_FN(16, 1)
-MAKE_SAD_FN(12, 48)
-MAKE_SAD_FN(12, 24)
-MAKE_SAD_FN(12, 16)
-MAKE_SAD_FN(12, 12)
-MAKE_SAD_FN(12, 6)
-MAKE_SAD_FN(12, 3)
-MAKE_SAD_FN(8, 32)
-MAKE_SAD_FN(8, 16)
-MAKE_SAD_FN(8, 8)
-MAKE_SAD_FN(8, 4)
-MAKE_SAD_FN(8, 2)
-MAKE_SAD_FN(8, 1)
-MAKE_SAD_FN(6, 24)
-MAKE_SAD_FN(6, 12)
-MAKE_SAD_FN(6, 6)
-MAKE_SAD_FN(6, 3)
-MAKE_SAD_FN(4, 8)
-MAKE_SAD_FN(4, 4)
-MAKE_SAD_FN(4, 2)
-MAKE_SAD_FN(4, 1)
-MAKE_SAD_FN(3, 6)
-MAKE_SAD_FN(3, 3)
-MAKE_SAD_FN(2, 4)
-MAKE_SAD_FN(2, 2)
-MAKE_SAD_FN(2, 1)
+  // match with CopyCode.cpp and Overlap.cpp, and luma (variance.cpp) list
+  MAKE_SAD_FN(64, 64)
+  MAKE_SAD_FN(64, 48)
+  MAKE_SAD_FN(64, 32)
+  MAKE_SAD_FN(64, 16)
+  MAKE_SAD_FN(48, 64)
+  MAKE_SAD_FN(48, 48)
+  MAKE_SAD_FN(48, 24)
+  MAKE_SAD_FN(48, 12)
+  MAKE_SAD_FN(32, 64)
+  MAKE_SAD_FN(32, 32)
+  MAKE_SAD_FN(32, 24)
+  MAKE_SAD_FN(32, 16)
+  MAKE_SAD_FN(32, 8)
+  MAKE_SAD_FN(24, 48)
+  MAKE_SAD_FN(24, 32)
+  MAKE_SAD_FN(24, 24)
+  MAKE_SAD_FN(24, 12)
+  MAKE_SAD_FN(24, 6)
+  MAKE_SAD_FN(16, 64)
+  MAKE_SAD_FN(16, 32)
+  MAKE_SAD_FN(16, 16)
+  MAKE_SAD_FN(16, 12)
+  MAKE_SAD_FN(16, 8)
+  MAKE_SAD_FN(16, 4)
+  MAKE_SAD_FN(16, 2)
+  MAKE_SAD_FN(16, 1)
+  MAKE_SAD_FN(12, 48)
+  MAKE_SAD_FN(12, 24)
+  MAKE_SAD_FN(12, 16)
+  MAKE_SAD_FN(12, 12)
+  MAKE_SAD_FN(12, 6)
+  MAKE_SAD_FN(12, 3)
+  MAKE_SAD_FN(8, 32)
+  MAKE_SAD_FN(8, 16)
+  MAKE_SAD_FN(8, 8)
+  MAKE_SAD_FN(8, 4)
+  MAKE_SAD_FN(8, 2)
+  MAKE_SAD_FN(8, 1)
+  MAKE_SAD_FN(6, 24)
+  MAKE_SAD_FN(6, 12)
+  MAKE_SAD_FN(6, 6)
+  MAKE_SAD_FN(6, 3)
+  MAKE_SAD_FN(4, 8)
+  MAKE_SAD_FN(4, 4)
+  MAKE_SAD_FN(4, 2)
+  MAKE_SAD_FN(4, 1)
+  MAKE_SAD_FN(3, 6)
+  MAKE_SAD_FN(3, 3)
+  MAKE_SAD_FN(2, 4)
+  MAKE_SAD_FN(2, 2)
+  MAKE_SAD_FN(2, 1)
 #undef MAKE_SAD_FN
 
-// PF SAD 10 SIMD intrinsic functions
-// only for >=8 bytes widths
-// really this is SSSE3, we make it use from SSE4.1 (until I make an USE_SSSE3 flag)
+  // PF SAD 10 SIMD intrinsic functions
+  // only for >=8 bytes widths
+  // really this is SSSE3, we make it use from SSE4.1 (until I make an USE_SSSE3 flag)
 #define MAKE_SAD_FN(x, y) \
 func_sad[make_tuple(x, y, 10, USE_SSE41)] = Sad10_ssse3_##x##xN<y>;
-MAKE_SAD_FN(24, 48)
-MAKE_SAD_FN(24, 32)
-MAKE_SAD_FN(24, 24)
-MAKE_SAD_FN(24, 12)
-MAKE_SAD_FN(24, 6)
-MAKE_SAD_FN(16, 64)
-MAKE_SAD_FN(16, 32)
-MAKE_SAD_FN(16, 16)
-MAKE_SAD_FN(16, 12)
-MAKE_SAD_FN(16, 8)
-MAKE_SAD_FN(16, 4)
-MAKE_SAD_FN(16, 2)
-MAKE_SAD_FN(16, 1)
-MAKE_SAD_FN(12, 48)
-MAKE_SAD_FN(12, 24)
-MAKE_SAD_FN(12, 16)
-MAKE_SAD_FN(12, 12)
-MAKE_SAD_FN(12, 6)
-MAKE_SAD_FN(12, 3)
-MAKE_SAD_FN(8, 32)
-MAKE_SAD_FN(8, 16)
-MAKE_SAD_FN(8, 8)
-MAKE_SAD_FN(8, 4)
-MAKE_SAD_FN(8, 2)
-MAKE_SAD_FN(8, 1)
-MAKE_SAD_FN(6, 24)
-MAKE_SAD_FN(6, 12)
-MAKE_SAD_FN(6, 6)
-MAKE_SAD_FN(6, 3)
-MAKE_SAD_FN(4, 8)
-MAKE_SAD_FN(4, 4)
-MAKE_SAD_FN(4, 2)
-MAKE_SAD_FN(4, 1)
+  MAKE_SAD_FN(24, 48)
+  MAKE_SAD_FN(24, 32)
+  MAKE_SAD_FN(24, 24)
+  MAKE_SAD_FN(24, 12)
+  MAKE_SAD_FN(24, 6)
+  MAKE_SAD_FN(16, 64)
+  MAKE_SAD_FN(16, 32)
+  MAKE_SAD_FN(16, 16)
+  MAKE_SAD_FN(16, 12)
+  MAKE_SAD_FN(16, 8)
+  MAKE_SAD_FN(16, 4)
+  MAKE_SAD_FN(16, 2)
+  MAKE_SAD_FN(16, 1)
+  MAKE_SAD_FN(12, 48)
+  MAKE_SAD_FN(12, 24)
+  MAKE_SAD_FN(12, 16)
+  MAKE_SAD_FN(12, 12)
+  MAKE_SAD_FN(12, 6)
+  MAKE_SAD_FN(12, 3)
+  MAKE_SAD_FN(8, 32)
+  MAKE_SAD_FN(8, 16)
+  MAKE_SAD_FN(8, 8)
+  MAKE_SAD_FN(8, 4)
+  MAKE_SAD_FN(8, 2)
+  MAKE_SAD_FN(8, 1)
+  MAKE_SAD_FN(6, 24)
+  MAKE_SAD_FN(6, 12)
+  MAKE_SAD_FN(6, 6)
+  MAKE_SAD_FN(6, 3)
+  MAKE_SAD_FN(4, 8)
+  MAKE_SAD_FN(4, 4)
+  MAKE_SAD_FN(4, 2)
+  MAKE_SAD_FN(4, 1)
 #undef MAKE_SAD_FN
 
-// PF SAD 16 SIMD intrinsic functions
-// only for >=8 bytes widths
+  // PF SAD 16 SIMD intrinsic functions
+  // only for >=8 bytes widths
 #ifdef USE_SAD_ASM
-// define external asm routines for 8 bit later
+  // define external asm routines for 8 bit later
 #define MAKE_SAD_FN(x, y) \
 func_sad[make_tuple(x, y, 16, USE_SSE2)] = Sad16_sse2_##x##xN<y>;
 #else
-// no external asm for 8 bit, sse2 implemented as intrinsics
+  // no external asm for 8 bit, sse2 implemented as intrinsics
 #define MAKE_SAD_FN(x, y) \
 func_sad[make_tuple(x, y, 16, USE_SSE2)] = Sad16_sse2_##x##xN<y>;\
 func_sad[make_tuple(x, y, 8, USE_SSE2)] = Sad_sse2<x,y>;
 #endif
 
-      MAKE_SAD_FN(64, 64)
-      MAKE_SAD_FN(64, 48)
-      MAKE_SAD_FN(64, 32)
-      MAKE_SAD_FN(64, 16)
-      MAKE_SAD_FN(48, 64)
-      MAKE_SAD_FN(48, 48)
-      MAKE_SAD_FN(48, 24)
-      MAKE_SAD_FN(48, 12)
-      MAKE_SAD_FN(32, 64)
-      MAKE_SAD_FN(32, 32)
-      MAKE_SAD_FN(32, 24)
-      MAKE_SAD_FN(32, 16)
-      MAKE_SAD_FN(32, 8)
-      MAKE_SAD_FN(24, 48)
-      MAKE_SAD_FN(24, 32)
-      MAKE_SAD_FN(24, 24)
-      MAKE_SAD_FN(24, 12)
-      MAKE_SAD_FN(24, 6)
-      MAKE_SAD_FN(16, 64)
-      MAKE_SAD_FN(16, 32)
-      MAKE_SAD_FN(16, 16)
-      MAKE_SAD_FN(16, 12)
-      MAKE_SAD_FN(16, 8)
-      MAKE_SAD_FN(16, 4)
-      MAKE_SAD_FN(16, 2)
-      MAKE_SAD_FN(16, 1)
-      MAKE_SAD_FN(12, 48)
-      MAKE_SAD_FN(12, 24)
-      MAKE_SAD_FN(12, 16)
-      MAKE_SAD_FN(12, 12)
-      MAKE_SAD_FN(12, 6)
-      MAKE_SAD_FN(12, 3)
-      MAKE_SAD_FN(8, 32)
-      MAKE_SAD_FN(8, 16)
-      MAKE_SAD_FN(8, 8)
-      MAKE_SAD_FN(8, 4)
-      MAKE_SAD_FN(8, 2)
-      MAKE_SAD_FN(8, 1)
-      MAKE_SAD_FN(6, 24)
-      MAKE_SAD_FN(6, 12)
-      MAKE_SAD_FN(6, 6)
-      MAKE_SAD_FN(6, 3)
-      MAKE_SAD_FN(4, 8)
-      MAKE_SAD_FN(4, 4)
-      MAKE_SAD_FN(4, 2)
-      MAKE_SAD_FN(4, 1)
-      //MAKE_SAD_FN(2, 4)  // 2 pixels 4 bytes not supported with SSE2
-      //MAKE_SAD_FN(2, 2)
-      //MAKE_SAD_FN(2, 1)
+        MAKE_SAD_FN(64, 64)
+        MAKE_SAD_FN(64, 48)
+        MAKE_SAD_FN(64, 32)
+        MAKE_SAD_FN(64, 16)
+        MAKE_SAD_FN(48, 64)
+        MAKE_SAD_FN(48, 48)
+        MAKE_SAD_FN(48, 24)
+        MAKE_SAD_FN(48, 12)
+        MAKE_SAD_FN(32, 64)
+        MAKE_SAD_FN(32, 32)
+        MAKE_SAD_FN(32, 24)
+        MAKE_SAD_FN(32, 16)
+        MAKE_SAD_FN(32, 8)
+        MAKE_SAD_FN(24, 48)
+        MAKE_SAD_FN(24, 32)
+        MAKE_SAD_FN(24, 24)
+        MAKE_SAD_FN(24, 12)
+        MAKE_SAD_FN(24, 6)
+        MAKE_SAD_FN(16, 64)
+        MAKE_SAD_FN(16, 32)
+        MAKE_SAD_FN(16, 16)
+        MAKE_SAD_FN(16, 12)
+        MAKE_SAD_FN(16, 8)
+        MAKE_SAD_FN(16, 4)
+        MAKE_SAD_FN(16, 2)
+        MAKE_SAD_FN(16, 1)
+        MAKE_SAD_FN(12, 48)
+        MAKE_SAD_FN(12, 24)
+        MAKE_SAD_FN(12, 16)
+        MAKE_SAD_FN(12, 12)
+        MAKE_SAD_FN(12, 6)
+        MAKE_SAD_FN(12, 3)
+        MAKE_SAD_FN(8, 32)
+        MAKE_SAD_FN(8, 16)
+        MAKE_SAD_FN(8, 8)
+        MAKE_SAD_FN(8, 4)
+        MAKE_SAD_FN(8, 2)
+        MAKE_SAD_FN(8, 1)
+        MAKE_SAD_FN(6, 24)
+        MAKE_SAD_FN(6, 12)
+        MAKE_SAD_FN(6, 6)
+        MAKE_SAD_FN(6, 3)
+        MAKE_SAD_FN(4, 8)
+        MAKE_SAD_FN(4, 4)
+        MAKE_SAD_FN(4, 2)
+        MAKE_SAD_FN(4, 1)
+        //MAKE_SAD_FN(2, 4)  // 2 pixels 4 bytes not supported with SSE2
+        //MAKE_SAD_FN(2, 2)
+        //MAKE_SAD_FN(2, 1)
 #undef MAKE_SAD_FN
 
 #ifdef USE_SAD_ASM
-    // 8 bit SAD function from x265 asm
-
-    // Block Size: 64*x
-    // Supported: 64x64, 64x48, 64x32, 64x16
-    // AVX2:
-    func_sad[make_tuple(64, 64, 8, USE_AVX2)] = x264_pixel_sad_64x64_avx2;
-    func_sad[make_tuple(64, 48, 8, USE_AVX2)] = x264_pixel_sad_64x48_avx2;
-    func_sad[make_tuple(64, 32, 8, USE_AVX2)] = x264_pixel_sad_64x32_avx2;
-    func_sad[make_tuple(64, 16, 8, USE_AVX2)] = x264_pixel_sad_64x16_avx2;
-    // SSE2:
-    func_sad[make_tuple(64, 64, 8, USE_SSE2)] = x264_pixel_sad_64x64_sse2;
-    func_sad[make_tuple(64, 48, 8, USE_SSE2)] = x264_pixel_sad_64x48_sse2;
-    func_sad[make_tuple(64, 32, 8, USE_SSE2)] = x264_pixel_sad_64x32_sse2;
-    func_sad[make_tuple(64, 16, 8, USE_SSE2)] = x264_pixel_sad_64x16_sse2;
-
-    // Block Size: 48*x
-    // Supported: 48x64, 48x48, 48x24, 48x12
-    // AVX2
-    func_sad[make_tuple(48, 64, 8, USE_AVX2)] = x264_pixel_sad_48x64_avx2;
-    func_sad[make_tuple(48, 48, 8, USE_AVX2)] = x264_pixel_sad_48x48_avx2;
-    func_sad[make_tuple(48, 24, 8, USE_AVX2)] = x264_pixel_sad_48x24_avx2;
-    func_sad[make_tuple(48, 12, 8, USE_AVX2)] = x264_pixel_sad_48x12_avx2;
-    // SSE2
-    func_sad[make_tuple(48, 64, 8, USE_SSE2)] = x264_pixel_sad_48x64_sse2;
-    func_sad[make_tuple(48, 48, 8, USE_SSE2)] = x264_pixel_sad_48x48_sse2;
-    func_sad[make_tuple(48, 24, 8, USE_SSE2)] = x264_pixel_sad_48x24_sse2;
-    func_sad[make_tuple(48, 12, 8, USE_SSE2)] = x264_pixel_sad_48x12_sse2;
-
-    // Block Size: 32*x
-    // Supported: 32x64, 32x32, 32x24, 32x16, 32x8
-    // AVX2
-    func_sad[make_tuple(32, 64, 8, USE_AVX2)] = x264_pixel_sad_32x64_avx2;
-    func_sad[make_tuple(32, 32, 8, USE_AVX2)] = x264_pixel_sad_32x32_avx2;
-    func_sad[make_tuple(32, 24, 8, USE_AVX2)] = x264_pixel_sad_32x24_avx2;
-    func_sad[make_tuple(32, 16, 8, USE_AVX2)] = x264_pixel_sad_32x16_avx2;
-    func_sad[make_tuple(32, 8, 8, USE_AVX2)] = x264_pixel_sad_32x8_avx2;
-    // SSE3
-    func_sad[make_tuple(32, 64, 8, USE_SSE41)] = x264_pixel_sad_32x64_sse3;
-    func_sad[make_tuple(32, 32, 8, USE_SSE41)] = x264_pixel_sad_32x32_sse3;
-    func_sad[make_tuple(32, 24, 8, USE_SSE41)] = x264_pixel_sad_32x24_sse3;
-    func_sad[make_tuple(32, 16, 8, USE_SSE41)] = x264_pixel_sad_32x16_sse3;
-    func_sad[make_tuple(32, 8, 8, USE_SSE41)] = x264_pixel_sad_32x8_sse3;
-    // SSE2
-    func_sad[make_tuple(32, 64, 8, USE_SSE2)] = x264_pixel_sad_32x64_sse2;
-    func_sad[make_tuple(32, 32, 8, USE_SSE2)] = x264_pixel_sad_32x32_sse2;
-    func_sad[make_tuple(32, 24, 8, USE_SSE2)] = x264_pixel_sad_32x24_sse2;
-    func_sad[make_tuple(32, 16, 8, USE_SSE2)] = x264_pixel_sad_32x16_sse2;
-    func_sad[make_tuple(32, 8 , 8, USE_SSE2)] = x264_pixel_sad_32x8_sse2;
-
-    // Block Size: 24*x
-    // Supported: 24x48, 24x32, 24x12, 24x6
-    func_sad[make_tuple(24, 48, 8, USE_SSE2)] = x264_pixel_sad_24x48_sse2;
-    func_sad[make_tuple(24, 32, 8, USE_SSE2)] = x264_pixel_sad_24x32_sse2;
-    func_sad[make_tuple(24, 24, 8, USE_SSE2)] = x264_pixel_sad_24x24_sse2;
-    func_sad[make_tuple(24, 12, 8, USE_SSE2)] = x264_pixel_sad_24x12_sse2;
-    func_sad[make_tuple(24,  6, 8, USE_SSE2)] = x264_pixel_sad_24x6_sse2;
-
-    // Supported: 16x64, 16x32, 16x16, 16x12, 16x8, 16x4
-    // SSE3
-    func_sad[make_tuple(16, 64, 8, USE_SSE41)] = x264_pixel_sad_16x64_sse3;
-    func_sad[make_tuple(16, 32, 8, USE_SSE41)] = x264_pixel_sad_16x32_sse3;
-    func_sad[make_tuple(16, 16, 8, USE_SSE41)] = x264_pixel_sad_16x16_sse3;
-    func_sad[make_tuple(16, 12, 8, USE_SSE41)] = x264_pixel_sad_16x12_sse3;
-    func_sad[make_tuple(16, 8, 8, USE_SSE41)] = x264_pixel_sad_16x8_sse3;
-    func_sad[make_tuple(16, 4, 8, USE_SSE41)] = x264_pixel_sad_16x4_sse3;
-    // SSE2
-    func_sad[make_tuple(16, 64, 8, USE_SSE2)] = x264_pixel_sad_16x64_sse2;
-    func_sad[make_tuple(16, 32, 8, USE_SSE2)] = x264_pixel_sad_16x32_sse2;
-    func_sad[make_tuple(16, 16, 8, USE_SSE2)] = x264_pixel_sad_16x16_sse2;
-    func_sad[make_tuple(16, 12, 8, USE_SSE2)] = x264_pixel_sad_16x12_sse2;
-    func_sad[make_tuple(16, 8 , 8, USE_SSE2)] = x264_pixel_sad_16x8_sse2;
-    func_sad[make_tuple(16, 4, 8, USE_SSE2)] = x264_pixel_sad_16x4_sse2;//mmx2;
-    //func_sad[make_tuple(16, 2, 8, USE_SSE2)] = Sad16x2_iSSE;
-
-    // Block Size: 12*x
-    // Supported: 12x48, 12x24, 12x16, 12x6, 12x3
-    func_sad[make_tuple(12, 48, 8, USE_SSE2)] = x264_pixel_sad_12x48_sse2;
-    func_sad[make_tuple(12, 24, 8, USE_SSE2)] = x264_pixel_sad_12x24_sse2;
-    func_sad[make_tuple(12, 16, 8, USE_SSE2)] = x264_pixel_sad_12x16_sse2;
-    func_sad[make_tuple(12, 12, 8, USE_SSE2)] = x264_pixel_sad_12x12_sse2;
-    func_sad[make_tuple(12,  6, 8, USE_SSE2)] = x264_pixel_sad_12x6_sse2;
-    func_sad[make_tuple(12,  3, 8, USE_SSE2)] = x264_pixel_sad_12x3_sse2;
-
-    // Block Size: 8*x
-    // Supported: 8x32, 8x16, 8x8, 8x4, (8x2, 8x1)
-    func_sad[make_tuple(8, 32, 8, USE_SSE2)] = x264_pixel_sad_8x32_sse2;
-    func_sad[make_tuple(8, 16, 8, USE_SSE2)] = x264_pixel_sad_8x16_sse2;
-    func_sad[make_tuple(8,  8, 8, USE_SSE2)] = x264_pixel_sad_8x8_sse2; // 2.7.37 instead of mmx2;
-    //func_sad[make_tuple(8, 8, 8, USE_SSE2)] = x264_pixel_sad_8x8_mmx2;
-    func_sad[make_tuple(8,  4, 8, USE_SSE2)] = x264_pixel_sad_8x4_sse2; // 2.7.37 instead of mmx2;
-    //func_sad[make_tuple(8, 4, 8, USE_SSE2)] = x264_pixel_sad_8x4_mmx2;
-
-    //func_sad[make_tuple(8 , 2 , 8, USE_SSE2)] = Sad8x2_iSSE;
-    //func_sad[make_tuple(8 , 1 , 8, USE_SSE2)] = Sad8x1_iSSE;
-
-    func_sad[make_tuple(6, 24, 8, USE_SSE2)] = x264_pixel_sad_6x24_sse2;
-    func_sad[make_tuple(6, 12, 8, USE_SSE2)] = x264_pixel_sad_6x12_sse2;
-    func_sad[make_tuple(6, 6, 8, USE_SSE2)] = x264_pixel_sad_6x6_sse2;
-
-    // Block Size: 4*x
-    // Supported: 4x8, 4x4, 4x2
-    func_sad[make_tuple(4 , 8 , 8, USE_SSE2)] = x264_pixel_sad_4x8_sse2; // 2.7.37 instead of mmx2;
-    //func_sad[make_tuple(4, 8, 8, USE_SSE2)] = x264_pixel_sad_4x8_mmx2;
-    func_sad[make_tuple(4 , 4 , 8, USE_SSE2)] = x264_pixel_sad_4x4_sse2; // 2.7.37 instead of mmx2;
-    //func_sad[make_tuple(4, 4, 8, USE_SSE2)] = x264_pixel_sad_4x4_mmx2;
-    //func_sad[make_tuple(4 , 2 , 8, USE_SSE2)] = Sad4x2_iSSE;
-    // Block Size: 2*x
-    // Supported: 2x4, 2x2
-    //func_sad[make_tuple(2 , 4 , 8, USE_SSE2)] = Sad2x4_iSSE;
-    //func_sad[make_tuple(2, 2, 8, USE_SSE2)] = Sad2x2_iSSE;
+      // 8 bit SAD function from x265 asm
+
+      // Block Size: 64*x
+      // Supported: 64x64, 64x48, 64x32, 64x16
+      // AVX2:
+      func_sad[make_tuple(64, 64, 8, USE_AVX2)] = x264_pixel_sad_64x64_avx2;
+      func_sad[make_tuple(64, 48, 8, USE_AVX2)] = x264_pixel_sad_64x48_avx2;
+      func_sad[make_tuple(64, 32, 8, USE_AVX2)] = x264_pixel_sad_64x32_avx2;
+      func_sad[make_tuple(64, 16, 8, USE_AVX2)] = x264_pixel_sad_64x16_avx2;
+      // SSE2:
+      func_sad[make_tuple(64, 64, 8, USE_SSE2)] = x264_pixel_sad_64x64_sse2;
+      func_sad[make_tuple(64, 48, 8, USE_SSE2)] = x264_pixel_sad_64x48_sse2;
+      func_sad[make_tuple(64, 32, 8, USE_SSE2)] = x264_pixel_sad_64x32_sse2;
+      func_sad[make_tuple(64, 16, 8, USE_SSE2)] = x264_pixel_sad_64x16_sse2;
+
+      // Block Size: 48*x
+      // Supported: 48x64, 48x48, 48x24, 48x12
+      // AVX2
+      func_sad[make_tuple(48, 64, 8, USE_AVX2)] = x264_pixel_sad_48x64_avx2;
+      func_sad[make_tuple(48, 48, 8, USE_AVX2)] = x264_pixel_sad_48x48_avx2;
+      func_sad[make_tuple(48, 24, 8, USE_AVX2)] = x264_pixel_sad_48x24_avx2;
+      func_sad[make_tuple(48, 12, 8, USE_AVX2)] = x264_pixel_sad_48x12_avx2;
+      // SSE2
+      func_sad[make_tuple(48, 64, 8, USE_SSE2)] = x264_pixel_sad_48x64_sse2;
+      func_sad[make_tuple(48, 48, 8, USE_SSE2)] = x264_pixel_sad_48x48_sse2;
+      func_sad[make_tuple(48, 24, 8, USE_SSE2)] = x264_pixel_sad_48x24_sse2;
+      func_sad[make_tuple(48, 12, 8, USE_SSE2)] = x264_pixel_sad_48x12_sse2;
+
+      // Block Size: 32*x
+      // Supported: 32x64, 32x32, 32x24, 32x16, 32x8
+      // AVX2
+      func_sad[make_tuple(32, 64, 8, USE_AVX2)] = x264_pixel_sad_32x64_avx2;
+      func_sad[make_tuple(32, 32, 8, USE_AVX2)] = x264_pixel_sad_32x32_avx2;
+      func_sad[make_tuple(32, 24, 8, USE_AVX2)] = x264_pixel_sad_32x24_avx2;
+      func_sad[make_tuple(32, 16, 8, USE_AVX2)] = x264_pixel_sad_32x16_avx2;
+      func_sad[make_tuple(32, 8, 8, USE_AVX2)] = x264_pixel_sad_32x8_avx2;
+      // SSE3
+      func_sad[make_tuple(32, 64, 8, USE_SSE41)] = x264_pixel_sad_32x64_sse3;
+      func_sad[make_tuple(32, 32, 8, USE_SSE41)] = x264_pixel_sad_32x32_sse3;
+      func_sad[make_tuple(32, 24, 8, USE_SSE41)] = x264_pixel_sad_32x24_sse3;
+      func_sad[make_tuple(32, 16, 8, USE_SSE41)] = x264_pixel_sad_32x16_sse3;
+      func_sad[make_tuple(32, 8, 8, USE_SSE41)] = x264_pixel_sad_32x8_sse3;
+      // SSE2
+      func_sad[make_tuple(32, 64, 8, USE_SSE2)] = x264_pixel_sad_32x64_sse2;
+      func_sad[make_tuple(32, 32, 8, USE_SSE2)] = x264_pixel_sad_32x32_sse2;
+      func_sad[make_tuple(32, 24, 8, USE_SSE2)] = x264_pixel_sad_32x24_sse2;
+      func_sad[make_tuple(32, 16, 8, USE_SSE2)] = x264_pixel_sad_32x16_sse2;
+      func_sad[make_tuple(32, 8 , 8, USE_SSE2)] = x264_pixel_sad_32x8_sse2;
+
+      // Block Size: 24*x
+      // Supported: 24x48, 24x32, 24x12, 24x6
+      func_sad[make_tuple(24, 48, 8, USE_SSE2)] = x264_pixel_sad_24x48_sse2;
+      func_sad[make_tuple(24, 32, 8, USE_SSE2)] = x264_pixel_sad_24x32_sse2;
+      func_sad[make_tuple(24, 24, 8, USE_SSE2)] = x264_pixel_sad_24x24_sse2;
+      func_sad[make_tuple(24, 12, 8, USE_SSE2)] = x264_pixel_sad_24x12_sse2;
+      func_sad[make_tuple(24,  6, 8, USE_SSE2)] = x264_pixel_sad_24x6_sse2;
+
+      // Supported: 16x64, 16x32, 16x16, 16x12, 16x8, 16x4
+      // SSE3
+      func_sad[make_tuple(16, 64, 8, USE_SSE41)] = x264_pixel_sad_16x64_sse3;
+      func_sad[make_tuple(16, 32, 8, USE_SSE41)] = x264_pixel_sad_16x32_sse3;
+      func_sad[make_tuple(16, 16, 8, USE_SSE41)] = x264_pixel_sad_16x16_sse3;
+      func_sad[make_tuple(16, 12, 8, USE_SSE41)] = x264_pixel_sad_16x12_sse3;
+      func_sad[make_tuple(16, 8, 8, USE_SSE41)] = x264_pixel_sad_16x8_sse3;
+      func_sad[make_tuple(16, 4, 8, USE_SSE41)] = x264_pixel_sad_16x4_sse3;
+      // SSE2
+      func_sad[make_tuple(16, 64, 8, USE_SSE2)] = x264_pixel_sad_16x64_sse2;
+      func_sad[make_tuple(16, 32, 8, USE_SSE2)] = x264_pixel_sad_16x32_sse2;
+      func_sad[make_tuple(16, 16, 8, USE_SSE2)] = x264_pixel_sad_16x16_sse2;
+      func_sad[make_tuple(16, 12, 8, USE_SSE2)] = x264_pixel_sad_16x12_sse2;
+      func_sad[make_tuple(16, 8 , 8, USE_SSE2)] = x264_pixel_sad_16x8_sse2;
+      func_sad[make_tuple(16, 4, 8, USE_SSE2)] = x264_pixel_sad_16x4_sse2;//mmx2;
+      //func_sad[make_tuple(16, 2, 8, USE_SSE2)] = Sad16x2_iSSE;
+
+      // Block Size: 12*x
+      // Supported: 12x48, 12x24, 12x16, 12x6, 12x3
+      func_sad[make_tuple(12, 48, 8, USE_SSE2)] = x264_pixel_sad_12x48_sse2;
+      func_sad[make_tuple(12, 24, 8, USE_SSE2)] = x264_pixel_sad_12x24_sse2;
+      func_sad[make_tuple(12, 16, 8, USE_SSE2)] = x264_pixel_sad_12x16_sse2;
+      func_sad[make_tuple(12, 12, 8, USE_SSE2)] = x264_pixel_sad_12x12_sse2;
+      func_sad[make_tuple(12,  6, 8, USE_SSE2)] = x264_pixel_sad_12x6_sse2;
+      func_sad[make_tuple(12,  3, 8, USE_SSE2)] = x264_pixel_sad_12x3_sse2;
+
+      // Block Size: 8*x
+      // Supported: 8x32, 8x16, 8x8, 8x4, (8x2, 8x1)
+      func_sad[make_tuple(8, 32, 8, USE_SSE2)] = x264_pixel_sad_8x32_sse2;
+      func_sad[make_tuple(8, 16, 8, USE_SSE2)] = x264_pixel_sad_8x16_sse2;
+      func_sad[make_tuple(8,  8, 8, USE_SSE2)] = x264_pixel_sad_8x8_sse2; // 2.7.37 instead of mmx2;
+      //func_sad[make_tuple(8, 8, 8, USE_SSE2)] = x264_pixel_sad_8x8_mmx2;
+      func_sad[make_tuple(8,  4, 8, USE_SSE2)] = x264_pixel_sad_8x4_sse2; // 2.7.37 instead of mmx2;
+      //func_sad[make_tuple(8, 4, 8, USE_SSE2)] = x264_pixel_sad_8x4_mmx2;
+
+      //func_sad[make_tuple(8 , 2 , 8, USE_SSE2)] = Sad8x2_iSSE;
+      //func_sad[make_tuple(8 , 1 , 8, USE_SSE2)] = Sad8x1_iSSE;
+
+      func_sad[make_tuple(6, 24, 8, USE_SSE2)] = x264_pixel_sad_6x24_sse2;
+      func_sad[make_tuple(6, 12, 8, USE_SSE2)] = x264_pixel_sad_6x12_sse2;
+      func_sad[make_tuple(6, 6, 8, USE_SSE2)] = x264_pixel_sad_6x6_sse2;
+
+      // Block Size: 4*x
+      // Supported: 4x8, 4x4, 4x2
+      func_sad[make_tuple(4 , 8 , 8, USE_SSE2)] = x264_pixel_sad_4x8_sse2; // 2.7.37 instead of mmx2;
+      //func_sad[make_tuple(4, 8, 8, USE_SSE2)] = x264_pixel_sad_4x8_mmx2;
+      func_sad[make_tuple(4 , 4 , 8, USE_SSE2)] = x264_pixel_sad_4x4_sse2; // 2.7.37 instead of mmx2;
+      //func_sad[make_tuple(4, 4, 8, USE_SSE2)] = x264_pixel_sad_4x4_mmx2;
+      //func_sad[make_tuple(4 , 2 , 8, USE_SSE2)] = Sad4x2_iSSE;
+      // Block Size: 2*x
+      // Supported: 2x4, 2x2
+      //func_sad[make_tuple(2 , 4 , 8, USE_SSE2)] = Sad2x4_iSSE;
+      //func_sad[make_tuple(2, 2, 8, USE_SSE2)] = Sad2x2_iSSE;
 #endif // USE_SAD_ASM
 
-    //---------------- AVX2
-    // PF SAD 16 SIMD intrinsic functions
-    // only for >=16 bytes widths (2x16 byte still OK *but not optimal), width 24 is not available)
-    // templates in SADFunctions_avx2
+      //---------------- AVX2
+      // PF SAD 16 SIMD intrinsic functions
+      // only for >=16 bytes widths (2x16 byte still OK *but not optimal), width 24 is not available)
+      // templates in SADFunctions_avx2
 #define MAKE_SAD_FN(x, y) func_sad[make_tuple(x, y, 16, USE_AVX2)] = Sad16_avx2<x, y,uint16_t>; \
       func_sad[make_tuple(x, y, 10, USE_AVX2)] = Sad10_avx2<x, y>;
-      MAKE_SAD_FN(64, 64)
-      MAKE_SAD_FN(64, 48)
-      MAKE_SAD_FN(64, 32)
-      MAKE_SAD_FN(64, 16)
-      MAKE_SAD_FN(48, 64)
-      MAKE_SAD_FN(48, 48)
-      MAKE_SAD_FN(48, 24)
-      MAKE_SAD_FN(48, 12)
-      MAKE_SAD_FN(32, 64)
-      MAKE_SAD_FN(32, 32)
-      MAKE_SAD_FN(32, 24)
-      MAKE_SAD_FN(32, 16)
-      MAKE_SAD_FN(32, 8)
-      // MAKE_SAD_FN(24, 32) // 24*2 is not mod 32 bytes, not supported here
+        MAKE_SAD_FN(64, 64)
+        MAKE_SAD_FN(64, 48)
+        MAKE_SAD_FN(64, 32)
+        MAKE_SAD_FN(64, 16)
+        MAKE_SAD_FN(48, 64)
+        MAKE_SAD_FN(48, 48)
+        MAKE_SAD_FN(48, 24)
+        MAKE_SAD_FN(48, 12)
+        MAKE_SAD_FN(32, 64)
+        MAKE_SAD_FN(32, 32)
+        MAKE_SAD_FN(32, 24)
+        MAKE_SAD_FN(32, 16)
+        MAKE_SAD_FN(32, 8)
+        // MAKE_SAD_FN(24, 32) // 24*2 is not mod 32 bytes, not supported here
       
-      MAKE_SAD_FN(16, 64)
-      MAKE_SAD_FN(16, 32)
-      MAKE_SAD_FN(16, 16)
-      MAKE_SAD_FN(16, 12)
-      MAKE_SAD_FN(16, 8)
-      MAKE_SAD_FN(16, 4)
-      MAKE_SAD_FN(16, 2)
-      MAKE_SAD_FN(16, 1) // 32 bytes with height=1 is OK for AVX2
+        MAKE_SAD_FN(16, 64)
+        MAKE_SAD_FN(16, 32)
+        MAKE_SAD_FN(16, 16)
+        MAKE_SAD_FN(16, 12)
+        MAKE_SAD_FN(16, 8)
+        MAKE_SAD_FN(16, 4)
+        MAKE_SAD_FN(16, 2)
+        MAKE_SAD_FN(16, 1) // 32 bytes with height=1 is OK for AVX2
       
-      //MAKE_SAD_FN(12, 16) 12*2 not mod 32 bytes
-
-      // 8 pixel wide (16bytes): still not optimal
-      //MAKE_SAD_FN(8, 32)
-      //MAKE_SAD_FN(8, 16)
-      //MAKE_SAD_FN(8, 8)
-      //MAKE_SAD_FN(8, 4)
-      //MAKE_SAD_FN(8, 2)
-      // MAKE_SAD_FN(8, 1) // 16 bytes with height=1 not supported for AVX2
-      //MAKE_SAD_FN(4, 8)
-      //MAKE_SAD_FN(4, 4)
-      //MAKE_SAD_FN(4, 2)
-      //MAKE_SAD_FN(4, 1)  // 8 bytes with height=1 not supported for SSE2
-      //MAKE_SAD_FN(2, 4)  // 2 pixels 4 bytes not supported with SSE2
-      //MAKE_SAD_FN(2, 2)
-      //MAKE_SAD_FN(2, 1)
+        //MAKE_SAD_FN(12, 16) 12*2 not mod 32 bytes
+
+        // 8 pixel wide (16bytes): still not optimal
+        //MAKE_SAD_FN(8, 32)
+        //MAKE_SAD_FN(8, 16)
+        //MAKE_SAD_FN(8, 8)
+        //MAKE_SAD_FN(8, 4)
+        //MAKE_SAD_FN(8, 2)
+        // MAKE_SAD_FN(8, 1) // 16 bytes with height=1 not supported for AVX2
+        //MAKE_SAD_FN(4, 8)
+        //MAKE_SAD_FN(4, 4)
+        //MAKE_SAD_FN(4, 2)
+        //MAKE_SAD_FN(4, 1)  // 8 bytes with height=1 not supported for SSE2
+        //MAKE_SAD_FN(2, 4)  // 2 pixels 4 bytes not supported with SSE2
+        //MAKE_SAD_FN(2, 2)
+        //MAKE_SAD_FN(2, 1)
 #undef MAKE_SAD_FN
+      return func_sad;
+    }();
 
 
     SADFunction *result = nullptr;
@@ -1054,7 +1048,7 @@ func_sad[make_tuple(x, y, 8, USE_SSE2)] = Sad_sse2<x,y>;
     while (result == nullptr) {
       arch_t current_arch_try = archlist[index++];
       if (current_arch_try > arch) continue;
-      result = func_sad[make_tuple(BlockX, BlockY, bits_per_pixel, current_arch_try)];
+      result = find_function(func_sad_table, make_tuple(BlockX, BlockY, bits_per_pixel, current_arch_try));
 
       if (result == nullptr && current_arch_try == NO_SIMD) {
         break;
@@ -1066,10 +1060,10 @@ func_sad[make_tuple(x, y, 8, USE_SSE2)] = Sad_sse2<x,y>;
       arch_t current_arch_try = archlist[index++];
       if (current_arch_try > arch) continue;
       if (result == nullptr && current_arch_try == NO_SIMD) {
-        result = func_sad[make_tuple(BlockX, BlockY, bits_per_pixel_2, NO_SIMD)];
+        result = find_function(func_sad_table, make_tuple(BlockX, BlockY, bits_per_pixel_2, NO_SIMD));
       }
       else {
-        result = func_sad[make_tuple(BlockX, BlockY, bits_per_pixel_2, current_arch_try)];
+        result = find_function(func_sad_table, make_tuple(BlockX, BlockY, bits_per_pixel_2, current_arch_try));
       }
 
       if (result == nullptr && current_arch_try == NO_SIMD) {
@@ -1240,144 +1234,145 @@ SADFunction* get_satd_function(int BlockX, int BlockY, int pixelsize, arch_t arc
 {
     // 8 bit only (pixelsize==1)
     // BlkSizeX, BlkSizeY, pixelsize, arch_t
-    std::map<std::tuple<int, int, int, arch_t>, SADFunction*> func_satd;
     using std::make_tuple;
+    static const std::map<std::tuple<int, int, int, arch_t>, SADFunction*> func_satd_table = []() {
+      std::map<std::tuple<int, int, int, arch_t>, SADFunction*> func_satd;
 
-    //made C callable function prototypes in SadFunction.h
-    //some not implemented asm macros are in separate functions (e.g. 32x32 = 16x16 + 16x16 + 16x16 + 16x16) 
-    //x264_pixel_satd_##blksizex##x##blksizey##_sse2/sse4/ssse3/avx/avx2   in pixel-a.asm
+      //made C callable function prototypes in SadFunction.h
+      //some not implemented asm macros are in separate functions (e.g. 32x32 = 16x16 + 16x16 + 16x16 + 16x16) 
+      //x264_pixel_satd_##blksizex##x##blksizey##_sse2/sse4/ssse3/avx/avx2   in pixel-a.asm
 
 #ifdef USE_SATD_ASM
 #ifdef _M_X64
-    func_satd[make_tuple(64, 64, 1, USE_AVX2)] = x264_pixel_satd_64x64_avx2;
-    func_satd[make_tuple(64, 48, 1, USE_AVX2)] = x264_pixel_satd_64x48_avx2;
-    func_satd[make_tuple(64, 32, 1, USE_AVX2)] = x264_pixel_satd_64x32_avx2;
-    func_satd[make_tuple(64, 16, 1, USE_AVX2)] = x264_pixel_satd_64x16_avx2;
-    func_satd[make_tuple(48, 64, 1, USE_AVX2)] = x264_pixel_satd_48x64_avx2;
-    func_satd[make_tuple(48, 48, 1, USE_AVX2)] = x264_pixel_satd_48x48_avx2;
-    func_satd[make_tuple(48, 24, 1, USE_AVX2)] = x264_pixel_satd_48x24_avx2;
-    func_satd[make_tuple(48, 12, 1, USE_AVX2)] = x264_pixel_satd_48x12_avx2;
-    func_satd[make_tuple(32, 64, 1, USE_AVX2)] = x264_pixel_satd_32x64_avx2;
-    func_satd[make_tuple(32, 32, 1, USE_AVX2)] = x264_pixel_satd_32x32_avx2;
-    func_satd[make_tuple(32, 16, 1, USE_AVX2)] = x264_pixel_satd_32x16_avx2;
-    func_satd[make_tuple(32, 8, 1, USE_AVX2)] = x264_pixel_satd_32x8_avx2;
-
-    func_satd[make_tuple(16, 64, 1, USE_AVX2)] = x264_pixel_satd_16x64_avx2;
-    func_satd[make_tuple(16, 32, 1, USE_AVX2)] = x264_pixel_satd_16x32_avx2;
+      func_satd[make_tuple(64, 64, 1, USE_AVX2)] = x264_pixel_satd_64x64_avx2;
+      func_satd[make_tuple(64, 48, 1, USE_AVX2)] = x264_pixel_satd_64x48_avx2;
+      func_satd[make_tuple(64, 32, 1, USE_AVX2)] = x264_pixel_satd_64x32_avx2;
+      func_satd[make_tuple(64, 16, 1, USE_AVX2)] = x264_pixel_satd_64x16_avx2;
+      func_satd[make_tuple(48, 64, 1, USE_AVX2)] = x264_pixel_satd_48x64_avx2;
+      func_satd[make_tuple(48, 48, 1, USE_AVX2)] = x264_pixel_satd_48x48_avx2;
+      func_satd[make_tuple(48, 24, 1, USE_AVX2)] = x264_pixel_satd_48x24_avx2;
+      func_satd[make_tuple(48, 12, 1, USE_AVX2)] = x264_pixel_satd_48x12_avx2;
+      func_satd[make_tuple(32, 64, 1, USE_AVX2)] = x264_pixel_satd_32x64_avx2;
+      func_satd[make_tuple(32, 32, 1, USE_AVX2)] = x264_pixel_satd_32x32_avx2;
+      func_satd[make_tuple(32, 16, 1, USE_AVX2)] = x264_pixel_satd_32x16_avx2;
+      func_satd[make_tuple(32, 8, 1, USE_AVX2)] = x264_pixel_satd_32x8_avx2;
+
+      func_satd[make_tuple(16, 64, 1, USE_AVX2)] = x264_pixel_satd_16x64_avx2;
+      func_satd[make_tuple(16, 32, 1, USE_AVX2)] = x264_pixel_satd_16x32_avx2;
 #endif
-    func_satd[make_tuple(16, 16, 1, USE_AVX2)] = x264_pixel_satd_16x16_avx2;
-    func_satd[make_tuple(16, 8 , 1, USE_AVX2)] = x264_pixel_satd_16x8_avx2;
-    func_satd[make_tuple(8 , 16, 1, USE_AVX2)] = x264_pixel_satd_8x16_avx2;
-    func_satd[make_tuple(8 , 8 , 1, USE_AVX2)] = x264_pixel_satd_8x8_avx2;
-
-    func_satd[make_tuple(64, 64, 1, USE_AVX)] = x264_pixel_satd_64x64_avx;
-    func_satd[make_tuple(64, 48, 1, USE_AVX)] = x264_pixel_satd_64x48_avx;
-    func_satd[make_tuple(64, 32, 1, USE_AVX)] = x264_pixel_satd_64x32_avx;
-    func_satd[make_tuple(64, 16, 1, USE_AVX)] = x264_pixel_satd_64x16_avx;
-    func_satd[make_tuple(48, 64, 1, USE_AVX)] = x264_pixel_satd_48x64_avx;
-    func_satd[make_tuple(48, 48, 1, USE_AVX)] = x264_pixel_satd_48x48_avx;
-    func_satd[make_tuple(48, 24, 1, USE_AVX)] = x264_pixel_satd_48x24_avx;
-    func_satd[make_tuple(48, 12, 1, USE_AVX)] = x264_pixel_satd_48x12_avx;
-    func_satd[make_tuple(32, 64, 1, USE_AVX)] = x264_pixel_satd_32x64_avx;
-    func_satd[make_tuple(32, 32, 1, USE_AVX)] = x264_pixel_satd_32x32_avx;
-    func_satd[make_tuple(32, 24, 1, USE_AVX)] = x264_pixel_satd_32x24_avx;
-    func_satd[make_tuple(32, 16, 1, USE_AVX)] = x264_pixel_satd_32x16_avx;
-    func_satd[make_tuple(32,  8, 1, USE_AVX)] = x264_pixel_satd_32x8_avx;
-    func_satd[make_tuple(32,  4, 1, USE_AVX)] = x264_pixel_satd_32x4_avx;
-    func_satd[make_tuple(24, 48, 1, USE_AVX)] = x264_pixel_satd_24x48_avx;
-    func_satd[make_tuple(24, 32, 1, USE_AVX)] = x264_pixel_satd_24x32_avx;
-    func_satd[make_tuple(24, 24, 1, USE_AVX)] = x264_pixel_satd_24x24_avx;
-    func_satd[make_tuple(24, 12, 1, USE_AVX)] = x264_pixel_satd_24x12_avx;
-    func_satd[make_tuple(16, 64, 1, USE_AVX)] = x264_pixel_satd_16x64_avx;
-    func_satd[make_tuple(16, 32, 1, USE_AVX)] = x264_pixel_satd_16x32_avx;
-    func_satd[make_tuple(16, 16, 1, USE_AVX)] = x264_pixel_satd_16x16_avx;
-    func_satd[make_tuple(16, 12, 1, USE_AVX)] = x264_pixel_satd_16x12_avx;
-    func_satd[make_tuple(16, 8 , 1, USE_AVX)] = x264_pixel_satd_16x8_avx;
-    func_satd[make_tuple(16, 4 , 1, USE_AVX)] = x264_pixel_satd_16x4_avx;
-    // no 12x48, 12x24, 12x12. 12x48 generated from 12x16_avx
-    func_satd[make_tuple(12, 48, 1, USE_AVX)] = x264_pixel_satd_12x48_avx;
-    func_satd[make_tuple(12, 16, 1, USE_AVX)] = x264_pixel_satd_12x16_avx;
-    func_satd[make_tuple(8 , 32, 1, USE_AVX)] = x264_pixel_satd_8x32_avx;
-    func_satd[make_tuple(8 , 16, 1, USE_AVX)] = x264_pixel_satd_8x16_avx;
-    func_satd[make_tuple(8 , 8 , 1, USE_AVX)] = x264_pixel_satd_8x8_avx;
-    func_satd[make_tuple(8 , 4 , 1, USE_AVX)] = x264_pixel_satd_8x4_avx;
-
-    func_satd[make_tuple(64, 64, 1, USE_SSE41)] = x264_pixel_satd_64x64_sse4;
-    func_satd[make_tuple(64, 48, 1, USE_SSE41)] = x264_pixel_satd_64x48_sse4;
-    func_satd[make_tuple(64, 32, 1, USE_SSE41)] = x264_pixel_satd_64x32_sse4;
-    func_satd[make_tuple(64, 16, 1, USE_SSE41)] = x264_pixel_satd_64x16_sse4;
-    func_satd[make_tuple(48, 64, 1, USE_SSE41)] = x264_pixel_satd_48x64_sse4;
-    func_satd[make_tuple(48, 48, 1, USE_SSE41)] = x264_pixel_satd_48x48_sse4;
-    func_satd[make_tuple(48, 24, 1, USE_SSE41)] = x264_pixel_satd_48x24_sse4;
-    func_satd[make_tuple(48, 12, 1, USE_SSE41)] = x264_pixel_satd_48x12_sse4;
-    func_satd[make_tuple(32, 64, 1, USE_SSE41)] = x264_pixel_satd_32x64_sse4;
-    func_satd[make_tuple(32, 32, 1, USE_SSE41)] = x264_pixel_satd_32x32_sse4;
-    func_satd[make_tuple(32, 24, 1, USE_SSE41)] = x264_pixel_satd_32x24_sse4;
-    func_satd[make_tuple(32, 16, 1, USE_SSE41)] = x264_pixel_satd_32x16_sse4;
-    func_satd[make_tuple(32,  8, 1, USE_SSE41)] = x264_pixel_satd_32x8_sse4;
-    func_satd[make_tuple(32,  4, 1, USE_SSE41)] = x264_pixel_satd_32x4_sse4;
-    func_satd[make_tuple(24, 48, 1, USE_SSE41)] = x264_pixel_satd_24x48_sse4;
-    func_satd[make_tuple(24, 32, 1, USE_SSE41)] = x264_pixel_satd_24x32_sse4;
-    func_satd[make_tuple(24, 24, 1, USE_SSE41)] = x264_pixel_satd_24x24_sse4;
-    func_satd[make_tuple(24, 12, 1, USE_SSE41)] = x264_pixel_satd_24x12_sse4;
-    func_satd[make_tuple(16, 64, 1, USE_SSE41)] = x264_pixel_satd_16x64_sse4;
-    func_satd[make_tuple(16, 32, 1, USE_SSE41)] = x264_pixel_satd_16x32_sse4;
-    func_satd[make_tuple(16, 16, 1, USE_SSE41)] = x264_pixel_satd_16x16_sse4;
-    func_satd[make_tuple(16, 12, 1, USE_SSE41)] = x264_pixel_satd_16x12_sse4;
-    func_satd[make_tuple(16, 8 , 1, USE_SSE41)] = x264_pixel_satd_16x8_sse4;
-    func_satd[make_tuple(16, 4 , 1, USE_SSE41)] = x264_pixel_satd_16x4_sse4;
-    // no 12x48, 12x24, 12x12. 12x48 generated from 12x16_sse4
-    func_satd[make_tuple(12, 48, 1, USE_SSE41)] = x264_pixel_satd_12x48_sse4;
-    func_satd[make_tuple(12, 16, 1, USE_SSE41)] = x264_pixel_satd_12x16_sse4;
-    func_satd[make_tuple(8 , 32, 1, USE_SSE41)] = x264_pixel_satd_8x32_sse4;
-    func_satd[make_tuple(8 , 16, 1, USE_SSE41)] = x264_pixel_satd_8x16_sse4;
-    func_satd[make_tuple(8 , 8 , 1, USE_SSE41)] = x264_pixel_satd_8x8_sse4;
-    func_satd[make_tuple(8 , 4 , 1, USE_SSE41)] = x264_pixel_satd_8x4_sse4;
-    func_satd[make_tuple(4,  8 , 1, USE_SSE41)] = x264_pixel_satd_4x8_sse4;
-    func_satd[make_tuple(4,  4 , 1, USE_SSE41)] = x264_pixel_satd_4x4_sse4;
-
-    func_satd[make_tuple(64, 64, 1, USE_SSE2)] = x264_pixel_satd_64x64_sse2;
-    func_satd[make_tuple(64, 48, 1, USE_SSE2)] = x264_pixel_satd_64x48_sse2;
-    func_satd[make_tuple(64, 32, 1, USE_SSE2)] = x264_pixel_satd_64x32_sse2;
-    func_satd[make_tuple(64, 16, 1, USE_SSE2)] = x264_pixel_satd_64x16_sse2;
-    func_satd[make_tuple(48, 64, 1, USE_SSE2)] = x264_pixel_satd_48x64_sse2;
-    func_satd[make_tuple(48, 48, 1, USE_SSE2)] = x264_pixel_satd_48x48_sse2;
-    func_satd[make_tuple(48, 24, 1, USE_SSE2)] = x264_pixel_satd_48x24_sse2;
-    func_satd[make_tuple(48, 12, 1, USE_SSE2)] = x264_pixel_satd_48x12_sse2;
-    func_satd[make_tuple(32, 64, 1, USE_SSE2)] = x264_pixel_satd_32x64_sse2;
-    func_satd[make_tuple(32, 32, 1, USE_SSE2)] = x264_pixel_satd_32x32_sse2;
-    func_satd[make_tuple(32, 16, 1, USE_SSE2)] = x264_pixel_satd_32x16_sse2;
-    func_satd[make_tuple(32, 24, 1, USE_SSE2)] = x264_pixel_satd_32x24_sse2;
-    func_satd[make_tuple(32,  8, 1, USE_SSE2)] = x264_pixel_satd_32x8_sse2;
-    func_satd[make_tuple(32,  4, 1, USE_SSE2)] = x264_pixel_satd_32x4_sse2;
-    func_satd[make_tuple(24, 48, 1, USE_SSE2)] = x264_pixel_satd_24x48_sse2;
-    func_satd[make_tuple(24, 32, 1, USE_SSE2)] = x264_pixel_satd_24x32_sse2;
-    func_satd[make_tuple(24, 24, 1, USE_SSE2)] = x264_pixel_satd_24x24_sse2;
-    func_satd[make_tuple(24, 12, 1, USE_SSE2)] = x264_pixel_satd_24x12_sse2;
-    func_satd[make_tuple(16, 64, 1, USE_SSE2)] = x264_pixel_satd_16x64_sse2;
-    func_satd[make_tuple(16, 32, 1, USE_SSE2)] = x264_pixel_satd_16x32_sse2;
-    func_satd[make_tuple(16, 16, 1, USE_SSE2)] = x264_pixel_satd_16x16_sse2;
-    func_satd[make_tuple(16, 12, 1, USE_SSE2)] = x264_pixel_satd_16x12_sse2;
-    func_satd[make_tuple(16, 8 , 1, USE_SSE2)] = x264_pixel_satd_16x8_sse2;
-    func_satd[make_tuple(16, 4 , 1, USE_SSE2)] = x264_pixel_satd_16x4_sse2;
-    // no 12x48, 12x24, 12x12
-    // 12x48 generated from 12x16 sse2, 
-    // 12x24, 12x12 generated from 4x4 mmx2, 
-    func_satd[make_tuple(12, 48, 1, USE_SSE2)] = x264_pixel_satd_12x48_sse2;
-    func_satd[make_tuple(12, 24, 1, USE_SSE2)] = x264_pixel_satd_12x24_mmx2;
-    func_satd[make_tuple(12, 16, 1, USE_SSE2)] = x264_pixel_satd_12x16_sse2;
-    func_satd[make_tuple(12, 12, 1, USE_SSE2)] = x264_pixel_satd_12x12_mmx2;
-    func_satd[make_tuple(8 , 32, 1, USE_SSE2)] = x264_pixel_satd_8x32_sse2;
-    func_satd[make_tuple(8 , 16, 1, USE_SSE2)] = x264_pixel_satd_8x16_sse2;
-    func_satd[make_tuple(8 , 8 , 1, USE_SSE2)] = x264_pixel_satd_8x8_sse2;
-    func_satd[make_tuple(8 , 4 , 1, USE_SSE2)] = x264_pixel_satd_8x4_sse2;
-    func_satd[make_tuple(4 , 32, 1, USE_SSE2)] = x264_pixel_satd_4x32_sse2;
-    func_satd[make_tuple(4 , 16, 1, USE_SSE2)] = x264_pixel_satd_4x16_sse2;
-    func_satd[make_tuple(4 , 8 , 1, USE_SSE2)] = x264_pixel_satd_4x8_sse2;
-    func_satd[make_tuple(4 , 4 , 1, USE_SSE2)] = x264_pixel_satd_4x4_mmx2;
+      func_satd[make_tuple(16, 16, 1, USE_AVX2)] = x264_pixel_satd_16x16_avx2;
+      func_satd[make_tuple(16, 8 , 1, USE_AVX2)] = x264_pixel_satd_16x8_avx2;
+      func_satd[make_tuple(8 , 16, 1, USE_AVX2)] = x264_pixel_satd_8x16_avx2;
+      func_satd[make_tuple(8 , 8 , 1, USE_AVX2)] = x264_pixel_satd_8x8_avx2;
+
+      func_satd[make_tuple(64, 64, 1, USE_AVX)] = x264_pixel_satd_64x64_avx;
+      func_satd[make_tuple(64, 48, 1, USE_AVX)] = x264_pixel_satd_64x48_avx;
+      func_satd[make_tuple(64, 32, 1, USE_AVX)] = x264_pixel_satd_64x32_avx;
+      func_satd[make_tuple(64, 16, 1, USE_AVX)] = x264_pixel_satd_64x16_avx;
+      func_satd[make_tuple(48, 64, 1, USE_AVX)] = x264_pixel_satd_48x64_avx;
+      func_satd[make_tuple(48, 48, 1, USE_AVX)] = x264_pixel_satd_48x48_avx;
+      func_satd[make_tuple(48, 24, 1, USE_AVX)] = x264_pixel_satd_48x24_avx;
+      func_satd[make_tuple(48, 12, 1, USE_AVX)] = x264_pixel_satd_48x12_avx;
+      func_satd[make_tuple(32, 64, 1, USE_AVX)] = x264_pixel_satd_32x64_avx;
+      func_satd[make_tuple(32, 32, 1, USE_AVX)] = x264_pixel_satd_32x32_avx;
+      func_satd[make_tuple(32, 24, 1, USE_AVX)] = x264_pixel_satd_32x24_avx;
+      func_satd[make_tuple(32, 16, 1, USE_AVX)] = x264_pixel_satd_32x16_avx;
+      func_satd[make_tuple(32,  8, 1, USE_AVX)] = x264_pixel_satd_32x8_avx;
+      func_satd[make_tuple(32,  4, 1, USE_AVX)] = x264_pixel_satd_32x4_avx;
+      func_satd[make_tuple(24, 48, 1, USE_AVX)] = x264_pixel_satd_24x48_avx;
+      func_satd[make_tuple(24, 32, 1, USE_AVX)] = x264_pixel_satd_24x32_avx;
+      func_satd[make_tuple(24, 24, 1, USE_AVX)] = x264_pixel_satd_24x24_avx;
+      func_satd[make_tuple(24, 12, 1, USE_AVX)] = x264_pixel_satd_24x12_avx;
+      func_satd[make_tuple(16, 64, 1, USE_AVX)] = x264_pixel_satd_16x64_avx;
+      func_satd[make_tuple(16, 32, 1, USE_AVX)] = x264_pixel_satd_16x32_avx;
+      func_satd[make_tuple(16, 16, 1, USE_AVX)] = x264_pixel_satd_16x16_avx;
+      func_satd[make_tuple(16, 12, 1, USE_AVX)] = x264_pixel_satd_16x12_avx;
+      func_satd[make_tuple(16, 8 , 1, USE_AVX)] = x264_pixel_satd_16x8_avx;
+      func_satd[make_tuple(16, 4 , 1, USE_AVX)] = x264_pixel_satd_16x4_avx;
+      // no 12x48, 12x24, 12x12. 12x48 generated from 12x16_avx
+      func_satd[make_tuple(12, 48, 1, USE_AVX)] = x264_pixel_satd_12x48_avx;
+      func_satd[make_tuple(12, 16, 1, USE_AVX)] = x264_pixel_satd_12x16_avx;
+      func_satd[make_tuple(8 , 32, 1, USE_AVX)] = x264_pixel_satd_8x32_avx;
+      func_satd[make_tuple(8 , 16, 1, USE_AVX)] = x264_pixel_satd_8x16_avx;
+      func_satd[make_tuple(8 , 8 , 1, USE_AVX)] = x264_pixel_satd_8x8_avx;
+      func_satd[make_tuple(8 , 4 , 1, USE_AVX)] = x264_pixel_satd_8x4_avx;
+
+      func_satd[make_tuple(64, 64, 1, USE_SSE41)] = x264_pixel_satd_64x64_sse4;
+      func_satd[make_tuple(64, 48, 1, USE_SSE41)] = x264_pixel_satd_64x48_sse4;
+      func_satd[make_tuple(64, 32, 1, USE_SSE41)] = x264_pixel_satd_64x32_sse4;
+      func_satd[make_tuple(64, 16, 1, USE_SSE41)] = x264_pixel_satd_64x16_sse4;
+      func_satd[make_tuple(48, 64, 1, USE_SSE41)] = x264_pixel_satd_48x64_sse4;
+      func_satd[make_tuple(48, 48, 1, USE_SSE41)] = x264_pixel_satd_48x48_sse4;
+      func_satd[make_tuple(48, 24, 1, USE_SSE41)] = x264_pixel_satd_48x24_sse4;
+      func_satd[make_tuple(48, 12, 1, USE_SSE41)] = x264_pixel_satd_48x12_sse4;
+      func_satd[make_tuple(32, 64, 1, USE_SSE41)] = x264_pixel_satd_32x64_sse4;
+      func_satd[make_tuple(32, 32, 1, USE_SSE41)] = x264_pixel_satd_32x32_sse4;
+      func_satd[make_tuple(32, 24, 1, USE_SSE41)] = x264_pixel_satd_32x24_sse4;
+      func_satd[make_tuple(32, 16, 1, USE_SSE41)] = x264_pixel_satd_32x16_sse4;
+      func_satd[make_tuple(32,  8, 1, USE_SSE41)] = x264_pixel_satd_32x8_sse4;
+      func_satd[make_tuple(32,  4, 1, USE_SSE41)] = x264_pixel_satd_32x4_sse4;
+      func_satd[make_tuple(24, 48, 1, USE_SSE41)] = x264_pixel_satd_24x48_sse4;
+      func_satd[make_tuple(24, 32, 1, USE_SSE41)] = x264_pixel_satd_24x32_sse4;
+      func_satd[make_tuple(24, 24, 1, USE_SSE41)] = x264_pixel_satd_24x24_sse4;
+      func_satd[make_tuple(24, 12, 1, USE_SSE41)] = x264_pixel_satd_24x12_sse4;
+      func_satd[make_tuple(16, 64, 1, USE_SSE41)] = x264_pixel_satd_16x64_sse4;
+      func_satd[make_tuple(16, 32, 1, USE_SSE41)] = x264_pixel_satd_16x32_sse4;
+      func_satd[make_tuple(16, 16, 1, USE_SSE41)] = x264_pixel_satd_16x16_sse4;
+      func_satd[make_tuple(16, 12, 1, USE_SSE41)] = x264_pixel_satd_16x12_sse4;
+      func_satd[make_tuple(16, 8 , 1, USE_SSE41)] = x264_pixel_satd_16x8_sse4;
+      func_satd[make_tuple(16, 4 , 1, USE_SSE41)] = x264_pixel_satd_16x4_sse4;
+      // no 12x48, 12x24, 12x12. 12x48 generated from 12x16_sse4
+      func_satd[make_tuple(12, 48, 1, USE_SSE41)] = x264_pixel_satd_12x48_sse4;
+      func_satd[make_tuple(12, 16, 1, USE_SSE41)] = x264_pixel_satd_12x16_sse4;
+      func_satd[make_tuple(8 , 32, 1, USE_SSE41)] = x264_pixel_satd_8x32_sse4;
+      func_satd[make_tuple(8 , 16, 1, USE_SSE41)] = x264_pixel_satd_8x16_sse4;
+      func_satd[make_tuple(8 , 8 , 1, USE_SSE41)] = x264_pixel_satd_8x8_sse4;
+      func_satd[make_tuple(8 , 4 , 1, USE_SSE41)] = x264_pixel_satd_8x4_sse4;
+      func_satd[make_tuple(4,  8 , 1, USE_SSE41)] = x264_pixel_satd_4x8_sse4;
+      func_satd[make_tuple(4,  4 , 1, USE_SSE41)] = x264_pixel_satd_4x4_sse4;
+
+      func_satd[make_tuple(64, 64, 1, USE_SSE2)] = x264_pixel_satd_64x64_sse2;
+      func_satd[make_tuple(64, 48, 1, USE_SSE2)] = x264_pixel_satd_64x48_sse2;
+      func_satd[make_tuple(64, 32, 1, USE_SSE2)] = x264_pixel_satd_64x32_sse2;
+      func_satd[make_tuple(64, 16, 1, USE_SSE2)] = x264_pixel_satd_64x16_sse2;
+      func_satd[make_tuple(48, 64, 1, USE_SSE2)] = x264_pixel_satd_48x64_sse2;
+      func_satd[make_tuple(48, 48, 1, USE_SSE2)] = x264_pixel_satd_48x48_sse2;
+      func_satd[make_tuple(48, 24, 1, USE_SSE2)] = x264_pixel_satd_48x24_sse2;
+      func_satd[make_tuple(48, 12, 1, USE_SSE2)] = x264_pixel_satd_48x12_sse2;
+      func_satd[make_tuple(32, 64, 1, USE_SSE2)] = x264_pixel_satd_32x64_sse2;
+      func_satd[make_tuple(32, 32, 1, USE_SSE2)] = x264_pixel_satd_32x32_sse2;
+      func_satd[make_tuple(32, 16, 1, USE_SSE2)] = x264_pixel_satd_32x16_sse2;
+      func_satd[make_tuple(32, 24, 1, USE_SSE2)] = x264_pixel_satd_32x24_sse2;
+      func_satd[make_tuple(32,  8, 1, USE_SSE2)] = x264_pixel_satd_32x8_sse2;
+      func_satd[make_tuple(32,  4, 1, USE_SSE2)] = x264_pixel_satd_32x4_sse2;
+      func_satd[make_tuple(24, 48, 1, USE_SSE2)] = x264_pixel_satd_24x48_sse2;
+      func_satd[make_tuple(24, 32, 1, USE_SSE2)] = x264_pixel_satd_24x32_sse2;
+      func_satd[make_tuple(24, 24, 1, USE_SSE2)] = x264_pixel_satd_24x24_sse2;
+      func_satd[make_tuple(24, 12, 1, USE_SSE2)] = x264_pixel_satd_24x12_sse2;
+      func_satd[make_tuple(16, 64, 1, USE_SSE2)] = x264_pixel_satd_16x64_sse2;
+      func_satd[make_tuple(16, 32, 1, USE_SSE2)] = x264_pixel_satd_16x32_sse2;
+      func_satd[make_tuple(16, 16, 1, USE_SSE2)] = x264_pixel_satd_16x16_sse2;
+      func_satd[make_tuple(16, 12, 1, USE_SSE2)] = x264_pixel_satd_16x12_sse2;
+      func_satd[make_tuple(16, 8 , 1, USE_SSE2)] = x264_pixel_satd_16x8_sse2;
+      func_satd[make_tuple(16, 4 , 1, USE_SSE2)] = x264_pixel_satd_16x4_sse2;
+      // no 12x48, 12x24, 12x12
+      // 12x48 generated from 12x16 sse2, 
+      // 12x24, 12x12 generated from 4x4 mmx2, 
+      func_satd[make_tuple(12, 48, 1, USE_SSE2)] = x264_pixel_satd_12x48_sse2;
+      func_satd[make_tuple(12, 24, 1, USE_SSE2)] = x264_pixel_satd_12x24_mmx2;
+      func_satd[make_tuple(12, 16, 1, USE_SSE2)] = x264_pixel_satd_12x16_sse2;
+      func_satd[make_tuple(12, 12, 1, USE_SSE2)] = x264_pixel_satd_12x12_mmx2;
+      func_satd[make_tuple(8 , 32, 1, USE_SSE2)] = x264_pixel_satd_8x32_sse2;
+      func_satd[make_tuple(8 , 16, 1, USE_SSE2)] = x264_pixel_satd_8x16_sse2;
+      func_satd[make_tuple(8 , 8 , 1, USE_SSE2)] = x264_pixel_satd_8x8_sse2;
+      func_satd[make_tuple(8 , 4 , 1, USE_SSE2)] = x264_pixel_satd_8x4_sse2;
+      func_satd[make_tuple(4 , 32, 1, USE_SSE2)] = x264_pixel_satd_4x32_sse2;
+      func_satd[make_tuple(4 , 16, 1, USE_SSE2)] = x264_pixel_satd_4x16_sse2;
+      func_satd[make_tuple(4 , 8 , 1, USE_SSE2)] = x264_pixel_satd_4x8_sse2;
+      func_satd[make_tuple(4 , 4 , 1, USE_SSE2)] = x264_pixel_satd_4x4_mmx2;
 #endif // USE_SATD_ASM
-    // 8 and 16 bit C; 16 bit SSE4/SSE2 SADT functions
-    // e.g.. satd16_64x64_sse2<false>;
+      // 8 and 16 bit C; 16 bit SSE4/SSE2 SADT functions
+      // e.g.. satd16_64x64_sse2<false>;
 #ifdef USE_SATD_ASM
 #define MAKE_FN(w,h) \
     func_satd[make_tuple(w, h, 2, NO_SIMD)] = mvtools_satd_##w##x##h##_c<uint16_t>; \
@@ -1385,51 +1380,53 @@ SADFunction* get_satd_function(int BlockX, int BlockY, int pixelsize, arch_t arc
     func_satd[make_tuple(w, h, 2, USE_SSE41)] = satd16_##w##x##h##_sse2<true>; \
     func_satd[make_tuple(w, h, 2, USE_SSE2)] = satd16_##w##x##h##_sse2<false>;
 #else
-    // additional: 8 bit C from 2.7.46 (gcc)
-    // FIXME: implement 8 bit sse2 in case of external asm-less compilation
+      // additional: 8 bit C from 2.7.46 (gcc)
+      // FIXME: implement 8 bit sse2 in case of external asm-less compilation
 #define MAKE_FN(w,h) \
     func_satd[make_tuple(w, h, 2, NO_SIMD)] = mvtools_satd_##w##x##h##_c<uint16_t>; \
     func_satd[make_tuple(w, h, 1, NO_SIMD)] = mvtools_satd_##w##x##h##_c<uint8_t>; \
     func_satd[make_tuple(w, h, 2, USE_SSE41)] = satd16_##w##x##h##_sse2<true>; \
     func_satd[make_tuple(w, h, 2, USE_SSE2)] = satd16_##w##x##h##_sse2<false>;
 #endif
-      MAKE_FN(64, 64)
-      MAKE_FN(64, 48)
-      MAKE_FN(64, 32)
-      MAKE_FN(64, 16)
-      MAKE_FN(48, 64)
-      MAKE_FN(48, 48)
-      MAKE_FN(48, 24)
-      MAKE_FN(48, 12)
-      MAKE_FN(32, 64)
-      MAKE_FN(32, 32)
-      MAKE_FN(32, 24)
-      MAKE_FN(32, 16)
-      MAKE_FN(32, 8)
-      MAKE_FN(32, 4)
-      MAKE_FN(24, 48)
-      MAKE_FN(24, 32)
-      MAKE_FN(24, 24)
-      MAKE_FN(24, 12)
-      MAKE_FN(16, 64)
-      MAKE_FN(16, 32)
-      MAKE_FN(16, 16)
-      MAKE_FN(16, 12)
-      MAKE_FN(16, 8)
-      MAKE_FN(16, 4)
-      MAKE_FN(12, 48)
-      MAKE_FN(12, 24)
-      MAKE_FN(12, 16)
-      MAKE_FN(12, 12)
-      MAKE_FN(8, 32)
-      MAKE_FN(8, 16)
-      MAKE_FN(8, 8)
-      MAKE_FN(8, 4)
-      MAKE_FN(4, 32)
-      MAKE_FN(4, 16)
-      MAKE_FN(4, 8)
-      MAKE_FN(4, 4)
+        MAKE_FN(64, 64)
+        MAKE_FN(64, 48)
+        MAKE_FN(64, 32)
+        MAKE_FN(64, 16)
+        MAKE_FN(48, 64)
+        MAKE_FN(48, 48)
+        MAKE_FN(48, 24)
+        MAKE_FN(48, 12)
+        MAKE_FN(32, 64)
+        MAKE_FN(32, 32)
+        MAKE_FN(32, 24)
+        MAKE_FN(32, 16)
+        MAKE_FN(32, 8)
+        MAKE_FN(32, 4)
+        MAKE_FN(24, 48)
+        MAKE_FN(24, 32)
+        MAKE_FN(24, 24)
+        MAKE_FN(24, 12)
+        MAKE_FN(16, 64)
+        MAKE_FN(16, 32)
+        MAKE_FN(16, 16)
+        MAKE_FN(16, 12)
+        MAKE_FN(16, 8)
+        MAKE_FN(16, 4)
+        MAKE_FN(12, 48)
+        MAKE_FN(12, 24)
+        MAKE_FN(12, 16)
+        MAKE_FN(12, 12)
+        MAKE_FN(8, 32)
+        MAKE_FN(8, 16)
+        MAKE_FN(8, 8)
+        MAKE_FN(8, 4)
+        MAKE_FN(4, 32)
+        MAKE_FN(4, 16)
+        MAKE_FN(4, 8)
+        MAKE_FN(4, 4)
 #undef MAKE_FN
+      return func_satd;
+    }();
 
     SADFunction *result = nullptr;
     arch_t archlist[] = { USE_AVX2, USE_AVX, USE_SSE41, USE_SSE2, NO_SIMD };
@@ -1438,10 +1435,10 @@ SADFunction* get_satd_function(int BlockX, int BlockY, int pixelsize, arch_t arc
       arch_t current_arch_try = archlist[index++];
       if (current_arch_try > arch) continue;
       if (result == nullptr && current_arch_try == NO_SIMD) {
-        result = func_satd[make_tuple(BlockX, BlockY, pixelsize, NO_SIMD)];
+        result = find_function(func_satd_table, make_tuple(BlockX, BlockY, pixelsize, NO_SIMD));
       }
       else {
-        result = func_satd[make_tuple(BlockX, BlockY, pixelsize, current_arch_try)];
+        result = find_function(func_satd_table, make_tuple(BlockX, BlockY, pixelsize, current_arch_try));
       }
       if (result == nullptr && current_arch_try == NO_SIMD) {
         break;
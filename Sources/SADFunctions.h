@@ -74,8 +74,18 @@ unsigned int Sad_sse2(const uint8_t* pSrc, int nSrcPitch8, const uint8_t* pRef,
         sad1 = _mm_sad_epu8(dst1, src1);
         acc = _mm_add_epi32(acc, sad1);
       }
+      if constexpr (vert_inc >= 8) {
+        // unroll 8 (e.g. 24xN: the 16 pixel part shares the row step)
+        for (int k = 4; k < 8; ++k) {
+          dst1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRef + x + nRefPitch * k));
+          src1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + x + nSrcPitch * k));
+          sad1 = _mm_sad_epu8(dst1, src1);
+          acc = _mm_add_epi32(acc, sad1);
+        }
+      }
     }
-    if constexpr (nBlkWidth % 16 != 0 && nBlkWidth % 8 == 0) {
+    // remaining 8, 4 and 2 pixel columns, e.g. 12 = 8 + 4, 6 = 4 + 2
+    if constexpr (nBlkWidth % 16 >= 8) {
       for (int x = nBlkWidth / 16 * 16; x < nBlkWidth / 8 * 8; x += 8) {
         auto dst1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pRef + x));
         auto src1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc + x));
@@ -114,7 +124,7 @@ unsigned int Sad_sse2(const uint8_t* pSrc, int nSrcPitch8, const uint8_t* pRef,
         }
       }
     }
-    if constexpr (nBlkWidth % 8 != 0 && nBlkWidth % 4 == 0) {
+    if constexpr (nBlkWidth % 8 >= 4) {
       for (int x = nBlkWidth / 8 * 8; x < nBlkWidth / 4 * 4; x += 4) {
         auto dst1 = _mm_cvtsi32_si128(*reinterpret_cast<const uint32_t*>(pRef + x));
         auto src1 = _mm_cvtsi32_si128(*reinterpret_cast<const uint32_t*>(pSrc + x));
@@ -135,7 +145,7 @@ unsigned int Sad_sse2(const uint8_t* pSrc, int nSrcPitch8, const uint8_t* pRef,
         }
       }
     }
-    if constexpr (nBlkWidth % 4 != 0 && nBlkWidth % 2 == 0) {
+    if constexpr (nBlkWidth % 4 >= 2) {
       for (int x = nBlkWidth / 4 * 4; x < nBlkWidth / 2 * 2; x += 2) {
         auto dst1 = _mm_cvtsi32_si128(*reinterpret_cast<const uint16_t*>(pRef + x));
         auto src1 = _mm_cvtsi32_si128(*reinterpret_cast<const uint16_t*>(pSrc + x));
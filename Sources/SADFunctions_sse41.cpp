@@ -0,0 +1,109 @@
+#include <smmintrin.h>
+#include "SADFunctions_sse41.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+// mpsadbw based SADs of a block against pRef + 0..7 pixels.
+// Each mpsadbw gives 8 sums of 4 pixels, they are accumulated in 16 bits
+// and widened before they could overflow.
+template<int nBlkWidth, int nBlkHeight>
+static void SadRow8_sse41(unsigned int *pSad8, const uint8_t *pSrc, int nSrcPitch, const uint8_t *pRef, int nRefPitch)
+{
+  static_assert(nBlkWidth % 4 == 0, "SadRow8: width must be mod4");
+  constexpr int rows_per_flush = 65535 / (nBlkWidth * 255);
+
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc_lo = zero;
+  __m128i acc_hi = zero;
+
+  int y = 0;
+  while (y < nBlkHeight)
+  {
+    const int y_end = std::min(y + rows_per_flush, nBlkHeight);
+    __m128i acc16 = zero;
+    for (; y < y_end; y++)
+    {
+      for (int x = 0; x < nBlkWidth / 8 * 8; x += 8)
+      {
+        const __m128i ref = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRef + x));
+        const __m128i src = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSrc + x));
+        acc16 = _mm_add_epi16(acc16, _mm_mpsadbw_epu8(ref, src, 0)); // ref 0..10 vs src 0..3
+        acc16 = _mm_add_epi16(acc16, _mm_mpsadbw_epu8(ref, src, 5)); // ref 4..14 vs src 4..7
+      }
+      if constexpr (nBlkWidth % 8 != 0)
+      {
+        constexpr int x = nBlkWidth / 8 * 8;
+        const __m128i ref = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRef + x));
+        const __m128i src = _mm_cvtsi32_si128(*reinterpret_cast<const uint32_t*>(pSrc + x));
+        acc16 = _mm_add_epi16(acc16, _mm_mpsadbw_epu8(ref, src, 0));
+      }
+      pSrc += nSrcPitch;
+      pRef += nRefPitch;
+    }
+    acc_lo = _mm_add_epi32(acc_lo, _mm_cvtepu16_epi32(acc16));
+    acc_hi = _mm_add_epi32(acc_hi, _mm_unpackhi_epi16(acc16, zero));
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pSad8), acc_lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(pSad8 + 4), acc_hi);
+}
+
+SADRow8Function* get_sad_row8_function(int BlockX, int BlockY, int bits_per_pixel, arch_t arch)
+{
+  using std::make_tuple;
+
+  if (bits_per_pixel != 8 || arch < USE_SSE41)
+    return nullptr;
+
+  // BlkSizeX, BlkSizeY
+  static const std::map<std::tuple<int, int>, SADRow8Function*> func_sad_row8_table = []() {
+    std::map<std::tuple<int, int>, SADRow8Function*> func_sad_row8;
+#define MAKE_SAD_ROW8_FN(x, y) func_sad_row8[make_tuple(x, y)] = SadRow8_sse41<x, y>;
+    MAKE_SAD_ROW8_FN(64, 64)
+    MAKE_SAD_ROW8_FN(64, 48)
+    MAKE_SAD_ROW8_FN(64, 32)
+    MAKE_SAD_ROW8_FN(64, 16)
+    MAKE_SAD_ROW8_FN(48, 64)
+    MAKE_SAD_ROW8_FN(48, 48)
+    MAKE_SAD_ROW8_FN(48, 24)
+    MAKE_SAD_ROW8_FN(48, 12)
+    MAKE_SAD_ROW8_FN(32, 64)
+    MAKE_SAD_ROW8_FN(32, 32)
+    MAKE_SAD_ROW8_FN(32, 24)
+    MAKE_SAD_ROW8_FN(32, 16)
+    MAKE_SAD_ROW8_FN(32, 8)
+    MAKE_SAD_ROW8_FN(24, 48)
+    MAKE_SAD_ROW8_FN(24, 32)
+    MAKE_SAD_ROW8_FN(24, 24)
+    MAKE_SAD_ROW8_FN(24, 12)
+    MAKE_SAD_ROW8_FN(24, 6)
+    MAKE_SAD_ROW8_FN(16, 64)
+    MAKE_SAD_ROW8_FN(16, 32)
+    MAKE_SAD_ROW8_FN(16, 16)
+    MAKE_SAD_ROW8_FN(16, 12)
+    MAKE_SAD_ROW8_FN(16, 8)
+    MAKE_SAD_ROW8_FN(16, 4)
+    MAKE_SAD_ROW8_FN(16, 2)
+    MAKE_SAD_ROW8_FN(16, 1)
+    MAKE_SAD_ROW8_FN(12, 48)
+    MAKE_SAD_ROW8_FN(12, 24)
+    MAKE_SAD_ROW8_FN(12, 16)
+    MAKE_SAD_ROW8_FN(12, 12)
+    MAKE_SAD_ROW8_FN(12, 6)
+    MAKE_SAD_ROW8_FN(12, 3)
+    MAKE_SAD_ROW8_FN(8, 32)
+    MAKE_SAD_ROW8_FN(8, 16)
+    MAKE_SAD_ROW8_FN(8, 8)
+    MAKE_SAD_ROW8_FN(8, 4)
+    MAKE_SAD_ROW8_FN(8, 2)
+    MAKE_SAD_ROW8_FN(8, 1)
+    MAKE_SAD_ROW8_FN(4, 8)
+    MAKE_SAD_ROW8_FN(4, 4)
+    MAKE_SAD_ROW8_FN(4, 2)
+    MAKE_SAD_ROW8_FN(4, 1)
+#undef MAKE_SAD_ROW8_FN
+    return func_sad_row8;
+  }();
+
+  return find_function(func_sad_row8_table, make_tuple(BlockX, BlockY));
+}
@@ -0,0 +1,36 @@
+// Functions that computes distances between blocks
+
+// See legal notice in Copying.txt for more information
+
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA, or visit
+// http://www.gnu.org/copyleft/gpl.html .
+
+/*! \file SADFunctions_sse41.h
+ *  \brief SADs of a block against a row of horizontally adjacent reference positions.
+ *
+ *	Used by the exhaustive search: one call gives the SAD of the source block
+ *	against pRef, pRef+1, ... pRef+7 (in pixels), based on mpsadbw.
+ *	The reference is read up to 8*((BlockX+7)/8)+8 bytes from pRef on each line.
+ */
+
+#ifndef __SAD_FUNC_SSE41__
+#define __SAD_FUNC_SSE41__
+
+#include "types.h"
+#include <stdint.h>
+
+SADRow8Function* get_sad_row8_function(int BlockX, int BlockY, int bits_per_pixel, arch_t arch);
+
+#endif
@@ -650,6 +650,7 @@ void SimpleResize::SimpleResizeDo_int16(short *dstp, int row_size, int height, i
   }
   
   // C version
+  short* dstp0 = dstp;
   const unsigned int* pControl = &hControl[0];
 
   const  short* srcp1;
@@ -698,7 +699,8 @@ void SimpleResize::SimpleResizeDo_int16(short *dstp, int row_size, int height, i
   }
 
   // for reference. We don't try to integrate it to the C code above
-  if (limitVectors) MakeVectorsSafe_c(dstp, real_width, real_height, dst_pitch, nPel, isXpart); // use real_width, real_height instead of row_size, height
+  // from the first row, dstp has been advanced by the loop above
+  if (limitVectors) MakeVectorsSafe_c(dstp0, real_width, real_height, dst_pitch, nPel, isXpart); // use real_width, real_height instead of row_size, height
 
 }
 
@@ -31,7 +31,15 @@ public:
   unsigned char nPel;
   unsigned char nModeYUV;
   unsigned char nLevels;
-  unsigned char param;
+  unsigned char param;       // SUPER_PARAM_* bits
+};
+
+enum
+{
+  SUPER_PARAM_PEL_ON_DEMAND = 0x01,  // only the full-pel finest plane is stored (MSuper ondemand)
+  SUPER_PARAM_SHARP_SHIFT = 1,       // 2 bits: sharp of MSuper, to interpolate on demand
+  SUPER_PARAM_SHARP_MASK = 0x03,
+  SUPER_PARAM_VIRTUAL_PAD = 0x08     // padding is not stored, clients clamp the blocks (MSuper virtualpad)
 };
 
 
@@ -150,7 +150,7 @@ template<int nBlkWidth, int nBlkHeight, typename pixel_t>
 unsigned int Luma_C(const unsigned char *pSrc, int nSrcPitch)
 {
     const unsigned char *s = pSrc;
-    typedef typename std::conditional < sizeof(pixel_t) == 1 && (nBlkWidth*nBlkHeight*255 < 65535), short, int>::type internal_sum_t;
+    typedef typename std::conditional < sizeof(pixel_t) == 1 && (nBlkWidth*nBlkHeight*255 <= 65535), unsigned short, int>::type internal_sum_t;
     internal_sum_t sumLuma = 0; // until sum is 16 bits, better asm is generated
     for ( int j = 0; j < nBlkHeight; j++ )
     {
@@ -173,168 +173,171 @@ LUMAFunction* get_luma_function(int BlockX, int BlockY, int pixelsize, arch_t ar
     // 8 bit only (pixelsize==1)
     //---------- LUMA
     // BlkSizeX, BlkSizeY, pixelsize, arch_t
-    std::map<std::tuple<int, int, int, arch_t>, LUMAFunction*> func_luma;
     using std::make_tuple;
+    static const std::map<std::tuple<int, int, int, arch_t>, LUMAFunction*> func_luma_table = []() {
+      std::map<std::tuple<int, int, int, arch_t>, LUMAFunction*> func_luma;
 
 #define MAKE_LUMA_FN(x, y) func_luma[make_tuple(x, y, 1, NO_SIMD)] = Luma_C<x, y, uint8_t>; \
 func_luma[make_tuple(x, y, 2, NO_SIMD)] = Luma_C<x, y, uint16_t>;
-    MAKE_LUMA_FN(64, 64)
-      MAKE_LUMA_FN(64, 48)
-      MAKE_LUMA_FN(64, 32)
-      MAKE_LUMA_FN(64, 16)
-      MAKE_LUMA_FN(48, 64)
-      MAKE_LUMA_FN(48, 48)
-      MAKE_LUMA_FN(48, 24)
-      MAKE_LUMA_FN(48, 12)
-      MAKE_LUMA_FN(32, 64)
-      MAKE_LUMA_FN(32, 32)
-      MAKE_LUMA_FN(32, 24)
-      MAKE_LUMA_FN(32, 16)
-      MAKE_LUMA_FN(32, 8)
-      MAKE_LUMA_FN(24, 48)
-      MAKE_LUMA_FN(24, 32)
-      MAKE_LUMA_FN(24, 24)
-      MAKE_LUMA_FN(24, 12)
-      MAKE_LUMA_FN(24, 6)
-      MAKE_LUMA_FN(16, 64)
-      MAKE_LUMA_FN(16, 32)
-      MAKE_LUMA_FN(16, 16)
-      MAKE_LUMA_FN(16, 12)
-      MAKE_LUMA_FN(16, 8)
-      MAKE_LUMA_FN(16, 4)
-      MAKE_LUMA_FN(16, 2)
-      MAKE_LUMA_FN(16, 1)
-      MAKE_LUMA_FN(12, 48)
-      MAKE_LUMA_FN(12, 24)
-      MAKE_LUMA_FN(12, 16)
-      MAKE_LUMA_FN(12, 12)
-      MAKE_LUMA_FN(12, 6)
-      MAKE_LUMA_FN(8, 32)
-      MAKE_LUMA_FN(8, 16)
-      MAKE_LUMA_FN(8, 8)
-      MAKE_LUMA_FN(8, 4)
-      MAKE_LUMA_FN(8, 2)
-      MAKE_LUMA_FN(8, 1)
-      MAKE_LUMA_FN(6, 12)
-      MAKE_LUMA_FN(6, 6)
-      MAKE_LUMA_FN(6, 3)
-      MAKE_LUMA_FN(4, 8)
-      MAKE_LUMA_FN(4, 4)
-      MAKE_LUMA_FN(4, 2)
-      MAKE_LUMA_FN(4, 1)
-      MAKE_LUMA_FN(3, 6)
-      MAKE_LUMA_FN(3, 3)
-      MAKE_LUMA_FN(2, 4)
-      MAKE_LUMA_FN(2, 2)
-      MAKE_LUMA_FN(2, 1)
+      MAKE_LUMA_FN(64, 64)
+        MAKE_LUMA_FN(64, 48)
+        MAKE_LUMA_FN(64, 32)
+        MAKE_LUMA_FN(64, 16)
+        MAKE_LUMA_FN(48, 64)
+        MAKE_LUMA_FN(48, 48)
+        MAKE_LUMA_FN(48, 24)
+        MAKE_LUMA_FN(48, 12)
+        MAKE_LUMA_FN(32, 64)
+        MAKE_LUMA_FN(32, 32)
+        MAKE_LUMA_FN(32, 24)
+        MAKE_LUMA_FN(32, 16)
+        MAKE_LUMA_FN(32, 8)
+        MAKE_LUMA_FN(24, 48)
+        MAKE_LUMA_FN(24, 32)
+        MAKE_LUMA_FN(24, 24)
+        MAKE_LUMA_FN(24, 12)
+        MAKE_LUMA_FN(24, 6)
+        MAKE_LUMA_FN(16, 64)
+        MAKE_LUMA_FN(16, 32)
+        MAKE_LUMA_FN(16, 16)
+        MAKE_LUMA_FN(16, 12)
+        MAKE_LUMA_FN(16, 8)
+        MAKE_LUMA_FN(16, 4)
+        MAKE_LUMA_FN(16, 2)
+        MAKE_LUMA_FN(16, 1)
+        MAKE_LUMA_FN(12, 48)
+        MAKE_LUMA_FN(12, 24)
+        MAKE_LUMA_FN(12, 16)
+        MAKE_LUMA_FN(12, 12)
+        MAKE_LUMA_FN(12, 6)
+        MAKE_LUMA_FN(8, 32)
+        MAKE_LUMA_FN(8, 16)
+        MAKE_LUMA_FN(8, 8)
+        MAKE_LUMA_FN(8, 4)
+        MAKE_LUMA_FN(8, 2)
+        MAKE_LUMA_FN(8, 1)
+        MAKE_LUMA_FN(6, 12)
+        MAKE_LUMA_FN(6, 6)
+        MAKE_LUMA_FN(6, 3)
+        MAKE_LUMA_FN(4, 8)
+        MAKE_LUMA_FN(4, 4)
+        MAKE_LUMA_FN(4, 2)
+        MAKE_LUMA_FN(4, 1)
+        MAKE_LUMA_FN(3, 6)
+        MAKE_LUMA_FN(3, 3)
+        MAKE_LUMA_FN(2, 4)
+        MAKE_LUMA_FN(2, 2)
+        MAKE_LUMA_FN(2, 1)
 #undef MAKE_LUMA_FN
-    // non-template functions come from Variance-a.asm
-    func_luma[make_tuple(64, 64, 1, USE_SSE2)] = Luma8_sse2<64, 64>;
-    func_luma[make_tuple(64, 48, 1, USE_SSE2)] = Luma8_sse2<64, 48>;
-    func_luma[make_tuple(64, 32, 1, USE_SSE2)] = Luma8_sse2<64, 32>;
-    func_luma[make_tuple(64, 16, 1, USE_SSE2)] = Luma8_sse2<64, 16>;
-    func_luma[make_tuple(48, 64, 1, USE_SSE2)] = Luma8_sse2<48, 64>;
-    func_luma[make_tuple(48, 48, 1, USE_SSE2)] = Luma8_sse2<48, 48>;
-    func_luma[make_tuple(48, 48, 1, USE_SSE2)] = Luma8_sse2<48, 24>;
-    func_luma[make_tuple(48, 48, 1, USE_SSE2)] = Luma8_sse2<48, 12>;
-    func_luma[make_tuple(32, 64, 1, USE_SSE2)] = Luma8_sse2<32, 64>;
+      // non-template functions come from Variance-a.asm
+      func_luma[make_tuple(64, 64, 1, USE_SSE2)] = Luma8_sse2<64, 64>;
+      func_luma[make_tuple(64, 48, 1, USE_SSE2)] = Luma8_sse2<64, 48>;
+      func_luma[make_tuple(64, 32, 1, USE_SSE2)] = Luma8_sse2<64, 32>;
+      func_luma[make_tuple(64, 16, 1, USE_SSE2)] = Luma8_sse2<64, 16>;
+      func_luma[make_tuple(48, 64, 1, USE_SSE2)] = Luma8_sse2<48, 64>;
+      func_luma[make_tuple(48, 48, 1, USE_SSE2)] = Luma8_sse2<48, 48>;
+      func_luma[make_tuple(48, 24, 1, USE_SSE2)] = Luma8_sse2<48, 24>;
+      func_luma[make_tuple(48, 12, 1, USE_SSE2)] = Luma8_sse2<48, 12>;
+      func_luma[make_tuple(32, 64, 1, USE_SSE2)] = Luma8_sse2<32, 64>;
 #ifdef USE_LUMA_ASM
-    func_luma[make_tuple(32, 32, 1, USE_SSE2)] = Luma32x32_sse2;
+      func_luma[make_tuple(32, 32, 1, USE_SSE2)] = Luma32x32_sse2;
 #else
-    func_luma[make_tuple(32, 32, 1, USE_SSE2)] = Luma8_sse2<32, 32>;
+      func_luma[make_tuple(32, 32, 1, USE_SSE2)] = Luma8_sse2<32, 32>;
 #endif
-    func_luma[make_tuple(32, 24, 1, USE_SSE2)] = Luma8_sse2<32, 24>;
+      func_luma[make_tuple(32, 24, 1, USE_SSE2)] = Luma8_sse2<32, 24>;
 #ifdef USE_LUMA_ASM
-    func_luma[make_tuple(32, 16, 1, USE_SSE2)] = Luma32x16_sse2;
+      func_luma[make_tuple(32, 16, 1, USE_SSE2)] = Luma32x16_sse2;
 #else
-    func_luma[make_tuple(32, 16, 1, USE_SSE2)] = Luma8_sse2<32, 16>;
+      func_luma[make_tuple(32, 16, 1, USE_SSE2)] = Luma8_sse2<32, 16>;
 #endif
-    func_luma[make_tuple(32, 8, 1, USE_SSE2)] = Luma8_sse2<32, 8>;
-    func_luma[make_tuple(24, 48, 1, USE_SSE2)] = Luma8_sse2<24, 48>;
-    func_luma[make_tuple(24, 32, 1, USE_SSE2)] = Luma8_sse2<24, 32>;
-    func_luma[make_tuple(24, 24, 1, USE_SSE2)] = Luma8_sse2<24, 24>;
-    func_luma[make_tuple(24, 12, 1, USE_SSE2)] = Luma8_sse2<24, 12>;
-    func_luma[make_tuple(24, 6, 1, USE_SSE2)] = Luma8_sse2<24, 6>;
-    func_luma[make_tuple(16, 64, 1, USE_SSE2)] = Luma8_sse2<16, 64>;
+      func_luma[make_tuple(32, 8, 1, USE_SSE2)] = Luma8_sse2<32, 8>;
+      func_luma[make_tuple(24, 48, 1, USE_SSE2)] = Luma8_sse2<24, 48>;
+      func_luma[make_tuple(24, 32, 1, USE_SSE2)] = Luma8_sse2<24, 32>;
+      func_luma[make_tuple(24, 24, 1, USE_SSE2)] = Luma8_sse2<24, 24>;
+      func_luma[make_tuple(24, 12, 1, USE_SSE2)] = Luma8_sse2<24, 12>;
+      func_luma[make_tuple(24, 6, 1, USE_SSE2)] = Luma8_sse2<24, 6>;
+      func_luma[make_tuple(16, 64, 1, USE_SSE2)] = Luma8_sse2<16, 64>;
 #ifdef USE_LUMA_ASM
-    func_luma[make_tuple(16, 32, 1, USE_SSE2)] = Luma16x32_sse2;
-    func_luma[make_tuple(16, 16, 1, USE_SSE2)] = Luma16x16_sse2;
+      func_luma[make_tuple(16, 32, 1, USE_SSE2)] = Luma16x32_sse2;
+      func_luma[make_tuple(16, 16, 1, USE_SSE2)] = Luma16x16_sse2;
 #else
-    func_luma[make_tuple(16, 32, 1, USE_SSE2)] = Luma8_sse2<16, 32>;
-    func_luma[make_tuple(16, 16, 1, USE_SSE2)] = Luma8_sse2<16, 16>;
+      func_luma[make_tuple(16, 32, 1, USE_SSE2)] = Luma8_sse2<16, 32>;
+      func_luma[make_tuple(16, 16, 1, USE_SSE2)] = Luma8_sse2<16, 16>;
 #endif
-    func_luma[make_tuple(16, 12, 1, USE_SSE2)] = Luma8_sse2<16, 12>;
+      func_luma[make_tuple(16, 12, 1, USE_SSE2)] = Luma8_sse2<16, 12>;
 #ifdef USE_LUMA_ASM
-    func_luma[make_tuple(16, 8 , 1, USE_SSE2)] = Luma16x8_sse2;
+      func_luma[make_tuple(16, 8 , 1, USE_SSE2)] = Luma16x8_sse2;
 #else
-    func_luma[make_tuple(16, 8, 1, USE_SSE2)] = Luma8_sse2<16, 8>;
+      func_luma[make_tuple(16, 8, 1, USE_SSE2)] = Luma8_sse2<16, 8>;
 #endif
-    func_luma[make_tuple(16, 4, 1, USE_SSE2)] = Luma8_sse2<16, 4>;
+      func_luma[make_tuple(16, 4, 1, USE_SSE2)] = Luma8_sse2<16, 4>;
 #ifdef USE_LUMA_ASM
-    func_luma[make_tuple(16, 2 , 1, USE_SSE2)] = Luma16x2_sse2;
+      func_luma[make_tuple(16, 2 , 1, USE_SSE2)] = Luma16x2_sse2;
 #else
-    func_luma[make_tuple(16, 2, 1, USE_SSE2)] = Luma8_sse2<16, 2>;
+      func_luma[make_tuple(16, 2, 1, USE_SSE2)] = Luma8_sse2<16, 2>;
 #endif
-    func_luma[make_tuple(16, 1, 1, USE_SSE2)] = Luma8_sse2<16, 1>;
-    func_luma[make_tuple(8, 32, 1, USE_SSE2)] = Luma8_sse2<8, 32>;
-    func_luma[make_tuple(8, 16, 1, USE_SSE2)] = Luma8_sse2<8, 16>;
+      func_luma[make_tuple(16, 1, 1, USE_SSE2)] = Luma8_sse2<16, 1>;
+      func_luma[make_tuple(8, 32, 1, USE_SSE2)] = Luma8_sse2<8, 32>;
+      func_luma[make_tuple(8, 16, 1, USE_SSE2)] = Luma8_sse2<8, 16>;
 #ifdef USE_LUMA_ASM
-    func_luma[make_tuple(8 , 8 , 1, USE_SSE2)] = Luma8x8_sse2;
-    func_luma[make_tuple(8 , 4 , 1, USE_SSE2)] = Luma8x4_sse2;
+      func_luma[make_tuple(8 , 8 , 1, USE_SSE2)] = Luma8x8_sse2;
+      func_luma[make_tuple(8 , 4 , 1, USE_SSE2)] = Luma8x4_sse2;
 #else
-    func_luma[make_tuple(8, 8, 1, USE_SSE2)] = Luma8_sse2<8, 8>;
-    func_luma[make_tuple(8, 4, 1, USE_SSE2)] = Luma8_sse2<8, 4>;
+      func_luma[make_tuple(8, 8, 1, USE_SSE2)] = Luma8_sse2<8, 8>;
+      func_luma[make_tuple(8, 4, 1, USE_SSE2)] = Luma8_sse2<8, 4>;
 #endif
-    func_luma[make_tuple(8, 2, 1, USE_SSE2)] = Luma8_sse2<8, 2>;
+      func_luma[make_tuple(8, 2, 1, USE_SSE2)] = Luma8_sse2<8, 2>;
 #ifdef USE_LUMA_ASM
-    func_luma[make_tuple(4 , 4 , 1, USE_SSE2)] = Luma4x4_sse2;
+      func_luma[make_tuple(4 , 4 , 1, USE_SSE2)] = Luma4x4_sse2;
 #else
-    func_luma[make_tuple(4, 4, 1, USE_SSE2)] = Luma8_sse2<4, 4>;;
+      func_luma[make_tuple(4, 4, 1, USE_SSE2)] = Luma8_sse2<4, 4>;;
 #endif
-    // no 4,1 or 2,x,x for uint16_t
-    // nor 12*
+      // no 4,1 or 2,x,x for uint16_t
+      // nor 12*
 #define MAKE_LUMA_FN(x, y) func_luma[make_tuple(x, y, 2, USE_SSE2)] = Luma16_sse2<x, y>;
-    MAKE_LUMA_FN(64, 64)
-      MAKE_LUMA_FN(64, 48)
-      MAKE_LUMA_FN(64, 32)
-      MAKE_LUMA_FN(64, 16)
-      MAKE_LUMA_FN(48, 64)
-      MAKE_LUMA_FN(32, 64)
-      MAKE_LUMA_FN(32, 32)
-      MAKE_LUMA_FN(32, 24)
-      MAKE_LUMA_FN(32, 16)
-      MAKE_LUMA_FN(32, 8)
-      MAKE_LUMA_FN(24, 48)
-      MAKE_LUMA_FN(24, 32)
-      MAKE_LUMA_FN(24, 24)
-      MAKE_LUMA_FN(24, 12)
-      MAKE_LUMA_FN(24, 6)
-      MAKE_LUMA_FN(16, 64)
-      MAKE_LUMA_FN(16, 32)
-      MAKE_LUMA_FN(16, 16)
-      MAKE_LUMA_FN(16, 12)
-      MAKE_LUMA_FN(16, 8)
-      MAKE_LUMA_FN(16, 4)
-      MAKE_LUMA_FN(16, 2)
-      MAKE_LUMA_FN(16, 1)
-      MAKE_LUMA_FN(12, 48)
-      MAKE_LUMA_FN(12, 24)
-      MAKE_LUMA_FN(12, 16)
-      MAKE_LUMA_FN(12, 12)
-      MAKE_LUMA_FN(8, 32)
-      MAKE_LUMA_FN(8, 16)
-      MAKE_LUMA_FN(8, 8)
-      MAKE_LUMA_FN(8, 4)
-      MAKE_LUMA_FN(8, 2)
-      MAKE_LUMA_FN(8, 1)
-      MAKE_LUMA_FN(4, 8)
-      MAKE_LUMA_FN(4, 4)
-      MAKE_LUMA_FN(4, 2)
-      //MAKE_LUMA_FN(4, 1)
-      //MAKE_LUMA_FN(2, 4)
-      //MAKE_LUMA_FN(2, 2)
-      //MAKE_LUMA_FN(2, 1)
+      MAKE_LUMA_FN(64, 64)
+        MAKE_LUMA_FN(64, 48)
+        MAKE_LUMA_FN(64, 32)
+        MAKE_LUMA_FN(64, 16)
+        MAKE_LUMA_FN(48, 64)
+        MAKE_LUMA_FN(32, 64)
+        MAKE_LUMA_FN(32, 32)
+        MAKE_LUMA_FN(32, 24)
+        MAKE_LUMA_FN(32, 16)
+        MAKE_LUMA_FN(32, 8)
+        MAKE_LUMA_FN(24, 48)
+        MAKE_LUMA_FN(24, 32)
+        MAKE_LUMA_FN(24, 24)
+        MAKE_LUMA_FN(24, 12)
+        MAKE_LUMA_FN(24, 6)
+        MAKE_LUMA_FN(16, 64)
+        MAKE_LUMA_FN(16, 32)
+        MAKE_LUMA_FN(16, 16)
+        MAKE_LUMA_FN(16, 12)
+        MAKE_LUMA_FN(16, 8)
+        MAKE_LUMA_FN(16, 4)
+        MAKE_LUMA_FN(16, 2)
+        MAKE_LUMA_FN(16, 1)
+        MAKE_LUMA_FN(12, 48)
+        MAKE_LUMA_FN(12, 24)
+        MAKE_LUMA_FN(12, 16)
+        MAKE_LUMA_FN(12, 12)
+        MAKE_LUMA_FN(8, 32)
+        MAKE_LUMA_FN(8, 16)
+        MAKE_LUMA_FN(8, 8)
+        MAKE_LUMA_FN(8, 4)
+        MAKE_LUMA_FN(8, 2)
+        MAKE_LUMA_FN(8, 1)
+        MAKE_LUMA_FN(4, 8)
+        MAKE_LUMA_FN(4, 4)
+        MAKE_LUMA_FN(4, 2)
+        //MAKE_LUMA_FN(4, 1)
+        //MAKE_LUMA_FN(2, 4)
+        //MAKE_LUMA_FN(2, 2)
+        //MAKE_LUMA_FN(2, 1)
 #undef MAKE_LUMA_FN
+      return func_luma;
+    }();
 
     LUMAFunction *result = nullptr;
     arch_t archlist[] = { USE_AVX2, USE_AVX, USE_SSE41, USE_SSE2, NO_SIMD };
@@ -342,7 +345,7 @@ func_luma[make_tuple(x, y, 2, NO_SIMD)] = Luma_C<x, y, uint16_t>;
     while (result == nullptr) {
       arch_t current_arch_try = archlist[index++];
       if (current_arch_try > arch) continue;
-      result = func_luma[make_tuple(BlockX, BlockY, pixelsize, current_arch_try)];
+      result = find_function(func_luma_table, make_tuple(BlockX, BlockY, pixelsize, current_arch_try));
       if (result == nullptr && current_arch_try == NO_SIMD)
         break;
     }
@@ -111,6 +111,61 @@ private:
 
 
 
+// Large buffers (frame planes) on 2 MiB pages: transparent huge pages on
+// Linux, where the random accesses of the block search are TLB-bound.
+// Smaller blocks, or other platforms, fall back to a regular aligned
+// allocation. Blocks must be released with deallocate().
+class AllocHuge
+{
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	static const size_t  HUGE_PAGE_SIZE = size_t (1) << 21;
+	static const size_t  THRESHOLD = HUGE_PAGE_SIZE * 2;
+
+	// Returns nullptr on failure, like _aligned_malloc
+	static inline void *
+	               allocate (size_t nbr_bytes, size_t align);
+	static inline void
+	               deallocate (void *ptr);
+
+};	// class AllocHuge
+
+
+
+// AllocAlign through AllocHuge, for the containers of plane buffers
+template <typename T, long ALIG = 16>
+class AllocAlignHuge
+:	public AllocAlign <T, ALIG>
+{
+
+/*\\\ PUBLIC \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
+
+public:
+
+	typedef	typename AllocAlign <T, ALIG>::pointer	pointer;
+	typedef	typename AllocAlign <T, ALIG>::size_type	size_type;
+
+	               AllocAlignHuge ()                                       = default;
+	               AllocAlignHuge (AllocAlignHuge <T, ALIG> const &other)  = default;
+	template <typename U>
+	               AllocAlignHuge (AllocAlignHuge <U, ALIG> const &/*other*/) {}
+
+	inline pointer allocate (size_type n, typename std::allocator <void>::const_pointer ptr = nullptr);
+	inline void    deallocate (pointer p, size_type n);
+
+	template <typename U>
+	struct rebind
+	{
+		typedef AllocAlignHuge <U, ALIG> other;
+	};
+
+};	// class AllocAlignHuge
+
+
+
 }	// namespace fstb
 
 
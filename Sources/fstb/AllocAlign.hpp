@@ -23,11 +23,18 @@ http://sam.zoy.org/wtfpl/COPYING for more details.
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 #include "fstb/def.h"
+#include "MemInfo.h"
 
 #include <cassert>
 #if ! defined (_MSC_VER)
 	#include <cstdlib>
 #endif
+#if defined (_WIN32)
+	#include <malloc.h>
+#endif
+#if defined (__linux__)
+	#include <sys/mman.h>
+#endif
 
 
 
@@ -106,6 +113,7 @@ typename AllocAlign <T, ALIG>::pointer	AllocAlign <T, ALIG>::allocate (size_type
 		throw std::bad_alloc ();
 #endif
 	}
+	MemInfo::OnAlloc (zone_ptr, nbr_bytes);
 
 	return (zone_ptr);
 }
@@ -119,6 +127,7 @@ void	AllocAlign <T, ALIG>::deallocate (pointer ptr, size_type n)
 
 	if (ptr != nullptr)
 	{
+		MemInfo::OnFree (ptr);
 
 #if defined (_MSC_VER)
 
@@ -202,6 +211,91 @@ bool	AllocAlign <T, ALIG>::operator != (AllocAlign <T, ALIG> const &other)
 
 
 
+void *	AllocHuge::allocate (size_t nbr_bytes, size_t align)
+{
+	void *         zone_ptr = nullptr;
+
+#if defined (__linux__)
+
+	if (nbr_bytes >= THRESHOLD)
+	{
+		// Whole pages, so the tail of the block is covered too
+		const size_t   nbr_bytes_pg = (nbr_bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+		if (posix_memalign (&zone_ptr, HUGE_PAGE_SIZE, nbr_bytes_pg) == 0)
+		{
+	#if defined (MADV_HUGEPAGE)
+			// Only a hint, ignored when the huge pages are disabled
+			madvise (zone_ptr, nbr_bytes_pg, MADV_HUGEPAGE);
+	#endif
+			MemInfo::OnAlloc (zone_ptr, nbr_bytes_pg);
+			return zone_ptr;
+		}
+		zone_ptr = nullptr;
+	}
+
+#endif
+
+#if defined (_WIN32)
+	zone_ptr = _aligned_malloc (nbr_bytes, align);
+#else
+	if (align < sizeof (void *))
+	{
+		align = sizeof (void *);
+	}
+	if (posix_memalign (&zone_ptr, align, nbr_bytes) != 0)
+	{
+		zone_ptr = nullptr;
+	}
+#endif
+	MemInfo::OnAlloc (zone_ptr, nbr_bytes);
+
+	return zone_ptr;
+}
+
+
+
+void	AllocHuge::deallocate (void *ptr)
+{
+	MemInfo::OnFree (ptr);
+#if defined (_WIN32)
+	_aligned_free (ptr);
+#else
+	free (ptr);
+#endif
+}
+
+
+
+template <class T, long ALIG>
+typename AllocAlignHuge <T, ALIG>::pointer	AllocAlignHuge <T, ALIG>::allocate (size_type n, typename std::allocator <void>::const_pointer ptr)
+{
+	fstb::unused (ptr);
+
+	pointer        zone_ptr = static_cast <pointer> (
+		AllocHuge::allocate (sizeof (T) * n, ALIG)
+	);
+	if (zone_ptr == nullptr)
+	{
+#if defined (__cpp_exceptions) || ! defined (__GNUC__)
+		throw std::bad_alloc ();
+#endif
+	}
+
+	return (zone_ptr);
+}
+
+
+
+template <class T, long ALIG>
+void	AllocAlignHuge <T, ALIG>::deallocate (pointer ptr, size_type n)
+{
+	fstb::unused (n);
+
+	AllocHuge::deallocate (ptr);
+}
+
+
+
 /*\\\ PROTECTED \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 
@@ -39,12 +39,26 @@ enum arch_t {
     USE_AVX2
 };
 
+// lookup in a function table, nullptr when the configuration is missing.
+// The get_*_function() tables are function-local static const maps, filled
+// by a lambda on the first call (thread-safe initialization).
+template <class M, class K>
+typename M::mapped_type find_function(const M &table, const K &key)
+{
+  const auto it = table.find(key);
+  return (it != table.end()) ? it->second : nullptr;
+}
+
 typedef uint8_t BYTE;
 /*\\\ INCLUDE FILES \\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\\*/
 
 typedef unsigned int (SADFunction)(const uint8_t *pSrc, int nSrcPitch,
   const uint8_t *pRef, int nRefPitch);
 
+// SADs against 8 horizontally consecutive reference positions, see SADFunctions_sse41.h
+typedef void (SADRow8Function)(unsigned int *pSad8, const uint8_t *pSrc, int nSrcPitch,
+  const uint8_t *pRef, int nRefPitch);
+
 #endif	// types_HEADER_INCLUDED
 
 
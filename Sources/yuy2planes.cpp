@@ -22,6 +22,7 @@
 #include "types.h"
 #include <emmintrin.h>
 #include "avs/cpuid.h"
+#include "fstb/AllocAlign.h"
 
 YUY2Planes::YUY2Planes(int _nWidth, int _nHeight)
 {
@@ -29,16 +30,16 @@ YUY2Planes::YUY2Planes(int _nWidth, int _nHeight)
   nHeight = _nHeight;
   srcPitch = (nWidth + 15) & (~15);
   srcPitchUV = (nWidth / 2 + 15) & (~15); //v 1.2.1
-  pSrc = (unsigned char*)_aligned_malloc(srcPitch*nHeight, 128);   //v 1.2.1
-  pSrcU = (unsigned char*)_aligned_malloc(srcPitchUV*nHeight, 128);
-  pSrcV = (unsigned char*)_aligned_malloc(srcPitchUV*nHeight, 128);
+  pSrc = (unsigned char*)fstb::AllocHuge::allocate(srcPitch*nHeight, 128);   //v 1.2.1
+  pSrcU = (unsigned char*)fstb::AllocHuge::allocate(srcPitchUV*nHeight, 128);
+  pSrcV = (unsigned char*)fstb::AllocHuge::allocate(srcPitchUV*nHeight, 128);
 }
 
 YUY2Planes::~YUY2Planes()
 {
-  _aligned_free(pSrc);
-  _aligned_free(pSrcU);
-  _aligned_free(pSrcV);
+  fstb::AllocHuge::deallocate(pSrc);
+  fstb::AllocHuge::deallocate(pSrcU);
+  fstb::AllocHuge::deallocate(pSrcV);
 }
 
 // borrowed from Avisynth+ project